@@ -931,7 +931,7 @@ YOGI_API void MOCK_BranchSendBroadcast(decltype(YOGI_BranchSendBroadcast) fn) {
 // Mock implementation for YOGI_BranchSendBroadcastAsync
 static std::function<decltype(YOGI_BranchSendBroadcastAsync)> mock_BranchSendBroadcastAsync_fn = {};
 
-YOGI_API int YOGI_BranchSendBroadcastAsync(void* branch, int enc, const void* data, int datasize, int retry,
+YOGI_API int YOGI_BranchSendBroadcastAsync(void* branch, int enc, const void* data, int datasize, int retry, int prio,
                                            void (*fn)(int res, int oid, void* userarg), void* userarg) {
   std::lock_guard<std::mutex> lock(global_mock_mutex);
   if (!mock_BranchSendBroadcastAsync_fn) {
@@ -939,7 +939,7 @@ YOGI_API int YOGI_BranchSendBroadcastAsync(void* branch, int enc, const void* da
     return YOGI_ERR_UNKNOWN;
   }
 
-  return mock_BranchSendBroadcastAsync_fn(branch, enc, data, datasize, retry, fn, userarg);
+  return mock_BranchSendBroadcastAsync_fn(branch, enc, data, datasize, retry, prio, fn, userarg);
 }
 
 YOGI_API void MOCK_BranchSendBroadcastAsync(decltype(YOGI_BranchSendBroadcastAsync) fn) {
@@ -947,6 +947,25 @@ YOGI_API void MOCK_BranchSendBroadcastAsync(decltype(YOGI_BranchSendBroadcastAsy
   mock_BranchSendBroadcastAsync_fn = fn ? fn : decltype(mock_BranchSendBroadcastAsync_fn){};
 }
 
+// Mock implementation for YOGI_BranchSendToAsync
+static std::function<decltype(YOGI_BranchSendToAsync)> mock_BranchSendToAsync_fn = {};
+
+YOGI_API int YOGI_BranchSendToAsync(void* branch, const void* uuid, int enc, const void* data, int datasize,
+                                    int retry, int prio, void (*fn)(int res, int oid, void* userarg), void* userarg) {
+  std::lock_guard<std::mutex> lock(global_mock_mutex);
+  if (!mock_BranchSendToAsync_fn) {
+    std::cout << "WARNING: Unmonitored mock function call: YOGI_BranchSendToAsync()" << std::endl;
+    return YOGI_ERR_UNKNOWN;
+  }
+
+  return mock_BranchSendToAsync_fn(branch, uuid, enc, data, datasize, retry, prio, fn, userarg);
+}
+
+YOGI_API void MOCK_BranchSendToAsync(decltype(YOGI_BranchSendToAsync) fn) {
+  std::lock_guard<std::mutex> lock(global_mock_mutex);
+  mock_BranchSendToAsync_fn = fn ? fn : decltype(mock_BranchSendToAsync_fn){};
+}
+
 // Mock implementation for YOGI_BranchCancelSendBroadcast
 static std::function<decltype(YOGI_BranchCancelSendBroadcast)> mock_BranchCancelSendBroadcast_fn = {};
 
@@ -1209,6 +1228,7 @@ YOGI_API void MOCK_ResetMocks() {
   mock_BranchCancelAwaitEvent_fn             = {};
   mock_BranchSendBroadcast_fn                = {};
   mock_BranchSendBroadcastAsync_fn           = {};
+  mock_BranchSendToAsync_fn                  = {};
   mock_BranchCancelSendBroadcast_fn          = {};
   mock_BranchReceiveBroadcastAsync_fn        = {};
   mock_BranchCancelReceiveBroadcast_fn       = {};
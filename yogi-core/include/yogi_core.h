@@ -327,6 +327,15 @@
 //! Could not open file
 #define YOGI_ERR_OPEN_FILE_FAILED -50
 
+//! The data cannot be converted to the requested encoding
+#define YOGI_ERR_INCOMPATIBLE_ENCODING -51
+
+//! Not connected to the given branch
+#define YOGI_ERR_BRANCH_NOT_CONNECTED -52
+
+//! Broadcasts got lost and cannot be delivered
+#define YOGI_ERR_BROADCASTS_LOST -53
+
 //! @}
 //!
 //! @defgroup VB Log verbosity/severity
@@ -635,10 +644,28 @@
 //! \endcode
 #define YOGI_BEV_CONNECTION_LOST (1 << 3)
 
+//! Broadcasts multicast by a branch got lost and cannot be delivered
+//!
+//! This happens if lost datagrams could not be repaired in time or if the
+//! receive queue was full while the sending branch was blocked due to the
+//! block_peer broadcast queue policy. The event result is
+//! #YOGI_ERR_BROADCASTS_LOST.
+//!
+//! Associated event information:
+//!
+//! \code
+//!   {
+//!     "uuid":  "123e4567-e89b-12d3-a456-426655440000",
+//!     "count": 3
+//!   }
+//! \endcode
+#define YOGI_BEV_BROADCASTS_LOST (1 << 4)
+
 //! All branch events
 #define YOGI_BEV_ALL                                      \
   (YOGI_BEV_BRANCH_DISCOVERED | YOGI_BEV_BRANCH_QUERIED | \
-   YOGI_BEV_CONNECT_FINISHED | YOGI_BEV_CONNECTION_LOST)
+   YOGI_BEV_CONNECT_FINISHED | YOGI_BEV_CONNECTION_LOST | \
+   YOGI_BEV_BROADCASTS_LOST)
 
 //! @}
 //!
@@ -650,6 +677,18 @@
 
 #define YOGI_ENC_JSON 0     ///< Data is encoded as JSON
 #define YOGI_ENC_MSGPACK 1  ///< Data is encoded as MessagePack
+#define YOGI_ENC_RAW 2      ///< Opaque binary data that is passed through unchanged
+
+//! @}
+//!
+//! @defgroup PRIO Send priorities
+//!
+//! Priorities for sending messages to remote branches.
+//!
+//! @{
+
+#define YOGI_PRIO_NORMAL 0  ///< Regular messages
+#define YOGI_PRIO_HIGH 1    ///< Messages that overtake queued regular messages
 
 //! @}
 //!
@@ -2036,7 +2075,14 @@ YOGI_API int YOGI_BranchCancelAwaitEvent(void* branch);
  *   The payload in \p data can be given encoded in either JSON or MessagePack
  *   as specified in the \p datafmt parameter. It does not matter which format
  *   is chosen since the receivers can specify their desired format and the
- *   library performs the necessary conversions automatically.
+ *   library performs the necessary conversions automatically. Opaque binary
+ *   data can be sent with #YOGI_ENC_RAW; it is neither validated nor
+ *   converted and can only be received as #YOGI_ENC_RAW.
+ *
+ * Payloads larger than #YOGI_CONST_MAX_MESSAGE_PAYLOAD_SIZE are transparently
+ * split into fragments that are put into the send queues one after another.
+ * While a fragmented message is being queued on a connection, no other
+ * messages can be put into that connection's send queue.
  *
  * Setting the \p block parameter to #YOGI_FALSE will cause the function to skip
  * sending the message to branches that have a full send queue. If at least one
@@ -2045,6 +2091,15 @@ YOGI_API int YOGI_BranchCancelAwaitEvent(void* branch);
  * until the message has been put into the send queues of all connected
  * branches.
  *
+ * Broadcasts to branches that use the same broadcast_multicast_port get sent
+ * as a single UDP multicast datagram if they fit into one. Such broadcasts do
+ * not go through the send queues, so they are neither delayed by full queues
+ * nor ordered relative to broadcasts sent over the connections, e.g. larger
+ * broadcasts or the ones sent via YOGI_BranchSendToAsync(). A receiving branch
+ * using the block_peer broadcast queue policy cannot slow them down either;
+ * it discards them while its queue is full and reports them via the
+ * #YOGI_BEV_BROADCASTS_LOST event.
+ *
  * \attention
  *   Calling this function from within a handler function executed through the
  *   branch's _context_  with \p block set to #YOGI_TRUE will cause a dead-lock
@@ -2076,7 +2131,9 @@ YOGI_API int YOGI_BranchSendBroadcast(void* branch, int enc, const void* data,
  *   The payload in \p data can be given encoded in either JSON or MessagePack
  *   as specified in the \p datafmt parameter. It does not matter which format
  *   is chosen since the receivers can specify their desired format and the
- *   library performs the necessary conversions automatically.
+ *   library performs the necessary conversions automatically. Opaque binary
+ *   data can be sent with #YOGI_ENC_RAW; it is neither validated nor
+ *   converted and can only be received as #YOGI_ENC_RAW.
  *
  * The handler function \p fn will be called once the operation finishes. Its
  * parameters are:
@@ -2091,6 +2148,23 @@ YOGI_API int YOGI_BranchSendBroadcast(void* branch, int enc, const void* data,
  * \p fn will be called once the message has been put into the send queues of
  * all connected branches.
  *
+ * Each connection has a separate send queue for #YOGI_PRIO_HIGH messages.
+ * Messages from that queue get sent ahead of any queued #YOGI_PRIO_NORMAL
+ * messages as soon as the message currently being transmitted has been sent
+ * completely. The order of messages with the same priority is preserved.
+ * Payloads larger than #YOGI_CONST_MAX_MESSAGE_PAYLOAD_SIZE get fragmented
+ * and are always sent with #YOGI_PRIO_NORMAL. They always get queued as if
+ * \p retry was set to #YOGI_TRUE.
+ *
+ * Broadcasts to branches that use the same broadcast_multicast_port get sent
+ * as a single UDP multicast datagram if they fit into one. Such broadcasts do
+ * not go through the send queues, so they are neither delayed by full queues
+ * nor ordered relative to broadcasts sent over the connections, e.g. larger
+ * broadcasts or the ones sent via YOGI_BranchSendToAsync(). A receiving branch
+ * using the block_peer broadcast queue policy cannot slow them down either;
+ * it discards them while its queue is full and reports them via the
+ * #YOGI_BEV_BROADCASTS_LOST event.
+ *
  * The function returns an ID which uniquely identifies this send operation
  * until \p fn has been called. It can be used in a subsequent
  * YOGI_BranchCancelSendBroadcast() call to abort the operation.
@@ -2104,6 +2178,7 @@ YOGI_API int YOGI_BranchSendBroadcast(void* branch, int enc, const void* data,
  * \param[in] data     Payload encoded according to \p datafmt
  * \param[in] datasize Number of bytes in \p data
  * \param[in] retry    Retry sending the message (#YOGI_TRUE or #YOGI_FALSE)
+ * \param[in] prio     Send priority (see \ref PRIO)
  * \param[in] fn       Handler to call once the operation finishes
  * \param[in] userarg  User-specified argument to be passed to \p fn
  *
@@ -2111,16 +2186,73 @@ YOGI_API int YOGI_BranchSendBroadcast(void* branch, int enc, const void* data,
  * \returns [<0] An error code in case of a failure (see \ref EC)
  */
 YOGI_API int YOGI_BranchSendBroadcastAsync(
-    void* branch, int enc, const void* data, int datasize, int retry,
+    void* branch, int enc, const void* data, int datasize, int retry, int prio,
     void (*fn)(int res, int oid, void* userarg), void* userarg);
 
+/*!
+ * Sends a broadcast message to a single connected branch.
+ *
+ * This function works like YOGI_BranchSendBroadcastAsync() but puts the
+ * message only into the send queue of the connection to the branch with the
+ * UUID \p uuid. It is received like any other broadcast message, i.e. via
+ * YOGI_BranchReceiveBroadcastAsync(). This avoids sending messages that are
+ * only of interest to one branch, e.g. replies to requests, to all connected
+ * branches.
+ *
+ * If no session with the branch identified by \p uuid is running, the function
+ * fails with the #YOGI_ERR_BRANCH_NOT_CONNECTED error and \p fn will not be
+ * called.
+ *
+ * The handler function \p fn will be called once the operation finishes. Its
+ * parameters are:
+ *  -# __res__: #YOGI_OK or error code associated with the operation
+ *  -# __oid__: Operation ID as returned by this library function
+ *  -# __userarg__: Value of the user-specified \p userarg parameter
+ *
+ * Setting the \p retry parameter to #YOGI_FALSE will cause \p fn to be called
+ * with the #YOGI_ERR_TX_QUEUE_FULL error if the send queue of the connection is
+ * full. If the parameter is set to #YOGI_TRUE instead, \p fn will be called
+ * once the message has been put into the send queue. Payloads that get
+ * fragmented always get queued (see YOGI_BranchSendBroadcastAsync()).
+ *
+ * The message is always sent over the connection, so it is not ordered
+ * relative to broadcasts sent via UDP multicast (see
+ * YOGI_BranchSendBroadcastAsync()).
+ *
+ * The function returns an ID which uniquely identifies this send operation
+ * until \p fn has been called. It can be used in a subsequent
+ * YOGI_BranchCancelSendBroadcast() call to abort the operation.
+ *
+ * \note
+ *   The memory pointed to via \p data will be copied if necessary, i.e. \p data
+ *   only needs to remain valid until the function returns.
+ *
+ * \param[in] branch   The branch handle
+ * \param[in] uuid     UUID of the receiving branch (16 byte array)
+ * \param[in] enc      Encoding type used for \p data (see \ref ENC)
+ * \param[in] data     Payload encoded according to \p datafmt
+ * \param[in] datasize Number of bytes in \p data
+ * \param[in] retry    Retry sending the message (#YOGI_TRUE or #YOGI_FALSE)
+ * \param[in] prio     Send priority (see \ref PRIO)
+ * \param[in] fn       Handler to call once the operation finishes
+ * \param[in] userarg  User-specified argument to be passed to \p fn
+ *
+ * \returns [>0] Operation ID if successful
+ * \returns [<0] An error code in case of a failure (see \ref EC)
+ */
+YOGI_API int YOGI_BranchSendToAsync(
+    void* branch, const void* uuid, int enc, const void* data, int datasize,
+    int retry, int prio, void (*fn)(int res, int oid, void* userarg),
+    void* userarg);
+
 /*!
  * Cancels a send broadcast operation.
  *
  * Calling this function will cause the send operation with the specified
  * operation ID \p oid to be canceled, resulting in the handler function
- * registered via the YOGI_BranchSendBroadcastAsync() call that returned the
- * same \p oid to be called with the #YOGI_ERR_CANCELED error.
+ * registered via the YOGI_BranchSendBroadcastAsync() or
+ * YOGI_BranchSendToAsync() call that returned the same \p oid to be called
+ * with the #YOGI_ERR_CANCELED error.
  *
  * \note
  *   If the send operation has already been carried out but the handler function
@@ -2146,7 +2278,10 @@ YOGI_API int YOGI_BranchCancelSendBroadcast(void* branch, int oid);
  *
  * \note
  *   The desired encoding of the received payload can be set via \p datafmt.
- *   The library will automatically perform any necessary conversions.
+ *   The library will automatically perform any necessary conversions between
+ *   JSON and MessagePack. Payloads sent as #YOGI_ENC_RAW can only be received
+ *   as #YOGI_ENC_RAW and vice versa; otherwise \p fn will be called with the
+ *   #YOGI_ERR_INCOMPATIBLE_ENCODING error.
  *
  * This function will register \p fn to be called once a broadcast message has
  * been received. The parameters passed to \p fn are:
@@ -2160,7 +2295,11 @@ YOGI_API int YOGI_BranchCancelSendBroadcast(void* branch, int oid);
  *  - with the first \p datasize - 1 characters of the received payload plus a
  *    trailing zero if \p datafmt is #YOGI_ENC_JSON; and
  *  - with the first \p datasize bytes of the received payload if \p datafmt is
- *    #YOGI_ENC_MSGPACK.
+ *    #YOGI_ENC_MSGPACK or #YOGI_ENC_RAW.
+ *
+ * Fragmented payloads that do not need to be converted are written to \p data
+ * as their fragments arrive, i.e. the contents of \p data are undefined until
+ * \p fn has been called.
  *
  * If this function is called while a previous receive operation is still active
  * then the previous operation will be canceled with the #YOGI_ERR_CANCELED
@@ -76,6 +76,9 @@ const char* Result::description() const {
     case YOGI_ERR_CONFIGURATION_VALIDATION_FAILED: return "Validating the configuration failed";
     case YOGI_ERR_WORKER_ALREADY_ADDED: return "The context has already been added as a worker";
     case YOGI_ERR_OPEN_FILE_FAILED: return "Could not open file";
+    case YOGI_ERR_INCOMPATIBLE_ENCODING: return "The data cannot be converted to the requested encoding";
+    case YOGI_ERR_BRANCH_NOT_CONNECTED: return "Not connected to the given branch";
+    case YOGI_ERR_BROADCASTS_LOST: return "Broadcasts got lost and cannot be delivered";
     // :CODEGEN_END:
   }
   // clang-format on
@@ -0,0 +1,54 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <src/data/compression.h>
+
+#include <zlib.h>
+
+#include <limits>
+
+bool compress_data(const Byte* data, std::size_t size, SmallBuffer* buffer) {
+  if (size == 0 || size > std::numeric_limits<uLong>::max()) return false;
+
+  // Only as much output space as would make compression worthwhile
+  auto old_size = buffer->size();
+  buffer->resize(old_size + size - 1);
+
+  auto dest_size = static_cast<uLongf>(size - 1);
+  auto res = compress2(buffer->data() + old_size, &dest_size, data, static_cast<uLong>(size), Z_BEST_SPEED);
+  if (res != Z_OK) {
+    buffer->resize(old_size);
+    return false;
+  }
+
+  buffer->resize(old_size + dest_size);
+  return true;
+}
+
+bool decompress_data(const Byte* data, std::size_t size, Buffer* buffer) {
+  if (size > std::numeric_limits<uLong>::max() || buffer->size() > std::numeric_limits<uLongf>::max()) {
+    return false;
+  }
+
+  auto dest_size = static_cast<uLongf>(buffer->size());
+  auto res       = uncompress(buffer->data(), &dest_size, data, static_cast<uLong>(size));
+  return res == Z_OK && dest_size == buffer->size();
+}
@@ -0,0 +1,35 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <src/data/buffer.h>
+
+// Appends the zlib-compressed data to buffer. Returns false and leaves buffer
+// unchanged if the compressed data would not be smaller than the input.
+bool compress_data(const Byte* data, std::size_t size, SmallBuffer* buffer);
+
+// Decompresses zlib-compressed data into buffer which has to be sized to hold
+// exactly the decompressed data. Returns false if the data is corrupt or if
+// its decompressed size does not match the size of buffer.
+bool decompress_data(const Byte* data, std::size_t size, Buffer* buffer);
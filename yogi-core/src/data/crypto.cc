@@ -22,7 +22,9 @@
 #include <src/data/crypto.h>
 #include <src/util/hex.h>
 
+#include <openssl/crypto.h>
 #include <openssl/err.h>
+#include <openssl/hmac.h>
 #include <openssl/rand.h>
 #include <openssl/sha.h>
 #include <limits>
@@ -52,6 +54,24 @@ Buffer make_sha256(std::string_view data) {
   return make_sha256_impl(data.data(), data.size());
 }
 
+Buffer make_hmac_sha256(const Buffer& key, const Byte* data, std::size_t size) {
+  Buffer mac(SHA256_DIGEST_LENGTH);
+
+  unsigned int mac_size = 0;
+  HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()), data, size, mac.data(), &mac_size);
+  YOGI_ASSERT(mac_size == mac.size());
+
+  return mac;
+}
+
+bool secure_equal(const Byte* a, const Byte* b, std::size_t size) {
+  return CRYPTO_memcmp(a, b, size) == 0;
+}
+
+bool secure_equal(const Buffer& a, const Buffer& b) {
+  return a.size() == b.size() && secure_equal(a.data(), b.data(), a.size());
+}
+
 Buffer generate_random_bytes(std::size_t n) {
   Buffer bytes(n);
 
@@ -29,5 +29,10 @@
 
 Buffer make_sha256(const Buffer& data);
 Buffer make_sha256(std::string_view data);
+Buffer make_hmac_sha256(const Buffer& key, const Byte* data, std::size_t size);
+
+// Compares in constant time in order not to leak how many bytes match
+bool secure_equal(const Byte* a, const Byte* b, std::size_t size);
+bool secure_equal(const Buffer& a, const Buffer& b);
 
 Buffer generate_random_bytes(std::size_t n);
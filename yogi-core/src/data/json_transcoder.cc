@@ -0,0 +1,607 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <src/api/errors.h>
+#include <src/data/json_transcoder.h>
+
+#include <boost/container/small_vector.hpp>
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+template <typename UInt>
+void append_big_endian(SmallBuffer* buffer, UInt val) {
+  for (int i = static_cast<int>(sizeof(UInt)) - 1; i >= 0; --i) {
+    buffer->push_back(static_cast<Byte>(val >> (i * 8)));
+  }
+}
+
+// SAX handler for nlohmann::json that writes MessagePack directly. Since the
+// number of elements in a container is only known once the container ends,
+// space for the largest possible header gets reserved and the content gets
+// moved back afterwards if a shorter header suffices.
+class JsonToMsgPackSax {
+ public:
+  using json              = nlohmann::json;
+  using number_integer_t  = json::number_integer_t;
+  using number_unsigned_t = json::number_unsigned_t;
+  using number_float_t    = json::number_float_t;
+  using string_t          = json::string_t;
+  using binary_t          = json::binary_t;
+
+  explicit JsonToMsgPackSax(SmallBuffer* out) : out_(out) {
+  }
+
+  bool null() {
+    add_value();
+    out_->push_back(0xC0);
+    return true;
+  }
+
+  bool boolean(bool val) {
+    add_value();
+    out_->push_back(val ? 0xC3 : 0xC2);
+    return true;
+  }
+
+  bool number_integer(number_integer_t val) {
+    add_value();
+    if (val >= 0) {
+      write_unsigned(static_cast<std::uint64_t>(val));
+    } else {
+      write_negative(val);
+    }
+
+    return true;
+  }
+
+  bool number_unsigned(number_unsigned_t val) {
+    add_value();
+    write_unsigned(val);
+    return true;
+  }
+
+  bool number_float(number_float_t val, const string_t&) {
+    add_value();
+    write_float(val);
+    return true;
+  }
+
+  bool string(string_t& val) {
+    add_value();
+    write_string(val);
+    return true;
+  }
+
+  bool binary(binary_t&) {
+    // Binary values do not exist in JSON
+    YOGI_NEVER_REACHED;
+    return false;
+  }
+
+  bool start_object(std::size_t) {
+    add_value();
+    open_container(true);
+    return true;
+  }
+
+  bool key(string_t& val) {
+    write_string(val);
+    return true;
+  }
+
+  bool end_object() {
+    close_container();
+    return true;
+  }
+
+  bool start_array(std::size_t) {
+    add_value();
+    open_container(false);
+    return true;
+  }
+
+  bool end_array() {
+    close_container();
+    return true;
+  }
+
+  bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) {
+    throw DescriptiveError(YOGI_ERR_PARSING_JSON_FAILED) << ex.what();
+  }
+
+ private:
+  static constexpr std::size_t kMaxContainerHeaderSize = 5;
+
+  struct Container {
+    std::size_t header_pos;
+    std::size_t size;
+    bool is_map;
+  };
+
+  void add_value() {
+    if (!containers_.empty()) {
+      ++containers_.back().size;
+    }
+  }
+
+  void open_container(bool is_map) {
+    containers_.push_back({out_->size(), 0, is_map});
+    out_->resize(out_->size() + kMaxContainerHeaderSize);
+  }
+
+  void close_container() {
+    auto container = containers_.back();
+    containers_.pop_back();
+
+    SmallBuffer header;
+    if (container.size <= 15) {
+      header.push_back(static_cast<Byte>((container.is_map ? 0x80 : 0x90) | container.size));
+    } else if (container.size <= std::numeric_limits<std::uint16_t>::max()) {
+      header.push_back(container.is_map ? 0xDE : 0xDC);
+      append_big_endian(&header, static_cast<std::uint16_t>(container.size));
+    } else {
+      header.push_back(container.is_map ? 0xDF : 0xDD);
+      append_big_endian(&header, static_cast<std::uint32_t>(container.size));
+    }
+
+    auto header_it  = out_->begin() + static_cast<std::ptrdiff_t>(container.header_pos);
+    auto content_it = header_it + static_cast<std::ptrdiff_t>(kMaxContainerHeaderSize);
+    auto gap        = static_cast<std::ptrdiff_t>(kMaxContainerHeaderSize - header.size());
+    if (gap > 0) {
+      std::move(content_it, out_->end(), content_it - gap);
+      out_->resize(out_->size() - static_cast<std::size_t>(gap));
+    }
+
+    std::copy(header.begin(), header.end(), header_it);
+  }
+
+  void write_unsigned(std::uint64_t val) {
+    if (val <= 0x7F) {
+      out_->push_back(static_cast<Byte>(val));
+    } else if (val <= std::numeric_limits<std::uint8_t>::max()) {
+      out_->push_back(0xCC);
+      append_big_endian(out_, static_cast<std::uint8_t>(val));
+    } else if (val <= std::numeric_limits<std::uint16_t>::max()) {
+      out_->push_back(0xCD);
+      append_big_endian(out_, static_cast<std::uint16_t>(val));
+    } else if (val <= std::numeric_limits<std::uint32_t>::max()) {
+      out_->push_back(0xCE);
+      append_big_endian(out_, static_cast<std::uint32_t>(val));
+    } else {
+      out_->push_back(0xCF);
+      append_big_endian(out_, val);
+    }
+  }
+
+  void write_negative(std::int64_t val) {
+    if (val >= -32) {
+      out_->push_back(static_cast<Byte>(val));
+    } else if (val >= std::numeric_limits<std::int8_t>::min()) {
+      out_->push_back(0xD0);
+      append_big_endian(out_, static_cast<std::uint8_t>(val));
+    } else if (val >= std::numeric_limits<std::int16_t>::min()) {
+      out_->push_back(0xD1);
+      append_big_endian(out_, static_cast<std::uint16_t>(val));
+    } else if (val >= std::numeric_limits<std::int32_t>::min()) {
+      out_->push_back(0xD2);
+      append_big_endian(out_, static_cast<std::uint32_t>(val));
+    } else {
+      out_->push_back(0xD3);
+      append_big_endian(out_, static_cast<std::uint64_t>(val));
+    }
+  }
+
+  void write_float(double val) {
+    // Same as nlohmann::json: use single precision if it is lossless
+    if (val >= static_cast<double>(std::numeric_limits<float>::lowest()) &&
+        val <= static_cast<double>(std::numeric_limits<float>::max()) &&
+        static_cast<double>(static_cast<float>(val)) == val) {
+      auto f = static_cast<float>(val);
+      std::uint32_t bits;
+      std::memcpy(&bits, &f, sizeof(bits));
+      out_->push_back(0xCA);
+      append_big_endian(out_, bits);
+    } else {
+      std::uint64_t bits;
+      std::memcpy(&bits, &val, sizeof(bits));
+      out_->push_back(0xCB);
+      append_big_endian(out_, bits);
+    }
+  }
+
+  void write_string(const string_t& str) {
+    auto n = str.size();
+    if (n <= 31) {
+      out_->push_back(static_cast<Byte>(0xA0 | n));
+    } else if (n <= std::numeric_limits<std::uint8_t>::max()) {
+      out_->push_back(0xD9);
+      append_big_endian(out_, static_cast<std::uint8_t>(n));
+    } else if (n <= std::numeric_limits<std::uint16_t>::max()) {
+      out_->push_back(0xDA);
+      append_big_endian(out_, static_cast<std::uint16_t>(n));
+    } else {
+      out_->push_back(0xDB);
+      append_big_endian(out_, static_cast<std::uint32_t>(n));
+    }
+
+    out_->insert(out_->end(), str.begin(), str.end());
+  }
+
+  SmallBuffer* out_;
+  boost::container::small_vector<Container, 16> containers_;
+};
+
+// Writes JSON text into a fixed-size buffer and keeps counting once the buffer
+// is full so that the required size is known in the end
+class JsonWriter {
+ public:
+  explicit JsonWriter(boost::asio::mutable_buffer buffer)
+      : data_(static_cast<char*>(buffer.data())), capacity_(buffer.size()), size_(0) {
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+  void put(char ch) {
+    if (size_ < capacity_) {
+      data_[size_] = ch;
+    }
+
+    ++size_;
+  }
+
+  void write(const char* str, std::size_t n) {
+    if (size_ < capacity_) {
+      std::memcpy(data_ + size_, str, std::min(n, capacity_ - size_));
+    }
+
+    size_ += n;
+  }
+
+  template <std::size_t N>
+  void write(const char (&str)[N]) {
+    write(str, N - 1);
+  }
+
+  template <typename Int>
+  void write_integer(Int val) {
+    std::array<char, 24> buf;
+    auto res = std::to_chars(buf.data(), buf.data() + buf.size(), val);
+    write(buf.data(), static_cast<std::size_t>(res.ptr - buf.data()));
+  }
+
+  void write_float(double val) {
+    if (!std::isfinite(val)) {
+      write("null");
+      return;
+    }
+
+    // Same routine as used by nlohmann::json::dump()
+    std::array<char, 64> buf;
+    auto end = nlohmann::detail::to_chars(buf.data(), buf.data() + buf.size(), val);
+    write(buf.data(), static_cast<std::size_t>(end - buf.data()));
+  }
+
+ private:
+  char* data_;
+  const std::size_t capacity_;
+  std::size_t size_;
+};
+
+// Reads MessagePack data item by item and writes the corresponding JSON text;
+// uses an explicit stack instead of recursion for nested containers
+class MsgPackToJsonTranscoder {
+ public:
+  MsgPackToJsonTranscoder(const Byte* data, std::size_t size, JsonWriter* out)
+      : begin_(data), pos_(data), end_(data + size), out_(out) {
+  }
+
+  void run() {
+    do {
+      write_separator();
+      transcode_item();
+    } while (!containers_.empty());
+
+    if (pos_ != end_) {
+      throw_error("Unexpected data after the end of the top-level value");
+    }
+  }
+
+ private:
+  struct Container {
+    std::size_t remaining_items;  // keys and values for maps
+    bool is_map;
+    bool first;
+  };
+
+  bool expecting_key() const {
+    if (containers_.empty()) return false;
+    auto& container = containers_.back();
+    return container.is_map && container.remaining_items % 2 == 0;
+  }
+
+  void write_separator() {
+    if (containers_.empty()) return;
+
+    auto& container = containers_.back();
+    if (container.is_map && !expecting_key()) {
+      out_->put(':');
+    } else if (!container.first) {
+      out_->put(',');
+    }
+
+    container.first = false;
+  }
+
+  void transcode_item() {
+    auto type = read<std::uint8_t>();
+
+    if (expecting_key() && !(type >= 0xA0 && type <= 0xBF) && !(type >= 0xD9 && type <= 0xDB)) {
+      throw_error("Map keys must be strings");
+    }
+
+    if (type <= 0x7F) {
+      out_->write_integer(type);
+    } else if (type <= 0x8F) {
+      open_container(type & 0x0F, true);
+      return;
+    } else if (type <= 0x9F) {
+      open_container(type & 0x0F, false);
+      return;
+    } else if (type <= 0xBF) {
+      write_string(type & 0x1F);
+    } else if (type >= 0xE0) {
+      out_->write_integer(static_cast<std::int8_t>(type));
+    } else {
+      switch (type) {
+        // clang-format off
+        case 0xC0: out_->write("null"); break;
+        case 0xC2: out_->write("false"); break;
+        case 0xC3: out_->write("true"); break;
+        case 0xC4: write_binary(read<std::uint8_t>(), false); break;
+        case 0xC5: write_binary(read<std::uint16_t>(), false); break;
+        case 0xC6: write_binary(read<std::uint32_t>(), false); break;
+        case 0xC7: write_binary(read<std::uint8_t>(), true); break;
+        case 0xC8: write_binary(read<std::uint16_t>(), true); break;
+        case 0xC9: write_binary(read<std::uint32_t>(), true); break;
+        case 0xCA: out_->write_float(read_float<float, std::uint32_t>()); break;
+        case 0xCB: out_->write_float(read_float<double, std::uint64_t>()); break;
+        case 0xCC: out_->write_integer(read<std::uint8_t>()); break;
+        case 0xCD: out_->write_integer(read<std::uint16_t>()); break;
+        case 0xCE: out_->write_integer(read<std::uint32_t>()); break;
+        case 0xCF: out_->write_integer(read<std::uint64_t>()); break;
+        case 0xD0: out_->write_integer(static_cast<std::int8_t>(read<std::uint8_t>())); break;
+        case 0xD1: out_->write_integer(static_cast<std::int16_t>(read<std::uint16_t>())); break;
+        case 0xD2: out_->write_integer(static_cast<std::int32_t>(read<std::uint32_t>())); break;
+        case 0xD3: out_->write_integer(static_cast<std::int64_t>(read<std::uint64_t>())); break;
+        case 0xD4: write_binary(1, true); break;
+        case 0xD5: write_binary(2, true); break;
+        case 0xD6: write_binary(4, true); break;
+        case 0xD7: write_binary(8, true); break;
+        case 0xD8: write_binary(16, true); break;
+        case 0xD9: write_string(read<std::uint8_t>()); break;
+        case 0xDA: write_string(read<std::uint16_t>()); break;
+        case 0xDB: write_string(read<std::uint32_t>()); break;
+        case 0xDC: open_container(read<std::uint16_t>(), false); return;
+        case 0xDD: open_container(read<std::uint32_t>(), false); return;
+        case 0xDE: open_container(read<std::uint16_t>(), true); return;
+        case 0xDF: open_container(read<std::uint32_t>(), true); return;
+        default: throw_error("Invalid type byte");
+          // clang-format on
+      }
+    }
+
+    finish_item();
+  }
+
+  void open_container(std::size_t size, bool is_map) {
+    out_->put(is_map ? '{' : '[');
+
+    if (size == 0) {
+      out_->put(is_map ? '}' : ']');
+      finish_item();
+    } else {
+      containers_.push_back({is_map ? size * 2 : size, is_map, true});
+    }
+  }
+
+  void finish_item() {
+    while (!containers_.empty()) {
+      auto& container = containers_.back();
+      if (--container.remaining_items > 0) return;
+
+      out_->put(container.is_map ? '}' : ']');
+      containers_.pop_back();
+    }
+  }
+
+  void write_string(std::size_t size) {
+    auto str = read_bytes(size);
+    auto end = str + size;
+
+    out_->put('"');
+
+    auto unescaped_begin = str;
+    auto flush           = [&](const Byte* p) {
+      out_->write(reinterpret_cast<const char*>(unescaped_begin), static_cast<std::size_t>(p - unescaped_begin));
+    };
+
+    for (auto p = str; p < end;) {
+      if (*p >= 0x80) {
+        auto n = get_utf8_sequence_length(p, end);
+        if (n == 0) throw_error("Invalid UTF-8 string");
+        p += n;
+        continue;
+      }
+
+      if (*p >= 0x20 && *p != '"' && *p != '\\') {
+        ++p;
+        continue;
+      }
+
+      flush(p);
+      write_escaped(*p);
+      unescaped_begin = ++p;
+    }
+
+    flush(end);
+    out_->put('"');
+  }
+
+  void write_escaped(Byte ch) {
+    switch (ch) {
+      // clang-format off
+      case '"':  out_->write("\\\""); break;
+      case '\\': out_->write("\\\\"); break;
+      case '\b': out_->write("\\b"); break;
+      case '\f': out_->write("\\f"); break;
+      case '\n': out_->write("\\n"); break;
+      case '\r': out_->write("\\r"); break;
+      case '\t': out_->write("\\t"); break;
+      // clang-format on
+
+      default: {
+        static const char hex[] = "0123456789abcdef";
+        char buf[] = {'\\', 'u', '0', '0', hex[ch >> 4], hex[ch & 0x0F]};
+        out_->write(buf, sizeof(buf));
+        break;
+      }
+    }
+  }
+
+  // Returns 0 for invalid sequences, including overlong encodings, surrogates
+  // and code points beyond U+10FFFF
+  static std::size_t get_utf8_sequence_length(const Byte* p, const Byte* end) {
+    auto in_range = [&](std::size_t idx, Byte lo, Byte hi) {
+      return p + idx < end && p[idx] >= lo && p[idx] <= hi;
+    };
+
+    auto ch = p[0];
+    if (ch >= 0xC2 && ch <= 0xDF) {
+      return in_range(1, 0x80, 0xBF) ? 2 : 0;
+    }
+
+    if (ch >= 0xE0 && ch <= 0xEF) {
+      Byte lo = ch == 0xE0 ? 0xA0 : 0x80;
+      Byte hi = ch == 0xED ? 0x9F : 0xBF;
+      return in_range(1, lo, hi) && in_range(2, 0x80, 0xBF) ? 3 : 0;
+    }
+
+    if (ch >= 0xF0 && ch <= 0xF4) {
+      Byte lo = ch == 0xF0 ? 0x90 : 0x80;
+      Byte hi = ch == 0xF4 ? 0x8F : 0xBF;
+      return in_range(1, lo, hi) && in_range(2, 0x80, 0xBF) && in_range(3, 0x80, 0xBF) ? 4 : 0;
+    }
+
+    return 0;
+  }
+
+  // Same representation as nlohmann::json::dump() uses for binary values
+  void write_binary(std::size_t size, bool has_subtype) {
+    std::uint8_t subtype = has_subtype ? read<std::uint8_t>() : 0;
+    auto data            = read_bytes(size);
+
+    out_->write("{\"bytes\":[");
+    for (std::size_t i = 0; i < size; ++i) {
+      if (i > 0) out_->put(',');
+      out_->write_integer(data[i]);
+    }
+
+    out_->write("],\"subtype\":");
+    if (has_subtype) {
+      out_->write_integer(subtype);
+    } else {
+      out_->write("null");
+    }
+
+    out_->put('}');
+  }
+
+  const Byte* read_bytes(std::size_t n) {
+    if (static_cast<std::size_t>(end_ - pos_) < n) {
+      throw_error("Insufficient bytes");
+    }
+
+    auto p = pos_;
+    pos_ += n;
+    return p;
+  }
+
+  template <typename UInt>
+  UInt read() {
+    auto p   = read_bytes(sizeof(UInt));
+    UInt val = 0;
+    for (std::size_t i = 0; i < sizeof(UInt); ++i) {
+      val = static_cast<UInt>((val << 8) | p[i]);
+    }
+
+    return val;
+  }
+
+  template <typename Float, typename UInt>
+  double read_float() {
+    static_assert(sizeof(Float) == sizeof(UInt), "Size mismatch");
+
+    auto bits = read<UInt>();
+    Float val;
+    std::memcpy(&val, &bits, sizeof(val));
+    return static_cast<double>(val);
+  }
+
+  [[noreturn]] void throw_error(const char* what) {
+    throw DescriptiveError(YOGI_ERR_INVALID_USER_MSGPACK) << what << " at offset " << (pos_ - begin_);
+  }
+
+  const Byte* const begin_;
+  const Byte* pos_;
+  const Byte* const end_;
+  JsonWriter* out_;
+  boost::container::small_vector<Container, 16> containers_;
+};
+
+}  // anonymous namespace
+
+void transcode_json_to_msgpack(const char* json, std::size_t size, SmallBuffer* msgpack) {
+  auto initial_size = msgpack->size();
+
+  try {
+    JsonToMsgPackSax sax(msgpack);
+    nlohmann::json::sax_parse(json, json + size, &sax);
+  } catch (...) {
+    msgpack->resize(initial_size);
+    throw;
+  }
+}
+
+std::size_t transcode_msgpack_to_json(const Byte* msgpack, std::size_t size, boost::asio::mutable_buffer json) {
+  JsonWriter writer(json);
+  MsgPackToJsonTranscoder(msgpack, size, &writer).run();
+  writer.put('\0');
+  return writer.size();
+}
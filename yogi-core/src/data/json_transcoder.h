@@ -0,0 +1,43 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <src/data/buffer.h>
+
+#include <boost/asio/buffer.hpp>
+
+// Streaming conversion between JSON text and MessagePack without creating
+// intermediate JSON objects. The output is the same as going through
+// nlohmann::json, except that the order of the keys in maps is preserved.
+
+// Converts size bytes of JSON text (without a terminating zero) into
+// MessagePack and appends the result to msgpack; throws a DescriptiveError
+// with YOGI_ERR_PARSING_JSON_FAILED if the JSON is invalid
+void transcode_json_to_msgpack(const char* json, std::size_t size, SmallBuffer* msgpack);
+
+// Converts MessagePack data into zero-terminated JSON text and writes as much
+// of it as fits into json; returns the number of bytes required for the full
+// text including the terminating zero. Throws a DescriptiveError with
+// YOGI_ERR_INVALID_USER_MSGPACK if the data is invalid.
+std::size_t transcode_msgpack_to_json(const Byte* msgpack, std::size_t size, boost::asio::mutable_buffer json);
@@ -0,0 +1,124 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <src/data/msgpack_validator.h>
+
+#include <cstdint>
+
+namespace {
+
+// Number of bytes following the type byte that hold the length of a
+// str/bin/ext body or the element count of an array/map
+const std::uint8_t kLengthFieldSize[32] = {
+    // clang-format off
+    0, 0, 0, 0,     // 0xC0-0xC3 nil, (never used), false, true
+    1, 2, 4,        // 0xC4-0xC6 bin 8/16/32
+    1, 2, 4,        // 0xC7-0xC9 ext 8/16/32
+    0, 0,           // 0xCA-0xCB float 32/64
+    0, 0, 0, 0,     // 0xCC-0xCF uint 8/16/32/64
+    0, 0, 0, 0,     // 0xD0-0xD3 int 8/16/32/64
+    0, 0, 0, 0, 0,  // 0xD4-0xD8 fixext 1/2/4/8/16
+    1, 2, 4,        // 0xD9-0xDB str 8/16/32
+    2, 4,           // 0xDC-0xDD array 16/32
+    2, 4,           // 0xDE-0xDF map 16/32
+    // clang-format on
+};
+
+// Number of bytes in the body of a type in addition to the length given in its
+// length field (if any)
+const std::uint8_t kFixedBodySize[32] = {
+    // clang-format off
+    0, 0, 0, 0,     // 0xC0-0xC3 nil, (never used), false, true
+    0, 0, 0,        // 0xC4-0xC6 bin 8/16/32
+    1, 1, 1,        // 0xC7-0xC9 ext 8/16/32: type
+    4, 8,           // 0xCA-0xCB float 32/64
+    1, 2, 4, 8,     // 0xCC-0xCF uint 8/16/32/64
+    1, 2, 4, 8,     // 0xD0-0xD3 int 8/16/32/64
+    2, 3, 5, 9, 17, // 0xD4-0xD8 fixext 1/2/4/8/16: type and data
+    0, 0, 0,        // 0xD9-0xDB str 8/16/32
+    0, 0,           // 0xDC-0xDD array 16/32
+    0, 0,           // 0xDE-0xDF map 16/32
+    // clang-format on
+};
+
+}  // anonymous namespace
+
+bool validate_msgpack(const Byte* data, std::size_t size, std::size_t* error_offset) {
+  const Byte* p   = data;
+  const Byte* end = data + size;
+
+  auto fail = [&] {
+    *error_offset = static_cast<std::size_t>(p - data);
+    return false;
+  };
+
+  // Instead of keeping a stack of containers, only the total number of items
+  // that still have to follow is tracked. Since every item takes at least one
+  // byte, the count can never legitimately exceed the number of bytes left.
+  std::uint64_t remaining = 1;
+  while (remaining > 0) {
+    if (remaining > static_cast<std::uint64_t>(end - p)) return fail();
+    --remaining;
+
+    auto type = *p;
+    std::uint64_t body_size;
+
+    if (type <= 0x7F || type >= 0xE0) {  // positive and negative fixint
+      body_size = 0;
+    } else if (type <= 0x8F) {  // fixmap
+      remaining += 2u * (type & 0x0Fu);
+      body_size = 0;
+    } else if (type <= 0x9F) {  // fixarray
+      remaining += type & 0x0Fu;
+      body_size = 0;
+    } else if (type <= 0xBF) {  // fixstr
+      body_size = type & 0x1Fu;
+    } else if (type == 0xC1) {
+      return fail();
+    } else {
+      auto idx = type - 0xC0u;
+      auto n   = kLengthFieldSize[idx];
+      if (static_cast<std::size_t>(end - p) <= n) return fail();
+
+      std::uint64_t length = 0;
+      for (std::size_t i = 1; i <= n; ++i) {
+        length = (length << 8) | p[i];
+      }
+
+      if (type >= 0xDC) {  // array and map 16/32
+        remaining += type >= 0xDE ? 2 * length : length;
+        body_size = 0;
+      } else {
+        body_size = length + kFixedBodySize[idx];
+      }
+
+      p += n;
+    }
+
+    ++p;
+    if (body_size > static_cast<std::uint64_t>(end - p)) return fail();
+    p += body_size;
+  }
+
+  if (p != end) return fail();
+
+  return true;
+}
@@ -0,0 +1,32 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <src/data/buffer.h>
+
+// Checks that data contains exactly one complete MessagePack object by only
+// looking at type bytes and lengths; the contents of strings, binary data and
+// extensions are skipped. Does not allocate any memory. Returns false and sets
+// error_offset to the position of the offending byte if the data is invalid.
+bool validate_msgpack(const Byte* data, std::size_t size, std::size_t* error_offset);
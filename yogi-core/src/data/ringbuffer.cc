@@ -21,10 +21,28 @@
 
 #include <src/data/ringbuffer.h>
 
-LockFreeRingBuffer::LockFreeRingBuffer(size_type capacity) : capacity_(capacity) {
-  write_idx_ = 0;
-  read_idx_  = 0;
-  data_.resize(capacity + 1);
+#include <thread>
+
+LockFreeRingBuffer::LockFreeRingBuffer(size_type capacity, bool mirrored) {
+  reserve_idx_ = 0;
+  write_idx_   = 0;
+  read_idx_    = 0;
+
+  if (mirrored) {
+    mirrored_data_ = MirroredMemory::try_create(capacity + 1);
+  }
+
+  if (mirrored_data_) {
+    data_ = mirrored_data_->data();
+    size_ = mirrored_data_->size();
+  } else {
+    heap_data_.resize(capacity + 1);
+    data_ = heap_data_.data();
+    size_ = heap_data_.size();
+  }
+
+  capacity_ = size_ - 1;
+  YOGI_UNUSED(reserve_padding_);
   YOGI_UNUSED(padding_);
 }
 
@@ -75,20 +93,18 @@ LockFreeRingBuffer::size_type LockFreeRingBuffer::read(Byte* buffer, size_type m
   max_size = std::min(max_size, avail);
 
   auto new_ri = ri + max_size;
-  if (new_ri > data_.size()) {
-    auto count_0 = data_.size() - ri;
+  if (new_ri > size_ && !mirrored()) {
+    auto count_0 = size_ - ri;
     auto count_1 = max_size - count_0;
 
-    std::copy(data_.begin() + static_cast<long>(ri), data_.begin() + static_cast<long>(data_.size()), buffer);
-    std::copy(data_.begin(), data_.begin() + static_cast<long>(count_1), buffer + count_0);
-
-    new_ri -= data_.size();
+    std::copy(data_ + ri, data_ + size_, buffer);
+    std::copy(data_, data_ + count_1, buffer + count_0);
   } else {
-    std::copy(data_.begin() + static_cast<long>(ri), data_.begin() + static_cast<long>(ri + max_size), buffer);
+    std::copy(data_ + ri, data_ + ri + max_size, buffer);
+  }
 
-    if (new_ri == data_.size()) {
-      new_ri = 0;
-    }
+  if (new_ri >= size_) {
+    new_ri -= size_;
   }
 
   read_idx_.store(new_ri, std::memory_order_release);
@@ -107,12 +123,8 @@ LockFreeRingBuffer::size_type LockFreeRingBuffer::discard(size_type max_size) {
   max_size = std::min(max_size, avail);
 
   auto new_ri = ri + max_size;
-  if (new_ri > data_.size()) {
-    new_ri -= data_.size();
-  } else {
-    if (new_ri == data_.size()) {
-      new_ri = 0;
-    }
+  if (new_ri >= size_) {
+    new_ri -= size_;
   }
 
   read_idx_.store(new_ri, std::memory_order_release);
@@ -128,21 +140,51 @@ void LockFreeRingBuffer::commit_first_read_array(size_type n) {
   auto ri = read_idx_.load(std::memory_order_relaxed);
 
   ri += n;
-  if (ri == data_.size()) {
-    ri = 0;
+  if (ri >= size_) {
+    ri -= size_;
   }
 
   read_idx_.store(ri, std::memory_order_release);
 }
 
 boost::asio::const_buffers_1 LockFreeRingBuffer::first_read_array() const {
-  auto wi = write_idx_.load(std::memory_order_relaxed);
+  auto wi   = write_idx_.load(std::memory_order_relaxed);
+  auto ri   = read_idx_.load(std::memory_order_relaxed);
+  auto data = static_cast<const Byte*>(data_);
+
+  if (mirrored()) {
+    return boost::asio::buffer(data + ri, available_for_read(wi, ri));
+  } else if (wi < ri) {
+    return boost::asio::buffer(data + ri, size_ - ri);
+  } else {
+    return boost::asio::buffer(data + ri, wi - ri);
+  }
+}
+
+void LockFreeRingBuffer::commit_read_arrays(size_type n) {
+  YOGI_ASSERT(n <= available_for_read());
+
   auto ri = read_idx_.load(std::memory_order_relaxed);
 
-  if (wi < ri) {
-    return boost::asio::buffer(data_.data() + ri, data_.size() - ri);
+  ri += n;
+  if (ri >= size_) {
+    ri -= size_;
+  }
+
+  read_idx_.store(ri, std::memory_order_release);
+}
+
+// Returns both contiguous parts of the readable data; the second part is only
+// non-empty if the data wraps around the end of the internal buffer
+LockFreeRingBuffer::const_buffers_2 LockFreeRingBuffer::read_arrays() const {
+  auto wi   = write_idx_.load(std::memory_order_acquire);
+  auto ri   = read_idx_.load(std::memory_order_relaxed);
+  auto data = static_cast<const Byte*>(data_);
+
+  if (wi < ri && !mirrored()) {
+    return {boost::asio::buffer(data + ri, size_ - ri), boost::asio::buffer(data, wi)};
   } else {
-    return boost::asio::buffer(data_.data() + ri, wi - ri);
+    return {boost::asio::buffer(data + ri, available_for_read(wi, ri)), boost::asio::const_buffer()};
   }
 }
 
@@ -167,26 +209,66 @@ LockFreeRingBuffer::size_type LockFreeRingBuffer::write(const Byte* data, size_t
   auto new_wi = wi + input_cnt;
   auto last   = data + input_cnt;
 
-  if (new_wi > data_.size()) {
-    auto count_0  = data_.size() - wi;
+  if (new_wi > size_ && !mirrored()) {
+    auto count_0  = size_ - wi;
     auto midpoint = data + count_0;
 
-    std::uninitialized_copy(data, midpoint, data_.begin() + static_cast<long>(wi));
-    std::uninitialized_copy(midpoint, last, data_.begin());
-
-    new_wi -= data_.size();
+    std::uninitialized_copy(data, midpoint, data_ + wi);
+    std::uninitialized_copy(midpoint, last, data_);
   } else {
-    std::uninitialized_copy(data, last, data_.begin() + static_cast<long>(wi));
+    std::uninitialized_copy(data, last, data_ + wi);
+  }
 
-    if (new_wi == data_.size()) {
-      new_wi = 0;
-    }
+  if (new_wi >= size_) {
+    new_wi -= size_;
   }
 
+  reserve_idx_.store(new_wi, std::memory_order_relaxed);
   write_idx_.store(new_wi, std::memory_order_release);
   return input_cnt;
 }
 
+bool LockFreeRingBuffer::try_write_concurrently(const const_buffers_2& data,
+                                                const std::function<void(size_type end_idx)>& before_publish) {
+  auto size = data[0].size() + data[1].size();
+
+  // Reserve space
+  auto begin = reserve_idx_.load(std::memory_order_relaxed);
+  size_type end;
+  do {
+    auto ri = read_idx_.load(std::memory_order_acquire);
+    if (available_for_write(begin, ri) < size) {
+      return false;
+    }
+
+    end = begin + size;
+    if (end >= size_) {
+      end -= size_;
+    }
+  } while (!reserve_idx_.compare_exchange_weak(begin, end, std::memory_order_relaxed));
+
+  copy_in(copy_in(begin, data[0]), data[1]);
+
+  if (before_publish) {
+    before_publish(end);
+  }
+
+  // Publish once all producers that reserved space before us have published
+  while (write_idx_.load(std::memory_order_relaxed) != begin) {
+    std::this_thread::yield();
+  }
+
+  write_idx_.store(end, std::memory_order_release);
+  return true;
+}
+
+// Returns the number of bytes between the read position and the given index,
+// i.e. how much data has to be read before the index is reached
+LockFreeRingBuffer::size_type LockFreeRingBuffer::readable_bytes_before(size_type idx) const {
+  auto ri = read_idx_.load(std::memory_order_relaxed);
+  return available_for_read(idx, ri);
+}
+
 void LockFreeRingBuffer::commit_first_write_array(size_type n) {
   YOGI_ASSERT(n <= boost::asio::buffer_size(first_write_array()));
 
@@ -195,10 +277,11 @@ void LockFreeRingBuffer::commit_first_write_array(size_type n) {
   YOGI_UNUSED(dummy);
 
   wi += n;
-  if (wi >= data_.size()) {
-    wi -= data_.size();
+  if (wi >= size_) {
+    wi -= size_;
   }
 
+  reserve_idx_.store(wi, std::memory_order_relaxed);
   write_idx_.store(wi, std::memory_order_release);
 }
 
@@ -206,11 +289,13 @@ boost::asio::mutable_buffers_1 LockFreeRingBuffer::first_write_array() {
   auto wi = write_idx_.load(std::memory_order_relaxed);
   auto ri = read_idx_.load(std::memory_order_relaxed);
 
-  if (wi < ri) {
-    return boost::asio::buffer(data_.data() + wi, ri - wi - 1);
+  if (mirrored()) {
+    return boost::asio::buffer(data_ + wi, available_for_write(wi, ri));
+  } else if (wi < ri) {
+    return boost::asio::buffer(data_ + wi, ri - wi - 1);
   }
 
-  return boost::asio::buffer(data_.data() + wi, data_.size() - wi - (ri == 0 ? 1 : 0));
+  return boost::asio::buffer(data_ + wi, size_ - wi - (ri == 0 ? 1 : 0));
 }
 
 LockFreeRingBuffer::size_type LockFreeRingBuffer::available_for_read(size_type write_idx, size_type read_idx) const {
@@ -218,13 +303,13 @@ LockFreeRingBuffer::size_type LockFreeRingBuffer::available_for_read(size_type w
     return write_idx - read_idx;
   }
 
-  return write_idx + data_.size() - read_idx;
+  return write_idx + size_ - read_idx;
 }
 
 LockFreeRingBuffer::size_type LockFreeRingBuffer::available_for_write(size_type write_idx, size_type read_idx) const {
   auto n = read_idx - write_idx - 1;
   if (write_idx >= read_idx) {
-    n += data_.size();
+    n += size_;
   }
 
   return n;
@@ -232,9 +317,29 @@ LockFreeRingBuffer::size_type LockFreeRingBuffer::available_for_write(size_type
 
 LockFreeRingBuffer::size_type LockFreeRingBuffer::next_index(size_type idx) const {
   idx += 1;
-  if (idx >= data_.size()) {
-    idx -= data_.size();
+  if (idx >= size_) {
+    idx -= size_;
   }
 
   return idx;
 }
+
+LockFreeRingBuffer::size_type LockFreeRingBuffer::copy_in(size_type idx, boost::asio::const_buffer data) {
+  auto first = static_cast<const Byte*>(data.data());
+  auto last  = first + data.size();
+
+  auto new_idx = idx + data.size();
+  if (new_idx > size_ && !mirrored()) {
+    auto midpoint = first + (size_ - idx);
+    std::uninitialized_copy(first, midpoint, data_ + idx);
+    std::uninitialized_copy(midpoint, last, data_);
+  } else {
+    std::uninitialized_copy(first, last, data_ + idx);
+  }
+
+  if (new_idx >= size_) {
+    new_idx -= size_;
+  }
+
+  return new_idx;
+}
@@ -24,26 +24,48 @@
 #include <src/config.h>
 
 #include <src/data/buffer.h>
+#include <src/system/mirrored_memory.h>
 
 #include <boost/asio/buffer.hpp>
 
+#include <array>
 #include <atomic>
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <vector>
 
 // Implementation based on the lock-free single-producer/single-consumer
 // ringbuffer implementation in boost by Tim Blechmann (spsc_queue).
+//
+// In mirrored mode, the internal buffer is mapped twice back-to-back into
+// memory so that all readable and writable data is always contiguous. The
+// capacity gets rounded up to the page size in that case. If mirrored memory
+// is not available on the platform, the ringbuffer falls back to the normal
+// mode.
+//
+// Besides the single-producer write functions, try_write_concurrently() can be
+// used by multiple producers at the same time: space is reserved by advancing
+// a separate reservation index and the reserved blocks are published to the
+// consumer in reservation order. The two ways of writing must not be mixed
+// concurrently. The optional before_publish function gets called with the
+// index behind the reserved block after the data has been copied but before
+// it becomes visible to the consumer.
 class LockFreeRingBuffer {
  public:
-  using size_type = std::size_t;
+  using size_type       = std::size_t;
+  using const_buffers_2 = std::array<boost::asio::const_buffer, 2>;
 
-  explicit LockFreeRingBuffer(size_type capacity);
+  explicit LockFreeRingBuffer(size_type capacity, bool mirrored = false);
 
   size_type capacity() const {
     return capacity_;
   };
 
+  bool mirrored() const {
+    return !!mirrored_data_;
+  }
+
   bool empty();
   bool full();
   Byte front() const;
@@ -53,8 +75,13 @@ class LockFreeRingBuffer {
   size_type discard(size_type max_size);
   void commit_first_read_array(size_type n);
   boost::asio::const_buffers_1 first_read_array() const;
+  void commit_read_arrays(size_type n);
+  const_buffers_2 read_arrays() const;
   size_type available_for_write() const;
   size_type write(const Byte* data, size_type size);
+  bool try_write_concurrently(const const_buffers_2& data,
+                              const std::function<void(size_type end_idx)>& before_publish = {});
+  size_type readable_bytes_before(size_type idx) const;
   void commit_first_write_array(size_type n);
   boost::asio::mutable_buffers_1 first_write_array();
 
@@ -76,11 +103,17 @@ class LockFreeRingBuffer {
   size_type available_for_read(size_type write_idx, size_type read_idx) const;
   size_type available_for_write(size_type write_idx, size_type read_idx) const;
   size_type next_index(size_type idx) const;
+  size_type copy_in(size_type idx, boost::asio::const_buffer data);
 
   static constexpr int kCacheLineSize = 64;
+  std::atomic<std::size_t> reserve_idx_;
+  Byte reserve_padding_[kCacheLineSize - sizeof(std::size_t)];
   std::atomic<std::size_t> write_idx_;
   Byte padding_[kCacheLineSize - sizeof(std::size_t)];
   std::atomic<std::size_t> read_idx_;
-  const size_type capacity_;
-  Buffer data_;
+  Buffer heap_data_;
+  MirroredMemoryPtr mirrored_data_;
+  Byte* data_;
+  size_type size_;
+  size_type capacity_;
 };
@@ -25,6 +25,12 @@
 
 namespace {
 
+boost::uuids::uuid copy_uuid_from_user_buffer(const void* buffer) {
+  boost::uuids::uuid uuid;
+  std::memcpy(&uuid, buffer, uuid.size());
+  return uuid;
+}
+
 void copy_uuid_to_user_buffer(const boost::uuids::uuid& uuid, void* buffer) {
   if (buffer == nullptr) return;
   std::memcpy(buffer, &uuid, uuid.size());
@@ -162,7 +168,7 @@ YOGI_API int YOGI_BranchSendBroadcast(void* branch, int enc, const void* data, i
   BEGIN_CHECKED_API_FUNCTION_RETURN_INT
 
   CHECK_PARAM(branch != nullptr);
-  CHECK_PARAM(enc == YOGI_ENC_JSON || enc == YOGI_ENC_MSGPACK);
+  CHECK_PARAM(enc == YOGI_ENC_JSON || enc == YOGI_ENC_MSGPACK || enc == YOGI_ENC_RAW);
   CHECK_PARAM(data != nullptr);
   CHECK_PARAM(datasize > 0);
   CHECK_PARAM(block == YOGI_TRUE || block == YOGI_FALSE);
@@ -175,26 +181,51 @@ YOGI_API int YOGI_BranchSendBroadcast(void* branch, int enc, const void* data, i
   END_CHECKED_API_FUNCTION
 }
 
-YOGI_API int YOGI_BranchSendBroadcastAsync(void* branch, int enc, const void* data, int datasize, int retry,
+YOGI_API int YOGI_BranchSendBroadcastAsync(void* branch, int enc, const void* data, int datasize, int retry, int prio,
                                            void (*fn)(int res, int oid, void* userarg), void* userarg) {
   BEGIN_CHECKED_API_FUNCTION_RETURN_INT
 
   CHECK_PARAM(branch != nullptr);
-  CHECK_PARAM(enc == YOGI_ENC_JSON || enc == YOGI_ENC_MSGPACK);
+  CHECK_PARAM(enc == YOGI_ENC_JSON || enc == YOGI_ENC_MSGPACK || enc == YOGI_ENC_RAW);
   CHECK_PARAM(data != nullptr);
   CHECK_PARAM(datasize > 0);
   CHECK_PARAM(retry == YOGI_TRUE || retry == YOGI_FALSE);
+  CHECK_PARAM(prio == YOGI_PRIO_NORMAL || prio == YOGI_PRIO_HIGH);
   CHECK_PARAM(fn != nullptr);
 
-  auto brn    = ObjectRegister::get<Branch>(branch);
-  auto buffer = boost::asio::buffer(data, static_cast<std::size_t>(datasize));
+  auto brn     = ObjectRegister::get<Branch>(branch);
+  auto buffer  = boost::asio::buffer(data, static_cast<std::size_t>(datasize));
+  auto tx_prio = prio == YOGI_PRIO_HIGH ? Branch::TxPriority::kHigh : Branch::TxPriority::kNormal;
 
-  return brn->send_broadcast_async(Payload(buffer, enc), retry == YOGI_TRUE,
+  return brn->send_broadcast_async(Payload(buffer, enc), retry == YOGI_TRUE, tx_prio,
                                    [=](auto& res, auto oid) { fn(res.error_code(), oid, userarg); });
 
   END_CHECKED_API_FUNCTION
 }
 
+YOGI_API int YOGI_BranchSendToAsync(void* branch, const void* uuid, int enc, const void* data, int datasize,
+                                    int retry, int prio, void (*fn)(int res, int oid, void* userarg), void* userarg) {
+  BEGIN_CHECKED_API_FUNCTION_RETURN_INT
+
+  CHECK_PARAM(branch != nullptr);
+  CHECK_PARAM(uuid != nullptr);
+  CHECK_PARAM(enc == YOGI_ENC_JSON || enc == YOGI_ENC_MSGPACK || enc == YOGI_ENC_RAW);
+  CHECK_PARAM(data != nullptr);
+  CHECK_PARAM(datasize > 0);
+  CHECK_PARAM(retry == YOGI_TRUE || retry == YOGI_FALSE);
+  CHECK_PARAM(prio == YOGI_PRIO_NORMAL || prio == YOGI_PRIO_HIGH);
+  CHECK_PARAM(fn != nullptr);
+
+  auto brn     = ObjectRegister::get<Branch>(branch);
+  auto buffer  = boost::asio::buffer(data, static_cast<std::size_t>(datasize));
+  auto tx_prio = prio == YOGI_PRIO_HIGH ? Branch::TxPriority::kHigh : Branch::TxPriority::kNormal;
+
+  return brn->send_to_async(copy_uuid_from_user_buffer(uuid), Payload(buffer, enc), retry == YOGI_TRUE, tx_prio,
+                            [=](auto& res, auto oid) { fn(res.error_code(), oid, userarg); });
+
+  END_CHECKED_API_FUNCTION
+}
+
 YOGI_API int YOGI_BranchCancelSendBroadcast(void* branch, int oid) {
   BEGIN_CHECKED_API_FUNCTION
 
@@ -214,7 +245,7 @@ YOGI_API int YOGI_BranchReceiveBroadcastAsync(void* branch, void* uuid, int enc,
   BEGIN_CHECKED_API_FUNCTION
 
   CHECK_PARAM(branch != nullptr);
-  CHECK_PARAM(enc == YOGI_ENC_JSON || enc == YOGI_ENC_MSGPACK);
+  CHECK_PARAM(enc == YOGI_ENC_JSON || enc == YOGI_ENC_MSGPACK || enc == YOGI_ENC_RAW);
   CHECK_PARAM(data != nullptr || datasize == 0);
   CHECK_PARAM(fn != nullptr);
 
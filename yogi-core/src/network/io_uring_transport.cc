@@ -0,0 +1,90 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <src/network/io_uring_transport.h>
+
+#include <cerrno>
+#include <cstring>
+
+IoUringTransport::IoUringTransport(ContextPtr context, IoUringPtr io_uring, boost::asio::ip::tcp::socket&& socket,
+                                   std::chrono::nanoseconds timeout, std::size_t transceive_byte_limit,
+                                   bool created_via_accept)
+    : TcpTransport(context, std::move(socket), timeout, transceive_byte_limit, created_via_accept),
+      io_uring_(io_uring) {
+  YOGI_ASSERT(io_uring_);
+}
+
+IoUringTransport::~IoUringTransport() {
+  cancel_operations();
+}
+
+void IoUringTransport::write_some_async(boost::asio::const_buffer data, TransferSomeHandler handler) {
+  write_some_async(ConstBufferSequence{data}, handler);
+}
+
+void IoUringTransport::write_some_async(const ConstBufferSequence& data, TransferSomeHandler handler) {
+  IoUring::ConstBufferSequence seq(data.begin(), data.end());
+  io_uring_->write_some_async(socket().native_handle(), seq, [=](int res, auto) {
+    handler(make_result(res), res > 0 ? static_cast<std::size_t>(res) : 0);
+  });
+}
+
+void IoUringTransport::read_some_async(boost::asio::mutable_buffer data, TransferSomeHandler handler) {
+  auto weak_self = make_weak_ptr();
+  io_uring_->read_some_async(socket().native_handle(), data.size(), [=](int res, const Byte* received) {
+    // The destination buffer belongs to the owner of this transport
+    auto self = weak_self.lock();
+    if (!self) {
+      handler(Error(YOGI_ERR_CANCELED), 0);
+      return;
+    }
+
+    // A read of zero bytes means that the peer closed the connection
+    if (res == 0) res = -ECONNRESET;
+
+    auto n = res > 0 ? static_cast<std::size_t>(res) : 0;
+    std::memcpy(data.data(), received, n);
+    handler(make_result(res), n);
+  });
+}
+
+void IoUringTransport::shutdown() {
+  cancel_operations();
+  TcpTransport::shutdown();
+}
+
+void IoUringTransport::cancel_operations() {
+  // Outstanding operations keep the socket open in the kernel and queued ones
+  // would use the file descriptor after it got closed and possibly reused
+  if (socket().is_open()) {
+    io_uring_->cancel(socket().native_handle());
+  }
+}
+
+Result IoUringTransport::make_result(int res) {
+  if (res >= 0) {
+    return Success();
+  } else if (res == -ECANCELED) {
+    return Error(YOGI_ERR_CANCELED);
+  } else {
+    return Error(YOGI_ERR_RW_SOCKET_FAILED);
+  }
+}
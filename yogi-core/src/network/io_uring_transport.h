@@ -0,0 +1,57 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <src/network/tcp_transport.h>
+#include <src/system/io_uring.h>
+
+class IoUringTransport;
+typedef std::shared_ptr<IoUringTransport> IoUringTransportPtr;
+typedef std::weak_ptr<IoUringTransport> IoUringTransportWeakPtr;
+
+// TCP transport that reads from and writes to the socket via io_uring instead
+// of asio. Connecting, accepting and shutting down still happen via asio.
+class IoUringTransport : public TcpTransport {
+ public:
+  IoUringTransport(ContextPtr context, IoUringPtr io_uring, boost::asio::ip::tcp::socket&& socket,
+                   std::chrono::nanoseconds timeout, std::size_t transceive_byte_limit, bool created_via_accept);
+  virtual ~IoUringTransport();
+
+ protected:
+  virtual void write_some_async(boost::asio::const_buffer data, TransferSomeHandler handler) override;
+  virtual void write_some_async(const ConstBufferSequence& data, TransferSomeHandler handler) override;
+  virtual void read_some_async(boost::asio::mutable_buffer data, TransferSomeHandler handler) override;
+  virtual void shutdown() override;
+
+ private:
+  IoUringTransportWeakPtr make_weak_ptr() {
+    return std::static_pointer_cast<IoUringTransport>(shared_from_this());
+  }
+
+  static Result make_result(int res);
+
+  void cancel_operations();
+
+  const IoUringPtr io_uring_;
+};
@@ -0,0 +1,85 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <src/network/loopback_listener.h>
+
+#include <boost/functional/hash.hpp>
+
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+std::mutex registry_mutex;
+std::unordered_map<boost::uuids::uuid, LoopbackListenerWeakPtr, boost::hash<boost::uuids::uuid>> registry;
+
+}  // anonymous namespace
+
+LoopbackListener::LoopbackListener(ContextPtr context, const boost::uuids::uuid& uuid,
+                                   std::chrono::nanoseconds timeout, std::size_t transceive_byte_limit)
+    : context_(context), uuid_(uuid), cfg_{context, timeout, transceive_byte_limit} {
+}
+
+LoopbackListener::~LoopbackListener() {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  auto it = registry.find(uuid_);
+  if (it != registry.end() && it->second.expired()) {
+    registry.erase(it);
+  }
+}
+
+void LoopbackListener::start(AcceptFn accept_fn) {
+  YOGI_ASSERT(!accept_fn_);
+  accept_fn_ = accept_fn;
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  registry[uuid_] = make_weak_ptr();
+}
+
+LoopbackTransportPtr LoopbackListener::connect(ContextPtr context, const boost::uuids::uuid& uuid,
+                                               std::chrono::nanoseconds timeout,
+                                               std::size_t transceive_byte_limit) {
+  LoopbackListenerPtr listener;
+  {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto it = registry.find(uuid);
+    if (it != registry.end()) {
+      listener = it->second.lock();
+    }
+  }
+
+  if (!listener) {
+    return {};
+  }
+
+  auto transports = LoopbackTransport::create_pair({context, timeout, transceive_byte_limit}, listener->cfg_);
+
+  auto weak_listener = listener->make_weak_ptr();
+  auto accepted      = transports.second;
+  listener->context_->post([weak_listener, accepted] {
+    auto listener = weak_listener.lock();
+    if (!listener) return;
+
+    listener->accept_fn_(accepted);
+  });
+
+  return transports.first;
+}
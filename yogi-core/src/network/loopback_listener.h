@@ -0,0 +1,65 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <src/network/loopback_transport.h>
+#include <src/objects/context.h>
+
+#include <boost/uuid/uuid.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+class LoopbackListener;
+typedef std::shared_ptr<LoopbackListener> LoopbackListenerPtr;
+typedef std::weak_ptr<LoopbackListener> LoopbackListenerWeakPtr;
+
+// Counterpart to TcpListener for connections within the same process. Started
+// listeners are registered in a process-wide registry under a UUID which
+// allows connect() to find them.
+class LoopbackListener : public std::enable_shared_from_this<LoopbackListener> {
+ public:
+  typedef std::function<void(LoopbackTransportPtr transport)> AcceptFn;
+
+  LoopbackListener(ContextPtr context, const boost::uuids::uuid& uuid, std::chrono::nanoseconds timeout,
+                   std::size_t transceive_byte_limit);
+  virtual ~LoopbackListener();
+
+  void start(AcceptFn accept_fn);
+
+  // Returns an empty pointer if no listener is registered for the given UUID
+  static LoopbackTransportPtr connect(ContextPtr context, const boost::uuids::uuid& uuid,
+                                      std::chrono::nanoseconds timeout, std::size_t transceive_byte_limit);
+
+ private:
+  LoopbackListenerWeakPtr make_weak_ptr() {
+    return {shared_from_this()};
+  }
+
+  const ContextPtr context_;
+  const boost::uuids::uuid uuid_;
+  const LoopbackTransport::EndpointConfig cfg_;
+  AcceptFn accept_fn_;
+};
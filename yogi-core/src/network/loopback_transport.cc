@@ -0,0 +1,204 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <src/network/loopback_transport.h>
+
+#include <algorithm>
+
+namespace {
+
+std::size_t copy_buffers(const Transport::ConstBufferSequence& src, boost::asio::mutable_buffer dst) {
+  std::size_t n = 0;
+  for (auto& buf : src) {
+    n += boost::asio::buffer_copy(dst + n, buf);
+  }
+
+  return n;
+}
+
+}  // anonymous namespace
+
+// State shared by both endpoints; endpoint i writes into directions[i] and
+// reads from directions[1 - i]
+struct LoopbackTransport::Channel {
+  struct Direction {
+    explicit Direction(std::size_t buffer_size) : buffer(buffer_size) {
+    }
+
+    LockFreeRingBuffer buffer;
+    Transport::ConstBufferSequence pending_write_data;
+    Transport::TransferSomeHandler pending_write_handler;
+    boost::asio::mutable_buffer pending_read_data;
+    Transport::TransferSomeHandler pending_read_handler;
+  };
+
+  explicit Channel(std::size_t buffer_size) : directions{Direction(buffer_size), Direction(buffer_size)} {
+  }
+
+  std::mutex mutex;
+  Direction directions[2];
+  ContextPtr contexts[2];
+  bool closed[2] = {false, false};
+};
+
+std::pair<LoopbackTransportPtr, LoopbackTransportPtr> LoopbackTransport::create_pair(
+    const EndpointConfig& connecting, const EndpointConfig& accepting, std::size_t buffer_size) {
+  auto channel         = std::make_shared<Channel>(buffer_size);
+  channel->contexts[0] = connecting.context;
+  channel->contexts[1] = accepting.context;
+
+  return std::make_pair(LoopbackTransportPtr(new LoopbackTransport(connecting, channel, 0)),
+                        LoopbackTransportPtr(new LoopbackTransport(accepting, channel, 1)));
+}
+
+LoopbackTransport::~LoopbackTransport() {
+  shutdown();
+}
+
+void LoopbackTransport::write_some_async(boost::asio::const_buffer data, TransferSomeHandler handler) {
+  write_some_async(ConstBufferSequence{data}, handler);
+}
+
+void LoopbackTransport::write_some_async(const ConstBufferSequence& data, TransferSomeHandler handler) {
+  std::lock_guard<std::mutex> lock(channel_->mutex);
+
+  auto& dir = channel_->directions[side_];
+  YOGI_ASSERT(!dir.pending_write_handler);
+
+  dir.pending_write_data    = data;
+  dir.pending_write_handler = handler;
+  try_finish_pending_write(side_);
+}
+
+void LoopbackTransport::read_some_async(boost::asio::mutable_buffer data, TransferSomeHandler handler) {
+  std::lock_guard<std::mutex> lock(channel_->mutex);
+
+  auto& dir = channel_->directions[1 - side_];
+  YOGI_ASSERT(!dir.pending_read_handler);
+
+  dir.pending_read_data    = data;
+  dir.pending_read_handler = handler;
+  try_finish_pending_read(1 - side_);
+}
+
+void LoopbackTransport::shutdown() {
+  std::lock_guard<std::mutex> lock(channel_->mutex);
+  if (channel_->closed[side_]) return;
+
+  channel_->closed[side_] = true;
+
+  // Our own operations get canceled and those of the peer fail
+  auto& tx_dir = channel_->directions[side_];
+  auto& rx_dir = channel_->directions[1 - side_];
+  complete(channel_->contexts[side_], &tx_dir.pending_write_handler, Error(YOGI_ERR_CANCELED), 0);
+  complete(channel_->contexts[side_], &rx_dir.pending_read_handler, Error(YOGI_ERR_CANCELED), 0);
+  complete(channel_->contexts[1 - side_], &tx_dir.pending_read_handler, Error(YOGI_ERR_RW_SOCKET_FAILED), 0);
+  complete(channel_->contexts[1 - side_], &rx_dir.pending_write_handler, Error(YOGI_ERR_RW_SOCKET_FAILED), 0);
+}
+
+LoopbackTransport::LoopbackTransport(const EndpointConfig& cfg, ChannelPtr channel, int side)
+    : Transport(cfg.context, cfg.timeout, side == 1, "in-process", cfg.transceive_byte_limit),
+      channel_(channel),
+      side_(side) {
+}
+
+void LoopbackTransport::complete(const ContextPtr& context, TransferSomeHandler* handler, const Result& res,
+                                 std::size_t n) {
+  if (!*handler) return;
+
+  auto fn  = *handler;
+  *handler = {};
+  context->post([=] { fn(res, n); });
+}
+
+// Both functions must be called with the channel mutex locked; side is the
+// endpoint that writes into the direction
+void LoopbackTransport::try_finish_pending_write(int side) {
+  auto& dir        = channel_->directions[side];
+  auto& writer_ctx = channel_->contexts[side];
+  auto& reader_ctx = channel_->contexts[1 - side];
+
+  if (channel_->closed[side]) {
+    complete(writer_ctx, &dir.pending_write_handler, Error(YOGI_ERR_CANCELED), 0);
+    return;
+  }
+
+  if (channel_->closed[1 - side]) {
+    complete(writer_ctx, &dir.pending_write_handler, Error(YOGI_ERR_RW_SOCKET_FAILED), 0);
+    return;
+  }
+
+  // Hand the data over directly if the reader is waiting (the buffer must be
+  // empty in that case)
+  if (dir.pending_read_handler) {
+    YOGI_ASSERT(dir.buffer.empty());
+    auto n = copy_buffers(dir.pending_write_data, dir.pending_read_data);
+    complete(reader_ctx, &dir.pending_read_handler, Success(), n);
+    complete(writer_ctx, &dir.pending_write_handler, Success(), n);
+    return;
+  }
+
+  std::size_t n = 0;
+  for (auto& buf : dir.pending_write_data) {
+    auto written = dir.buffer.write(static_cast<const Byte*>(buf.data()), buf.size());
+    n += written;
+    if (written < buf.size()) break;
+  }
+
+  if (n > 0) {
+    complete(writer_ctx, &dir.pending_write_handler, Success(), n);
+  }
+}
+
+void LoopbackTransport::try_finish_pending_read(int side) {
+  auto& dir        = channel_->directions[side];
+  auto& writer_ctx = channel_->contexts[side];
+  auto& reader_ctx = channel_->contexts[1 - side];
+
+  if (channel_->closed[1 - side]) {
+    complete(reader_ctx, &dir.pending_read_handler, Error(YOGI_ERR_CANCELED), 0);
+    return;
+  }
+
+  auto& data = dir.pending_read_data;
+  auto n     = dir.buffer.read(static_cast<Byte*>(data.data()), data.size());
+
+  // A waiting writer's data follows the buffered data, so it can go straight
+  // into the reader's buffer instead of through the intermediate buffer
+  if (n < data.size() && dir.pending_write_handler) {
+    auto n_direct = copy_buffers(dir.pending_write_data, data + n);
+    if (n_direct > 0) {
+      complete(writer_ctx, &dir.pending_write_handler, Success(), n_direct);
+      n += n_direct;
+    }
+  }
+
+  if (n > 0) {
+    complete(reader_ctx, &dir.pending_read_handler, Success(), n);
+
+    // The writer only waits if the buffer was full
+    if (dir.pending_write_handler) {
+      try_finish_pending_write(side);
+    }
+  } else if (channel_->closed[side]) {
+    complete(reader_ctx, &dir.pending_read_handler, Error(YOGI_ERR_RW_SOCKET_FAILED), 0);
+  }
+}
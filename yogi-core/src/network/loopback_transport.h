@@ -0,0 +1,78 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <src/data/ringbuffer.h>
+#include <src/network/transport.h>
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+class LoopbackTransport;
+typedef std::shared_ptr<LoopbackTransport> LoopbackTransportPtr;
+typedef std::weak_ptr<LoopbackTransport> LoopbackTransportWeakPtr;
+
+// Transport between two endpoints within the same process. Data gets copied
+// straight from the sender's buffer into the receiver's buffer if a receive
+// operation is pending; otherwise it is held in a small intermediate buffer
+// just like the socket buffers of a TCP connection. A send operation waiting
+// for space in that buffer hands its data straight to the next receive
+// operation once the buffered data has been read.
+class LoopbackTransport : public Transport {
+ public:
+  static constexpr std::size_t kDefaultBufferSize = 64 * 1024;
+
+  struct EndpointConfig {
+    ContextPtr context;
+    std::chrono::nanoseconds timeout;
+    std::size_t transceive_byte_limit;
+  };
+
+  // Returns the connecting and the accepting endpoint
+  static std::pair<LoopbackTransportPtr, LoopbackTransportPtr> create_pair(const EndpointConfig& connecting,
+                                                                           const EndpointConfig& accepting,
+                                                                           std::size_t buffer_size = kDefaultBufferSize);
+
+  virtual ~LoopbackTransport();
+
+ protected:
+  virtual void write_some_async(boost::asio::const_buffer data, TransferSomeHandler handler) override;
+  virtual void write_some_async(const ConstBufferSequence& data, TransferSomeHandler handler) override;
+  virtual void read_some_async(boost::asio::mutable_buffer data, TransferSomeHandler handler) override;
+  virtual void shutdown() override;
+
+ private:
+  struct Channel;
+  typedef std::shared_ptr<Channel> ChannelPtr;
+
+  LoopbackTransport(const EndpointConfig& cfg, ChannelPtr channel, int side);
+
+  void complete(const ContextPtr& context, TransferSomeHandler* handler, const Result& res, std::size_t n);
+  void try_finish_pending_write(int side);
+  void try_finish_pending_read(int side);
+
+  const ChannelPtr channel_;
+  const int side_;
+};
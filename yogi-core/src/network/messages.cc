@@ -20,73 +20,172 @@
  */
 
 #include <src/api/errors.h>
+#include <src/data/compression.h>
+#include <src/data/json_transcoder.h>
+#include <src/data/msgpack_validator.h>
 #include <src/network/messages.h>
 
-#include <nlohmann/json.hpp>
-
-struct MsgPackCheckVisitor : public msgpack::null_visitor {
-  void parse_error(std::size_t parsed_offset, std::size_t error_offset) {
-    throw DescriptiveError(YOGI_ERR_INVALID_USER_MSGPACK)
-        << "Parse errror. Parsed offset: " << parsed_offset << "; Error offset: " << error_offset;
-  }
-
-  void insufficient_bytes(std::size_t parsed_offset, std::size_t error_offset) {
-    throw DescriptiveError(YOGI_ERR_INVALID_USER_MSGPACK)
-        << "Insufficient bytes. Parsed offset: " << parsed_offset << "; Error offset: " << error_offset;
-  }
-};
-
 void check_payload_is_valid_msgpack(const char* data, std::size_t size) {
-  MsgPackCheckVisitor visitor;
-  bool ok = msgpack::parse(data, size, visitor);
-  if (!ok) {
-    throw DescriptiveError(YOGI_ERR_INVALID_USER_MSGPACK) << "msgpack::parse() returned false";
+  std::size_t error_offset;
+  if (!validate_msgpack(reinterpret_cast<const Byte*>(data), size, &error_offset)) {
+    throw DescriptiveError(YOGI_ERR_INVALID_USER_MSGPACK) << "Invalid data at offset " << error_offset;
   }
 }
 
-Buffer check_and_convert_payload_from_json_to_msgpack(const char* data, std::size_t size) {
+void check_and_convert_payload_from_json_to_msgpack(const char* data, std::size_t size, SmallBuffer* buffer) {
   YOGI_ASSERT(size > 0);
   if (data[size - 1] != '\0') {
     throw DescriptiveError(YOGI_ERR_PARSING_JSON_FAILED) << "Unterminated string";
   }
 
-  try {
-    auto json = nlohmann::json::parse(data);
-    return nlohmann::json::to_msgpack(json);
-  } catch (const std::exception& e) {
-    throw DescriptiveError(YOGI_ERR_PARSING_JSON_FAILED) << e.what();
+  transcode_json_to_msgpack(data, size - 1, buffer);
+}
+
+namespace {
+
+std::size_t read_uint32(const Byte* p) {
+  return (std::size_t{p[0]} << 24) | (std::size_t{p[1]} << 16) | (std::size_t{p[2]} << 8) | p[3];
+}
+
+void write_uint32(Byte* p, std::size_t val) {
+  YOGI_ASSERT(val <= 0xFFFFFFFF);
+  p[0] = static_cast<Byte>(val >> 24);
+  p[1] = static_cast<Byte>(val >> 16);
+  p[2] = static_cast<Byte>(val >> 8);
+  p[3] = static_cast<Byte>(val);
+}
+
+std::uint64_t read_uint64(const Byte* p) {
+  return (std::uint64_t{read_uint32(p)} << 32) | read_uint32(p + 4);
+}
+
+void write_uint64(Byte* p, std::uint64_t val) {
+  write_uint32(p, static_cast<std::size_t>(val >> 32));
+  write_uint32(p + 4, static_cast<std::size_t>(val & 0xFFFFFFFF));
+}
+
+// Multicast messages start with the message type followed by a sequence number
+SmallBuffer make_multicast_msg_bytes(MessageType type, std::uint64_t seq, std::size_t size) {
+  SmallBuffer bytes(size, type);
+  write_uint64(bytes.data() + 1, seq);
+  return bytes;
+}
+
+SmallBuffer make_multicast_sync_msg_bytes(std::uint64_t seq, const Buffer& wrapped_key) {
+  YOGI_ASSERT(wrapped_key.size() == messages::MulticastSync::kKeySize);
+
+  auto bytes = make_multicast_msg_bytes(MessageType::kMulticastSync, seq, 9);
+  bytes.insert(bytes.end(), wrapped_key.begin(), wrapped_key.end());
+  return bytes;
+}
+
+SmallBuffer make_multicast_nack_msg_bytes(std::uint64_t first_seq, std::size_t count) {
+  auto bytes = make_multicast_msg_bytes(MessageType::kMulticastNack, first_seq, messages::MulticastNack::kSize);
+  write_uint32(bytes.data() + 9, count);
+  return bytes;
+}
+
+SmallBuffer make_multicast_repair_msg_bytes(std::uint64_t seq, const SmallBuffer& msg_bytes) {
+  auto bytes = make_multicast_msg_bytes(MessageType::kMulticastRepair, seq, messages::MulticastRepair::kHeaderSize);
+  bytes.insert(bytes.end(), msg_bytes.begin(), msg_bytes.end());
+  return bytes;
+}
+
+// Compressed messages start with the message type followed by the size of the
+// uncompressed message as a 32 bit big endian integer
+constexpr std::size_t kCompressedMsgHeaderSize = 5;
+
+void decompress_and_deserialize(boost::asio::const_buffer serialized_msg, const IncomingMessage::MessageHandler& fn,
+                                std::size_t max_msg_size) {
+  if (serialized_msg.size() < kCompressedMsgHeaderSize) {
+    throw DescriptiveError(YOGI_ERR_DESERIALIZE_MSG_FAILED) << "Compressed message header too short";
+  }
+
+  auto header   = static_cast<const Byte*>(serialized_msg.data());
+  auto msg_size = read_uint32(header + 1);
+  if (msg_size == 0 || msg_size > max_msg_size) {
+    throw DescriptiveError(YOGI_ERR_DESERIALIZE_MSG_FAILED) << "Invalid decompressed message size " << msg_size;
   }
+
+  Buffer msg(msg_size);
+  if (!decompress_data(header + kCompressedMsgHeaderSize, serialized_msg.size() - kCompressedMsgHeaderSize, &msg)) {
+    throw DescriptiveError(YOGI_ERR_DESERIALIZE_MSG_FAILED) << "Decompressing message failed";
+  }
+
+  // Compressed messages must not be nested; fragmentation always happens after
+  // compression
+  if (msg[0] == MessageType::kCompressed || msg[0] == MessageType::kFragment) {
+    throw DescriptiveError(YOGI_ERR_DESERIALIZE_MSG_FAILED) << "Invalid compressed message type";
+  }
+
+  IncomingMessage::deserialize(msg, fn);
 }
 
-void IncomingMessage::deserialize(const Buffer& serialized_msg, const MessageHandler& fn) {
-  if (serialized_msg.empty()) {
+}  // anonymous namespace
+
+void IncomingMessage::deserialize(boost::asio::const_buffer serialized_msg, const MessageHandler& fn,
+                                  std::size_t max_decompressed_size) {
+  if (serialized_msg.size() == 0) {
     fn(messages::HeartbeatIncoming());
     return;
   }
 
-  switch (serialized_msg[0]) {
+  auto msg_type = *static_cast<const Byte*>(serialized_msg.data());
+  switch (msg_type) {
     case MessageType::kAcknowledge:
       fn(messages::AcknowledgeIncoming());
       break;
     case MessageType::kBroadcast:
       fn(messages::BroadcastIncoming(serialized_msg));
       break;
+    case MessageType::kCompressed:
+      decompress_and_deserialize(serialized_msg, fn, max_decompressed_size);
+      break;
+    case MessageType::kFragment:
+      fn(messages::FragmentIncoming(serialized_msg));
+      break;
+    case MessageType::kMulticastSync:
+      fn(messages::MulticastSyncIncoming(serialized_msg));
+      break;
+    case MessageType::kMulticastNack:
+      fn(messages::MulticastNackIncoming(serialized_msg));
+      break;
+    case MessageType::kMulticastRepair:
+      fn(messages::MulticastRepairIncoming(serialized_msg));
+      break;
     default:
-      throw DescriptiveError(YOGI_ERR_DESERIALIZE_MSG_FAILED) << "Unknown message type " << serialized_msg[0];
+      throw DescriptiveError(YOGI_ERR_DESERIALIZE_MSG_FAILED) << "Unknown message type " << msg_type;
   }
 }
 
-void Payload::serialize_to(SmallBuffer* buffer) const {
-  if (data_.size() == 0) return;
+void IncomingMessage::deserialize(const Buffer& serialized_msg, const MessageHandler& fn,
+                                  std::size_t max_decompressed_size) {
+  deserialize(boost::asio::buffer(serialized_msg), fn, max_decompressed_size);
+}
 
+Payload Payload::deserialize(boost::asio::const_buffer serialized_payload) {
+  if (serialized_payload.size() > 0 && *static_cast<const Byte*>(serialized_payload.data()) == kRawPayloadMarker) {
+    return Payload(serialized_payload + 1, YOGI_ENC_RAW);
+  }
+
+  return Payload(serialized_payload, YOGI_ENC_MSGPACK);
+}
+
+void Payload::serialize_to(SmallBuffer* buffer) const {
   auto raw = static_cast<const char*>(data_.data());
 
+  if (encoding_ == YOGI_ENC_RAW) {
+    buffer->push_back(kRawPayloadMarker);
+    buffer->insert(buffer->end(), raw, raw + data_.size());
+    return;
+  }
+
+  if (data_.size() == 0) return;
+
   switch (encoding_) {
-    case YOGI_ENC_JSON: {
-      auto data = check_and_convert_payload_from_json_to_msgpack(raw, data_.size());
-      buffer->insert(buffer->end(), data.begin(), data.end());
+    case YOGI_ENC_JSON:
+      check_and_convert_payload_from_json_to_msgpack(raw, data_.size(), buffer);
       break;
-    }
 
     case YOGI_ENC_MSGPACK: {
       check_payload_is_valid_msgpack(raw, data_.size());
@@ -102,40 +201,40 @@ void Payload::serialize_to(SmallBuffer* buffer) const {
 
 Result Payload::serialize_to_user_buffer(boost::asio::mutable_buffer buffer, int encoding,
                                          std::size_t* bytes_written) const {
-  Buffer tmp_buf;
-  std::string tmp_str;
-  boost::asio::const_buffer src;
+  SmallBuffer tmp_buf;
+  std::size_t src_size;  // Size of the full converted data
+  std::size_t n;         // Bytes actually written to the user buffer
 
   if (encoding == encoding_) {
-    src = data_;
+    src_size = data_.size();
+    n        = boost::asio::buffer_copy(buffer, data_);
+  } else if (encoding == YOGI_ENC_RAW || encoding_ == YOGI_ENC_RAW) {
+    return Error(YOGI_ERR_INCOMPATIBLE_ENCODING);
   } else {
     switch (encoding) {
-      case YOGI_ENC_JSON: {
-        auto raw  = static_cast<const unsigned char*>(data_.data());
-        auto json = nlohmann::json::from_msgpack(raw, raw + data_.size());
-        tmp_str   = json.dump();
-        src       = boost::asio::buffer(tmp_str.data(), tmp_str.size() + 1);
+      // Converted directly into the user buffer
+      case YOGI_ENC_JSON:
+        src_size = transcode_msgpack_to_json(static_cast<const Byte*>(data_.data()), data_.size(), buffer);
+        n        = std::min(src_size, buffer.size());
         break;
-      }
 
-      case YOGI_ENC_MSGPACK: {
-        auto raw  = static_cast<const char*>(data_.data());
-        auto json = nlohmann::json::parse(raw);
-        tmp_buf   = nlohmann::json::to_msgpack(json);
-        src       = boost::asio::buffer(tmp_buf);
+      case YOGI_ENC_MSGPACK:
+        check_and_convert_payload_from_json_to_msgpack(static_cast<const char*>(data_.data()), data_.size(),
+                                                       &tmp_buf);
+        src_size = tmp_buf.size();
+        n        = boost::asio::buffer_copy(buffer, boost::asio::buffer(tmp_buf.data(), tmp_buf.size()));
         break;
-      }
 
       default:
         YOGI_NEVER_REACHED;
+        return Error(YOGI_ERR_UNKNOWN);
     }
   }
 
-  auto n = boost::asio::buffer_copy(buffer, src);
   YOGI_ASSERT(bytes_written != nullptr);
   *bytes_written = n;
 
-  if (n < src.size()) {
+  if (n < src_size) {
     if (encoding == YOGI_ENC_JSON) {
       static_cast<char*>(buffer.data())[buffer.size() - 1] = '\0';
     }
@@ -166,13 +265,27 @@ SharedSmallBuffer OutgoingMessage::serialize_shared() {
   return shared_serialized_msg_;
 }
 
-OutgoingMessage::OutgoingMessage(SmallBuffer serialized_msg) : serialized_msg_(serialized_msg) {
+SharedSmallBuffer OutgoingMessage::compress_shared() {
+  if (!compression_done_) {
+    SmallBuffer compressed;
+    if (compress_msg_bytes(serialize(), &compressed)) {
+      shared_compressed_msg_ = make_shared_small_buffer(std::move(compressed));
+    }
+
+    compression_done_ = true;
+  }
+
+  return shared_compressed_msg_;
+}
+
+OutgoingMessage::OutgoingMessage(SmallBuffer serialized_msg)
+    : serialized_msg_(serialized_msg), compression_done_(false) {
 }
 
 namespace messages {
 
-BroadcastIncoming::BroadcastIncoming(const Buffer& serialized_msg)
-    : payload_(boost::asio::buffer(serialized_msg) + 1, YOGI_ENC_MSGPACK) {
+BroadcastIncoming::BroadcastIncoming(boost::asio::const_buffer serialized_msg)
+    : payload_(Payload::deserialize(serialized_msg + 1)) {
 }
 
 std::string BroadcastIncoming::to_string() const {
@@ -190,8 +303,127 @@ std::string BroadcastOutgoing::to_string() const {
   return ss.str();
 }
 
+Fragment::Header Fragment::make_header(std::size_t msg_size, std::size_t offset) {
+  YOGI_ASSERT(offset < msg_size);
+
+  Header header;
+  header[0] = kMessageType;
+  write_uint32(header.data() + 1, msg_size);
+  write_uint32(header.data() + 5, offset);
+  return header;
+}
+
+std::string Fragment::to_string() const {
+  std::stringstream ss;
+  ss << "Fragment, " << data_.size() << " bytes at offset " << offset_ << " of a " << msg_size_ << " bytes message";
+  return ss.str();
+}
+
+FragmentIncoming::FragmentIncoming(boost::asio::const_buffer serialized_msg) {
+  if (serialized_msg.size() <= kHeaderSize) {
+    throw DescriptiveError(YOGI_ERR_DESERIALIZE_MSG_FAILED) << "Fragment too short";
+  }
+
+  auto header = static_cast<const Byte*>(serialized_msg.data());
+  msg_size_   = read_uint32(header + 1);
+  offset_     = read_uint32(header + 5);
+  data_       = serialized_msg + kHeaderSize;
+
+  if (offset_ + data_.size() > msg_size_) {
+    throw DescriptiveError(YOGI_ERR_DESERIALIZE_MSG_FAILED) << "Fragment exceeds the message size";
+  }
+}
+
+std::string MulticastSync::to_string() const {
+  std::stringstream ss;
+  ss << "MulticastSync, sequence number " << seq_;
+  return ss.str();
+}
+
+MulticastSyncIncoming::MulticastSyncIncoming(boost::asio::const_buffer serialized_msg) {
+  if (serialized_msg.size() != kSize) {
+    throw DescriptiveError(YOGI_ERR_DESERIALIZE_MSG_FAILED) << "Invalid MulticastSync message size";
+  }
+
+  auto raw     = static_cast<const Byte*>(serialized_msg.data());
+  seq_         = read_uint64(raw + 1);
+  wrapped_key_ = Buffer(raw + 9, raw + kSize);
+}
+
+MulticastSyncOutgoing::MulticastSyncOutgoing(std::uint64_t seq, const Buffer& wrapped_key)
+    : OutgoingMessage(make_multicast_sync_msg_bytes(seq, wrapped_key)) {
+  seq_         = seq;
+  wrapped_key_ = wrapped_key;
+}
+
+std::string MulticastNack::to_string() const {
+  std::stringstream ss;
+  ss << "MulticastNack, " << count_ << " broadcasts starting at sequence number " << first_seq_;
+  return ss.str();
+}
+
+MulticastNackIncoming::MulticastNackIncoming(boost::asio::const_buffer serialized_msg) {
+  if (serialized_msg.size() != kSize) {
+    throw DescriptiveError(YOGI_ERR_DESERIALIZE_MSG_FAILED) << "Invalid MulticastNack message size";
+  }
+
+  auto raw   = static_cast<const Byte*>(serialized_msg.data());
+  first_seq_ = read_uint64(raw + 1);
+  count_     = read_uint32(raw + 9);
+}
+
+MulticastNackOutgoing::MulticastNackOutgoing(std::uint64_t first_seq, std::size_t count)
+    : OutgoingMessage(make_multicast_nack_msg_bytes(first_seq, count)) {
+  first_seq_ = first_seq;
+  count_     = count;
+}
+
+std::string MulticastRepair::to_string() const {
+  std::stringstream ss;
+  ss << "MulticastRepair, sequence number " << seq_;
+  if (is_lost()) {
+    ss << " lost";
+  } else {
+    ss << ", " << msg_size_ << " bytes message";
+  }
+
+  return ss.str();
+}
+
+MulticastRepairIncoming::MulticastRepairIncoming(boost::asio::const_buffer serialized_msg) {
+  if (serialized_msg.size() < kHeaderSize) {
+    throw DescriptiveError(YOGI_ERR_DESERIALIZE_MSG_FAILED) << "MulticastRepair message too short";
+  }
+
+  seq_      = read_uint64(static_cast<const Byte*>(serialized_msg.data()) + 1);
+  msg_      = serialized_msg + kHeaderSize;
+  msg_size_ = msg_.size();
+}
+
+MulticastRepairOutgoing::MulticastRepairOutgoing(std::uint64_t seq, const SmallBuffer& msg_bytes)
+    : OutgoingMessage(make_multicast_repair_msg_bytes(seq, msg_bytes)) {
+  seq_      = seq;
+  msg_size_ = msg_bytes.size();
+}
+
 }  // namespace messages
 
+bool compress_msg_bytes(const SmallBuffer& msg_bytes, SmallBuffer* compressed_msg_bytes) {
+  auto size = msg_bytes.size();
+  if (size <= kCompressedMsgHeaderSize || size > 0xFFFFFFFF) return false;
+
+  compressed_msg_bytes->resize(kCompressedMsgHeaderSize);
+  (*compressed_msg_bytes)[0] = MessageType::kCompressed;
+  write_uint32(compressed_msg_bytes->data() + 1, size);
+  if (!compress_data(msg_bytes.data(), size, compressed_msg_bytes) ||
+      compressed_msg_bytes->size() >= msg_bytes.size()) {
+    compressed_msg_bytes->clear();
+    return false;
+  }
+
+  return true;
+}
+
 std::ostream& operator<<(std::ostream& os, const Message& msg) {
   os << msg.to_string();
   return os;
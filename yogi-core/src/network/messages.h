@@ -23,6 +23,7 @@
 
 #include <src/config.h>
 
+#include <src/api/constants.h>
 #include <src/api/errors.h>
 #include <src/data/buffer.h>
 
@@ -50,6 +51,11 @@ enum MessageType : Byte {
   kHeartbeat,
   kAcknowledge,
   kBroadcast,
+  kCompressed,  // Another message compressed with zlib
+  kFragment,    // Part of a message that is too large to be sent at once
+  kMulticastSync,
+  kMulticastNack,
+  kMulticastRepair,
 };
 
 class Message {
@@ -65,7 +71,12 @@ class IncomingMessage : virtual public Message {
  public:
   typedef std::function<void(const IncomingMessage&)> MessageHandler;
 
-  static void deserialize(const Buffer& serialized_msg, const MessageHandler& fn);
+  // Compressed messages get rejected if they decompress to more than
+  // max_decompressed_size bytes; 0 rejects all compressed messages
+  static void deserialize(boost::asio::const_buffer serialized_msg, const MessageHandler& fn,
+                          std::size_t max_decompressed_size = 0);
+  static void deserialize(const Buffer& serialized_msg, const MessageHandler& fn,
+                          std::size_t max_decompressed_size = 0);
 
  protected:
   IncomingMessage() = default;
@@ -73,9 +84,22 @@ class IncomingMessage : virtual public Message {
 
 class Payload {
  public:
+  // Prefix for raw payloads on the wire; 0xC1 is never used in MessagePack
+  static constexpr Byte kRawPayloadMarker = 0xC1;
+
+  static Payload deserialize(boost::asio::const_buffer serialized_payload);
+
   Payload(boost::asio::const_buffer data, int encoding) : data_(data), encoding_(encoding) {
   }
 
+  boost::asio::const_buffer get_data() const {
+    return data_;
+  }
+
+  int get_encoding() const {
+    return encoding_;
+  }
+
   void serialize_to(SmallBuffer* buffer) const;
   Result serialize_to_user_buffer(boost::asio::mutable_buffer buffer, int encoding, std::size_t* bytes_written) const;
 
@@ -128,12 +152,19 @@ class OutgoingMessage : virtual public Message {
   const SmallBuffer& serialize() const;
   SharedSmallBuffer serialize_shared();
 
+  // Serialized message wrapped into a compressed message; the compression is
+  // only done once, however many connections the message gets sent to.
+  // Returns an empty pointer if compression does not make the message smaller.
+  SharedSmallBuffer compress_shared();
+
  protected:
   OutgoingMessage(SmallBuffer serialized_msg);
 
  private:
   SmallBuffer serialized_msg_;
   SharedSmallBuffer shared_serialized_msg_;
+  SharedSmallBuffer shared_compressed_msg_;
+  bool compression_done_;
 };
 
 namespace messages {
@@ -171,7 +202,7 @@ class Broadcast : public MessageT<MessageType::kBroadcast> {};
 
 class BroadcastIncoming : public IncomingMessage, public Broadcast {
  public:
-  BroadcastIncoming(const Buffer& serialized_msg);
+  BroadcastIncoming(boost::asio::const_buffer serialized_msg);
 
   virtual std::string to_string() const override final;
 
@@ -190,6 +221,175 @@ class BroadcastOutgoing : public OutgoingMessage, public Broadcast {
   virtual std::string to_string() const override final;
 };
 
+// Fragments of a message are sent in order and can be interleaved with other
+// messages, but not with fragments of other messages
+class Fragment : public MessageT<MessageType::kFragment> {
+ public:
+  // Message type followed by the size of the complete message and the offset
+  // of the fragment data within it as 32 bit big endian integers
+  static constexpr std::size_t kHeaderSize = 9;
+
+  // Messages that need to be fragmented get split into pieces of this size so
+  // that each fragment fits into the smallest possible receive queue
+  static constexpr std::size_t kMaxDataSize = constants::kMaxMessagePayloadSize;
+
+  typedef std::array<Byte, kHeaderSize> Header;
+
+  static Header make_header(std::size_t msg_size, std::size_t offset);
+
+  virtual std::string to_string() const override;
+
+  std::size_t get_msg_size() const {
+    return msg_size_;
+  }
+
+  std::size_t get_offset() const {
+    return offset_;
+  }
+
+  boost::asio::const_buffer get_data() const {
+    return data_;
+  }
+
+  bool is_first() const {
+    return offset_ == 0;
+  }
+
+  bool is_last() const {
+    return offset_ + data_.size() == msg_size_;
+  }
+
+ protected:
+  Fragment() = default;
+
+  std::size_t msg_size_ = 0;
+  std::size_t offset_   = 0;
+  boost::asio::const_buffer data_;
+};
+
+class FragmentIncoming : public IncomingMessage, public Fragment {
+ public:
+  FragmentIncoming(boost::asio::const_buffer serialized_msg);
+};
+
+// Broadcasts to branches that receive them via UDP multicast are numbered
+// consecutively by the sender. The following messages get exchanged over the
+// connection in order to synchronize the sequence numbers and to repair lost
+// datagrams. Sequence numbers are sent as 64 bit big endian integers.
+
+// Sequence number of the first broadcast that the sender multicasts instead
+// of sending it over the connection, followed by the key that the sender uses
+// for authenticating its datagrams. The key is XOR-ed with a key derived from
+// the session secret so that only the remote branch can read it.
+class MulticastSync : public MessageT<MessageType::kMulticastSync> {
+ public:
+  static constexpr std::size_t kKeySize = 32;
+  static constexpr std::size_t kSize    = 9 + kKeySize;
+
+  virtual std::string to_string() const override;
+
+  std::uint64_t get_seq() const {
+    return seq_;
+  }
+
+  const Buffer& get_wrapped_key() const {
+    return wrapped_key_;
+  }
+
+ protected:
+  MulticastSync() = default;
+
+  std::uint64_t seq_ = 0;
+  Buffer wrapped_key_;
+};
+
+class MulticastSyncIncoming : public IncomingMessage, public MulticastSync {
+ public:
+  MulticastSyncIncoming(boost::asio::const_buffer serialized_msg);
+};
+
+class MulticastSyncOutgoing : public OutgoingMessage, public MulticastSync {
+ public:
+  MulticastSyncOutgoing(std::uint64_t seq, const Buffer& wrapped_key);
+};
+
+// Requests count broadcasts starting at the given sequence number to be sent
+// again over the connection
+class MulticastNack : public MessageT<MessageType::kMulticastNack> {
+ public:
+  static constexpr std::size_t kSize = 13;
+
+  virtual std::string to_string() const override;
+
+  std::uint64_t get_first_seq() const {
+    return first_seq_;
+  }
+
+  std::size_t get_count() const {
+    return count_;
+  }
+
+ protected:
+  MulticastNack() = default;
+
+  std::uint64_t first_seq_ = 0;
+  std::size_t count_       = 0;
+};
+
+class MulticastNackIncoming : public IncomingMessage, public MulticastNack {
+ public:
+  MulticastNackIncoming(boost::asio::const_buffer serialized_msg);
+};
+
+class MulticastNackOutgoing : public OutgoingMessage, public MulticastNack {
+ public:
+  MulticastNackOutgoing(std::uint64_t first_seq, std::size_t count);
+};
+
+// Broadcast sent again in response to a NACK; the serialized broadcast message
+// is empty if the sender does not have it anymore
+class MulticastRepair : public MessageT<MessageType::kMulticastRepair> {
+ public:
+  static constexpr std::size_t kHeaderSize = 9;
+
+  virtual std::string to_string() const override;
+
+  std::uint64_t get_seq() const {
+    return seq_;
+  }
+
+  bool is_lost() const {
+    return msg_size_ == 0;
+  }
+
+ protected:
+  MulticastRepair() = default;
+
+  std::uint64_t seq_    = 0;
+  std::size_t msg_size_ = 0;
+};
+
+class MulticastRepairIncoming : public IncomingMessage, public MulticastRepair {
+ public:
+  MulticastRepairIncoming(boost::asio::const_buffer serialized_msg);
+
+  boost::asio::const_buffer get_msg() const {
+    return msg_;
+  }
+
+ private:
+  boost::asio::const_buffer msg_;
+};
+
+class MulticastRepairOutgoing : public OutgoingMessage, public MulticastRepair {
+ public:
+  MulticastRepairOutgoing(std::uint64_t seq, const SmallBuffer& msg_bytes);
+};
+
 }  // namespace messages
 
+// Wraps already serialized message bytes into a compressed message; returns
+// false if compression would not make the message smaller
+bool compress_msg_bytes(const SmallBuffer& msg_bytes, SmallBuffer* compressed_msg_bytes);
+
 std::ostream& operator<<(std::ostream& os, const Message& msg);
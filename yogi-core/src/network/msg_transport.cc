@@ -23,6 +23,8 @@
 #include <src/network/msg_transport.h>
 #include <src/util/algorithm.h>
 
+#include <thread>
+
 using namespace std::string_literals;
 
 YOGI_DEFINE_INTERNAL_LOGGER("MessageTransport")
@@ -64,43 +66,95 @@ bool deserialize_msg_size_field(const std::array<Byte, 5>& buffer, std::size_t s
   return false;
 }
 
-MessageTransport::MessageTransport(TransportPtr transport, std::size_t tx_queue_size, std::size_t rx_queue_size)
+MessageTransport::MessageTransport(TransportPtr transport, std::size_t tx_queue_size, std::size_t rx_queue_size,
+                                   bool mirrored_queues)
     : context_(transport->get_context()),
       transport_(transport),
-      tx_rb_(tx_queue_size),
-      rx_rb_(rx_queue_size),
+      tx_rb_(tx_queue_size, mirrored_queues),
+      tx_high_prio_rb_(make_high_prio_tx_queue_size(tx_queue_size), mirrored_queues),
+      rx_rb_(rx_queue_size, mirrored_queues),
       last_tx_error_(YOGI_OK),
+      tx_failed_(false),
+      has_pending_sends_{false, false},
+      tx_in_flight_{0, 0},
       send_to_transport_running_(false),
+      tx_batch_{},
+      tx_batch_running_(false),
+      tx_coalescing_delay_(std::chrono::nanoseconds::zero()),
+      tx_coalescing_threshold_(0),
+      tx_coalescing_timer_(context_->io_context()),
+      tx_coalescing_timer_running_(false),
+      tx_zero_copy_threshold_(0),
+      tx_compression_threshold_(0),
+      tx_compression_max_size_(0),
+      tx_frame_ref_bytes_(0),
+      in_place_delivery_running_(false),
       receive_from_transport_running_(false),
       last_rx_error_(YOGI_OK) {
   reset_received_size_field();
 }
 
+void MessageTransport::set_tx_coalescing(std::chrono::nanoseconds delay, std::size_t threshold) {
+  std::lock_guard<std::mutex> lock(tx_mutex_);
+  tx_coalescing_delay_     = delay;
+  tx_coalescing_threshold_ = threshold;
+}
+
+void MessageTransport::set_tx_zero_copy_threshold(std::size_t threshold) {
+  std::lock_guard<std::mutex> lock(tx_mutex_);
+  tx_zero_copy_threshold_ = threshold;
+}
+
+void MessageTransport::set_tx_compression_threshold(std::size_t threshold, std::size_t max_msg_size) {
+  std::lock_guard<std::mutex> lock(tx_mutex_);
+  tx_compression_threshold_ = threshold;
+  tx_compression_max_size_  = max_msg_size;
+}
+
 void MessageTransport::start() {
   set_logging_prefix("[peer " + transport_->get_peer_description() + ']');
   receive_some_bytes_from_transport();
 }
 
-bool MessageTransport::try_send(const OutgoingMessage& msg) {
-  std::lock_guard<std::mutex> lock(tx_mutex_);
-  if (last_tx_error_.is_error()) {
-    throw last_tx_error_.to_error();
+bool MessageTransport::try_send(const OutgoingMessage& msg, TxPriority prio) {
+  if (!may_send_immediately(prio)) return false;
+
+  if (auto compressed = try_compress(msg.serialize())) {
+    return try_send_shared_without_lock(compressed, prio);
   }
 
-  if (pending_sends_.empty()) {
-    return try_send_impl(msg.serialize());
-  } else {
-    return false;
+  if (needs_fragmentation(msg.get_size())) return false;
+
+  return enqueue_unless_pending(prio, [&] { return try_send_impl(msg.serialize(), prio); });
+}
+
+bool MessageTransport::try_send(const SharedSmallBuffer& msg_bytes, TxPriority prio) {
+  if (!may_send_immediately(prio)) return false;
+
+  if (auto compressed = try_compress(*msg_bytes)) {
+    return try_send_shared_without_lock(compressed, prio);
+  }
+
+  return try_send_shared_without_lock(msg_bytes, prio);
+}
+
+bool MessageTransport::try_send(OutgoingMessage* msg, TxPriority prio) {
+  if (!may_send_immediately(prio)) return false;
+
+  if (auto compressed = try_compress(msg)) {
+    return try_send_shared_without_lock(compressed, prio);
   }
+
+  return try_send_shared_without_lock(msg->serialize_shared(), prio);
 }
 
-void MessageTransport::send_async(OutgoingMessage* msg, OperationTag tag, SendHandler handler) {
+void MessageTransport::send_async(OutgoingMessage* msg, OperationTag tag, SendHandler handler, TxPriority prio) {
   YOGI_ASSERT(tag != 0);
-  send_async_impl(msg, tag, handler);
+  send_async_impl(msg, tag, handler, prio);
 }
 
-void MessageTransport::send_async(OutgoingMessage* msg, SendHandler handler) {
-  send_async_impl(msg, 0, handler);
+void MessageTransport::send_async(OutgoingMessage* msg, SendHandler handler, TxPriority prio) {
+  send_async_impl(msg, 0, handler, prio);
 }
 
 bool MessageTransport::cancel_send(OperationTag tag) {
@@ -109,10 +163,13 @@ bool MessageTransport::cancel_send(OperationTag tag) {
   std::lock_guard<std::mutex> lock(tx_mutex_);
   auto it = find_if(pending_sends_, [&](auto& ps) { return ps.tag == tag; });
 
-  if (it == pending_sends_.end()) return false;
+  // Messages that have been partially queued in fragments must be finished
+  if (it == pending_sends_.end() || it->bytes_fragmented > 0) return false;
 
   auto handler = std::move(it->handler);
+  auto prio    = it->prio;
   pending_sends_.erase(it);
+  get_has_pending_sends(prio) = contains_if(pending_sends_, [&](auto& ps) { return ps.prio == prio; });
 
   transport_->get_context()->post([=] { handler(Error(YOGI_ERR_CANCELED)); });
 
@@ -120,7 +177,7 @@ bool MessageTransport::cancel_send(OperationTag tag) {
 }
 
 void MessageTransport::receive_async(boost::asio::mutable_buffer msg, ReceiveHandler handler) {
-  YOGI_ASSERT(!pending_receive_handler_);
+  YOGI_ASSERT(!has_pending_receive());
   YOGI_ASSERT(!size_field_valid_);
 
   if (last_rx_error_.is_error()) {
@@ -135,41 +192,240 @@ void MessageTransport::receive_async(boost::asio::mutable_buffer msg, ReceiveHan
   receive_some_bytes_from_transport();
 }
 
+void MessageTransport::receive_in_place_async(InPlaceReceiveHandler handler) {
+  YOGI_ASSERT(!has_pending_receive());
+
+  if (last_rx_error_.is_error()) {
+    transport_->get_context()->post([=] { handler(last_rx_error_, {}); });
+    return;
+  }
+
+  pending_in_place_receive_handler_ = handler;
+  try_deliver_pending_receive();
+
+  if (!rx_rb_.full()) {
+    receive_some_bytes_from_transport();
+  }
+}
+
+void MessageTransport::receive_batch_async(BatchReceiveHandler handler) {
+  YOGI_ASSERT(!has_pending_receive());
+
+  if (last_rx_error_.is_error()) {
+    transport_->get_context()->post([=] { handler(last_rx_error_, {}); });
+    return;
+  }
+
+  pending_batch_receive_handler_ = handler;
+  try_deliver_pending_receive();
+
+  if (!rx_rb_.full()) {
+    receive_some_bytes_from_transport();
+  }
+}
+
 void MessageTransport::cancel_receive() {
-  if (!pending_receive_handler_) return;
+  if (pending_receive_handler_) {
+    ReceiveHandler handler;
+    std::swap(handler, pending_receive_handler_);
 
-  ReceiveHandler handler;
-  std::swap(handler, pending_receive_handler_);
+    transport_->get_context()->post([=] { handler(Error(YOGI_ERR_CANCELED), 0); });
+  }
+
+  if (pending_in_place_receive_handler_) {
+    InPlaceReceiveHandler handler;
+    std::swap(handler, pending_in_place_receive_handler_);
+
+    transport_->get_context()->post([=] { handler(Error(YOGI_ERR_CANCELED), {}); });
+  }
+
+  if (pending_batch_receive_handler_) {
+    BatchReceiveHandler handler;
+    std::swap(handler, pending_batch_receive_handler_);
+
+    transport_->get_context()->post([=] { handler(Error(YOGI_ERR_CANCELED), {}); });
+  }
+}
+
+bool MessageTransport::try_send_impl(const SmallBuffer& msg_bytes, TxPriority prio) {
+  auto& rb = get_tx_queue(prio);
+
+  SizeFieldBuffer size_field_buf;
+  auto n = serialize_msg_size_field(msg_bytes.size(), &size_field_buf);
+  YOGI_ASSERT(msg_bytes.size() + n <= rb.capacity());
+
+  // Lock-free, so multiple threads can enqueue messages at the same time
+  LockFreeRingBuffer::const_buffers_2 data = {boost::asio::buffer(size_field_buf.data(), n),
+                                              boost::asio::buffer(msg_bytes.data(), msg_bytes.size())};
+  if (!rb.try_write_concurrently(data)) {
+    // Data held back for coalescing must not block the queue
+    send_some_bytes_to_transport();
+    return false;
+  }
 
-  transport_->get_context()->post([=] { handler(Error(YOGI_ERR_CANCELED), 0); });
+  // High priority messages are never held back for coalescing
+  if (prio == TxPriority::kNormal && should_hold_back_tx_data()) {
+    start_tx_coalescing_timer();
+  } else {
+    send_some_bytes_to_transport();
+  }
+
+  return true;
+}
+
+bool MessageTransport::try_send_shared_impl(const SharedSmallBuffer& msg_bytes, TxPriority prio) {
+  YOGI_ASSERT(!needs_fragmentation(msg_bytes->size()));
+
+  if (should_send_by_reference(msg_bytes->size(), prio)) {
+    return try_send_by_reference(msg_bytes);
+  }
+
+  return try_send_impl(*msg_bytes, prio);
+}
+
+std::size_t MessageTransport::make_high_prio_tx_queue_size(std::size_t tx_queue_size) {
+  // The queue must still be able to hold the largest unfragmented message
+  auto min_size = static_cast<std::size_t>(constants::kMinTxQueueSize);
+  return std::min(tx_queue_size, std::max(tx_queue_size / kHighPrioTxQueueSizeDivisor, min_size));
+}
+
+bool MessageTransport::may_send_immediately(TxPriority prio) {
+  if (tx_failed_) {
+    std::lock_guard<std::mutex> lock(tx_mutex_);
+    throw last_tx_error_.to_error();
+  }
+
+  // Only a hint so that messages do not get compressed in vain; the check that
+  // counts is done by enqueue_unless_pending()
+  return !get_has_pending_sends(prio);
+}
+
+// Messages must not overtake messages of the same priority queued by
+// send_async(). Producers announce themselves via the in-flight counter before
+// checking the flag, and set_has_pending_sends() sets the flag before waiting
+// for the counter to drain, so either the producer sees the flag or the
+// message gets enqueued before the pending sends.
+template <typename Fn>
+bool MessageTransport::enqueue_unless_pending(TxPriority prio, Fn fn) {
+  auto& in_flight = get_tx_in_flight(prio);
+  ++in_flight;
+  bool ok = !get_has_pending_sends(prio) && fn();
+  --in_flight;
+  return ok;
+}
+
+// Must be called with tx_mutex_ held
+void MessageTransport::set_has_pending_sends(TxPriority prio) {
+  get_has_pending_sends(prio) = true;
+  while (get_tx_in_flight(prio) > 0) {
+    std::this_thread::yield();
+  }
 }
 
-bool MessageTransport::try_send_impl(const SmallBuffer& msg_bytes) {
-  if (!can_send(msg_bytes.size())) return false;
+bool MessageTransport::try_send_shared_without_lock(const SharedSmallBuffer& msg_bytes, TxPriority prio) {
+  if (needs_fragmentation(msg_bytes->size())) return false;
 
+  return enqueue_unless_pending(prio, [&] { return try_send_shared_impl(msg_bytes, prio); });
+}
+
+bool MessageTransport::try_send_fragment(const SmallBuffer& msg_bytes, std::size_t offset) {
+  auto data_size = std::min(messages::Fragment::kMaxDataSize, msg_bytes.size() - offset);
+
+  // Size field and fragment header
+  std::array<Byte, std::tuple_size<SizeFieldBuffer>::value + messages::Fragment::kHeaderSize> hdr_buf;
   SizeFieldBuffer size_field_buf;
-  auto n             = serialize_msg_size_field(msg_bytes.size(), &size_field_buf);
-  auto bytes_written = tx_rb_.write(size_field_buf.data(), n);
-  YOGI_UNUSED(bytes_written);
-  YOGI_ASSERT(bytes_written == n);
+  auto n = serialize_msg_size_field(messages::Fragment::kHeaderSize + data_size, &size_field_buf);
+  auto header = messages::Fragment::make_header(msg_bytes.size(), offset);
+  std::copy_n(size_field_buf.begin(), n, hdr_buf.begin());
+  std::copy(header.begin(), header.end(), hdr_buf.begin() + static_cast<std::ptrdiff_t>(n));
 
-  bytes_written = tx_rb_.write(static_cast<const Byte*>(msg_bytes.data()), msg_bytes.size());
-  YOGI_ASSERT(bytes_written == msg_bytes.size());
+  LockFreeRingBuffer::const_buffers_2 data = {boost::asio::buffer(hdr_buf.data(), n + header.size()),
+                                              boost::asio::buffer(msg_bytes.data() + offset, data_size)};
+  bool ok = tx_rb_.try_write_concurrently(data);
 
+  // Fragments are never held back for coalescing since they are large
   send_some_bytes_to_transport();
+  return ok;
+}
+
+bool MessageTransport::try_send_pending(PendingSend* ps) {
+  auto msg_size = ps->msg_bytes->size();
+  if (!needs_fragmentation(msg_size)) {
+    return try_send_shared_impl(ps->msg_bytes, ps->prio);
+  }
+
+  while (ps->bytes_fragmented < msg_size) {
+    if (!try_send_fragment(*ps->msg_bytes, ps->bytes_fragmented)) return false;
+    ps->bytes_fragmented += std::min(messages::Fragment::kMaxDataSize, msg_size - ps->bytes_fragmented);
+  }
 
   return true;
 }
 
-bool MessageTransport::can_send(std::size_t msg_size) const {
-  YOGI_ASSERT(msg_size + calculate_msg_size_field_length(msg_size) <= tx_rb_.capacity());
+bool MessageTransport::try_send_by_reference(const SharedSmallBuffer& msg_bytes) {
+  SizeFieldBuffer size_field_buf;
+  auto n = serialize_msg_size_field(msg_bytes->size(), &size_field_buf);
+  YOGI_ASSERT(msg_bytes->size() + n <= tx_rb_.capacity());
+
+  // Limit the amount of memory kept alive by queued references in the same
+  // way as the send queue limits the amount of copied data
+  if (tx_frame_ref_bytes_ + msg_bytes->size() > tx_rb_.capacity()) {
+    send_some_bytes_to_transport();
+    return false;
+  }
+
+  // Only the size field goes into the send queue; the reference is registered
+  // before the size field becomes visible to the sender so that the sender
+  // always knows where to insert the message bytes into the data stream. The
+  // mutex keeps the references in the same order as their size fields.
+  bool ok;
+  {
+    std::lock_guard<std::mutex> lock(tx_frame_refs_mutex_);
+    LockFreeRingBuffer::const_buffers_2 data = {boost::asio::buffer(size_field_buf.data(), n),
+                                                boost::asio::const_buffer()};
+    ok = tx_rb_.try_write_concurrently(data, [&](auto end_idx) {
+      tx_frame_refs_.push_back(TxFrameRef{end_idx, msg_bytes, 0});
+      tx_frame_ref_bytes_ += msg_bytes->size();
+    });
+  }
+
+  // References are never held back for coalescing since there is nothing to
+  // be gained by waiting for more data
+  send_some_bytes_to_transport();
+  return ok;
+}
+
+// Only the normal priority queue supports references
+bool MessageTransport::should_send_by_reference(std::size_t msg_size, TxPriority prio) const {
+  return prio == TxPriority::kNormal && tx_zero_copy_threshold_ > 0 && msg_size >= tx_zero_copy_threshold_;
+}
+
+// Returns an empty pointer if the message should be sent uncompressed
+SharedSmallBuffer MessageTransport::try_compress(const SmallBuffer& msg_bytes) const {
+  if (!should_compress(msg_bytes.size())) return {};
+
+  SmallBuffer compressed;
+  if (!compress_msg_bytes(msg_bytes, &compressed)) return {};
+
+  return make_shared_small_buffer(std::move(compressed));
+}
+
+// Same as above but the compressed message is cached by msg
+SharedSmallBuffer MessageTransport::try_compress(OutgoingMessage* msg) const {
+  if (!should_compress(msg->get_size())) return {};
+  return msg->compress_shared();
+}
 
-  auto n = tx_rb_.available_for_write();
-  if (n >= msg_size + 5) return true;  // optimisation since this is very likely
-  return n >= msg_size + calculate_msg_size_field_length(msg_size);
+bool MessageTransport::should_compress(std::size_t msg_size) const {
+  return tx_compression_threshold_ > 0 && msg_size >= tx_compression_threshold_ &&
+         msg_size <= tx_compression_max_size_;
 }
 
-void MessageTransport::send_async_impl(OutgoingMessage* msg, OperationTag tag, SendHandler handler) {
+bool MessageTransport::has_tx_data() {
+  return !tx_rb_.empty() || !tx_high_prio_rb_.empty() || tx_frame_ref_bytes_ > 0;
+}
+
+void MessageTransport::send_async_impl(OutgoingMessage* msg, OperationTag tag, SendHandler handler, TxPriority prio) {
   std::lock_guard<std::mutex> lock(tx_mutex_);
 
   if (tag != 0) {
@@ -181,24 +437,87 @@ void MessageTransport::send_async_impl(OutgoingMessage* msg, OperationTag tag, S
     return;
   }
 
-  if (pending_sends_.empty() && try_send_impl(msg->serialize())) {
+  // Compressed only once so that retries and other connections do not have to
+  // do it again
+  auto compressed = try_compress(msg);
+  auto msg_size   = compressed ? compressed->size() : msg->get_size();
+
+  // Fragmented messages are always queued via the pending sends; their
+  // fragments go through the normal priority queue but they keep their
+  // priority so that they do not get overtaken by later messages of it
+  if (needs_fragmentation(msg_size)) {
+    PendingSend ps = {tag, compressed ? compressed : msg->serialize_shared(), handler, prio, 0};
+    set_has_pending_sends(prio);
+    pending_sends_.push_back(ps);
+    retry_sending_pending_sends();
+    return;
+  }
+
+  bool sent = false;
+  if (!get_has_pending_sends(prio)) {
+    if (compressed) {
+      sent = try_send_shared_impl(compressed, prio);
+    } else if (should_send_by_reference(msg_size, prio)) {
+      sent = try_send_by_reference(msg->serialize_shared());
+    } else {
+      sent = try_send_impl(msg->serialize(), prio);
+    }
+  }
+
+  if (sent) {
     transport_->get_context()->post([=] { handler(Success()); });
   } else {
-    PendingSend ps = {tag, msg->serialize_shared(), handler};
+    PendingSend ps = {tag, compressed ? compressed : msg->serialize_shared(), handler, prio, 0};
+    set_has_pending_sends(prio);
     pending_sends_.push_back(ps);
-
-    YOGI_ASSERT(send_to_transport_running_);
   }
 }
 
 void MessageTransport::send_some_bytes_to_transport() {
-  YOGI_ASSERT(!tx_rb_.empty());
+  // Only one write operation can be in progress at a time; producers that find
+  // one running rely on its completion handler to pick up their data. The flag
+  // is always changed via exchange() so that the queue state seen by whoever
+  // clears it is visible to whoever sets it next, and vice versa.
+  while (has_tx_data() && !send_to_transport_running_.exchange(true)) {
+    if (write_tx_queue_to_transport()) {
+      return;
+    }
+
+    send_to_transport_running_.exchange(false);
 
-  if (send_to_transport_running_) return;
-  send_to_transport_running_ = true;
+    // Only the size field of the next reference is still missing; its
+    // producer calls this function again once it has been published
+    if (tx_rb_.empty() && tx_high_prio_rb_.empty()) return;
+  }
+}
+
+bool MessageTransport::write_tx_queue_to_transport() {
+  if (!tx_batch_running_ && !start_tx_batch()) return false;
+
+  // Send both parts of the ring buffer at once if the data wraps around,
+  // followed by the referenced message if it is next in the data stream
+  auto& rb      = get_tx_queue(tx_batch_.prio);
+  auto arrays   = rb.read_arrays();
+  auto rb_bytes = tx_batch_.rb_bytes;
+  Transport::ConstBufferSequence data;
+  for (auto& array : arrays) {
+    auto n = std::min(array.size(), rb_bytes - boost::asio::buffer_size(data));
+    if (n > 0) {
+      data.push_back(boost::asio::buffer(array.data(), n));
+    }
+  }
 
+  SharedSmallBuffer frame;
+  if (tx_batch_.has_frame_ref) {
+    std::lock_guard<std::mutex> lock(tx_frame_refs_mutex_);
+    auto& ref = tx_frame_refs_.front();
+    frame     = ref.msg_bytes;
+    data.push_back(boost::asio::buffer(frame->data(), frame->size()) + ref.bytes_sent);
+  }
+
+  auto prio      = tx_batch_.prio;
   auto weak_self = make_weak_ptr();
-  transport_->send_some_async(tx_rb_.first_read_array(), [=](auto& res, auto n) {
+  transport_->send_some_async(data, [=](auto& res, auto n) {
     auto self = weak_self.lock();
     if (!self) return;
 
@@ -207,27 +526,158 @@ void MessageTransport::send_some_bytes_to_transport() {
       return;
     }
 
-    std::lock_guard<std::mutex> lock(tx_mutex_);
-    self->tx_rb_.commit_first_read_array(n);
-    send_to_transport_running_ = false;
+    auto n_rb = std::min(n, rb_bytes);
+    self->get_tx_queue(prio).commit_read_arrays(n_rb);
+    self->tx_batch_.rb_bytes -= n_rb;
 
-    if (!self->tx_rb_.empty()) {
-      self->send_some_bytes_to_transport();
+    if (frame && n > n_rb && self->commit_sent_frame_bytes(n - n_rb)) {
+      self->tx_batch_.has_frame_ref = false;
     }
 
-    self->retry_sending_pending_sends();
+    self->tx_batch_running_ = self->tx_batch_.rb_bytes > 0 || self->tx_batch_.has_frame_ref;
+
+    {
+      std::lock_guard<std::mutex> lock(self->tx_mutex_);
+      self->retry_sending_pending_sends();
+    }
+
+    self->send_to_transport_running_.exchange(false);
+    self->send_some_bytes_to_transport();
+  });
+
+  return true;
+}
+
+bool MessageTransport::start_tx_batch() {
+  // All readable data in the high priority queue consists of complete frames
+  if (!tx_high_prio_rb_.empty()) {
+    tx_batch_         = TxBatch{TxPriority::kHigh, tx_high_prio_rb_.available_for_read(), false};
+    tx_batch_running_ = true;
+    return true;
+  }
+
+  // The readable data has to be determined before looking at the references
+  // since references get registered before their size field gets published
+  auto arrays   = tx_rb_.read_arrays();
+  auto rb_bytes = arrays[0].size() + arrays[1].size();
+  bool has_ref  = false;
+
+  {
+    std::lock_guard<std::mutex> lock(tx_frame_refs_mutex_);
+    if (!tx_frame_refs_.empty()) {
+      auto dist = tx_rb_.readable_bytes_before(tx_frame_refs_.front().rb_idx);
+      if (dist <= rb_bytes) {
+        rb_bytes = dist;
+        has_ref  = true;
+      }
+    }
+  }
+
+  // The size field of the next reference may not have been published yet
+  if (rb_bytes == 0 && !has_ref) return false;
+
+  auto limited_rb_bytes = limit_tx_batch_size(arrays, rb_bytes);
+  if (limited_rb_bytes < rb_bytes) {
+    rb_bytes = limited_rb_bytes;
+    has_ref  = false;
+  }
+
+  tx_batch_         = TxBatch{TxPriority::kNormal, rb_bytes, has_ref};
+  tx_batch_running_ = true;
+  return true;
+}
+
+std::size_t MessageTransport::limit_tx_batch_size(const LockFreeRingBuffer::const_buffers_2& arrays,
+                                                  std::size_t rb_bytes) const {
+  auto byte_at = [&](std::size_t pos) {
+    auto& array = pos < arrays[0].size() ? arrays[0] : arrays[1];
+    auto offset = pos < arrays[0].size() ? pos : pos - arrays[0].size();
+    return static_cast<const Byte*>(array.data())[offset];
+  };
+
+  // Walk the frames in the queue to find the first frame boundary after the
+  // limit; the last size field may belong to a referenced message
+  std::size_t pos = 0;
+  while (pos < rb_bytes && pos < kMaxTxBatchSize) {
+    SizeFieldBuffer size_field_buf;
+    std::size_t size_field_len = 0;
+    std::size_t msg_size       = 0;
+    do {
+      size_field_buf[size_field_len] = byte_at(pos + size_field_len);
+      ++size_field_len;
+    } while (!deserialize_msg_size_field(size_field_buf, size_field_len, &msg_size));
+
+    if (pos + size_field_len >= rb_bytes) return rb_bytes;
+    pos += size_field_len + msg_size;
+  }
+
+  return std::min(pos, rb_bytes);
+}
+
+bool MessageTransport::commit_sent_frame_bytes(std::size_t n) {
+  std::lock_guard<std::mutex> lock(tx_frame_refs_mutex_);
+  auto& ref = tx_frame_refs_.front();
+  ref.bytes_sent += n;
+
+  if (ref.bytes_sent == ref.msg_bytes->size()) {
+    tx_frame_ref_bytes_ -= ref.msg_bytes->size();
+    tx_frame_refs_.pop_front();
+    return true;
+  }
+
+  return false;
+}
+
+bool MessageTransport::should_hold_back_tx_data() const {
+  if (tx_coalescing_delay_ == tx_coalescing_delay_.zero()) return false;
+  if (tx_coalescing_threshold_ == 0) return true;
+  return tx_rb_.available_for_read() < tx_coalescing_threshold_;
+}
+
+void MessageTransport::start_tx_coalescing_timer() {
+  if (tx_coalescing_timer_running_.exchange(true)) return;
+
+  auto weak_self = make_weak_ptr();
+  tx_coalescing_timer_.expires_after(tx_coalescing_delay_);
+  tx_coalescing_timer_.async_wait([=](auto& ec) {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    self->on_tx_coalescing_timer_expired(ec);
   });
 }
 
+void MessageTransport::on_tx_coalescing_timer_expired(const boost::system::error_code& ec) {
+  tx_coalescing_timer_running_ = false;
+
+  if (ec == boost::asio::error::operation_aborted) return;
+
+  send_some_bytes_to_transport();
+}
+
 void MessageTransport::retry_sending_pending_sends() {
+  // Messages must stay in order within each priority and the fragments of a
+  // message must not be interleaved with the fragments of other messages
+  bool blocked[2]        = {false, false};
+  bool fragments_blocked = false;
+
   auto it = pending_sends_.begin();
-  while (it != pending_sends_.end() && try_send_impl(*it->msg_bytes)) {
-    auto handler = std::move(it->handler);
-    transport_->get_context()->post([=] { handler(Success()); });
-    ++it;
+  while (it != pending_sends_.end()) {
+    auto& prio_blocked = blocked[it->prio == TxPriority::kHigh];
+    bool fragmented    = needs_fragmentation(it->msg_bytes->size());
+    if (!prio_blocked && !(fragmented && fragments_blocked) && try_send_pending(&*it)) {
+      auto handler = std::move(it->handler);
+      transport_->get_context()->post([=] { handler(Success()); });
+      it = pending_sends_.erase(it);
+    } else {
+      prio_blocked = true;
+      fragments_blocked |= fragmented;
+      ++it;
+    }
   }
 
-  pending_sends_.erase(pending_sends_.begin(), it);
+  has_pending_sends_[0] = blocked[0];
+  has_pending_sends_[1] = blocked[1];
 }
 
 bool MessageTransport::try_get_received_size_field(std::size_t* msg_size) {
@@ -291,13 +741,31 @@ void MessageTransport::receive_some_bytes_from_transport() {
 }
 
 void MessageTransport::try_deliver_pending_receive() {
-  if (!pending_receive_handler_) return;
+  if (!has_pending_receive() || in_place_delivery_running_) return;
 
   std::size_t size;
   if (!try_get_received_size_field(&size) || rx_rb_.available_for_read() < size) {
     return;
   }
 
+  if (pending_in_place_receive_handler_) {
+    InPlaceReceiveHandler handler;
+    std::swap(handler, pending_in_place_receive_handler_);
+    reset_received_size_field();
+
+    deliver_in_place(size, handler);
+    return;
+  }
+
+  if (pending_batch_receive_handler_) {
+    BatchReceiveHandler handler;
+    std::swap(handler, pending_batch_receive_handler_);
+    reset_received_size_field();
+
+    deliver_batch(size, handler);
+    return;
+  }
+
   ReceiveHandler handler;
   std::swap(handler, pending_receive_handler_);
   reset_received_size_field();
@@ -313,6 +781,105 @@ void MessageTransport::try_deliver_pending_receive() {
   }
 }
 
+bool MessageTransport::has_pending_receive() const {
+  return pending_receive_handler_ || pending_in_place_receive_handler_ || pending_batch_receive_handler_;
+}
+
+void MessageTransport::deliver_in_place(std::size_t msg_size, InPlaceReceiveHandler handler) {
+  // The message stays in the ring buffer until the handler returns, so no
+  // other message must be parsed until then
+  in_place_delivery_running_ = true;
+
+  auto weak_self = make_weak_ptr();
+  transport_->get_context()->post([=] {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    handler(Success(), self->get_received_msg_view(0, msg_size));
+    self->finish_in_place_delivery(msg_size);
+  });
+}
+
+void MessageTransport::deliver_batch(std::size_t first_msg_size, BatchReceiveHandler handler) {
+  in_place_delivery_running_ = true;
+
+  auto weak_self = make_weak_ptr();
+  transport_->get_context()->post([=] {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    auto n = self->collect_received_msgs(first_msg_size);
+    handler(Success(), self->rx_batch_);
+    self->finish_in_place_delivery(n);
+  });
+}
+
+void MessageTransport::finish_in_place_delivery(std::size_t bytes_delivered) {
+  rx_rb_.discard(bytes_delivered);
+  in_place_delivery_running_ = false;
+
+  try_deliver_pending_receive();
+
+  if (!rx_rb_.full()) {
+    receive_some_bytes_from_transport();
+  }
+}
+
+std::size_t MessageTransport::collect_received_msgs(std::size_t first_msg_size) {
+  // The size field of the first message has already been popped from the ring
+  // buffer; the size fields of all following messages are parsed in place and
+  // discarded together with the messages once the handler returns
+  rx_batch_.clear();
+  rx_batch_.push_back(get_received_msg_view(0, first_msg_size));
+
+  auto arrays    = rx_rb_.read_arrays();
+  auto available = arrays[0].size() + arrays[1].size();
+  auto byte_at   = [&](std::size_t offset) {
+    auto& array = offset < arrays[0].size() ? arrays[0] : arrays[1];
+    offset      = offset < arrays[0].size() ? offset : offset - arrays[0].size();
+    return static_cast<const Byte*>(array.data())[offset];
+  };
+
+  std::size_t offset = first_msg_size;
+  while (offset < available) {
+    SizeFieldBuffer size_field;
+    std::size_t size_field_size = 0;
+    std::size_t msg_size;
+    bool ok;
+    do {
+      size_field[size_field_size] = byte_at(offset + size_field_size);
+      ++size_field_size;
+      ok = deserialize_msg_size_field(size_field, size_field_size, &msg_size);
+    } while (!ok && size_field_size < size_field.size() && offset + size_field_size < available);
+
+    // Incomplete or invalid messages are left to the regular parsing path
+    if (!ok || offset + size_field_size + msg_size > available) break;
+
+    rx_batch_.push_back(get_received_msg_view(offset + size_field_size, msg_size));
+    offset += size_field_size + msg_size;
+  }
+
+  return offset;
+}
+
+boost::asio::const_buffer MessageTransport::get_received_msg_view(std::size_t offset, std::size_t msg_size) {
+  auto arrays = rx_rb_.read_arrays();
+  if (offset + msg_size <= arrays[0].size()) {
+    return boost::asio::buffer(arrays[0] + offset, msg_size);
+  }
+
+  if (offset >= arrays[0].size()) {
+    return boost::asio::buffer(arrays[1] + (offset - arrays[0].size()), msg_size);
+  }
+
+  // The message wraps around the end of the ring buffer which can only happen
+  // if the ring buffer is not mirrored and only for one message at a time
+  rx_wrap_buffer_.resize(msg_size);
+  auto n = boost::asio::buffer_copy(boost::asio::buffer(rx_wrap_buffer_), arrays[0] + offset);
+  boost::asio::buffer_copy(boost::asio::buffer(rx_wrap_buffer_) + n, arrays[1]);
+  return boost::asio::buffer(rx_wrap_buffer_);
+}
+
 void MessageTransport::handle_send_error(const Error& err) {
   LOG_ERR("Sending message failed: " << err);
 
@@ -320,12 +887,15 @@ void MessageTransport::handle_send_error(const Error& err) {
 
   std::lock_guard<std::mutex> lock(tx_mutex_);
   last_tx_error_ = err;
+  tx_failed_     = true;
 
   for (auto& ps : pending_sends_) {
     ps.handler(err);
   }
 
   pending_sends_.clear();
+  has_pending_sends_[0] = false;
+  has_pending_sends_[1] = false;
 }
 
 void MessageTransport::handle_receive_error(const Error& err) {
@@ -340,6 +910,20 @@ void MessageTransport::handle_receive_error(const Error& err) {
 
     transport_->get_context()->post([=] { handler(Error(err), 0); });
   }
+
+  if (pending_in_place_receive_handler_) {
+    InPlaceReceiveHandler handler;
+    std::swap(handler, pending_in_place_receive_handler_);
+
+    transport_->get_context()->post([=] { handler(Error(err), {}); });
+  }
+
+  if (pending_batch_receive_handler_) {
+    BatchReceiveHandler handler;
+    std::swap(handler, pending_batch_receive_handler_);
+
+    transport_->get_context()->post([=] { handler(Error(err), {}); });
+  }
 }
 
 void MessageTransport::check_operation_tag_not_used(OperationTag tag) {
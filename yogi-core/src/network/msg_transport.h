@@ -29,7 +29,11 @@
 #include <src/objects/logger/log_user.h>
 
 #include <array>
+#include <atomic>
 #include <boost/asio/buffer.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -46,23 +50,62 @@ class MessageTransport : public std::enable_shared_from_this<MessageTransport>,
   typedef int OperationTag;
   typedef std::function<void(const Result&)> SendHandler;
   typedef std::function<void(const Result&, std::size_t msg_size)> ReceiveHandler;
+  typedef std::function<void(const Result&, boost::asio::const_buffer msg)> InPlaceReceiveHandler;
+  typedef std::vector<boost::asio::const_buffer> MessageViews;
+  typedef std::function<void(const Result&, const MessageViews& msgs)> BatchReceiveHandler;
   typedef ReceiveHandler SizeFieldReceiveHandler;
 
-  MessageTransport(TransportPtr transport, std::size_t tx_queue_size, std::size_t rx_queue_size);
+  // High priority messages have their own send queue and overtake queued
+  // normal priority messages; the queues are only switched between frames.
+  // Messages that are too large to be sent at once always get sent in
+  // fragments with normal priority.
+  enum class TxPriority {
+    kNormal,
+    kHigh,
+  };
+
+  MessageTransport(TransportPtr transport, std::size_t tx_queue_size, std::size_t rx_queue_size,
+                   bool mirrored_queues = false);
 
   ContextPtr get_context() const {
     return context_;
   }
 
+  void set_tx_coalescing(std::chrono::nanoseconds delay, std::size_t threshold);
+
+  // Messages of at least the given size get queued by reference instead of
+  // being copied into the send queue if they are passed as shared buffers;
+  // 0 disables this
+  void set_tx_zero_copy_threshold(std::size_t threshold);
+
+  // Messages of at least the given size get compressed before being queued
+  // unless this does not make them smaller; 0 disables compression. Must only
+  // be enabled if the remote side is able to decompress messages. Messages
+  // larger than max_msg_size get sent uncompressed since the remote side
+  // refuses to decompress them.
+  void set_tx_compression_threshold(std::size_t threshold, std::size_t max_msg_size);
   void start();
 
-  bool try_send(const OutgoingMessage& msg);
-  void send_async(OutgoingMessage* msg, OperationTag tag, SendHandler handler);
-  void send_async(OutgoingMessage* msg, SendHandler handler);
+  // Messages that need to be fragmented are never sent this way since their
+  // fragments get queued; use send_async() for them
+  bool try_send(const OutgoingMessage& msg, TxPriority prio = TxPriority::kNormal);
+  bool try_send(const SharedSmallBuffer& msg_bytes, TxPriority prio = TxPriority::kNormal);
+
+  // For messages that get sent over several connections; they share the
+  // serialized and the compressed message, so msg only gets compressed once
+  bool try_send(OutgoingMessage* msg, TxPriority prio = TxPriority::kNormal);
+  void send_async(OutgoingMessage* msg, OperationTag tag, SendHandler handler, TxPriority prio = TxPriority::kNormal);
+  void send_async(OutgoingMessage* msg, SendHandler handler, TxPriority prio = TxPriority::kNormal);
   bool cancel_send(OperationTag tag);
   void receive_async(boost::asio::mutable_buffer msg, ReceiveHandler handler);
+  void receive_in_place_async(InPlaceReceiveHandler handler);
+  void receive_batch_async(BatchReceiveHandler handler);
   void cancel_receive();
 
+  static bool needs_fragmentation(std::size_t msg_size) {
+    return msg_size > kMaxUnfragmentedMsgSize;
+  }
+
   void close() {
     transport_->close();
   }
@@ -74,21 +117,94 @@ class MessageTransport : public std::enable_shared_from_this<MessageTransport>,
     OperationTag tag;  // 0 => operation cannot be canceled
     SharedSmallBuffer msg_bytes;
     SendHandler handler;
+    TxPriority prio;
+    std::size_t bytes_fragmented;  // Message bytes already queued in fragments
+  };
+
+  // High priority messages are few and mostly small, e.g. heartbeats, so
+  // their queue only gets a fraction of the send queue size
+  static constexpr std::size_t kHighPrioTxQueueSizeDivisor = 8;
+
+  // Larger messages get split into fragments
+  static constexpr std::size_t kMaxUnfragmentedMsgSize = messages::Fragment::kHeaderSize +
+                                                         messages::Fragment::kMaxDataSize;
+
+  // Data that is currently being written to the transport; a batch always
+  // ends at a frame boundary and has to be finished before the next one can
+  // be started, possibly from the other send queue
+  struct TxBatch {
+    TxPriority prio;
+    std::size_t rb_bytes;  // Remaining bytes from the send queue
+    bool has_frame_ref;    // Followed by the front entry of tx_frame_refs_
+  };
+
+  // Upper limit for batches of normal priority messages so that high
+  // priority messages do not have to wait for the entire send queue
+  static constexpr std::size_t kMaxTxBatchSize = 64 * 1024;
+
+  // Message that has been queued by reference; it gets inserted into the data
+  // stream once the send queue has been read up to rb_idx
+  struct TxFrameRef {
+    LockFreeRingBuffer::size_type rb_idx;
+    SharedSmallBuffer msg_bytes;
+    std::size_t bytes_sent;
   };
 
   MessageTransportWeakPtr make_weak_ptr() {
     return shared_from_this();
   }
 
-  bool try_send_impl(const SmallBuffer& msg_bytes);
-  bool can_send(std::size_t msg_size) const;
-  void send_async_impl(OutgoingMessage* msg, OperationTag tag, SendHandler handler);
+  static std::size_t make_high_prio_tx_queue_size(std::size_t tx_queue_size);
+
+  LockFreeRingBuffer& get_tx_queue(TxPriority prio) {
+    return prio == TxPriority::kHigh ? tx_high_prio_rb_ : tx_rb_;
+  }
+
+  std::atomic<bool>& get_has_pending_sends(TxPriority prio) {
+    return has_pending_sends_[prio == TxPriority::kHigh];
+  }
+
+  std::atomic<int>& get_tx_in_flight(TxPriority prio) {
+    return tx_in_flight_[prio == TxPriority::kHigh];
+  }
+
+  bool may_send_immediately(TxPriority prio);
+
+  template <typename Fn>
+  bool enqueue_unless_pending(TxPriority prio, Fn fn);
+
+  void set_has_pending_sends(TxPriority prio);
+  bool try_send_shared_without_lock(const SharedSmallBuffer& msg_bytes, TxPriority prio);
+  bool try_send_impl(const SmallBuffer& msg_bytes, TxPriority prio);
+  bool try_send_fragment(const SmallBuffer& msg_bytes, std::size_t offset);
+  bool try_send_pending(PendingSend* ps);
+  bool try_send_shared_impl(const SharedSmallBuffer& msg_bytes, TxPriority prio);
+  bool try_send_by_reference(const SharedSmallBuffer& msg_bytes);
+  bool should_send_by_reference(std::size_t msg_size, TxPriority prio) const;
+  SharedSmallBuffer try_compress(const SmallBuffer& msg_bytes) const;
+  SharedSmallBuffer try_compress(OutgoingMessage* msg) const;
+  bool should_compress(std::size_t msg_size) const;
+  bool has_tx_data();
+  void send_async_impl(OutgoingMessage* msg, OperationTag tag, SendHandler handler, TxPriority prio);
   void send_some_bytes_to_transport();
+  bool write_tx_queue_to_transport();
+  bool start_tx_batch();
+  std::size_t limit_tx_batch_size(const LockFreeRingBuffer::const_buffers_2& arrays, std::size_t rb_bytes) const;
+  bool commit_sent_frame_bytes(std::size_t n);
+  bool should_hold_back_tx_data() const;
+  void start_tx_coalescing_timer();
+  void on_tx_coalescing_timer_expired(const boost::system::error_code& ec);
   void retry_sending_pending_sends();
   bool try_get_received_size_field(std::size_t* msg_size);
   void reset_received_size_field();
   void receive_some_bytes_from_transport();
   void try_deliver_pending_receive();
+  bool has_pending_receive() const;
+  void deliver_in_place(std::size_t msg_size, InPlaceReceiveHandler handler);
+  void deliver_batch(std::size_t first_msg_size, BatchReceiveHandler handler);
+  void finish_in_place_delivery(std::size_t bytes_delivered);
+  std::size_t collect_received_msgs(std::size_t first_msg_size);
+  boost::asio::const_buffer get_received_msg_view(std::size_t offset, std::size_t msg_size);
   void handle_send_error(const Error& err);
   void handle_receive_error(const Error& err);
   void check_operation_tag_not_used(OperationTag tag);
@@ -96,10 +212,26 @@ class MessageTransport : public std::enable_shared_from_this<MessageTransport>,
   const ContextPtr context_;
   const TransportPtr transport_;
   LockFreeRingBuffer tx_rb_;
+  LockFreeRingBuffer tx_high_prio_rb_;
   LockFreeRingBuffer rx_rb_;
   std::mutex tx_mutex_;
   Result last_tx_error_;
-  bool send_to_transport_running_;
+  std::atomic<bool> tx_failed_;
+  std::atomic<bool> has_pending_sends_[2];  // Indexed by priority
+  std::atomic<int> tx_in_flight_[2];        // Producers enqueueing without tx_mutex_
+  std::atomic<bool> send_to_transport_running_;
+  TxBatch tx_batch_;
+  bool tx_batch_running_;
+  std::chrono::nanoseconds tx_coalescing_delay_;
+  std::size_t tx_coalescing_threshold_;
+  boost::asio::steady_timer tx_coalescing_timer_;
+  std::atomic<bool> tx_coalescing_timer_running_;
+  std::size_t tx_zero_copy_threshold_;
+  std::size_t tx_compression_threshold_;
+  std::size_t tx_compression_max_size_;
+  std::mutex tx_frame_refs_mutex_;
+  std::deque<TxFrameRef> tx_frame_refs_;
+  std::atomic<std::size_t> tx_frame_ref_bytes_;
   std::vector<PendingSend> pending_sends_;
   SizeFieldBuffer size_field_buffer_;
   std::size_t size_field_buffer_size_;
@@ -107,6 +239,11 @@ class MessageTransport : public std::enable_shared_from_this<MessageTransport>,
   bool size_field_valid_;
   boost::asio::mutable_buffer pending_receive_buffer_;
   ReceiveHandler pending_receive_handler_;
+  InPlaceReceiveHandler pending_in_place_receive_handler_;
+  BatchReceiveHandler pending_batch_receive_handler_;
+  MessageViews rx_batch_;
+  bool in_place_delivery_running_;
+  Buffer rx_wrap_buffer_;
   bool receive_from_transport_running_;
   Result last_rx_error_;
 };
@@ -0,0 +1,358 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <src/network/shm_transport.h>
+
+#include <algorithm>
+#include <new>
+
+namespace {
+
+constexpr std::size_t kCacheLineSize  = 64;
+constexpr std::uint32_t kSegmentMagic = 0x59534d31;  // "YSM1"
+
+std::size_t round_up_to_cache_line(std::size_t n) {
+  return (n + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+}
+
+}  // anonymous namespace
+
+// Both structures live in shared memory, so they must only contain lock-free
+// atomics and plain data
+struct ShmTransport::Ring {
+  alignas(kCacheLineSize) std::atomic<std::uint64_t> write_idx;
+  alignas(kCacheLineSize) std::atomic<std::uint64_t> read_idx;
+  alignas(kCacheLineSize) std::uint64_t size;  // One byte more than the capacity
+  std::uint64_t data_offset;
+};
+
+struct ShmTransport::Segment {
+  struct alignas(kCacheLineSize) Endpoint {
+    std::atomic<std::uint32_t> doorbell;
+    std::atomic<std::uint32_t> waiting;
+    std::atomic<std::uint32_t> closed;
+  };
+
+  std::uint32_t magic;
+  Endpoint endpoints[2];
+  Ring rings[2];  // Ring i gets written by endpoint i
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared memory requires lock-free atomics");
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "Shared memory requires lock-free atomics");
+
+ShmTransportPtr ShmTransport::try_create(ContextPtr context, const std::string& name, std::size_t queue_size,
+                                         std::chrono::nanoseconds timeout, bool created_from_incoming_conn_req,
+                                         std::string peer_description, std::size_t transceive_byte_limit) {
+  auto shm = SharedMemory::try_create(name, get_segment_size(queue_size));
+  if (!shm) {
+    return {};
+  }
+
+  auto ring_offset = round_up_to_cache_line(sizeof(Segment));
+  auto ring_size   = round_up_to_cache_line(queue_size + 1);
+
+  auto segment = new (shm->data()) Segment();
+  for (int i = 0; i < 2; ++i) {
+    segment->rings[i].size        = queue_size + 1;
+    segment->rings[i].data_offset = ring_offset + static_cast<std::size_t>(i) * ring_size;
+  }
+
+  segment->magic = kSegmentMagic;
+
+  auto transport = ShmTransportPtr(new ShmTransport(context, std::move(shm), 0, timeout,
+                                                    created_from_incoming_conn_req, peer_description,
+                                                    transceive_byte_limit));
+  transport->start_waiter_thread();
+  return transport;
+}
+
+ShmTransportPtr ShmTransport::try_open(ContextPtr context, const std::string& name, std::chrono::nanoseconds timeout,
+                                       bool created_from_incoming_conn_req, std::string peer_description,
+                                       std::size_t transceive_byte_limit) {
+  auto shm = SharedMemory::try_open(name);
+  if (!shm || shm->size() < sizeof(Segment)) {
+    return {};
+  }
+
+  auto segment = reinterpret_cast<Segment*>(shm->data());
+  if (segment->magic != kSegmentMagic) {
+    return {};
+  }
+
+  for (auto& ring : segment->rings) {
+    if (ring.size < 2 || ring.data_offset + ring.size > shm->size()) {
+      return {};
+    }
+  }
+
+  auto transport = ShmTransportPtr(new ShmTransport(context, std::move(shm), 1, timeout,
+                                                    created_from_incoming_conn_req, peer_description,
+                                                    transceive_byte_limit));
+  transport->start_waiter_thread();
+  return transport;
+}
+
+ShmTransport::~ShmTransport() {
+  shutdown();
+}
+
+void ShmTransport::write_some_async(boost::asio::const_buffer data, TransferSomeHandler handler) {
+  write_some_async(ConstBufferSequence{data}, handler);
+}
+
+void ShmTransport::write_some_async(const ConstBufferSequence& data, TransferSomeHandler handler) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  YOGI_ASSERT(!pending_write_handler_);
+
+  pending_write_data_    = data;
+  pending_write_handler_ = handler;
+  if (closed_) {
+    fail_pending_operations(Error(YOGI_ERR_CANCELED));
+  } else {
+    try_finish_pending_write();
+  }
+}
+
+void ShmTransport::read_some_async(boost::asio::mutable_buffer data, TransferSomeHandler handler) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  YOGI_ASSERT(!pending_read_handler_);
+
+  pending_read_data_    = data;
+  pending_read_handler_ = handler;
+  if (closed_) {
+    fail_pending_operations(Error(YOGI_ERR_CANCELED));
+  } else {
+    try_finish_pending_read();
+  }
+}
+
+void ShmTransport::shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return;
+
+    closed_ = true;
+    segment_->endpoints[side_].closed.store(1);
+    ring_peer_doorbell();
+    fail_pending_operations(Error(YOGI_ERR_CANCELED));
+  }
+
+  stop_waiter_thread();
+}
+
+ShmTransport::ShmTransport(ContextPtr context, SharedMemoryPtr shm, int side, std::chrono::nanoseconds timeout,
+                           bool created_from_incoming_conn_req, std::string peer_description,
+                           std::size_t transceive_byte_limit)
+    : Transport(context, timeout, created_from_incoming_conn_req, peer_description, transceive_byte_limit),
+      shm_(std::move(shm)),
+      side_(side),
+      segment_(reinterpret_cast<Segment*>(shm_->data())),
+      tx_ring_(&segment_->rings[side]),
+      rx_ring_(&segment_->rings[1 - side]),
+      stop_waiter_(false),
+      doorbell_handler_posted_(false),
+      closed_(false) {
+}
+
+std::size_t ShmTransport::get_segment_size(std::size_t queue_size) {
+  return round_up_to_cache_line(sizeof(Segment)) + 2 * round_up_to_cache_line(queue_size + 1);
+}
+
+void ShmTransport::start_waiter_thread() {
+  // Rings after this point must not be missed, so the current doorbell value
+  // has to be read before the thread starts
+  auto doorbell = segment_->endpoints[side_].doorbell.load();
+
+  // The thread must not call shared_from_this() since it may run while the
+  // last shared pointer to this object is being released
+  auto weak_self = make_weak_ptr();
+  waiter_thread_ = std::thread([=] { waiter_thread_fn(weak_self, doorbell); });
+}
+
+void ShmTransport::stop_waiter_thread() {
+  if (!waiter_thread_.joinable()) return;
+
+  auto& endpoint = segment_->endpoints[side_];
+  stop_waiter_   = true;
+  endpoint.doorbell.fetch_add(1);
+  wake_all_on_address(&endpoint.doorbell);
+
+  waiter_thread_.join();
+}
+
+void ShmTransport::waiter_thread_fn(ShmTransportWeakPtr weak_self, std::uint32_t seen) {
+  auto& endpoint = segment_->endpoints[side_];
+
+  while (!stop_waiter_) {
+    // The peer checks the waiting flag after ringing the doorbell, so either
+    // it sees the flag or we see the new doorbell value
+    endpoint.waiting.store(1);
+    if (endpoint.doorbell.load() == seen) {
+      wait_on_address(&endpoint.doorbell, seen);
+    }
+    endpoint.waiting.store(0);
+
+    auto current = endpoint.doorbell.load();
+    if (current == seen || stop_waiter_) continue;
+    seen = current;
+
+    if (!doorbell_handler_posted_.exchange(true)) {
+      get_context()->post([weak_self] {
+        auto self = weak_self.lock();
+        if (!self) return;
+
+        self->on_doorbell_rung();
+      });
+    }
+  }
+}
+
+void ShmTransport::on_doorbell_rung() {
+  doorbell_handler_posted_ = false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) return;
+
+  if (pending_write_handler_) try_finish_pending_write();
+  if (pending_read_handler_) try_finish_pending_read();
+}
+
+void ShmTransport::ring_peer_doorbell() {
+  auto& endpoint = segment_->endpoints[1 - side_];
+  endpoint.doorbell.fetch_add(1);
+  if (endpoint.waiting.load()) {
+    wake_all_on_address(&endpoint.doorbell);
+  }
+}
+
+bool ShmTransport::peer_closed() const {
+  return segment_->endpoints[1 - side_].closed.load() != 0;
+}
+
+std::size_t ShmTransport::write_to_ring(const ConstBufferSequence& data) {
+  auto& ring     = *tx_ring_;
+  auto size      = ring.size;
+  auto ring_data = shm_->data() + ring.data_offset;
+
+  auto wi    = ring.write_idx.load(std::memory_order_relaxed);
+  auto ri    = ring.read_idx.load();
+  auto avail = (ri + size - wi - 1) % size;
+
+  std::size_t n = 0;
+  for (auto& buf : data) {
+    auto src   = static_cast<const Byte*>(buf.data());
+    auto count = std::min<std::size_t>(buf.size(), avail - n);
+    for (std::size_t copied = 0; copied < count;) {
+      auto idx   = (wi + n + copied) % size;
+      auto chunk = std::min<std::size_t>(count - copied, size - idx);
+      std::copy(src + copied, src + copied + chunk, ring_data + idx);
+      copied += chunk;
+    }
+
+    n += count;
+  }
+
+  if (n == 0) {
+    return 0;
+  }
+
+  ring.write_idx.store((wi + n) % size);
+
+  // The reader only waits if it found the ring empty
+  if (ring.read_idx.load() == wi) {
+    ring_peer_doorbell();
+  }
+
+  return n;
+}
+
+std::size_t ShmTransport::read_from_ring(boost::asio::mutable_buffer data) {
+  auto& ring     = *rx_ring_;
+  auto size      = ring.size;
+  auto ring_data = shm_->data() + ring.data_offset;
+
+  auto ri    = ring.read_idx.load(std::memory_order_relaxed);
+  auto wi    = ring.write_idx.load();
+  auto avail = (wi + size - ri) % size;
+
+  auto n   = std::min<std::size_t>(data.size(), avail);
+  auto dst = static_cast<Byte*>(data.data());
+  for (std::size_t copied = 0; copied < n;) {
+    auto idx   = (ri + copied) % size;
+    auto chunk = std::min<std::size_t>(n - copied, size - idx);
+    std::copy(ring_data + idx, ring_data + idx + chunk, dst + copied);
+    copied += chunk;
+  }
+
+  if (n == 0) {
+    return 0;
+  }
+
+  ring.read_idx.store((ri + n) % size);
+
+  // The writer only waits if it found the ring full
+  if ((ring.write_idx.load() + 1) % size == ri) {
+    ring_peer_doorbell();
+  }
+
+  return n;
+}
+
+bool ShmTransport::try_finish_pending_write() {
+  Result res    = Success();
+  std::size_t n = 0;
+  if (peer_closed()) {
+    res = Error(YOGI_ERR_RW_SOCKET_FAILED);
+  } else {
+    n = write_to_ring(pending_write_data_);
+    if (n == 0) return false;
+  }
+
+  auto handler           = pending_write_handler_;
+  pending_write_handler_ = {};
+  get_context()->post([=] { handler(res, n); });
+  return true;
+}
+
+bool ShmTransport::try_finish_pending_read() {
+  Result res = Success();
+  auto n     = read_from_ring(pending_read_data_);
+  if (n == 0) {
+    if (!peer_closed()) return false;
+    res = Error(YOGI_ERR_RW_SOCKET_FAILED);
+  }
+
+  auto handler          = pending_read_handler_;
+  pending_read_handler_ = {};
+  get_context()->post([=] { handler(res, n); });
+  return true;
+}
+
+void ShmTransport::fail_pending_operations(const Result& res) {
+  for (auto handler : {&pending_write_handler_, &pending_read_handler_}) {
+    if (*handler) {
+      auto fn  = *handler;
+      *handler = {};
+      get_context()->post([=] { fn(res, 0); });
+    }
+  }
+}
@@ -0,0 +1,109 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <src/network/transport.h>
+#include <src/system/shared_memory.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class ShmTransport;
+typedef std::shared_ptr<ShmTransport> ShmTransportPtr;
+typedef std::weak_ptr<ShmTransport> ShmTransportWeakPtr;
+
+// Transport between two endpoints on the same host that exchange data through
+// a shared memory segment containing one single-producer/single-consumer ring
+// buffer per direction. An endpoint only gets woken up by its peer if it
+// potentially waits for data or for free space, i.e. if the corresponding
+// ring buffer was empty or full.
+class ShmTransport : public Transport {
+ public:
+  // Creates the shared memory segment; returns an empty pointer if this is not
+  // supported on this platform or if a segment with the given name exists
+  static ShmTransportPtr try_create(ContextPtr context, const std::string& name, std::size_t queue_size,
+                                    std::chrono::nanoseconds timeout, bool created_from_incoming_conn_req,
+                                    std::string peer_description, std::size_t transceive_byte_limit);
+
+  // Attaches to a segment created by the peer via try_create()
+  static ShmTransportPtr try_open(ContextPtr context, const std::string& name, std::chrono::nanoseconds timeout,
+                                  bool created_from_incoming_conn_req, std::string peer_description,
+                                  std::size_t transceive_byte_limit);
+
+  virtual ~ShmTransport();
+
+  // Removes the name of the segment once the peer has attached to it
+  void remove_segment_name() {
+    shm_->remove_name();
+  }
+
+ protected:
+  virtual void write_some_async(boost::asio::const_buffer data, TransferSomeHandler handler) override;
+  virtual void write_some_async(const ConstBufferSequence& data, TransferSomeHandler handler) override;
+  virtual void read_some_async(boost::asio::mutable_buffer data, TransferSomeHandler handler) override;
+  virtual void shutdown() override;
+
+ private:
+  struct Segment;
+  struct Ring;
+
+  ShmTransport(ContextPtr context, SharedMemoryPtr shm, int side, std::chrono::nanoseconds timeout,
+               bool created_from_incoming_conn_req, std::string peer_description, std::size_t transceive_byte_limit);
+
+  ShmTransportWeakPtr make_weak_ptr() {
+    return std::static_pointer_cast<ShmTransport>(shared_from_this());
+  }
+
+  static std::size_t get_segment_size(std::size_t queue_size);
+
+  void start_waiter_thread();
+  void stop_waiter_thread();
+  void waiter_thread_fn(ShmTransportWeakPtr weak_self, std::uint32_t seen);
+  void on_doorbell_rung();
+  void ring_peer_doorbell();
+  bool peer_closed() const;
+  std::size_t write_to_ring(const ConstBufferSequence& data);
+  std::size_t read_from_ring(boost::asio::mutable_buffer data);
+  bool try_finish_pending_write();
+  bool try_finish_pending_read();
+  void fail_pending_operations(const Result& res);
+
+  const SharedMemoryPtr shm_;
+  const int side_;
+  Segment* const segment_;
+  Ring* const tx_ring_;
+  Ring* const rx_ring_;
+  std::thread waiter_thread_;
+  std::atomic<bool> stop_waiter_;
+  std::atomic<bool> doorbell_handler_posted_;
+  std::mutex mutex_;
+  bool closed_;
+  ConstBufferSequence pending_write_data_;
+  TransferSomeHandler pending_write_handler_;
+  boost::asio::mutable_buffer pending_read_data_;
+  TransferSomeHandler pending_read_handler_;
+};
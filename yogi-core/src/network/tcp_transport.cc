@@ -19,6 +19,7 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 
+#include <src/network/io_uring_transport.h>
 #include <src/network/tcp_transport.h>
 #include <src/system/network_info.h>
 
@@ -71,7 +72,8 @@ TcpTransport::AcceptGuardPtr TcpTransport::accept_async(ContextPtr context, boos
 
 TcpTransport::ConnectGuardPtr TcpTransport::connect_async(ContextPtr context, const boost::asio::ip::tcp::endpoint& ep,
                                                           std::chrono::nanoseconds timeout,
-                                                          std::size_t transceive_byte_limit, ConnectHandler handler) {
+                                                          std::size_t transceive_byte_limit, ConnectHandler handler,
+                                                          IoUringPtr io_uring) {
   struct ConnectData {
     ConnectData(boost::asio::io_context& ioc) : socket(boost::asio::make_strand(ioc)), timer(ioc) {
     }
@@ -101,8 +103,15 @@ TcpTransport::ConnectGuardPtr TcpTransport::connect_async(ContextPtr context, co
     if (condat->timed_out) {
       handler(Error(YOGI_ERR_TIMEOUT), {}, guard);
     } else if (!ec) {
-      auto transport =
-          TcpTransportPtr(new TcpTransport(context, std::move(condat->socket), timeout, transceive_byte_limit, false));
+      TcpTransportPtr transport;
+      if (io_uring) {
+        transport = std::make_shared<IoUringTransport>(context, io_uring, std::move(condat->socket), timeout,
+                                                       transceive_byte_limit, false);
+      } else {
+        transport = TcpTransportPtr(
+            new TcpTransport(context, std::move(condat->socket), timeout, transceive_byte_limit, false));
+      }
+
       handler(Success(), transport, guard);
     } else if (ec == boost::asio::error::operation_aborted) {
       handler(Error(YOGI_ERR_CANCELED), {}, guard);
@@ -125,6 +134,10 @@ TcpTransport::ConnectGuardPtr TcpTransport::connect_async(ContextPtr context, co
 }
 
 void TcpTransport::write_some_async(boost::asio::const_buffer data, TransferSomeHandler handler) {
+  write_some_async(ConstBufferSequence{data}, handler);
+}
+
+void TcpTransport::write_some_async(const ConstBufferSequence& data, TransferSomeHandler handler) {
   socket_.async_write_some(data, [=](auto& ec, auto bytes_written) {
     if (!ec) {
       handler(Success(), bytes_written);
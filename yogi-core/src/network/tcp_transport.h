@@ -26,6 +26,7 @@
 #include <src/network/transport.h>
 #include <src/objects/context.h>
 #include <src/objects/logger/log_user.h>
+#include <src/system/io_uring.h>
 
 #include <boost/asio.hpp>
 
@@ -67,9 +68,10 @@ class TcpTransport : public Transport {
                                      std::chrono::nanoseconds timeout, std::size_t transceive_byte_limit,
                                      AcceptHandler handler);
 
+  // Creates an IoUringTransport instead of a TcpTransport if io_uring is set
   static ConnectGuardPtr connect_async(ContextPtr context, const boost::asio::ip::tcp::endpoint& ep,
                                        std::chrono::nanoseconds timeout, std::size_t transceive_byte_limit,
-                                       ConnectHandler handler);
+                                       ConnectHandler handler, IoUringPtr io_uring = {});
 
   TcpTransport(ContextPtr context, boost::asio::ip::tcp::socket&& socket, std::chrono::nanoseconds timeout,
                std::size_t transceive_byte_limit, bool created_via_accept);
@@ -79,7 +81,12 @@ class TcpTransport : public Transport {
   }
 
  protected:
+  boost::asio::ip::tcp::socket& socket() {
+    return socket_;
+  }
+
   virtual void write_some_async(boost::asio::const_buffer data, TransferSomeHandler handler) override;
+  virtual void write_some_async(const ConstBufferSequence& data, TransferSomeHandler handler) override;
   virtual void read_some_async(boost::asio::mutable_buffer data, TransferSomeHandler handler) override;
   virtual void shutdown() override;
 
@@ -31,22 +31,23 @@ Transport::Transport(ContextPtr context, std::chrono::nanoseconds timeout, bool
       created_from_incoming_conn_req_(created_from_incoming_conn_req),
       peer_description_(peer_description),
       transceive_byte_limit_(transceive_byte_limit),
-      tx_timer_(context->io_context()),
-      rx_timer_(context->io_context()),
       timed_out_(false) {
 }
 
 Transport::~Transport() {
+  stop_timeout(tx_timeout_);
+  stop_timeout(rx_timeout_);
 }
 
 void Transport::send_some_async(boost::asio::const_buffer data, TransferSomeHandler handler) {
-  YOGI_ASSERT(data.size() > 0);
+  send_some_async(ConstBufferSequence{data}, handler);
+}
 
-  if (data.size() > transceive_byte_limit_) {
-    data = boost::asio::buffer(data.data(), transceive_byte_limit_);
-  }
+void Transport::send_some_async(ConstBufferSequence data, TransferSomeHandler handler) {
+  limit_to_transceive_byte_limit(&data);
+  YOGI_ASSERT(!data.empty());
 
-  start_timeout(&tx_timer_);
+  start_timeout(&tx_timeout_);
 
   auto weak_self = make_weak_ptr();
   write_some_async(data, [=](auto& res, auto bytes_written) {
@@ -56,7 +57,7 @@ void Transport::send_some_async(boost::asio::const_buffer data, TransferSomeHand
       return;
     }
 
-    self->tx_timer_.cancel();
+    self->stop_timeout(self->tx_timeout_);
 
     if (self->timed_out_) {
       handler(Error(YOGI_ERR_TIMEOUT), bytes_written);
@@ -89,7 +90,7 @@ void Transport::receive_some_async(boost::asio::mutable_buffer data, TransferSom
     data = boost::asio::buffer(data.data(), transceive_byte_limit_);
   }
 
-  start_timeout(&rx_timer_);
+  start_timeout(&rx_timeout_);
 
   auto weak_self = make_weak_ptr();
   read_some_async(data, [=](auto& res, auto bytes_read) {
@@ -99,7 +100,7 @@ void Transport::receive_some_async(boost::asio::mutable_buffer data, TransferSom
       return;
     }
 
-    self->rx_timer_.cancel();
+    self->stop_timeout(self->rx_timeout_);
 
     if (self->timed_out_) {
       handler(Error(YOGI_ERR_TIMEOUT), bytes_read);
@@ -152,14 +153,43 @@ void Transport::receive_all_async_impl(boost::asio::mutable_buffer data, const R
   }
 }
 
-void Transport::start_timeout(boost::asio::steady_timer* timer) {
-  timer->expires_from_now(timeout_);
-  timer->async_wait(bind_weak(&Transport::on_timeout, this));
+void Transport::write_some_async(const ConstBufferSequence& data, TransferSomeHandler handler) {
+  write_some_async(data.front(), handler);
 }
 
-void Transport::on_timeout(boost::system::error_code ec) {
-  if (ec) return;
+void Transport::limit_to_transceive_byte_limit(ConstBufferSequence* data) const {
+  auto remaining = transceive_byte_limit_;
+
+  auto it = data->begin();
+  for (; it != data->end() && remaining > 0 && it->size() > 0; ++it) {
+    if (it->size() > remaining) {
+      *it = boost::asio::buffer(it->data(), remaining);
+    }
+
+    remaining -= it->size();
+  }
+
+  data->erase(it, data->end());
+}
+
+void Transport::start_timeout(TimingWheelEntryPtr* entry) {
+  if (timeout_ == timeout_.max()) return;
+
+  auto& wheel = context_->timing_wheel();
+  if (!*entry) {
+    *entry = wheel.make_entry(bind_weak(&Transport::on_timeout, this));
+  }
+
+  wheel.arm(*entry, timeout_);
+}
+
+void Transport::stop_timeout(const TimingWheelEntryPtr& entry) {
+  if (entry) {
+    context_->timing_wheel().disarm(entry);
+  }
+}
 
+void Transport::on_timeout() {
   timed_out_ = true;
 
   close();
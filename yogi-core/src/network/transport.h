@@ -26,8 +26,10 @@
 #include <src/data/buffer.h>
 #include <src/objects/context.h>
 #include <src/objects/logger/log_user.h>
+#include <src/util/timing_wheel.h>
 
 #include <boost/asio.hpp>
+#include <boost/container/small_vector.hpp>
 
 #include <chrono>
 #include <functional>
@@ -43,6 +45,7 @@ class Transport : public std::enable_shared_from_this<Transport>, public LogUser
  public:
   typedef std::function<void(const Result&, const std::size_t bytes_transferred)> TransferSomeHandler;
   typedef std::function<void(const Result&)> TransferAllHandler;
+  typedef boost::container::small_vector<boost::asio::const_buffer, 2> ConstBufferSequence;
 
   Transport(ContextPtr context, std::chrono::nanoseconds timeout, bool created_from_incoming_conn_req,
             std::string peer_description, std::size_t transceive_byte_limit);
@@ -61,6 +64,7 @@ class Transport : public std::enable_shared_from_this<Transport>, public LogUser
   };
 
   void send_some_async(boost::asio::const_buffer data, TransferSomeHandler handler);
+  void send_some_async(ConstBufferSequence data, TransferSomeHandler handler);
   void send_all_async(boost::asio::const_buffer data, TransferAllHandler handler);
   void send_all_async(SharedBuffer data, TransferAllHandler handler);
   void send_all_async(SharedSmallBuffer data, TransferAllHandler handler);
@@ -74,6 +78,10 @@ class Transport : public std::enable_shared_from_this<Transport>, public LogUser
   virtual void read_some_async(boost::asio::mutable_buffer data, TransferSomeHandler handler) = 0;
   virtual void shutdown()                                                                     = 0;
 
+  // Transports that support gather writes should override this; by default
+  // only the first buffer gets written
+  virtual void write_some_async(const ConstBufferSequence& data, TransferSomeHandler handler);
+
  private:
   TransportWeakPtr make_weak_ptr() {
     return shared_from_this();
@@ -82,16 +90,18 @@ class Transport : public std::enable_shared_from_this<Transport>, public LogUser
                            TransferAllHandler handler);
   void receive_all_async_impl(boost::asio::mutable_buffer data, const Result& res, std::size_t bytes_read,
                               TransferAllHandler handler);
-  void start_timeout(boost::asio::steady_timer* timer);
-  void on_timeout(boost::system::error_code ec);
+  void limit_to_transceive_byte_limit(ConstBufferSequence* data) const;
+  void start_timeout(TimingWheelEntryPtr* entry);
+  void stop_timeout(const TimingWheelEntryPtr& entry);
+  void on_timeout();
 
   const ContextPtr context_;
   const std::chrono::nanoseconds timeout_;
   const bool created_from_incoming_conn_req_;
   const std::string peer_description_;
   const std::size_t transceive_byte_limit_;
-  boost::asio::steady_timer tx_timer_;
-  boost::asio::steady_timer rx_timer_;
+  TimingWheelEntryPtr tx_timeout_;
+  TimingWheelEntryPtr rx_timeout_;
   bool timed_out_;
   YOGI_DEBUG_ONLY(bool close_called_ = false;)
 };
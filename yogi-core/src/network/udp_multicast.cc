@@ -0,0 +1,68 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <src/api/errors.h>
+#include <src/network/udp_multicast.h>
+
+#include <boost/asio/ip/multicast.hpp>
+
+boost::system::error_code open_multicast_tx_socket(boost::asio::ip::udp::socket* socket,
+                                                   const boost::asio::ip::udp::endpoint& group_ep,
+                                                   const boost::asio::ip::address& ifc_addr) {
+  using namespace boost::asio::ip;
+
+  boost::system::error_code ec;
+  socket->open(group_ep.protocol(), ec);
+  if (ec) throw Error(YOGI_ERR_OPEN_SOCKET_FAILED);
+
+  auto opt = ifc_addr.is_v6() ? multicast::outbound_interface(static_cast<unsigned int>(ifc_addr.to_v6().scope_id()))
+                              : multicast::outbound_interface(ifc_addr.to_v4());
+  socket->set_option(opt, ec);
+
+  return ec;
+}
+
+void open_multicast_rx_socket(boost::asio::ip::udp::socket* socket, const boost::asio::ip::udp::endpoint& group_ep) {
+  using namespace boost::asio::ip;
+
+  boost::system::error_code ec;
+  socket->open(group_ep.protocol(), ec);
+  if (ec) throw Error(YOGI_ERR_OPEN_SOCKET_FAILED);
+
+  socket->set_option(udp::socket::reuse_address(true), ec);
+  if (ec) throw Error(YOGI_ERR_SET_SOCKET_OPTION_FAILED);
+
+  socket->bind(udp::endpoint(group_ep.protocol(), group_ep.port()), ec);
+  if (ec) throw Error(YOGI_ERR_BIND_SOCKET_FAILED);
+}
+
+boost::system::error_code join_multicast_group(boost::asio::ip::udp::socket* socket,
+                                               const boost::asio::ip::udp::endpoint& group_ep,
+                                               const boost::asio::ip::address& ifc_addr) {
+  using namespace boost::asio::ip;
+
+  boost::system::error_code ec;
+  auto opt = ifc_addr.is_v6() ? multicast::join_group(group_ep.address().to_v6(), ifc_addr.to_v6().scope_id())
+                              : multicast::join_group(group_ep.address().to_v4(), ifc_addr.to_v4());
+  socket->set_option(opt, ec);
+
+  return ec;
+}
@@ -0,0 +1,41 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <boost/asio/ip/udp.hpp>
+
+// Opens a socket for sending datagrams to the given multicast group over the
+// network interface with the given address; throws if the socket cannot be
+// opened and returns an error if the interface cannot be used
+boost::system::error_code open_multicast_tx_socket(boost::asio::ip::udp::socket* socket,
+                                                   const boost::asio::ip::udp::endpoint& group_ep,
+                                                   const boost::asio::ip::address& ifc_addr);
+
+// Opens a socket bound to the port of the given multicast group; other sockets
+// can bind to the same port
+void open_multicast_rx_socket(boost::asio::ip::udp::socket* socket, const boost::asio::ip::udp::endpoint& group_ep);
+
+boost::system::error_code join_multicast_group(boost::asio::ip::udp::socket* socket,
+                                               const boost::asio::ip::udp::endpoint& group_ep,
+                                               const boost::asio::ip::address& ifc_addr);
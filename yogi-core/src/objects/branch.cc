@@ -57,7 +57,9 @@ const boost::uuids::uuid& Branch::get_uuid() const {
 }
 
 std::string Branch::make_info_string() const {
-  return info_->to_json().dump();
+  auto json                    = info_->to_json();
+  json["broadcast_queue_peak"] = bc_man_->get_receive_queue_peak();
+  return json.dump();
 }
 
 Branch::BranchInfoStringsList Branch::make_connected_branches_info_strings() const {
@@ -72,9 +74,14 @@ bool Branch::cancel_await_event() {
   return con_man_->cancel_await_event();
 }
 
-Branch::SendBroadcastOperationId Branch::send_broadcast_async(const Payload& payload, bool retry,
+Branch::SendBroadcastOperationId Branch::send_broadcast_async(const Payload& payload, bool retry, TxPriority prio,
                                                               SendBroadcastHandler handler) {
-  return bc_man_->send_broadcast_async(payload, retry, handler);
+  return bc_man_->send_broadcast_async(payload, retry, prio, handler);
+}
+
+Branch::SendBroadcastOperationId Branch::send_to_async(const boost::uuids::uuid& uuid, const Payload& payload,
+                                                       bool retry, TxPriority prio, SendBroadcastHandler handler) {
+  return bc_man_->send_to_async(uuid, payload, retry, prio, handler);
 }
 
 Result Branch::send_broadcast(const Payload& payload, bool block) {
@@ -109,6 +116,22 @@ void Branch::on_message_received(const IncomingMessage& msg, const BranchConnect
       bc_man_->on_broadcast_received(static_cast<const messages::BroadcastIncoming&>(msg), conn);
       break;
 
+    case MessageType::kFragment:
+      bc_man_->on_fragment_received(static_cast<const messages::FragmentIncoming&>(msg), conn);
+      break;
+
+    case MessageType::kMulticastSync:
+      bc_man_->on_multicast_sync_received(static_cast<const messages::MulticastSyncIncoming&>(msg), conn);
+      break;
+
+    case MessageType::kMulticastNack:
+      bc_man_->on_multicast_nack_received(static_cast<const messages::MulticastNackIncoming&>(msg), conn);
+      break;
+
+    case MessageType::kMulticastRepair:
+      bc_man_->on_multicast_repair_received(static_cast<const messages::MulticastRepairIncoming&>(msg), conn);
+      break;
+
     default:
       LOG_ERR("Message of unexpected type received: " << msg);
       YOGI_NEVER_REACHED;
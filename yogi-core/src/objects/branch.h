@@ -38,6 +38,7 @@ class Branch : public ExposedObjectT<Branch, ObjectType::kBranch>, public LogUse
   using ReceiveBroadcastHandler  = BroadcastManager::ReceiveBroadcastHandler;
   using BranchInfoStringsList    = ConnectionManager::BranchInfoStringsList;
   using SendBroadcastOperationId = BroadcastManager::SendBroadcastOperationId;
+  using TxPriority               = BroadcastManager::TxPriority;
 
   Branch(ContextPtr context, const nlohmann::json& cfg);
 
@@ -49,7 +50,10 @@ class Branch : public ExposedObjectT<Branch, ObjectType::kBranch>, public LogUse
   BranchInfoStringsList make_connected_branches_info_strings() const;
   void await_event_async(int branch_events, BranchEventHandler handler);
   bool cancel_await_event();
-  SendBroadcastOperationId send_broadcast_async(const Payload& payload, bool retry, SendBroadcastHandler handler);
+  SendBroadcastOperationId send_broadcast_async(const Payload& payload, bool retry, TxPriority prio,
+                                                SendBroadcastHandler handler);
+  SendBroadcastOperationId send_to_async(const boost::uuids::uuid& uuid, const Payload& payload, bool retry,
+                                         TxPriority prio, SendBroadcastHandler handler);
   Result send_broadcast(const Payload& payload, bool block);
   bool cancel_send_broadcast(SendBroadcastOperationId oid);
   void receive_broadcast(int encoding, boost::asio::mutable_buffer data, ReceiveBroadcastHandler handler);
@@ -20,9 +20,9 @@
  */
 
 #include <src/api/errors.h>
+#include <src/network/udp_multicast.h>
 #include <src/objects/branch/advertising_receiver.h>
 
-#include <boost/asio/ip/multicast.hpp>
 using namespace std::string_literals;
 
 YOGI_DEFINE_INTERNAL_LOGGER("Branch.AdvertisingReceiver")
@@ -47,30 +47,14 @@ void AdvertisingReceiver::start(LocalBranchInfoPtr info, ObserverFn observer_fn)
 }
 
 void AdvertisingReceiver::setup_socket() {
-  using namespace boost::asio::ip;
-
-  boost::system::error_code ec;
-  socket_.open(adv_ep_.protocol(), ec);
-  if (ec) throw Error(YOGI_ERR_OPEN_SOCKET_FAILED);
-
-  socket_.set_option(udp::socket::reuse_address(true), ec);
-  if (ec) throw Error(YOGI_ERR_SET_SOCKET_OPTION_FAILED);
-
-  socket_.bind(udp::endpoint(adv_ep_.protocol(), adv_ep_.port()), ec);
-  if (ec) throw Error(YOGI_ERR_BIND_SOCKET_FAILED);
+  open_multicast_rx_socket(&socket_, adv_ep_);
 }
 
 bool AdvertisingReceiver::join_multicast_groups() {
-  using namespace boost::asio::ip;
-
   bool joined_at_least_once = false;
   for (auto& ifc : info_->get_advertising_interfaces()) {
     for (auto& addr : ifc.addresses) {
-      boost::system::error_code ec;
-      auto opt = addr.is_v6() ? multicast::join_group(adv_ep_.address().to_v6(), addr.to_v6().scope_id())
-                              : multicast::join_group(adv_ep_.address().to_v4(), addr.to_v4());
-      socket_.set_option(opt, ec);
-
+      auto ec = join_multicast_group(&socket_, adv_ep_, addr);
       if (ec) {
         LOG_ERR("Could not join advertising multicast group " << adv_ep_ << " for interface " << addr << ": "
                                                               << ec.message() << ". This interface will be ignored.");
@@ -19,22 +19,22 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 
+#include <src/network/udp_multicast.h>
 #include <src/objects/branch/advertising_sender.h>
 #include <src/util/algorithm.h>
 #include <src/util/bind.h>
 
-#include <boost/asio/ip/multicast.hpp>
-
 YOGI_DEFINE_INTERNAL_LOGGER("Branch.AdvertisingSender")
 
 AdvertisingSender::AdvertisingSender(ContextPtr context, const boost::asio::ip::udp::endpoint& adv_ep)
-    : context_(context), adv_ep_(adv_ep), timer_(context->io_context()), active_send_ops_(0) {
+    : context_(context), adv_ep_(adv_ep), timer_(context->io_context()), interval_(0), active_send_ops_(0) {
 }
 
 void AdvertisingSender::start(LocalBranchInfoPtr info) {
   YOGI_ASSERT(!info_);
 
-  info_ = info;
+  info_     = info;
+  interval_ = info->get_advertising_interval();
   set_logging_prefix(info->logging_prefix());
 
   setup_sockets();
@@ -45,6 +45,24 @@ void AdvertisingSender::start(LocalBranchInfoPtr info) {
   send_advertisements();
 }
 
+void AdvertisingSender::reset_interval() {
+  if (!info_) return;
+
+  auto base_interval = info_->get_advertising_interval();
+  if (interval_ == base_interval) return;
+
+  // Re-arm the timer if it is currently waiting for the longer interval
+  auto expiry = timer_.expiry() - interval_ + base_interval;
+  interval_   = base_interval;
+  if (active_send_ops_ == 0 && timer_.cancel() > 0) {
+    timer_.expires_at(expiry);
+    timer_.async_wait(bind_weak(&AdvertisingSender::on_timer_expired, this));
+  }
+
+  LOG_DBG("Advertising interval reset to " << std::chrono::duration_cast<std::chrono::milliseconds>(interval_).count()
+                                           << " ms");
+}
+
 void AdvertisingSender::setup_sockets() {
   for (auto& ifc : info_->get_advertising_interfaces()) {
     for (auto& addr : ifc.addresses) {
@@ -59,18 +77,7 @@ void AdvertisingSender::setup_sockets() {
 }
 
 bool AdvertisingSender::configure_socket(std::shared_ptr<SocketEntry> entry) {
-  boost::system::error_code ec;
-  entry->socket.open(adv_ep_.protocol(), ec);
-  if (ec) {
-    throw Error(YOGI_ERR_OPEN_SOCKET_FAILED);
-  }
-
-  auto opt =
-      entry->address.is_v6()
-          ? boost::asio::ip::multicast::outbound_interface(static_cast<unsigned int>(entry->address.to_v6().scope_id()))
-          : boost::asio::ip::multicast::outbound_interface(entry->address.to_v4());
-  entry->socket.set_option(opt, ec);
-
+  auto ec = open_multicast_tx_socket(&entry->socket, adv_ep_, entry->address);
   if (ec) {
     LOG_ERR("Could not set outbound interface for socket using address " << entry->address << ": " << ec.message()
                                                                          << ". This interface will be ignored.");
@@ -118,13 +125,23 @@ void AdvertisingSender::on_advertisement_sent(const boost::system::error_code& e
 }
 
 void AdvertisingSender::start_timer() {
-  timer_.expires_after(info_->get_advertising_interval());
+  timer_.expires_after(interval_);
   timer_.async_wait(bind_weak(&AdvertisingSender::on_timer_expired, this));
 }
 
+void AdvertisingSender::back_off_interval() {
+  auto max_interval = info_->get_max_advertising_interval();
+  if (interval_ >= max_interval) return;
+
+  interval_ = interval_ > max_interval / 2 ? max_interval : interval_ * 2;
+}
+
 void AdvertisingSender::on_timer_expired(const boost::system::error_code& ec) {
   if (!ec) {
+    back_off_interval();
     send_advertisements();
+  } else if (ec == boost::asio::error::operation_aborted) {
+    // Timer got re-armed by reset_interval()
   } else {
     LOG_ERR("Awaiting advertising timer expiry failed: " << ec.message()
                                                          << ". No more advertising messages will be sent.");
@@ -40,6 +40,10 @@ class AdvertisingSender : public std::enable_shared_from_this<AdvertisingSender>
     return adv_ep_;
   }
 
+  // Has to be called whenever a branch connects or disconnects so that the
+  // other branches get to know about the change quickly
+  void reset_interval();
+
  private:
   struct SocketEntry {
     std::string interface_name;
@@ -55,12 +59,14 @@ class AdvertisingSender : public std::enable_shared_from_this<AdvertisingSender>
   void send_advertisements();
   void on_advertisement_sent(const boost::system::error_code& ec, const std::shared_ptr<SocketEntry>& socket);
   void start_timer();
+  void back_off_interval();
   void on_timer_expired(const boost::system::error_code& ec);
 
   const ContextPtr context_;
   boost::asio::ip::udp::endpoint adv_ep_;
   LocalBranchInfoPtr info_;
   boost::asio::steady_timer timer_;
+  std::chrono::nanoseconds interval_;  // Current interval including backoff
   std::vector<std::shared_ptr<SocketEntry>> sockets_;
   int active_send_ops_;
 };
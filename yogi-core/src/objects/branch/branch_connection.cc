@@ -22,9 +22,13 @@
 #include <src/api/constants.h>
 #include <src/data/crypto.h>
 #include <src/network/serialize.h>
+#include <src/network/tcp_transport.h>
 #include <src/objects/branch/branch_connection.h>
 #include <src/util/bind.h>
 
+#include <algorithm>
+#include <boost/uuid/uuid_io.hpp>
+
 BranchConnection::BranchConnection(TransportPtr transport, const boost::asio::ip::address& peer_address,
                                    LocalBranchInfoPtr local_info)
     : transport_(transport),
@@ -32,9 +36,17 @@ BranchConnection::BranchConnection(TransportPtr transport, const boost::asio::ip
       local_info_(local_info),
       peer_address_(peer_address),
       connected_since_(Timestamp::now()),
+      pipelined_handshake_(false),
+      resuming_(false),
+      resumption_uuid_(),
       session_running_(false),
-      heartbeat_timer_(context_->io_context()),
-      next_result_(Success()) {
+      uses_multicast_(false),
+      multicast_synced_(false),
+      next_result_(Success()),
+      rx_paused_(false),
+      rx_pause_expired_(false),
+      rx_stalled_(false),
+      abort_result_(Success()) {
 }
 
 std::string BranchConnection::make_info_string() const {
@@ -46,8 +58,10 @@ std::string BranchConnection::make_info_string() const {
 void BranchConnection::exchange_branch_info(CompletionHandler handler) {
   YOGI_ASSERT(!remote_info_);
 
+  my_challenge_ = make_shared_buffer(generate_random_bytes(BranchInfo::kChallengeSize));
+
   auto weak_self = make_weak_ptr();
-  transport_->send_all_async(local_info_->make_info_message(), [=](auto& res) {
+  transport_->send_all_async(local_info_->make_pipelined_info_message(*my_challenge_), [=](auto& res) {
     auto self = weak_self.lock();
     if (!self) return;
 
@@ -64,7 +78,12 @@ void BranchConnection::authenticate(SharedBuffer password_hash, CompletionHandle
 
   if (!check_next_result(handler)) return;
 
-  auto my_challenge = make_shared_buffer(generate_random_bytes(8));
+  if (pipelined_handshake_) {
+    authenticate_pipelined(password_hash, handler);
+    return;
+  }
+
+  auto my_challenge = my_challenge_;
 
   auto weak_self = make_weak_ptr();
   transport_->send_all_async(my_challenge, [=](auto& res) {
@@ -79,6 +98,28 @@ void BranchConnection::authenticate(SharedBuffer password_hash, CompletionHandle
   });
 }
 
+void BranchConnection::negotiate_transport(CompletionHandler handler) {
+  YOGI_ASSERT(remote_info_);
+
+  if (!check_next_result(handler)) return;
+
+  // Both sides come to the same conclusion here, so they either both skip
+  // the negotiation or they both take part in it; branches of older versions
+  // do not know about the negotiation and would wait for it forever
+  bool in_process = !!std::dynamic_pointer_cast<LoopbackTransport>(transport_);
+  if (in_process || remote_info_->get_hostname() != local_info_->get_hostname() ||
+      !remote_info_->supports_shm_negotiation()) {
+    context_->post([=] { handler(Success()); });
+    return;
+  }
+
+  if (created_from_incoming_connection_request()) {
+    offer_shm_transport(handler);
+  } else {
+    await_shm_offer(handler);
+  }
+}
+
 void BranchConnection::run_session(MessageReceiveHandler rcv_handler, CompletionHandler session_handler) {
   YOGI_ASSERT(remote_info_);
   YOGI_ASSERT(!session_running());
@@ -86,11 +127,18 @@ void BranchConnection::run_session(MessageReceiveHandler rcv_handler, Completion
   if (!check_next_result(session_handler)) return;
 
   msg_transport_ = std::make_shared<MessageTransport>(transport_, local_info_->get_tx_queue_size(),
-                                                      local_info_->get_rx_queue_size());
+                                                      local_info_->get_rx_queue_size(),
+                                                      local_info_->get_mirrored_queues());
+  msg_transport_->set_tx_coalescing(local_info_->get_tx_coalescing_delay(),
+                                    local_info_->get_tx_coalescing_threshold());
+  msg_transport_->set_tx_zero_copy_threshold(local_info_->get_zero_copy_threshold());
+  msg_transport_->set_tx_compression_threshold(negotiate_compression_threshold(),
+                                               remote_info_->get_max_broadcast_size());
   msg_transport_->start();
+  uses_multicast_ = negotiate_multicast();
 
   restart_heartbeat_timer();
-  start_receive(make_shared_buffer());
+  start_receive();
   session_running_ = true;
   session_handler_ = session_handler;
   rcv_handler_     = rcv_handler;
@@ -139,6 +187,11 @@ void BranchConnection::on_info_header_received(SharedBuffer buffer, CompletionHa
 }
 
 void BranchConnection::on_info_body_received(SharedBuffer info_msg, CompletionHandler handler) {
+  if (!resuming_ && RemoteBranchInfo::has_resumption_request_flag(*info_msg)) {
+    on_resumption_request_received(info_msg, handler);
+    return;
+  }
+
   try {
     remote_info_ = std::make_shared<RemoteBranchInfo>(*info_msg, peer_address_);
 
@@ -150,6 +203,34 @@ void BranchConnection::on_info_body_received(SharedBuffer info_msg, CompletionHa
     return;
   }
 
+  // Branches that do not support the pipelined handshake ignore the challenge
+  // at the end of our info message
+  if (RemoteBranchInfo::has_pipelined_handshake_flag(*info_msg)) {
+    if (info_msg->size() < BranchInfo::kInfoMessageHeaderSize + BranchInfo::kChallengeSize) {
+      handler(Error(YOGI_ERR_DESERIALIZE_MSG_FAILED));
+      return;
+    }
+
+    remote_challenge_ = make_shared_buffer(info_msg->end() - BranchInfo::kChallengeSize, info_msg->end());
+
+    // The ack for a resumption request only gets sent once the other branch
+    // has checked the ticket; it closes the connection otherwise
+    if (resuming_) {
+      await_resumption_ack(handler);
+      return;
+    }
+
+    pipelined_handshake_ = true;
+    handler(Success());
+    return;
+  }
+
+  // Branches that do not support the pipelined handshake cannot resume sessions
+  if (resuming_) {
+    handler(Error(YOGI_ERR_DESERIALIZE_MSG_FAILED));
+    return;
+  }
+
   auto weak_self = make_weak_ptr();
   transport_->send_all_async(ack_msg_.serialize_shared(), [=](auto& res) {
     auto self = weak_self.lock();
@@ -179,6 +260,245 @@ void BranchConnection::on_info_ack_received(const Result& res, SharedBuffer ack_
   handler(Success());
 }
 
+void BranchConnection::on_resumption_request_received(SharedBuffer request_msg, CompletionHandler handler) {
+  if (request_msg->size() !=
+      BranchInfo::kInfoMessageHeaderSize + BranchInfo::kChallengeSize + BranchInfo::kResumptionTicketIdSize) {
+    handler(Error(YOGI_ERR_DESERIALIZE_MSG_FAILED));
+    return;
+  }
+
+  unsigned short tcp_port;
+  auto res = RemoteBranchInfo::deserialize_advertising_message(&resumption_uuid_, &tcp_port, *request_msg);
+  if (res.is_error()) {
+    handler(res);
+    return;
+  }
+
+  auto challenge_begin = request_msg->begin() + BranchInfo::kInfoMessageHeaderSize;
+  auto ticket_id_begin = challenge_begin + BranchInfo::kChallengeSize;
+  remote_challenge_    = make_shared_buffer(challenge_begin, ticket_id_begin);
+  received_ticket_id_  = make_shared_buffer(ticket_id_begin, request_msg->end());
+
+  handler(Success());
+}
+
+bool BranchConnection::supports_resumption() const {
+  // Sessions over shared memory or within the same process do not get lost
+  // due to network problems
+  if (!std::dynamic_pointer_cast<TcpTransport>(transport_)) return false;
+
+  return local_info_->get_resumption_window().count() > 0 && remote_info_->get_resumption_window().count() > 0;
+}
+
+SharedBuffer BranchConnection::make_resumption_ticket() const {
+  return make_shared_buffer(make_session_key("resumption"));
+}
+
+SharedBuffer BranchConnection::make_resumption_ticket_id() const {
+  return make_shared_buffer(make_session_key("resumption id"));
+}
+
+void BranchConnection::derive_session_secret(const Buffer& password_hash) {
+  YOGI_ASSERT(my_challenge_ && remote_challenge_);
+
+  bool is_server    = created_from_incoming_connection_request();
+  auto& client_chlg = is_server ? *remote_challenge_ : *my_challenge_;
+  auto& server_chlg = is_server ? *my_challenge_ : *remote_challenge_;
+
+  auto data = client_chlg;
+  data.insert(data.end(), server_chlg.begin(), server_chlg.end());
+  data.insert(data.end(), password_hash.begin(), password_hash.end());
+  session_secret_ = make_sha256(data);
+}
+
+Buffer BranchConnection::make_session_key(std::string_view label) const {
+  YOGI_ASSERT(!session_secret_.empty());
+
+  auto data = session_secret_;
+  data.insert(data.end(), label.begin(), label.end());
+  return make_sha256(data);
+}
+
+void BranchConnection::resume_session(SharedBuffer ticket, SharedBuffer ticket_id, CompletionHandler handler) {
+  YOGI_ASSERT(!remote_info_);
+  YOGI_ASSERT(ticket->size() == BranchInfo::kResumptionTicketSize);
+
+  resuming_          = true;
+  resumption_ticket_ = ticket;
+  my_challenge_      = make_shared_buffer(generate_random_bytes(BranchInfo::kChallengeSize));
+
+  auto msg       = local_info_->make_resumption_request_message(*my_challenge_, *ticket_id);
+  auto weak_self = make_weak_ptr();
+  transport_->send_all_async(msg, [=](auto& res) {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    if (res.is_error()) {
+      handler(res);
+    } else {
+      self->on_info_sent(handler);
+    }
+  });
+}
+
+void BranchConnection::await_resumption_ack(CompletionHandler handler) {
+  auto weak_self = make_weak_ptr();
+  auto ack_msg   = make_shared_buffer(ack_msg_.get_size() + BranchInfo::kResumptionProofSize);
+  transport_->receive_all_async(ack_msg, [=](auto& res) {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    self->on_resumption_ack_received(res, ack_msg, handler);
+  });
+}
+
+void BranchConnection::on_resumption_ack_received(const Result& res, SharedBuffer ack_msg, CompletionHandler handler) {
+  if (res.is_error()) {
+    handler(res);
+    return;
+  }
+
+  auto proof_begin = ack_msg->begin() + static_cast<std::ptrdiff_t>(ack_msg_.get_size());
+  check_ack_and_set_next_result(res, Buffer(ack_msg->begin(), proof_begin));
+  if (next_result_.is_error()) {
+    handler(next_result_);
+    return;
+  }
+
+  // Only a branch that knows the ticket can create the proof
+  auto remote_proof = make_resumption_proof(true);
+  if (!secure_equal(remote_proof->data(), &*proof_begin, remote_proof->size())) {
+    handler(Error(YOGI_ERR_PASSWORD_MISMATCH));
+    return;
+  }
+
+  // The other branch starts the session once it has checked our proof and
+  // closes the connection otherwise
+  auto weak_self = make_weak_ptr();
+  transport_->send_all_async(make_resumption_proof(false), [=](auto& res) {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    handler(res);
+  });
+}
+
+void BranchConnection::await_resumption_proof(CompletionHandler handler) {
+  auto weak_self = make_weak_ptr();
+  auto proof     = make_shared_buffer(BranchInfo::kResumptionProofSize);
+  transport_->receive_all_async(proof, [=](auto& res) {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    self->on_resumption_proof_received(res, proof, handler);
+  });
+}
+
+void BranchConnection::on_resumption_proof_received(const Result& res, SharedBuffer proof, CompletionHandler handler) {
+  if (res.is_error()) {
+    handler(res);
+    return;
+  }
+
+  if (!secure_equal(*make_resumption_proof(false), *proof)) {
+    handler(Error(YOGI_ERR_PASSWORD_MISMATCH));
+    return;
+  }
+
+  handler(Success());
+}
+
+// Proves the knowledge of the ticket without revealing it; the challenges of
+// both branches make sure that proofs cannot be replayed and the role makes
+// sure that a branch cannot pass off the other branch's proof as its own
+SharedBuffer BranchConnection::make_resumption_proof(bool by_server) const {
+  YOGI_ASSERT(resumption_ticket_);
+
+  bool is_server        = created_from_incoming_connection_request();
+  auto& client_chlg     = is_server ? *remote_challenge_ : *my_challenge_;
+  auto& server_chlg     = is_server ? *my_challenge_ : *remote_challenge_;
+  std::string_view role = by_server ? "server" : "client";
+
+  auto data = client_chlg;
+  data.insert(data.end(), server_chlg.begin(), server_chlg.end());
+  data.insert(data.end(), role.begin(), role.end());
+  return make_shared_buffer(make_hmac_sha256(*resumption_ticket_, data.data(), data.size()));
+}
+
+void BranchConnection::accept_resumption(RemoteBranchInfoPtr remote_info, SharedBuffer ticket,
+                                         CompletionHandler handler) {
+  YOGI_ASSERT(resumption_requested());
+  YOGI_ASSERT(remote_info->get_uuid() == resumption_uuid_);
+  YOGI_ASSERT(ticket->size() == BranchInfo::kResumptionTicketSize);
+
+  remote_info_       = remote_info;
+  resumption_ticket_ = ticket;
+
+  auto msg   = make_shared_buffer(ack_msg_.serialize().begin(), ack_msg_.serialize().end());
+  auto proof = make_resumption_proof(true);
+  msg->insert(msg->end(), proof->begin(), proof->end());
+
+  auto weak_self = make_weak_ptr();
+  transport_->send_all_async(msg, [=](auto& res) {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    if (res.is_error()) {
+      handler(res);
+    } else {
+      self->await_resumption_proof(handler);
+    }
+  });
+}
+
+void BranchConnection::authenticate_pipelined(SharedBuffer password_hash, CompletionHandler handler) {
+  auto my_solution     = solve_challenge(*my_challenge_, *password_hash);
+  auto remote_solution = solve_challenge(*remote_challenge_, *password_hash);
+
+  auto msg = make_shared_buffer(ack_msg_.serialize().begin(), ack_msg_.serialize().end());
+  msg->insert(msg->end(), remote_solution->begin(), remote_solution->end());
+
+  auto weak_self = make_weak_ptr();
+  transport_->send_all_async(msg, [=](auto& res) {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    if (res.is_error()) {
+      handler(res);
+    } else {
+      self->on_pipelined_solution_sent(my_solution, handler);
+    }
+  });
+}
+
+void BranchConnection::on_pipelined_solution_sent(SharedBuffer my_solution, CompletionHandler handler) {
+  auto weak_self    = make_weak_ptr();
+  auto received_msg = make_shared_buffer(ack_msg_.get_size() + my_solution->size());
+  transport_->receive_all_async(received_msg, [=](auto& res) {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    self->on_pipelined_solution_received(res, received_msg, my_solution, handler);
+  });
+}
+
+void BranchConnection::on_pipelined_solution_received(const Result& res, SharedBuffer received_msg,
+                                                      SharedBuffer my_solution, CompletionHandler handler) {
+  if (res.is_error()) {
+    handler(res);
+    return;
+  }
+
+  auto solution_begin = received_msg->begin() + static_cast<std::ptrdiff_t>(ack_msg_.get_size());
+  check_ack_and_set_next_result(res, Buffer(received_msg->begin(), solution_begin));
+
+  if (!std::equal(solution_begin, received_msg->end(), my_solution->begin(), my_solution->end())) {
+    handler(Error(YOGI_ERR_PASSWORD_MISMATCH));
+  } else {
+    handler(Success());
+  }
+}
+
 void BranchConnection::on_challenge_sent(SharedBuffer my_challenge, SharedBuffer password_hash,
                                          CompletionHandler handler) {
   auto weak_self        = make_weak_ptr();
@@ -197,6 +517,8 @@ void BranchConnection::on_challenge_sent(SharedBuffer my_challenge, SharedBuffer
 
 void BranchConnection::on_challenge_received(SharedBuffer remote_challenge, SharedBuffer my_challenge,
                                              SharedBuffer password_hash, CompletionHandler handler) {
+  remote_challenge_ = remote_challenge;
+
   auto weak_self       = make_weak_ptr();
   auto my_solution     = solve_challenge(*my_challenge, *password_hash);
   auto remote_solution = solve_challenge(*remote_challenge, *password_hash);
@@ -271,40 +593,234 @@ void BranchConnection::on_solution_ack_received(const Result& res, bool solution
   }
 }
 
-void BranchConnection::restart_heartbeat_timer() {
-  YOGI_ASSERT((remote_info_->get_timeout() / 2).count() > 0);
-  heartbeat_timer_.expires_from_now(remote_info_->get_timeout() / 2);
+std::string BranchConnection::make_shm_segment_name() const {
+  // The branch that accepted the TCP connection creates the segment
+  auto& creator_uuid = created_from_incoming_connection_request() ? local_info_->get_uuid() : remote_info_->get_uuid();
+  auto& opener_uuid  = created_from_incoming_connection_request() ? remote_info_->get_uuid() : local_info_->get_uuid();
+  return "/yogi-" + boost::uuids::to_string(creator_uuid) + '-' + boost::uuids::to_string(opener_uuid);
+}
+
+void BranchConnection::offer_shm_transport(CompletionHandler handler) {
+  ShmTransportPtr shm;
+  if (local_info_->get_shm_transport()) {
+    shm = ShmTransport::try_create(context_, make_shm_segment_name(), local_info_->get_tx_queue_size(),
+                                   local_info_->get_timeout(), true, transport_->get_peer_description(),
+                                   local_info_->get_transceive_byte_limit());
+  }
+
+  auto weak_self = make_weak_ptr();
+  auto offer     = make_shared_buffer(Buffer{static_cast<Byte>(shm ? 1 : 0)});
+  transport_->send_all_async(offer, [=](auto& res) {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    if (res.is_error()) {
+      handler(res);
+    } else {
+      self->on_shm_offer_sent(shm, handler);
+    }
+  });
+}
+
+void BranchConnection::on_shm_offer_sent(ShmTransportPtr shm, CompletionHandler handler) {
+  auto weak_self = make_weak_ptr();
+  auto answer    = make_shared_buffer(1);
+  transport_->receive_all_async(answer, [=](auto& res) {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    if (res.is_error()) {
+      handler(res);
+    } else {
+      self->on_shm_offer_answer_received(shm, answer, handler);
+    }
+  });
+}
+
+void BranchConnection::on_shm_offer_answer_received(ShmTransportPtr shm, SharedBuffer answer,
+                                                    CompletionHandler handler) {
+  if (shm && (*answer)[0] == 1) {
+    shm->remove_segment_name();
+    switch_to_shm_transport(shm);
+  }
+
+  handler(Success());
+}
 
+void BranchConnection::await_shm_offer(CompletionHandler handler) {
   auto weak_self = make_weak_ptr();
-  heartbeat_timer_.async_wait(bind_weak(&BranchConnection::on_heartbeat_timer_expired, this));
+  auto offer     = make_shared_buffer(1);
+  transport_->receive_all_async(offer, [=](auto& res) {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    if (res.is_error()) {
+      handler(res);
+    } else {
+      self->on_shm_offer_received(offer, handler);
+    }
+  });
+}
+
+void BranchConnection::on_shm_offer_received(SharedBuffer offer, CompletionHandler handler) {
+  ShmTransportPtr shm;
+  if ((*offer)[0] == 1 && local_info_->get_shm_transport()) {
+    shm = ShmTransport::try_open(context_, make_shm_segment_name(), local_info_->get_timeout(), false,
+                                 transport_->get_peer_description(), local_info_->get_transceive_byte_limit());
+  }
+
+  auto weak_self = make_weak_ptr();
+  auto answer    = make_shared_buffer(Buffer{static_cast<Byte>(shm ? 1 : 0)});
+  transport_->send_all_async(answer, [=](auto& res) {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    if (res.is_success() && shm) {
+      self->switch_to_shm_transport(shm);
+    }
+
+    handler(res);
+  });
+}
+
+void BranchConnection::switch_to_shm_transport(ShmTransportPtr shm) {
+  transport_->close();
+  transport_ = shm;
+}
+
+std::size_t BranchConnection::negotiate_compression_threshold() const {
+  // Copying data through shared memory is faster than compressing it
+  if (std::dynamic_pointer_cast<ShmTransport>(transport_)) return 0;
+
+  auto local_threshold  = local_info_->get_compression_threshold();
+  auto remote_threshold = remote_info_->get_compression_threshold();
+  if (local_threshold == 0 || remote_threshold == 0) return 0;
+
+  return std::max(local_threshold, remote_threshold);
 }
 
-void BranchConnection::on_heartbeat_timer_expired(boost::system::error_code ec) {
-  if (ec == boost::asio::error::operation_aborted) return;
+bool BranchConnection::negotiate_multicast() const {
+  // Connections within the same process or host do not go over the network
+  if (!std::dynamic_pointer_cast<TcpTransport>(transport_)) return false;
 
-  try_send(heartbeat_msg_);
+  auto local_port = local_info_->get_broadcast_multicast_port();
+  return local_port != 0 && local_port == remote_info_->get_broadcast_multicast_port();
+}
+
+void BranchConnection::restart_heartbeat_timer() {
+  YOGI_ASSERT((remote_info_->get_timeout() / 2).count() > 0);
+
+  auto& wheel = context_->timing_wheel();
+  if (!heartbeat_timer_) {
+    heartbeat_timer_ = wheel.make_entry(bind_weak(&BranchConnection::on_heartbeat_timer_expired, this));
+  }
+
+  wheel.arm(heartbeat_timer_, remote_info_->get_timeout() / 2);
+}
+
+void BranchConnection::on_heartbeat_timer_expired() {
+  // Heartbeats must not wait behind bulk data or the session may time out
+  try_send(heartbeat_msg_, TxPriority::kHigh);
   restart_heartbeat_timer();
 }
 
-void BranchConnection::start_receive(SharedBuffer buffer) {
-  auto weak_self = std::weak_ptr<BranchConnection>(shared_from_this());
-  buffer->resize(constants::kMinRxQueueSize);  // This will fit an entire message
-  msg_transport_->receive_async(boost::asio::buffer(*buffer), [=](auto& res, auto msg_size) {
+void BranchConnection::pause_receive() {
+  std::lock_guard<std::mutex> lock(rx_pause_mutex_);
+  if (rx_paused_) return;
+
+  rx_paused_        = true;
+  rx_pause_expired_ = false;
+
+  auto& wheel = context_->timing_wheel();
+  if (!rx_pause_timer_) {
+    rx_pause_timer_ = wheel.make_entry(bind_weak(&BranchConnection::on_rx_pause_timer_expired, this));
+  }
+
+  // The remote branch times out if its send queue stays full for too long
+  wheel.arm(rx_pause_timer_, remote_info_->get_timeout() / 2);
+}
+
+void BranchConnection::resume_receive() {
+  std::lock_guard<std::mutex> lock(rx_pause_mutex_);
+  rx_paused_        = false;
+  rx_pause_expired_ = false;
+
+  if (rx_pause_timer_) {
+    context_->timing_wheel().disarm(rx_pause_timer_);
+  }
+
+  if (rx_stalled_) {
+    rx_stalled_ = false;
+    context_->post(bind_weak(&BranchConnection::start_receive, this));
+  }
+}
+
+bool BranchConnection::receive_pause_expired() {
+  std::lock_guard<std::mutex> lock(rx_pause_mutex_);
+  return rx_pause_expired_;
+}
+
+void BranchConnection::on_rx_pause_timer_expired() {
+  std::lock_guard<std::mutex> lock(rx_pause_mutex_);
+  if (!rx_paused_) return;
+
+  rx_pause_expired_ = true;
+
+  if (rx_stalled_) {
+    rx_stalled_ = false;
+    context_->post(bind_weak(&BranchConnection::start_receive, this));
+  }
+}
+
+void BranchConnection::abort_session(const Error& err) {
+  {
+    std::lock_guard<std::mutex> lock(rx_pause_mutex_);
+    if (abort_result_.is_error()) return;
+    abort_result_ = err;
+  }
+
+  msg_transport_->close();
+
+  // A paused session would never notice that the connection got closed
+  resume_receive();
+}
+
+void BranchConnection::start_receive() {
+  {
+    std::lock_guard<std::mutex> lock(rx_pause_mutex_);
+    if (rx_paused_ && !rx_pause_expired_) {
+      rx_stalled_ = true;
+      return;
+    }
+  }
+
+  auto weak_self = make_weak_ptr();
+  msg_transport_->receive_batch_async([=](auto& res, auto& msgs) {
     auto self = weak_self.lock();
     if (!self) return;
 
     if (res.is_error()) {
-      self->on_session_error(res.to_error());
+      std::unique_lock<std::mutex> lock(self->rx_pause_mutex_);
+      auto err = self->abort_result_.is_error() ? self->abort_result_.to_error() : res.to_error();
+      lock.unlock();
+
+      self->on_session_error(err);
     } else {
-      buffer->resize(msg_size);
-      self->on_message_received(buffer);
-      self->start_receive(buffer);
+      for (auto& msg : msgs) {
+        self->on_message_received(msg);
+      }
+
+      self->start_receive();
     }
   });
 }
 
 void BranchConnection::on_session_error(const Error& err) {
-  heartbeat_timer_.cancel();
+  context_->timing_wheel().disarm(heartbeat_timer_);
+  if (rx_pause_timer_) {
+    context_->timing_wheel().disarm(rx_pause_timer_);
+  }
+
   session_handler_(err);
 }
 
@@ -327,8 +843,8 @@ bool BranchConnection::check_next_result(CompletionHandler handler) {
   return true;
 }
 
-void BranchConnection::on_message_received(const SharedBuffer& msg) {
-  IncomingMessage::deserialize(*msg, rcv_handler_);
+void BranchConnection::on_message_received(boost::asio::const_buffer msg) {
+  IncomingMessage::deserialize(msg, rcv_handler_, local_info_->get_max_broadcast_size());
 }
 
 std::ostream& operator<<(std::ostream& os, const BranchConnection& conn) {
@@ -23,7 +23,9 @@
 
 #include <src/config.h>
 
+#include <src/network/loopback_transport.h>
 #include <src/network/msg_transport.h>
+#include <src/network/shm_transport.h>
 #include <src/objects/branch/branch_info.h>
 #include <src/objects/context.h>
 
@@ -32,6 +34,7 @@
 #include <fstream>
 #include <functional>
 #include <memory>
+#include <string_view>
 
 class BranchConnection;
 typedef std::shared_ptr<BranchConnection> BranchConnectionPtr;
@@ -43,6 +46,7 @@ class BranchConnection : public std::enable_shared_from_this<BranchConnection> {
   using MessageReceiveHandler = IncomingMessage::MessageHandler;
   using OperationTag          = MessageTransport::OperationTag;
   using SendHandler           = MessageTransport::SendHandler;
+  using TxPriority            = MessageTransport::TxPriority;
 
   BranchConnection(TransportPtr transport, const boost::asio::ip::address& peer_address, LocalBranchInfoPtr local_info);
 
@@ -63,26 +67,109 @@ class BranchConnection : public std::enable_shared_from_this<BranchConnection> {
     return transport_->get_peer_description();
   }
 
+  const boost::asio::ip::address& get_peer_address() const {
+    return peer_address_;
+  }
+
+  // Sends the authentication challenge along with the branch info; if the
+  // remote branch does the same, the info ack gets deferred to authenticate()
+  // where it is sent together with the solution
   void exchange_branch_info(CompletionHandler handler);
   void authenticate(SharedBuffer password_hash, CompletionHandler handler);
+
+  // Switches to a shared memory transport if the remote branch runs on the
+  // same host and both branches agree to it; keeps the TCP transport otherwise
+  void negotiate_transport(CompletionHandler handler);
   void run_session(MessageReceiveHandler rcv_handler, CompletionHandler session_handler);
 
-  bool try_send(const OutgoingMessage& msg) {
-    return msg_transport_->try_send(msg);
+  // Session resumption: the branch that created the TCP connection of a lost
+  // session sends the ID of that session's ticket instead of its branch info;
+  // the other branch sends its branch info as usual, looks up the ticket and
+  // acks the request along with a proof that it knows the ticket. The
+  // requesting branch checks that proof and answers with its own proof. The
+  // proofs are bound to the new challenges of both branches and to the role
+  // of the branch creating them, so they can neither be replayed nor
+  // reflected. The session can be run afterwards. Tickets and their IDs are
+  // derived from the session secret; tickets never get sent.
+  bool supports_resumption() const;
+  SharedBuffer make_resumption_ticket() const;
+  SharedBuffer make_resumption_ticket_id() const;
+  void resume_session(SharedBuffer ticket, SharedBuffer ticket_id, CompletionHandler handler);
+
+  bool resumption_requested() const {
+    return !!received_ticket_id_;
+  }
+
+  const boost::uuids::uuid& get_resumption_uuid() const {
+    return resumption_uuid_;
+  }
+
+  const Buffer& get_received_resumption_ticket_id() const {
+    YOGI_ASSERT(received_ticket_id_);
+    return *received_ticket_id_;
+  }
+
+  void accept_resumption(RemoteBranchInfoPtr remote_info, SharedBuffer ticket, CompletionHandler handler);
+
+  // Both branches derive the same secret from the challenges exchanged during
+  // the handshake and the password; has to be called before run_session()
+  void derive_session_secret(const Buffer& password_hash);
+
+  // Key for a specific purpose that is derived from the session secret
+  Buffer make_session_key(std::string_view label) const;
+
+  // True if broadcasts to the remote branch get sent via UDP multicast; only
+  // valid once the session is running
+  bool uses_multicast() const {
+    return uses_multicast_;
   }
 
-  void send_async(OutgoingMessage* msg, OperationTag tag, SendHandler handler) {
-    msg_transport_->send_async(msg, tag, handler);
+  // Set once the remote branch has been told the sequence number of the
+  // first multicast broadcast; guarded by the BroadcastManager
+  bool multicast_synced() const {
+    return multicast_synced_;
   }
 
-  void send_async(OutgoingMessage* msg, SendHandler handler) {
-    msg_transport_->send_async(msg, handler);
+  void set_multicast_synced() {
+    multicast_synced_ = true;
+  }
+
+  bool try_send(const OutgoingMessage& msg, TxPriority prio = TxPriority::kNormal) {
+    return msg_transport_->try_send(msg, prio);
+  }
+
+  bool try_send(const SharedSmallBuffer& msg_bytes, TxPriority prio = TxPriority::kNormal) {
+    return msg_transport_->try_send(msg_bytes, prio);
+  }
+
+  bool try_send(OutgoingMessage* msg, TxPriority prio = TxPriority::kNormal) {
+    return msg_transport_->try_send(msg, prio);
+  }
+
+  void send_async(OutgoingMessage* msg, OperationTag tag, SendHandler handler, TxPriority prio = TxPriority::kNormal) {
+    msg_transport_->send_async(msg, tag, handler, prio);
+  }
+
+  void send_async(OutgoingMessage* msg, SendHandler handler, TxPriority prio = TxPriority::kNormal) {
+    msg_transport_->send_async(msg, handler, prio);
   }
 
   bool cancel_send(OperationTag tag) {
     return msg_transport_->cancel_send(tag);
   }
 
+  // Stops receiving messages once the current batch has been processed until
+  // resume_receive() gets called; this lets the send queue of the remote
+  // branch fill up and thus blocks it. Receiving continues after half of the
+  // remote branch's timeout so that it does not drop the connection.
+  void pause_receive();
+  void resume_receive();
+  bool receive_pause_expired();
+
+  // Closes the connection if the remote branch violates the protocol; the
+  // session terminates with the given error
+  void abort_session(const Error& err);
+
  private:
   branch_connection_weak_ptr make_weak_ptr() {
     return {shared_from_this()};
@@ -92,6 +179,16 @@ class BranchConnection : public std::enable_shared_from_this<BranchConnection> {
   void on_info_body_received(SharedBuffer info_msg, CompletionHandler handler);
   void on_info_ack_sent(CompletionHandler handler);
   void on_info_ack_received(const Result& res, SharedBuffer ack_msg, CompletionHandler handler);
+  void on_resumption_request_received(SharedBuffer request_msg, CompletionHandler handler);
+  void await_resumption_ack(CompletionHandler handler);
+  void on_resumption_ack_received(const Result& res, SharedBuffer ack_msg, CompletionHandler handler);
+  void await_resumption_proof(CompletionHandler handler);
+  void on_resumption_proof_received(const Result& res, SharedBuffer proof, CompletionHandler handler);
+  SharedBuffer make_resumption_proof(bool by_server) const;
+  void authenticate_pipelined(SharedBuffer password_hash, CompletionHandler handler);
+  void on_pipelined_solution_sent(SharedBuffer my_solution, CompletionHandler handler);
+  void on_pipelined_solution_received(const Result& res, SharedBuffer received_msg, SharedBuffer my_solution,
+                                      CompletionHandler handler);
   void on_challenge_sent(SharedBuffer my_challenge, SharedBuffer password_hash, CompletionHandler handler);
   void on_challenge_received(SharedBuffer remote_challenge, SharedBuffer my_challenge, SharedBuffer password_hash,
                              CompletionHandler handler);
@@ -101,15 +198,25 @@ class BranchConnection : public std::enable_shared_from_this<BranchConnection> {
   void on_solution_ack_sent(bool solutions_match, CompletionHandler handler);
   void on_solution_ack_received(const Result& res, bool solutions_match, SharedBuffer ack_msg,
                                 CompletionHandler handler);
+  std::string make_shm_segment_name() const;
+  void offer_shm_transport(CompletionHandler handler);
+  void on_shm_offer_sent(ShmTransportPtr shm, CompletionHandler handler);
+  void on_shm_offer_answer_received(ShmTransportPtr shm, SharedBuffer answer, CompletionHandler handler);
+  void await_shm_offer(CompletionHandler handler);
+  void on_shm_offer_received(SharedBuffer offer, CompletionHandler handler);
+  void switch_to_shm_transport(ShmTransportPtr shm);
+  std::size_t negotiate_compression_threshold() const;
+  bool negotiate_multicast() const;
   void restart_heartbeat_timer();
-  void on_heartbeat_timer_expired(boost::system::error_code ec);
-  void start_receive(SharedBuffer buffer);
+  void on_heartbeat_timer_expired();
+  void on_rx_pause_timer_expired();
+  void start_receive();
   void on_session_error(const Error& err);
   void check_ack_and_set_next_result(const Result& res, const Buffer& ack_msg);
   bool check_next_result(CompletionHandler handler);
-  void on_message_received(const SharedBuffer& msg);
+  void on_message_received(boost::asio::const_buffer msg);
 
-  const TransportPtr transport_;
+  TransportPtr transport_;
   const ContextPtr context_;
   const LocalBranchInfoPtr local_info_;
   const boost::asio::ip::address peer_address_;
@@ -117,12 +224,28 @@ class BranchConnection : public std::enable_shared_from_this<BranchConnection> {
   messages::HeartbeatOutgoing heartbeat_msg_;
   messages::AcknowledgeOutgoing ack_msg_;
   RemoteBranchInfoPtr remote_info_;
+  SharedBuffer my_challenge_;
+  SharedBuffer remote_challenge_;
+  bool pipelined_handshake_;
+  bool resuming_;
+  boost::uuids::uuid resumption_uuid_;
+  SharedBuffer resumption_ticket_;
+  SharedBuffer received_ticket_id_;
+  Buffer session_secret_;
   MessageTransportPtr msg_transport_;
   std::atomic<bool> session_running_;
+  bool uses_multicast_;
+  bool multicast_synced_;
   CompletionHandler session_handler_;
   MessageReceiveHandler rcv_handler_;
-  boost::asio::steady_timer heartbeat_timer_;
+  TimingWheelEntryPtr heartbeat_timer_;
+  TimingWheelEntryPtr rx_pause_timer_;
   Result next_result_;
+  std::mutex rx_pause_mutex_;
+  bool rx_paused_;
+  bool rx_pause_expired_;
+  bool rx_stalled_;
+  Result abort_result_;  // Guarded by rx_pause_mutex_
 };
 
 std::ostream& operator<<(std::ostream& os, const BranchConnection& conn);
@@ -41,6 +41,18 @@ void deserialize_field(Field* field, const Buffer& msg, Buffer::const_iterator*
   }
 }
 
+// Fields that got appended to the info message in later versions are missing
+// in the info messages of older branches; they get set to default_val then
+template <typename Field>
+void deserialize_optional_field(Field* field, const Field& default_val, const Buffer& msg,
+                                Buffer::const_iterator* it, Buffer::const_iterator fields_end) {
+  if (*it == fields_end) {
+    *field = default_val;
+  } else {
+    deserialize_field(field, msg, it);
+  }
+}
+
 }  // anonymous namespace
 
 void BranchInfo::populate_json() {
@@ -54,6 +66,8 @@ void BranchInfo::populate_json() {
     adv_interval = static_cast<float>(adv_interval_.count()) / 1e9f;
   }
 
+  auto resumption_window = static_cast<float>(resumption_window_.count()) / 1e9f;
+
   auto uuid_str = boost::uuids::to_string(uuid_);
   set_logging_prefix("["s + uuid_str + ']');
 
@@ -70,29 +84,50 @@ void BranchInfo::populate_json() {
       {"timeout", timeout},
       {"advertising_interval", adv_interval},
       {"ghost_mode", ghost_mode_},
+      {"compression_threshold", compression_threshold_},
+      {"broadcast_multicast_port", bc_multicast_port_},
+      {"resumption_window", resumption_window},
+      {"max_broadcast_size", max_bc_size_},
   };
 }
 
 LocalBranchInfo::LocalBranchInfo(const nlohmann::json& cfg, const NetworkInterfaceInfosVector& adv_ifs,
                                  unsigned short tcp_server_port) {
   // clang-format off
-  uuid_            = boost::uuids::random_generator()();
-  name_            = cfg.value("name", std::to_string(get_process_id()) + '@' + ::get_hostname());
-  description_     = cfg.value("description", std::string{});
-  net_name_        = cfg.value("network_name", ::get_hostname());
-  path_            = cfg.value("path", "/"s + name_);
-  hostname_        = ::get_hostname();
-  pid_             = ::get_process_id();
-  adv_ifs_         = adv_ifs;
-  tcp_server_port_ = tcp_server_port;
-  start_time_      = Timestamp::now();
-  timeout_         = extract_duration(cfg, "timeout", constants::kDefaultConnectionTimeout);
-  adv_interval_    = extract_duration(cfg, "advertising_interval", constants::kDefaultAdvInterval);
-  ghost_mode_      = cfg.value("ghost_mode", false);
-  adv_ep_          = extract_udp_endpoint(cfg, "advertising_address", constants::kDefaultAdvAddress, "advertising_port", constants::kDefaultAdvPort);
-  tx_queue_size_   = extract_size(cfg, "tx_queue_size", constants::kDefaultTxQueueSize);
-  rx_queue_size_   = extract_size(cfg, "rx_queue_size", constants::kDefaultRxQueueSize);
-  txrx_byte_limit_ = extract_size_with_inf_support(cfg, "_transceive_byte_limit", -1);
+  uuid_                    = boost::uuids::random_generator()();
+  name_                    = cfg.value("name", std::to_string(get_process_id()) + '@' + ::get_hostname());
+  description_             = cfg.value("description", std::string{});
+  net_name_                = cfg.value("network_name", ::get_hostname());
+  path_                    = cfg.value("path", "/"s + name_);
+  hostname_                = ::get_hostname();
+  pid_                     = ::get_process_id();
+  adv_ifs_                 = adv_ifs;
+  tcp_server_port_         = tcp_server_port;
+  start_time_              = Timestamp::now();
+  timeout_                 = extract_duration(cfg, "timeout", constants::kDefaultConnectionTimeout);
+  adv_interval_            = extract_duration(cfg, "advertising_interval", constants::kDefaultAdvInterval);
+  ghost_mode_              = cfg.value("ghost_mode", false);
+  max_adv_interval_        = extract_duration(cfg, "max_advertising_interval", 0);
+  max_concurrent_connects_ = extract_size(cfg, "max_concurrent_connects", 0);
+  connect_jitter_          = extract_duration(cfg, "connect_jitter", 0);
+  max_connect_backoff_     = extract_duration(cfg, "max_connect_backoff", 0);
+  adv_ep_                  = extract_udp_endpoint(cfg, "advertising_address", constants::kDefaultAdvAddress, "advertising_port", constants::kDefaultAdvPort);
+  tx_queue_size_           = extract_size(cfg, "tx_queue_size", constants::kDefaultTxQueueSize);
+  rx_queue_size_           = extract_size(cfg, "rx_queue_size", constants::kDefaultRxQueueSize);
+  mirrored_queues_         = cfg.value("mirrored_queues", false);
+  tx_coalescing_delay_     = extract_duration(cfg, "tx_coalescing_delay", 0);
+  tx_coalescing_threshold_ = extract_size(cfg, "tx_coalescing_bytes", 0);
+  io_backend_              = cfg.value("io_backend", "asio"s);
+  shm_transport_           = cfg.value("shm_transport", true);
+  zero_copy_threshold_     = extract_size(cfg, "zero_copy_threshold", 0);
+  bc_queue_depth_          = extract_size(cfg, "broadcast_queue_depth", 0);
+  bc_queue_bytes_          = extract_size(cfg, "broadcast_queue_bytes", 0);
+  bc_queue_policy_         = cfg.value("broadcast_queue_policy", "drop_oldest"s);
+  max_bc_size_             = extract_size(cfg, "max_broadcast_size", 16777216);
+  compression_threshold_   = extract_size(cfg, "compression_threshold", 0);
+  bc_multicast_port_       = cfg.value("broadcast_multicast_port", static_cast<unsigned short>(0));
+  resumption_window_       = extract_duration(cfg, "resumption_window", 0);
+  txrx_byte_limit_         = extract_size_with_inf_support(cfg, "_transceive_byte_limit", -1);
   // clang-format on
 
   populate_messages();
@@ -100,6 +135,35 @@ LocalBranchInfo::LocalBranchInfo(const nlohmann::json& cfg, const NetworkInterfa
   populate_json_with_local_info();
 }
 
+SharedBuffer LocalBranchInfo::make_pipelined_info_message(const Buffer& challenge) const {
+  YOGI_ASSERT(challenge.size() == kChallengeSize);
+
+  auto& info_msg = *make_info_message();
+  Buffer buffer(info_msg.begin(), info_msg.begin() + kAdvertisingMessageSize);
+  buffer[6] |= kPipelinedHandshakeFlag;
+
+  serialize(&buffer, info_msg.size() - kInfoMessageHeaderSize + challenge.size());
+  buffer.insert(buffer.end(), info_msg.begin() + kInfoMessageHeaderSize, info_msg.end());
+  buffer.insert(buffer.end(), challenge.begin(), challenge.end());
+
+  return make_shared_buffer(std::move(buffer));
+}
+
+SharedBuffer LocalBranchInfo::make_resumption_request_message(const Buffer& challenge,
+                                                              const Buffer& ticket_id) const {
+  YOGI_ASSERT(challenge.size() == kChallengeSize);
+  YOGI_ASSERT(ticket_id.size() == kResumptionTicketIdSize);
+
+  Buffer buffer(adv_msg_->begin(), adv_msg_->end());
+  buffer[6] |= kResumptionRequestFlag;
+
+  serialize(&buffer, challenge.size() + ticket_id.size());
+  buffer.insert(buffer.end(), challenge.begin(), challenge.end());
+  buffer.insert(buffer.end(), ticket_id.begin(), ticket_id.end());
+
+  return make_shared_buffer(std::move(buffer));
+}
+
 void LocalBranchInfo::populate_messages() {
   Buffer buffer{'Y', 'O', 'G', 'I', 0};
   buffer.push_back(constants::kVersionMajor);
@@ -111,6 +175,7 @@ void LocalBranchInfo::populate_messages() {
   adv_msg_ = make_shared_buffer(buffer);
 
   info_msg_ = make_shared_buffer(buffer);
+  (*info_msg_)[6] |= kShmNegotiationFlag;
 
   buffer.clear();
   serialize(&buffer, name_);
@@ -123,6 +188,10 @@ void LocalBranchInfo::populate_messages() {
   serialize(&buffer, timeout_);
   serialize(&buffer, adv_interval_);
   serialize(&buffer, ghost_mode_);
+  serialize(&buffer, compression_threshold_);
+  serialize(&buffer, bc_multicast_port_);
+  serialize(&buffer, resumption_window_);
+  serialize(&buffer, max_bc_size_);
 
   serialize(&*info_msg_, buffer.size());
   YOGI_ASSERT(info_msg_->size() == kInfoMessageHeaderSize);
@@ -145,11 +214,24 @@ void LocalBranchInfo::populate_json_with_local_info() {
     ifs.push_back(entry);
   }
 
-  json_["advertising_interfaces"] = ifs;
-  json_["advertising_address"]    = make_ip_address_string(adv_ep_);
-  json_["advertising_port"]       = adv_ep_.port();
-  json_["tx_queue_size"]          = tx_queue_size_;
-  json_["rx_queue_size"]          = rx_queue_size_;
+  json_["advertising_interfaces"]   = ifs;
+  json_["advertising_address"]      = make_ip_address_string(adv_ep_);
+  json_["advertising_port"]         = adv_ep_.port();
+  json_["max_advertising_interval"] = static_cast<float>(max_adv_interval_.count()) / 1e9f;
+  json_["max_concurrent_connects"]  = max_concurrent_connects_;
+  json_["connect_jitter"]           = static_cast<float>(connect_jitter_.count()) / 1e9f;
+  json_["max_connect_backoff"]      = static_cast<float>(max_connect_backoff_.count()) / 1e9f;
+  json_["tx_queue_size"]            = tx_queue_size_;
+  json_["rx_queue_size"]            = rx_queue_size_;
+  json_["mirrored_queues"]          = mirrored_queues_;
+  json_["tx_coalescing_delay"]      = static_cast<float>(tx_coalescing_delay_.count()) / 1e9f;
+  json_["tx_coalescing_bytes"]      = tx_coalescing_threshold_;
+  json_["io_backend"]               = io_backend_;
+  json_["shm_transport"]            = shm_transport_;
+  json_["zero_copy_threshold"]      = zero_copy_threshold_;
+  json_["broadcast_queue_depth"]    = bc_queue_depth_;
+  json_["broadcast_queue_bytes"]    = bc_queue_bytes_;
+  json_["broadcast_queue_policy"]   = bc_queue_policy_;
 }
 
 RemoteBranchInfo::RemoteBranchInfo(const Buffer& info_msg, const boost::asio::ip::address& addr) {
@@ -158,6 +240,18 @@ RemoteBranchInfo::RemoteBranchInfo(const Buffer& info_msg, const boost::asio::ip
     throw res.to_error();
   }
 
+  shm_negotiation_ = has_shm_negotiation_flag(info_msg);
+
+  // The challenge of the pipelined handshake follows the fields
+  auto fields_end = info_msg.cend();
+  if (has_pipelined_handshake_flag(info_msg)) {
+    if (info_msg.size() < kInfoMessageHeaderSize + kChallengeSize) {
+      throw Error(YOGI_ERR_DESERIALIZE_MSG_FAILED);
+    }
+
+    fields_end -= kChallengeSize;
+  }
+
   auto it = info_msg.cbegin() + kInfoMessageHeaderSize;
   deserialize_field(&name_, info_msg, &it);
   deserialize_field(&description_, info_msg, &it);
@@ -169,6 +263,13 @@ RemoteBranchInfo::RemoteBranchInfo(const Buffer& info_msg, const boost::asio::ip
   deserialize_field(&timeout_, info_msg, &it);
   deserialize_field(&adv_interval_, info_msg, &it);
   deserialize_field(&ghost_mode_, info_msg, &it);
+  deserialize_optional_field(&compression_threshold_, std::size_t{0}, info_msg, &it, fields_end);
+  deserialize_optional_field(&bc_multicast_port_, static_cast<unsigned short>(0), info_msg, &it, fields_end);
+  deserialize_optional_field(&resumption_window_, std::chrono::nanoseconds{}, info_msg, &it, fields_end);
+
+  // Branches that do not announce the field decompress messages up to this size
+  deserialize_optional_field(&max_bc_size_, static_cast<std::size_t>(constants::kMaxRxQueueSize), info_msg, &it,
+                             fields_end);
 
   populate_json();
 
@@ -42,8 +42,28 @@ class BranchInfo : public LogUser {
   enum {
     kAdvertisingMessageSize = 25,
     kInfoMessageHeaderSize  = kAdvertisingMessageSize + 4,
+    kChallengeSize          = 8,
+    kResumptionTicketSize   = 32,
+    kResumptionTicketIdSize = 32,
+    kResumptionProofSize    = 32,
   };
 
+  // Set in the minor version byte of info messages whose body ends with the
+  // authentication challenge. If both branches set it, the info ack and the
+  // solution get exchanged together and the handshake takes one round trip.
+  static constexpr Byte kPipelinedHandshakeFlag = 0x80;
+
+  // Set in the minor version byte of a message that gets sent instead of the
+  // info message in order to resume a lost session; its body consists of a
+  // new challenge followed by the ID of the resumption ticket of the lost
+  // session. The ticket itself never gets sent.
+  static constexpr Byte kResumptionRequestFlag = 0x40;
+
+  // Set in the minor version byte of info messages from branches that take
+  // part in negotiating a shared memory transport. Branches only exchange the
+  // shared memory offer and its answer if both of them set it.
+  static constexpr Byte kShmNegotiationFlag = 0x20;
+
   virtual ~BranchInfo() = default;
 
   const boost::uuids::uuid& get_uuid() const {
@@ -94,6 +114,23 @@ class BranchInfo : public LogUser {
     return ghost_mode_;
   }
 
+  std::size_t get_compression_threshold() const {
+    return compression_threshold_;
+  }
+
+  unsigned short get_broadcast_multicast_port() const {
+    return bc_multicast_port_;
+  }
+
+  // Also limits the size of compressed messages after decompression
+  std::size_t get_max_broadcast_size() const {
+    return max_bc_size_;
+  }
+
+  const std::chrono::nanoseconds& get_resumption_window() const {
+    return resumption_window_;
+  }
+
   const nlohmann::json& to_json() const {
     return json_;
   }
@@ -113,6 +150,10 @@ class BranchInfo : public LogUser {
   std::chrono::nanoseconds timeout_;
   std::chrono::nanoseconds adv_interval_;
   bool ghost_mode_;
+  std::size_t compression_threshold_;
+  unsigned short bc_multicast_port_;
+  std::chrono::nanoseconds resumption_window_;
+  std::size_t max_bc_size_;
   nlohmann::json json_;
 };
 
@@ -134,6 +175,11 @@ class LocalBranchInfo : public BranchInfo {
     return adv_ep_;
   }
 
+  // Broadcasts get multicast to the advertising address
+  boost::asio::ip::udp::endpoint get_broadcast_multicast_endpoint() const {
+    return {adv_ep_.address(), bc_multicast_port_};
+  }
+
   std::size_t get_tx_queue_size() const {
     return tx_queue_size_;
   }
@@ -142,6 +188,66 @@ class LocalBranchInfo : public BranchInfo {
     return rx_queue_size_;
   }
 
+  bool get_mirrored_queues() const {
+    return mirrored_queues_;
+  }
+
+  // The advertising interval doubles with every advertisement up to this
+  // value while no branches connect or disconnect; 0 disables the backoff
+  const std::chrono::nanoseconds& get_max_advertising_interval() const {
+    return max_adv_interval_;
+  }
+
+  // Limit for outgoing connections that are being established at the same
+  // time; 0 means unlimited
+  std::size_t get_max_concurrent_connects() const {
+    return max_concurrent_connects_;
+  }
+
+  // Connection attempts get delayed by a random amount of time up to this
+  const std::chrono::nanoseconds& get_connect_jitter() const {
+    return connect_jitter_;
+  }
+
+  // Failed connection attempts to a branch get retried after the advertising
+  // interval, doubling with every failure up to this value; 0 disables the
+  // backoff
+  const std::chrono::nanoseconds& get_max_connect_backoff() const {
+    return max_connect_backoff_;
+  }
+
+  const std::chrono::nanoseconds& get_tx_coalescing_delay() const {
+    return tx_coalescing_delay_;
+  }
+
+  std::size_t get_tx_coalescing_threshold() const {
+    return tx_coalescing_threshold_;
+  }
+
+  const std::string& get_io_backend() const {
+    return io_backend_;
+  }
+
+  bool get_shm_transport() const {
+    return shm_transport_;
+  }
+
+  std::size_t get_zero_copy_threshold() const {
+    return zero_copy_threshold_;
+  }
+
+  std::size_t get_broadcast_queue_depth() const {
+    return bc_queue_depth_;
+  }
+
+  std::size_t get_broadcast_queue_bytes() const {
+    return bc_queue_bytes_;
+  }
+
+  const std::string& get_broadcast_queue_policy() const {
+    return bc_queue_policy_;
+  }
+
   std::size_t get_transceive_byte_limit() const {
     return txrx_byte_limit_;
   }
@@ -156,14 +262,30 @@ class LocalBranchInfo : public BranchInfo {
     return info_msg_;
   };
 
+  SharedBuffer make_pipelined_info_message(const Buffer& challenge) const;
+  SharedBuffer make_resumption_request_message(const Buffer& challenge, const Buffer& ticket_id) const;
+
  private:
   void populate_messages();
   void populate_json_with_local_info();
 
   NetworkInterfaceInfosVector adv_ifs_;
   boost::asio::ip::udp::endpoint adv_ep_;
+  std::chrono::nanoseconds max_adv_interval_;
+  std::size_t max_concurrent_connects_;
+  std::chrono::nanoseconds connect_jitter_;
+  std::chrono::nanoseconds max_connect_backoff_;
   std::size_t tx_queue_size_;
   std::size_t rx_queue_size_;
+  bool mirrored_queues_;
+  std::chrono::nanoseconds tx_coalescing_delay_;
+  std::size_t tx_coalescing_threshold_;
+  std::string io_backend_;
+  bool shm_transport_;
+  std::size_t zero_copy_threshold_;
+  std::size_t bc_queue_depth_;
+  std::size_t bc_queue_bytes_;
+  std::string bc_queue_policy_;
   std::size_t txrx_byte_limit_;
   SharedBuffer adv_msg_;
   SharedBuffer info_msg_;
@@ -181,8 +303,26 @@ class RemoteBranchInfo : public BranchInfo {
 
   static Result deserialize_info_message_body_size(std::size_t* body_size, const Buffer& info_msg_hdr);
 
+  static bool has_pipelined_handshake_flag(const Buffer& info_msg_hdr) {
+    return (info_msg_hdr[6] & kPipelinedHandshakeFlag) != 0;
+  }
+
+  static bool has_resumption_request_flag(const Buffer& info_msg_hdr) {
+    return (info_msg_hdr[6] & kResumptionRequestFlag) != 0;
+  }
+
+  static bool has_shm_negotiation_flag(const Buffer& info_msg_hdr) {
+    return (info_msg_hdr[6] & kShmNegotiationFlag) != 0;
+  }
+
+  bool supports_shm_negotiation() const {
+    return shm_negotiation_;
+  }
+
  private:
   static Result check_magic_prefix_and_version(const Buffer& adv_msg);
+
+  bool shm_negotiation_;
 };
 
 // Format like this: [6ba7b810-9dad-11d1-80b4-00c04fd430c8]
@@ -19,13 +19,22 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 
+#include <src/data/crypto.h>
 #include <src/objects/branch/broadcast_manager.h>
 #include <src/util/algorithm.h>
+#include <src/util/bind.h>
 
 YOGI_DEFINE_INTERNAL_LOGGER("Branch.BroadcastManager")
 
 BroadcastManager::BroadcastManager(ContextPtr context, ConnectionManager& conn_manager)
-    : context_(context), conn_manager_(conn_manager) {
+    : context_(context),
+      conn_manager_(conn_manager),
+      rx_queue_depth_(0),
+      rx_queue_byte_limit_(0),
+      rx_max_msg_size_(0),
+      rx_queue_policy_(RxQueuePolicy::kDropOldest),
+      rx_queue_bytes_(0),
+      rx_queue_peak_(0) {
 }
 
 BroadcastManager::~BroadcastManager() {
@@ -33,11 +42,27 @@ BroadcastManager::~BroadcastManager() {
 
 void BroadcastManager::start(LocalBranchInfoPtr info) {
   set_logging_prefix(info->logging_prefix());
+
+  if (info->get_broadcast_multicast_port() != 0) {
+    auto group_ep = info->get_broadcast_multicast_endpoint();
+
+    mc_sender_ = std::make_shared<MulticastSender>(context_, group_ep);
+    mc_sender_->start(info);
+
+    mc_receiver_ = std::make_shared<MulticastReceiver>(context_, group_ep);
+    mc_receiver_->start(info, bind_weak(&BroadcastManager::on_multicast_received, this));
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(rx_mutex_);
+  rx_queue_depth_      = info->get_broadcast_queue_depth();
+  rx_queue_byte_limit_ = info->get_broadcast_queue_bytes();
+  rx_queue_policy_     = parse_rx_queue_policy(info->get_broadcast_queue_policy());
+  rx_max_msg_size_     = info->get_max_broadcast_size();
 }
 
 Result BroadcastManager::send_broadcast(const Payload& payload, bool block) {
   Result result;
-  send_broadcast_async(payload, block, [&](auto& res, auto) {
+  send_broadcast_async(payload, block, TxPriority::kNormal, [&](auto& res, auto) {
     std::lock_guard<std::mutex> lock(this->tx_sync_mutex_);
     result = res;
     this->tx_sync_cv_.notify_all();
@@ -50,34 +75,34 @@ Result BroadcastManager::send_broadcast(const Payload& payload, bool block) {
 }
 
 BroadcastManager::SendBroadcastOperationId BroadcastManager::send_broadcast_async(const Payload& payload, bool retry,
+                                                                                  TxPriority prio,
                                                                                   SendBroadcastHandler handler) {
   messages::BroadcastOutgoing msg(payload);
 
   auto oid = conn_manager_.make_operation_id();
+  if (mc_sender_) {
+    send_multicast(&msg, retry, prio, handler, oid);
+  } else {
+    send_to_sessions(&msg, retry, prio, handler, oid, [&](auto fn) { conn_manager_.foreach_running_session(fn); });
+  }
 
-  if (retry) {
-    std::shared_ptr<int> pending_handlers;
-
-    std::lock_guard<std::mutex> lock(tx_oids_mutex_);
-    conn_manager_.foreach_running_session(
-        [&](auto& conn) { this->send_now_or_later(&pending_handlers, &msg, conn, handler, oid); });
+  return oid;
+}
 
-    store_oid_for_later_or_call_handler_now(pending_handlers, handler, oid);
-  } else {
-    bool all_sent = true;
-    conn_manager_.foreach_running_session([&](auto& conn) {
-      if (!conn->try_send(msg)) {
-        all_sent = false;
-      }
-    });
+BroadcastManager::SendBroadcastOperationId BroadcastManager::send_to_async(const boost::uuids::uuid& uuid,
+                                                                           const Payload& payload, bool retry,
+                                                                           TxPriority prio,
+                                                                           SendBroadcastHandler handler) {
+  messages::BroadcastOutgoing msg(payload);
 
-    if (all_sent) {
-      context_->post([=] { handler(Success(), oid); });
-    } else {
-      context_->post([=] { handler(Error(YOGI_ERR_TX_QUEUE_FULL), oid); });
-    }
+  auto conn = conn_manager_.get_running_session(uuid);
+  if (!conn) {
+    throw Error(YOGI_ERR_BRANCH_NOT_CONNECTED);
   }
 
+  auto oid = conn_manager_.make_operation_id();
+  send_to_sessions(&msg, retry, prio, handler, oid, [&](auto fn) { fn(conn); });
+
   return oid;
 }
 
@@ -104,6 +129,20 @@ void BroadcastManager::receive_broadcast(int encoding, boost::asio::mutable_buff
   if (rx_handler_) {
     auto old_handler = rx_handler_;
     context_->post([=] { old_handler(Error(YOGI_ERR_CANCELED), {}, 0); });
+    stop_rx_stream();
+  }
+
+  if (!rx_queue_.empty()) {
+    auto& qb      = rx_queue_.front();
+    auto src_uuid = qb.src_uuid;
+    std::size_t n = 0;
+    auto res      = Payload(boost::asio::buffer(qb.payload.data(), qb.payload.size()), qb.encoding)
+                   .serialize_to_user_buffer(data, encoding, &n);
+    pop_rx_queue();
+
+    rx_handler_ = {};
+    context_->post([=] { handler(res, src_uuid, n); });
+    return;
   }
 
   rx_encoding_ = encoding;
@@ -118,6 +157,7 @@ bool BroadcastManager::cancel_receive_broadcast() {
     auto handler = rx_handler_;
     rx_handler_  = {};
     context_->post([=] { handler(Error(YOGI_ERR_CANCELED), {}, 0); });
+    stop_rx_stream();
     return true;
   }
 
@@ -127,46 +167,245 @@ bool BroadcastManager::cancel_receive_broadcast() {
 void BroadcastManager::on_broadcast_received(const messages::BroadcastIncoming& msg, const BranchConnectionPtr& conn) {
   std::lock_guard<std::recursive_mutex> lock(rx_mutex_);
 
-  if (rx_handler_) {
+  if (rx_handler_available()) {
     auto handler  = rx_handler_;
     rx_handler_   = {};
     std::size_t n = 0;
     auto res      = msg.get_payload().serialize_to_user_buffer(rx_data_, rx_encoding_, &n);
     handler(res, conn->get_remote_branch_info()->get_uuid(), n);
+  } else if (rx_queue_depth_ > 0) {
+    enqueue_received_broadcast(msg, conn);
+  }
+}
+
+void BroadcastManager::on_fragment_received(const messages::FragmentIncoming& frag, const BranchConnectionPtr& conn) {
+  std::lock_guard<std::recursive_mutex> lock(rx_mutex_);
+  if (!check_fragment_size(frag, conn)) return;
+
+  remove_erase_if(rx_reassemblies_, [](auto& r) { return r.conn.expired(); });
+  auto it = find_if(rx_reassemblies_, [&](auto& r) { return r.conn.lock() == conn; });
+
+  // The remaining fragments of a message get discarded if the sender starts
+  // a new message, e.g. because the send operation has been canceled
+  if (frag.is_first()) {
+    if (it != rx_reassemblies_.end()) {
+      rx_reassemblies_.erase(it);
+    }
+
+    if (!try_start_reassembly(frag, conn)) return;
+    it = rx_reassemblies_.end() - 1;
+  } else if (it == rx_reassemblies_.end()) {
+    return;
+  } else if (it->next_offset != frag.get_offset() || it->msg_size != frag.get_msg_size()) {
+    LOG_ERR("Fragment received out of order from " << conn << ": " << frag);
+    rx_reassemblies_.erase(it);
+    return;
+  }
+
+  append_fragment(&*it, frag);
+  if (!frag.is_last()) return;
+
+  auto reassembly = std::move(*it);
+  rx_reassemblies_.erase(it);
+  finish_reassembly(reassembly, conn);
+}
+
+void BroadcastManager::on_multicast_sync_received(const messages::MulticastSyncIncoming& msg,
+                                                  const BranchConnectionPtr& conn) {
+  std::lock_guard<std::recursive_mutex> lock(rx_mutex_);
+
+  auto state        = get_multicast_rx_state(conn);
+  state->synced     = true;
+  state->key        = wrap_multicast_key(msg.get_wrapped_key(), conn);
+  state->next_seq   = msg.get_seq();
+  state->nacked_seq = msg.get_seq();
+  state->held_back.clear();
+
+  auto unsynced = std::move(state->unsynced);
+  state->unsynced.clear();
+  for (auto& entry : unsynced) {
+    auto raw      = entry.bytes.data();
+    auto msg_size = entry.bytes.size() - MulticastSender::kDatagramHeaderSize - MulticastSender::kMacSize;
+
+    MulticastReceiver::Datagram dgram;
+    dgram.sender_address = entry.sender_address;
+    dgram.uuid           = conn->get_remote_branch_info()->get_uuid();
+    dgram.seq            = entry.seq;
+    dgram.header         = boost::asio::buffer(raw, MulticastSender::kDatagramHeaderSize);
+    dgram.msg            = boost::asio::buffer(raw + MulticastSender::kDatagramHeaderSize, msg_size);
+    dgram.mac            = boost::asio::buffer(raw + MulticastSender::kDatagramHeaderSize + msg_size,
+                                               MulticastSender::kMacSize);
+
+    handle_multicast_datagram(state, conn, dgram);
   }
 }
 
-void BroadcastManager::send_now_or_later(SharedCounter* pending_handlers, OutgoingMessage* msg,
+void BroadcastManager::on_multicast_nack_received(const messages::MulticastNackIncoming& msg,
+                                                  const BranchConnectionPtr& conn) {
+  if (!mc_sender_) return;
+
+  // Broadcasts that have not been sent yet cannot have been lost
+  auto count   = std::min(msg.get_count(), MulticastSender::kRepairWindowSize);
+  auto end_seq = std::min(msg.get_first_seq() + count, mc_sender_->get_next_seq());
+
+  for (auto seq = msg.get_first_seq(); seq < end_seq; ++seq) {
+    auto msg_bytes = mc_sender_->get_sent_msg(seq);
+    messages::MulticastRepairOutgoing repair(seq, msg_bytes ? *msg_bytes : SmallBuffer{});
+
+    try {
+      conn->send_async(&repair, [](auto&) {}, TxPriority::kHigh);
+    } catch (const Error& err) {
+      LOG_ERR("Could not repair broadcast " << seq << " for " << conn << ": " << err);
+      return;
+    }
+  }
+}
+
+void BroadcastManager::on_multicast_repair_received(const messages::MulticastRepairIncoming& msg,
+                                                    const BranchConnectionPtr& conn) {
+  std::lock_guard<std::recursive_mutex> lock(rx_mutex_);
+
+  auto state = get_multicast_rx_state(conn);
+  if (!state->synced || msg.get_seq() < state->next_seq) return;
+
+  if (msg.is_lost()) {
+    LOG_WRN("Broadcast " << msg.get_seq() << " from " << conn << " got lost and cannot be repaired");
+    state->held_back.emplace(msg.get_seq(), SmallBuffer{});
+  } else {
+    hold_back_multicast_msg(state, msg.get_seq(), msg.get_msg());
+  }
+
+  deliver_multicast_msgs(state, conn);
+}
+
+std::size_t BroadcastManager::get_receive_queue_peak() {
+  std::lock_guard<std::recursive_mutex> lock(rx_mutex_);
+  return rx_queue_peak_;
+}
+
+BroadcastManager::RxQueuePolicy BroadcastManager::parse_rx_queue_policy(const std::string& str) {
+  if (str == "drop_newest") return RxQueuePolicy::kDropNewest;
+  if (str == "block_peer") return RxQueuePolicy::kBlockPeer;
+  return RxQueuePolicy::kDropOldest;
+}
+
+template <typename ForeachSessionFn>
+void BroadcastManager::send_to_sessions(OutgoingMessage* msg, bool retry, TxPriority prio,
+                                        SendBroadcastHandler handler, SendBroadcastOperationId oid,
+                                        ForeachSessionFn foreach_session) {
+  // Messages that need to be fragmented can only be queued via send_async()
+  if (retry || MessageTransport::needs_fragmentation(msg->get_size())) {
+    std::shared_ptr<int> pending_handlers;
+
+    std::lock_guard<std::mutex> lock(tx_oids_mutex_);
+    foreach_session([&](auto& conn) { this->send_now_or_later(&pending_handlers, msg, prio, conn, handler, oid); });
+
+    store_oid_for_later_or_call_handler_now(pending_handlers, handler, oid);
+  } else {
+    // The connections share the serialized and the compressed message
+    bool all_sent = true;
+    foreach_session([&](auto& conn) {
+      if (!conn->try_send(msg, prio)) {
+        all_sent = false;
+      }
+    });
+
+    if (all_sent) {
+      context_->post([=] { handler(Success(), oid); });
+    } else {
+      context_->post([=] { handler(Error(YOGI_ERR_TX_QUEUE_FULL), oid); });
+    }
+  }
+}
+
+// Broadcasts get sent via multicast to all connections that support it and
+// over the connection to all others. Connections that have not been told the
+// sequence number of the first multicast broadcast yet get synced now.
+void BroadcastManager::send_multicast(OutgoingMessage* msg, bool retry, TxPriority prio,
+                                      SendBroadcastHandler handler, SendBroadcastOperationId oid) {
+  // Datagrams must not get fragmented
+  auto msg_bytes = msg->serialize_shared();
+  if (msg_bytes->size() > MulticastSender::kMaxMsgSize) {
+    send_to_sessions(msg, retry, prio, handler, oid, [&](auto fn) { conn_manager_.foreach_running_session(fn); });
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mc_tx_mutex_);
+
+  auto seq       = mc_sender_->get_next_seq();
+  bool multicast = false;
+  std::vector<BranchConnectionPtr> other_conns;
+  conn_manager_.foreach_running_session([&](auto& conn) {
+    if (this->try_use_multicast(conn, seq)) {
+      multicast = true;
+    } else {
+      other_conns.push_back(conn);
+    }
+  });
+
+  // Sequence numbers only get used up if somebody receives the datagram
+  if (multicast) {
+    mc_sender_->send(msg_bytes);
+  }
+
+  send_to_sessions(msg, retry, prio, handler, oid, [&](auto fn) {
+    for (auto& conn : other_conns) {
+      fn(conn);
+    }
+  });
+}
+
+bool BroadcastManager::try_use_multicast(const BranchConnectionPtr& conn, std::uint64_t seq) {
+  if (!conn->uses_multicast()) return false;
+  if (conn->multicast_synced()) return true;
+
+  // The sync message must not overtake broadcasts that are still queued for
+  // the connection; if the queue is full, the next broadcast tries again
+  try {
+    auto wrapped_key = wrap_multicast_key(mc_sender_->get_key(), conn);
+    if (!conn->try_send(messages::MulticastSyncOutgoing(seq, wrapped_key))) return false;
+  } catch (const Error&) {
+    return false;
+  }
+
+  conn->set_multicast_synced();
+  return true;
+}
+
+void BroadcastManager::send_now_or_later(SharedCounter* pending_handlers, OutgoingMessage* msg, TxPriority prio,
                                          BranchConnectionPtr conn, SendBroadcastHandler handler,
                                          SendBroadcastOperationId oid) {
   try {
-    if (!conn->try_send(*msg)) {
+    if (!conn->try_send(msg, prio)) {
       create_and_increment_counter(pending_handlers);
 
       try {
         auto& pending_handlers_ref = *pending_handlers;
         auto weak_self             = std::weak_ptr<BroadcastManager>{shared_from_this()};
-        conn->send_async(msg, oid, [=](auto&) {
-          bool success = false;
-
-          {
-            std::lock_guard<std::mutex> lock(tx_oids_mutex_);
-
-            YOGI_ASSERT(pending_handlers_ref);
-            bool is_last_handler = --*pending_handlers_ref == 0;
-            if (!is_last_handler) return;
-
-            if (auto self = weak_self.lock()) {
-              success = self->remove_active_oid(oid);
-            }
-          }
-
-          if (success) {
-            handler(Success(), oid);
-          } else {
-            handler(Error(YOGI_ERR_CANCELED), oid);
-          }
-        });
+        conn->send_async(
+            msg, oid,
+            [=](auto&) {
+              bool success = false;
+
+              {
+                std::lock_guard<std::mutex> lock(tx_oids_mutex_);
+
+                YOGI_ASSERT(pending_handlers_ref);
+                bool is_last_handler = --*pending_handlers_ref == 0;
+                if (!is_last_handler) return;
+
+                if (auto self = weak_self.lock()) {
+                  success = self->remove_active_oid(oid);
+                }
+              }
+
+              if (success) {
+                handler(Success(), oid);
+              } else {
+                handler(Error(YOGI_ERR_CANCELED), oid);
+              }
+            },
+            prio);
       } catch (...) {
         --**pending_handlers;
         throw;
@@ -195,6 +434,368 @@ void BroadcastManager::create_and_increment_counter(SharedCounter* counter) {
   }
 }
 
+void BroadcastManager::enqueue_received_broadcast(const messages::BroadcastIncoming& msg,
+                                                  const BranchConnectionPtr& conn) {
+  auto data = msg.get_payload().get_data();
+  auto raw  = static_cast<const Byte*>(data.data());
+
+  QueuedBroadcast qb;
+  qb.src_uuid = conn->get_remote_branch_info()->get_uuid();
+  qb.payload.assign(raw, raw + data.size());
+  qb.encoding = msg.get_payload().get_encoding();
+
+  switch (rx_queue_policy_) {
+    case RxQueuePolicy::kDropOldest:
+      while (!rx_queue_.empty() && rx_queue_full(qb.payload.size())) {
+        pop_rx_queue();
+      }
+
+      // Broadcasts exceeding the byte limit on their own are never queued
+      if (rx_queue_full(qb.payload.size())) return;
+      break;
+
+    case RxQueuePolicy::kDropNewest:
+      if (rx_queue_full(qb.payload.size())) return;
+      break;
+
+    case RxQueuePolicy::kBlockPeer:
+      if (rx_queue_full(qb.payload.size())) {
+        // Receiving from a peer that has been blocked for too long continues
+        // in order to keep its connection alive; its broadcasts get lost
+        if (conn->receive_pause_expired()) {
+          conn_manager_.report_lost_broadcasts(qb.src_uuid, 1);
+          return;
+        }
+
+        // Broadcasts that are already on their way still get queued, so the
+        // queue can temporarily exceed its limits by one batch per peer
+        conn->pause_receive();
+        if (!is_rx_blocked_peer(conn)) {
+          rx_blocked_peers_.push_back(conn);
+        }
+      }
+      break;
+  }
+
+  rx_queue_bytes_ += qb.payload.size();
+  rx_queue_.push_back(std::move(qb));
+  rx_queue_peak_ = std::max(rx_queue_peak_, rx_queue_.size());
+}
+
+bool BroadcastManager::rx_queue_full(std::size_t additional_bytes) const {
+  if (rx_queue_.size() >= rx_queue_depth_) return true;
+  if (rx_queue_byte_limit_ == 0) return false;
+  return rx_queue_bytes_ + additional_bytes > rx_queue_byte_limit_;
+}
+
+void BroadcastManager::pop_rx_queue() {
+  rx_queue_bytes_ -= rx_queue_.front().payload.size();
+  rx_queue_.pop_front();
+
+  if (!rx_blocked_peers_.empty() && !rx_queue_full(0)) {
+    resume_blocked_peers();
+  }
+}
+
+void BroadcastManager::resume_blocked_peers() {
+  for (auto& weak_conn : rx_blocked_peers_) {
+    if (auto conn = weak_conn.lock()) {
+      conn->resume_receive();
+    }
+  }
+
+  rx_blocked_peers_.clear();
+}
+
+// The receive operation is not available while a broadcast is being streamed
+// into its buffer
+bool BroadcastManager::rx_handler_available() const {
+  return rx_handler_ && std::none_of(rx_reassemblies_.begin(), rx_reassemblies_.end(),
+                                     [](auto& r) { return r.streaming && !r.conn.expired(); });
+}
+
+// Reassembling a message must not use up an unbounded amount of memory, so
+// the connection gets closed if the remote branch announces a huge message
+bool BroadcastManager::check_fragment_size(const messages::FragmentIncoming& frag, const BranchConnectionPtr& conn) {
+  auto msg_size = frag.get_msg_size();
+  if (msg_size > rx_max_msg_size_) {
+    LOG_ERR("Closing connection to " << conn << " since it sent a fragment of a message with " << msg_size
+                                     << " bytes which exceeds the limit of " << rx_max_msg_size_ << " bytes");
+    abort_reassembly(conn, Error(YOGI_ERR_PAYLOAD_TOO_LARGE));
+    return false;
+  }
+
+  if (frag.get_offset() + frag.get_data().size() > msg_size) {
+    LOG_ERR("Closing connection to " << conn << " since it sent a fragment beyond the end of its message: " << frag);
+    abort_reassembly(conn, Error(YOGI_ERR_DESERIALIZE_MSG_FAILED));
+    return false;
+  }
+
+  return true;
+}
+
+void BroadcastManager::abort_reassembly(const BranchConnectionPtr& conn, const Error& err) {
+  remove_erase_if(rx_reassemblies_, [&](auto& r) { return r.conn.lock() == conn; });
+  conn->abort_session(err);
+}
+
+bool BroadcastManager::try_start_reassembly(const messages::FragmentIncoming& frag, const BranchConnectionPtr& conn) {
+  // Nobody would be interested in the message
+  if (!rx_handler_ && rx_queue_depth_ == 0) return false;
+
+  RxReassembly reassembly = {conn, frag.get_msg_size(), 0, false, 0, {}};
+  reassembly.streaming    = can_stream(frag, &reassembly.payload_offset);
+  rx_reassemblies_.push_back(std::move(reassembly));
+
+  return true;
+}
+
+bool BroadcastManager::can_stream(const messages::FragmentIncoming& frag, std::size_t* payload_offset) const {
+  if (!rx_handler_available()) return false;
+
+  auto data = frag.get_data();
+  auto raw  = static_cast<const Byte*>(data.data());
+  if (data.size() < 2 || raw[0] != MessageType::kBroadcast) return false;
+
+  if (raw[1] == Payload::kRawPayloadMarker) {
+    *payload_offset = 2;
+    return rx_encoding_ == YOGI_ENC_RAW;
+  }
+
+  *payload_offset = 1;
+  return rx_encoding_ == YOGI_ENC_MSGPACK;
+}
+
+void BroadcastManager::append_fragment(RxReassembly* reassembly, const messages::FragmentIncoming& frag) {
+  auto data = frag.get_data();
+
+  if (reassembly->streaming) {
+    // Payload bytes beyond the end of the user buffer get dropped
+    auto skip = reassembly->payload_offset > frag.get_offset() ? reassembly->payload_offset - frag.get_offset() : 0;
+    auto pos  = frag.get_offset() + skip - reassembly->payload_offset;
+    if (skip < data.size() && pos < rx_data_.size()) {
+      boost::asio::buffer_copy(rx_data_ + pos, data + skip);
+    }
+  } else {
+    auto raw = static_cast<const Byte*>(data.data());
+    reassembly->msg.insert(reassembly->msg.end(), raw, raw + data.size());
+  }
+
+  reassembly->next_offset += data.size();
+}
+
+void BroadcastManager::finish_reassembly(const RxReassembly& reassembly, const BranchConnectionPtr& conn) {
+  if (reassembly.streaming) {
+    auto handler = rx_handler_;
+    rx_handler_  = {};
+
+    auto payload_size = reassembly.msg_size - reassembly.payload_offset;
+    auto n            = std::min(payload_size, rx_data_.size());
+    Result res        = Success();
+    if (n < payload_size) {
+      res = Error(YOGI_ERR_BUFFER_TOO_SMALL);
+    }
+
+    handler(res, conn->get_remote_branch_info()->get_uuid(), n);
+    return;
+  }
+
+  try {
+    IncomingMessage::deserialize(
+        reassembly.msg,
+        [&](const IncomingMessage& msg) {
+          if (msg.get_type() == MessageType::kBroadcast) {
+            this->on_broadcast_received(static_cast<const messages::BroadcastIncoming&>(msg), conn);
+          } else {
+            LOG_ERR("Fragmented message of unexpected type received from " << conn << ": " << msg);
+          }
+        },
+        rx_max_msg_size_);
+  } catch (const Error& err) {
+    LOG_ERR("Closing connection to " << conn << " since the message reassembled from its fragments is invalid: "
+                                     << err);
+    abort_reassembly(conn, err);
+  }
+}
+
+// Fragments that are still to come for the broadcast being streamed into the
+// buffer of a canceled receive operation get discarded
+void BroadcastManager::stop_rx_stream() {
+  remove_erase_if(rx_reassemblies_, [](auto& r) { return r.streaming; });
+}
+
+// The key is XOR-ed with a key derived from the session secret; since both
+// branches derive the same key, this function wraps and unwraps
+Buffer BroadcastManager::wrap_multicast_key(const Buffer& key, const BranchConnectionPtr& conn) {
+  auto session_key = conn->make_session_key("multicast");
+  YOGI_ASSERT(session_key.size() == key.size());
+
+  Buffer wrapped(key.size());
+  for (std::size_t i = 0; i < key.size(); ++i) {
+    wrapped[i] = key[i] ^ session_key[i];
+  }
+
+  return wrapped;
+}
+
+bool BroadcastManager::is_multicast_datagram_authentic(const MulticastReceiver::Datagram& dgram,
+                                                       const MulticastRxState& state,
+                                                       const BranchConnectionPtr& conn) {
+  auto sender_address = dgram.sender_address;
+  if (sender_address.is_v6() && sender_address.to_v6().is_v4_mapped()) {
+    sender_address = sender_address.to_v6().to_v4();
+  }
+
+  auto peer_address = conn->get_peer_address();
+  if (peer_address.is_v6() && peer_address.to_v6().is_v4_mapped()) {
+    peer_address = peer_address.to_v6().to_v4();
+  }
+
+  if (sender_address != peer_address) return false;
+
+  auto mac = MulticastSender::make_mac(state.key, dgram.header, dgram.msg);
+  auto raw_mac = static_cast<const Byte*>(dgram.mac.data());
+  return mac.size() == dgram.mac.size() && secure_equal(mac.data(), raw_mac, mac.size());
+}
+
+void BroadcastManager::on_multicast_received(const MulticastReceiver::Datagram& dgram) {
+  auto conn = conn_manager_.get_running_session(dgram.uuid);
+  if (!conn || !conn->uses_multicast()) return;
+
+  std::lock_guard<std::recursive_mutex> lock(rx_mutex_);
+  auto state = get_multicast_rx_state(conn);
+  if (state->synced) {
+    handle_multicast_datagram(state, conn, dgram);
+  } else {
+    keep_unsynced_multicast_datagram(state, dgram);
+  }
+}
+
+// Datagrams that arrive before the sync message are only kept for a while
+void BroadcastManager::keep_unsynced_multicast_datagram(MulticastRxState* state,
+                                                        const MulticastReceiver::Datagram& dgram) {
+  auto& unsynced = state->unsynced;
+  if (unsynced.size() >= MulticastSender::kRepairWindowSize) {
+    unsynced.pop_front();
+  }
+
+  Buffer bytes(dgram.header.size() + dgram.msg.size() + dgram.mac.size());
+  boost::asio::buffer_copy(boost::asio::buffer(bytes),
+                           std::array<boost::asio::const_buffer, 3>{dgram.header, dgram.msg, dgram.mac});
+  unsynced.push_back({dgram.sender_address, dgram.seq, std::move(bytes)});
+}
+
+void BroadcastManager::handle_multicast_datagram(MulticastRxState* state, const BranchConnectionPtr& conn,
+                                                 const MulticastReceiver::Datagram& dgram) {
+  if (!is_multicast_datagram_authentic(dgram, *state, conn)) {
+    LOG_WRN("Dropping multicast datagram claiming to be from " << conn << " received from " << dgram.sender_address
+                                                               << " since it could not be authenticated");
+    return;
+  }
+
+  auto seq = dgram.seq;
+  auto msg = dgram.msg;
+
+  // Datagrams without a message carry the sequence number of the last
+  // broadcast; everything up to it that is still missing gets requested again
+  if (msg.size() == 0) {
+    request_multicast_repair(state, conn, state->next_seq, seq + 1);
+    return;
+  }
+
+  request_multicast_repair(state, conn, std::max(state->next_seq, state->nacked_seq), seq);
+  hold_back_multicast_msg(state, seq, msg);
+  deliver_multicast_msgs(state, conn);
+}
+
+BroadcastManager::MulticastRxState* BroadcastManager::get_multicast_rx_state(const BranchConnectionPtr& conn) {
+  remove_erase_if(mc_rx_states_, [](auto& s) { return s.conn.expired(); });
+
+  auto it = find_if(mc_rx_states_, [&](auto& s) { return s.conn.lock() == conn; });
+  if (it != mc_rx_states_.end()) return &*it;
+
+  mc_rx_states_.push_back({conn, false, {}, 0, 0, {}, {}});
+  return &mc_rx_states_.back();
+}
+
+void BroadcastManager::hold_back_multicast_msg(MulticastRxState* state, std::uint64_t seq,
+                                               boost::asio::const_buffer msg) {
+  if (seq < state->next_seq) return;
+
+  auto raw = static_cast<const Byte*>(msg.data());
+  state->held_back.emplace(seq, SmallBuffer(raw, raw + msg.size()));
+}
+
+void BroadcastManager::request_multicast_repair(MulticastRxState* state, const BranchConnectionPtr& conn,
+                                                std::uint64_t first_seq, std::uint64_t end_seq) {
+  if (first_seq >= end_seq) return;
+
+  auto count = static_cast<std::size_t>(std::min<std::uint64_t>(end_seq - first_seq,
+                                                                MulticastSender::kRepairWindowSize));
+
+  // The request gets repeated with the next datagram if the queue is full
+  try {
+    if (!conn->try_send(messages::MulticastNackOutgoing(first_seq, count), TxPriority::kHigh)) return;
+  } catch (const Error& err) {
+    LOG_ERR("Could not request lost broadcasts from " << conn << ": " << err);
+    return;
+  }
+
+  state->nacked_seq = std::max(state->nacked_seq, first_seq + count);
+}
+
+void BroadcastManager::deliver_multicast_msgs(MulticastRxState* state, const BranchConnectionPtr& conn) {
+  if (!state->synced) return;
+
+  auto& held_back = state->held_back;
+  std::uint64_t lost = 0;
+
+  // Broadcasts that could not be repaired in time get skipped
+  if (held_back.size() > MulticastSender::kRepairWindowSize && held_back.begin()->first > state->next_seq) {
+    LOG_WRN("Skipping broadcasts " << state->next_seq << " to " << held_back.begin()->first - 1 << " from " << conn
+                                   << " since they could not be repaired in time");
+    lost += held_back.begin()->first - state->next_seq;
+    state->next_seq = held_back.begin()->first;
+  }
+
+  while (!held_back.empty() && held_back.begin()->first == state->next_seq) {
+    auto msg_bytes = std::move(held_back.begin()->second);
+    held_back.erase(held_back.begin());
+    ++state->next_seq;
+
+    if (msg_bytes.empty()) {
+      ++lost;
+      continue;
+    }
+
+    // Pausing the connection does not stop the datagrams of a blocked peer
+    if (is_rx_blocked_peer(conn)) {
+      ++lost;
+      continue;
+    }
+
+    try {
+      IncomingMessage::deserialize(boost::asio::buffer(msg_bytes.data(), msg_bytes.size()), [&](auto& msg) {
+        if (msg.get_type() == MessageType::kBroadcast) {
+          this->on_broadcast_received(static_cast<const messages::BroadcastIncoming&>(msg), conn);
+        } else {
+          LOG_ERR("Multicast message of unexpected type received from " << conn << ": " << msg);
+        }
+      });
+    } catch (const Error& err) {
+      LOG_ERR("Invalid multicast message received from " << conn << ": " << err);
+    }
+  }
+
+  if (lost > 0) {
+    conn_manager_.report_lost_broadcasts(conn->get_remote_branch_info()->get_uuid(), lost);
+  }
+}
+
+bool BroadcastManager::is_rx_blocked_peer(const BranchConnectionPtr& conn) {
+  return contains_if(rx_blocked_peers_, [&](auto& weak_conn) { return weak_conn.lock() == conn; });
+}
+
 bool BroadcastManager::remove_active_oid(SendBroadcastOperationId oid) {
   auto it = find(tx_active_oids_, oid);
   if (it != tx_active_oids_.end()) {
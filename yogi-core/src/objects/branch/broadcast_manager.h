@@ -25,16 +25,21 @@
 
 #include <src/network/messages.h>
 #include <src/objects/branch/connection_manager.h>
+#include <src/objects/branch/multicast_receiver.h>
+#include <src/objects/branch/multicast_sender.h>
 #include <src/objects/context.h>
 #include <src/objects/logger/log_user.h>
 
 #include <boost/asio/buffer.hpp>
+#include <deque>
+#include <map>
 #include <mutex>
 #include <vector>
 
 class BroadcastManager final : public std::enable_shared_from_this<BroadcastManager>, public LogUser {
  public:
   typedef MessageTransport::OperationTag SendBroadcastOperationId;
+  typedef MessageTransport::TxPriority TxPriority;
   typedef std::function<void(const Result& res, SendBroadcastOperationId oid)> SendBroadcastHandler;
   typedef std::function<void(const Result& res, const boost::uuids::uuid& src_uuid, std::size_t size)>
       ReceiveBroadcastHandler;
@@ -44,23 +49,112 @@ class BroadcastManager final : public std::enable_shared_from_this<BroadcastMana
 
   void start(LocalBranchInfoPtr info);
   Result send_broadcast(const Payload& payload, bool retry);
-  SendBroadcastOperationId send_broadcast_async(const Payload& payload, bool retry, SendBroadcastHandler handler);
+  SendBroadcastOperationId send_broadcast_async(const Payload& payload, bool retry, TxPriority prio,
+                                                SendBroadcastHandler handler);
+  SendBroadcastOperationId send_to_async(const boost::uuids::uuid& uuid, const Payload& payload, bool retry,
+                                         TxPriority prio, SendBroadcastHandler handler);
   bool cancel_send_broadcast(SendBroadcastOperationId oid);
   void receive_broadcast(int encoding, boost::asio::mutable_buffer data, ReceiveBroadcastHandler handler);
   bool cancel_receive_broadcast();
   void on_broadcast_received(const messages::BroadcastIncoming& msg, const BranchConnectionPtr& conn);
+  void on_fragment_received(const messages::FragmentIncoming& frag, const BranchConnectionPtr& conn);
+  void on_multicast_sync_received(const messages::MulticastSyncIncoming& msg, const BranchConnectionPtr& conn);
+  void on_multicast_nack_received(const messages::MulticastNackIncoming& msg, const BranchConnectionPtr& conn);
+  void on_multicast_repair_received(const messages::MulticastRepairIncoming& msg, const BranchConnectionPtr& conn);
+  std::size_t get_receive_queue_peak();
 
  private:
   typedef std::shared_ptr<int> SharedCounter;
 
-  void send_now_or_later(SharedCounter* pending_handlers, OutgoingMessage* msg, BranchConnectionPtr conn,
-                         SendBroadcastHandler handler, SendBroadcastOperationId oid);
+  enum class RxQueuePolicy {
+    kDropOldest,
+    kDropNewest,
+    kBlockPeer,
+  };
+
+  // Broadcast received while no receive operation was pending
+  struct QueuedBroadcast {
+    boost::uuids::uuid src_uuid;
+    SmallBuffer payload;  // MessagePack or raw bytes, depending on encoding
+    int encoding;
+  };
+
+  // Fragmented message that is being received from a connection; broadcasts
+  // that can be passed to the pending receive operation without conversion
+  // get streamed directly into its buffer, everything else is reassembled in
+  // memory first
+  struct RxReassembly {
+    std::weak_ptr<BranchConnection> conn;
+    std::size_t msg_size;
+    std::size_t next_offset;
+    bool streaming;
+    std::size_t payload_offset;  // Start of the payload in the message
+    Buffer msg;                  // Only used if not streaming
+  };
+
+  // Broadcasts received via multicast from a connection get held back until
+  // all broadcasts with lower sequence numbers have been delivered. Datagrams
+  // that arrive before the connection has been synced can only be
+  // authenticated once the sync message with the key has been received.
+  struct UnsyncedDatagram {
+    boost::asio::ip::address sender_address;
+    std::uint64_t seq;
+    Buffer bytes;  // Header, message and MAC
+  };
+
+  struct MulticastRxState {
+    std::weak_ptr<BranchConnection> conn;
+    bool synced;
+    Buffer key;                                      // Only valid if synced
+    std::uint64_t next_seq;                          // Next broadcast to deliver
+    std::uint64_t nacked_seq;                        // Requested up to here
+    std::map<std::uint64_t, SmallBuffer> held_back;  // Empty if lost for good
+    std::deque<UnsyncedDatagram> unsynced;
+  };
+
+  static RxQueuePolicy parse_rx_queue_policy(const std::string& str);
+
+  template <typename ForeachSessionFn>
+  void send_to_sessions(OutgoingMessage* msg, bool retry, TxPriority prio, SendBroadcastHandler handler,
+                        SendBroadcastOperationId oid, ForeachSessionFn foreach_session);
+
+  void send_multicast(OutgoingMessage* msg, bool retry, TxPriority prio, SendBroadcastHandler handler,
+                      SendBroadcastOperationId oid);
+  bool try_use_multicast(const BranchConnectionPtr& conn, std::uint64_t seq);
+
+  void send_now_or_later(SharedCounter* pending_handlers, OutgoingMessage* msg, TxPriority prio,
+                         BranchConnectionPtr conn, SendBroadcastHandler handler, SendBroadcastOperationId oid);
 
   void store_oid_for_later_or_call_handler_now(SharedCounter pending_handlers, SendBroadcastHandler handler,
                                                SendBroadcastOperationId oid);
 
   void create_and_increment_counter(SharedCounter* counter);
   bool remove_active_oid(SendBroadcastOperationId oid);
+  void enqueue_received_broadcast(const messages::BroadcastIncoming& msg, const BranchConnectionPtr& conn);
+  bool rx_queue_full(std::size_t additional_bytes) const;
+  void pop_rx_queue();
+  void resume_blocked_peers();
+  bool rx_handler_available() const;
+  bool check_fragment_size(const messages::FragmentIncoming& frag, const BranchConnectionPtr& conn);
+  void abort_reassembly(const BranchConnectionPtr& conn, const Error& err);
+  bool try_start_reassembly(const messages::FragmentIncoming& frag, const BranchConnectionPtr& conn);
+  bool can_stream(const messages::FragmentIncoming& frag, std::size_t* payload_offset) const;
+  void append_fragment(RxReassembly* reassembly, const messages::FragmentIncoming& frag);
+  void finish_reassembly(const RxReassembly& reassembly, const BranchConnectionPtr& conn);
+  void stop_rx_stream();
+  static Buffer wrap_multicast_key(const Buffer& key, const BranchConnectionPtr& conn);
+  static bool is_multicast_datagram_authentic(const MulticastReceiver::Datagram& dgram,
+                                              const MulticastRxState& state, const BranchConnectionPtr& conn);
+  void on_multicast_received(const MulticastReceiver::Datagram& dgram);
+  void keep_unsynced_multicast_datagram(MulticastRxState* state, const MulticastReceiver::Datagram& dgram);
+  void handle_multicast_datagram(MulticastRxState* state, const BranchConnectionPtr& conn,
+                                 const MulticastReceiver::Datagram& dgram);
+  MulticastRxState* get_multicast_rx_state(const BranchConnectionPtr& conn);
+  void hold_back_multicast_msg(MulticastRxState* state, std::uint64_t seq, boost::asio::const_buffer msg);
+  void request_multicast_repair(MulticastRxState* state, const BranchConnectionPtr& conn, std::uint64_t first_seq,
+                                std::uint64_t end_seq);
+  void deliver_multicast_msgs(MulticastRxState* state, const BranchConnectionPtr& conn);
+  bool is_rx_blocked_peer(const BranchConnectionPtr& conn);
 
   const ContextPtr context_;
   ConnectionManager& conn_manager_;
@@ -72,6 +166,19 @@ class BroadcastManager final : public std::enable_shared_from_this<BroadcastMana
   int rx_encoding_;
   boost::asio::mutable_buffer rx_data_;
   ReceiveBroadcastHandler rx_handler_;
+  std::size_t rx_queue_depth_;
+  std::size_t rx_queue_byte_limit_;
+  std::size_t rx_max_msg_size_;
+  RxQueuePolicy rx_queue_policy_;
+  std::deque<QueuedBroadcast> rx_queue_;
+  std::size_t rx_queue_bytes_;
+  std::size_t rx_queue_peak_;
+  std::vector<std::weak_ptr<BranchConnection>> rx_blocked_peers_;
+  std::vector<RxReassembly> rx_reassemblies_;
+  MulticastSenderPtr mc_sender_;
+  MulticastReceiverPtr mc_receiver_;
+  std::mutex mc_tx_mutex_;
+  std::vector<MulticastRxState> mc_rx_states_;
 };
 
 typedef std::shared_ptr<BroadcastManager> BroadcastManagerPtr;
@@ -0,0 +1,154 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <src/objects/branch/connect_scheduler.h>
+
+#include <algorithm>
+#include <boost/uuid/uuid_io.hpp>
+#include <vector>
+
+YOGI_DEFINE_INTERNAL_LOGGER("Branch.ConnectScheduler")
+
+ConnectScheduler::ConnectScheduler(ContextPtr context, LocalBranchInfoPtr info)
+    : context_(context), info_(info), random_engine_(std::random_device{}()) {
+  set_logging_prefix(info->logging_prefix());
+}
+
+bool ConnectScheduler::schedule(const boost::uuids::uuid& uuid, ConnectFn connect_fn) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = backoffs_.find(uuid);
+    if (it != backoffs_.end() && std::chrono::steady_clock::now() < it->second.retry_after) {
+      return false;
+    }
+
+    auto delay = make_jitter();
+    if (delay.count() > 0) {
+      start_jitter_timer(uuid, connect_fn, delay);
+      return true;
+    }
+
+    queue_.push_back({uuid, connect_fn});
+  }
+
+  start_queued_connects();
+  return true;
+}
+
+void ConnectScheduler::finished(const boost::uuids::uuid& uuid, bool success) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_.erase(uuid)) return;
+
+    if (success) {
+      backoffs_.erase(uuid);
+    } else {
+      increase_backoff(uuid);
+    }
+  }
+
+  start_queued_connects();
+}
+
+// Must be called with mutex_ locked
+std::chrono::nanoseconds ConnectScheduler::make_jitter() {
+  auto max_jitter = info_->get_connect_jitter();
+  if (max_jitter.count() == 0) return {};
+
+  std::uniform_int_distribution<std::chrono::nanoseconds::rep> dist(0, max_jitter.count());
+  return std::chrono::nanoseconds(dist(random_engine_));
+}
+
+// Must be called with mutex_ locked
+void ConnectScheduler::start_jitter_timer(const boost::uuids::uuid& uuid, ConnectFn connect_fn,
+                                          std::chrono::nanoseconds delay) {
+  auto weak_self = make_weak_ptr();
+  auto& wheel    = context_->timing_wheel();
+  auto timer     = wheel.make_entry([weak_self, uuid, connect_fn] {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    {
+      std::lock_guard<std::mutex> lock(self->mutex_);
+      self->jitter_timers_.erase(uuid);
+      self->queue_.push_back({uuid, connect_fn});
+    }
+
+    self->start_queued_connects();
+  });
+
+  jitter_timers_[uuid] = timer;
+  wheel.arm(timer, delay);
+}
+
+// Must be called with mutex_ locked
+void ConnectScheduler::increase_backoff(const boost::uuids::uuid& uuid) {
+  auto max_backoff = info_->get_max_connect_backoff();
+  if (max_backoff.count() == 0) return;
+
+  auto now = std::chrono::steady_clock::now();
+  prune_backoffs(now, max_backoff);
+
+  auto it    = backoffs_.find(uuid);
+  auto delay = it == backoffs_.end() ? info_->get_advertising_interval() : it->second.delay * 2;
+  delay      = std::min(delay, max_backoff);
+
+  backoffs_[uuid] = {delay, now + delay};
+
+  LOG_DBG("Backing off from connecting to [" << uuid << "] for "
+                                              << std::chrono::duration_cast<std::chrono::milliseconds>(delay).count()
+                                              << " ms");
+}
+
+// Must be called with mutex_ locked; branches whose last failed attempt lies
+// further back than the maximum backoff start over, which also keeps branches
+// that have disappeared from piling up
+void ConnectScheduler::prune_backoffs(std::chrono::steady_clock::time_point now,
+                                      std::chrono::nanoseconds max_backoff) {
+  for (auto it = backoffs_.begin(); it != backoffs_.end();) {
+    if (now - it->second.retry_after > max_backoff) {
+      it = backoffs_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void ConnectScheduler::start_queued_connects() {
+  std::vector<ConnectFn> connect_fns;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto max_running = info_->get_max_concurrent_connects();
+    while (!queue_.empty() && (max_running == 0 || running_.size() < max_running)) {
+      running_.insert(queue_.front().uuid);
+      connect_fns.push_back(queue_.front().connect_fn);
+      queue_.pop_front();
+    }
+  }
+
+  // The connect functions may call finished() right away
+  for (auto& fn : connect_fns) {
+    fn();
+  }
+}
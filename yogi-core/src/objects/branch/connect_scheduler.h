@@ -0,0 +1,98 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <src/objects/branch/branch_info.h>
+#include <src/objects/context.h>
+#include <src/objects/logger/log_user.h>
+
+#include <boost/functional/hash.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+class ConnectScheduler;
+typedef std::shared_ptr<ConnectScheduler> ConnectSchedulerPtr;
+typedef std::weak_ptr<ConnectScheduler> ConnectSchedulerWeakPtr;
+
+// Decides when outgoing connections to other branches get established so
+// that branches do not all connect to each other at once, e.g. after a
+// network partition heals. Connection attempts are delayed by a random
+// amount of time, the number of concurrent attempts is limited and branches
+// that could not be connected to are retried with exponential backoff.
+class ConnectScheduler : public std::enable_shared_from_this<ConnectScheduler>, public LogUser {
+ public:
+  typedef std::function<void()> ConnectFn;
+
+  ConnectScheduler(ContextPtr context, LocalBranchInfoPtr info);
+
+  // Returns false if the branch is still backing off from a failed attempt
+  bool schedule(const boost::uuids::uuid& uuid, ConnectFn connect_fn);
+
+  // Has to be called once the connection attempt started by the connect_fn
+  // passed to schedule() has finished; does nothing for other UUIDs
+  void finished(const boost::uuids::uuid& uuid, bool success);
+
+ private:
+  typedef std::unordered_set<boost::uuids::uuid, boost::hash<boost::uuids::uuid>> UuidSet;
+
+  struct QueuedConnect {
+    boost::uuids::uuid uuid;
+    ConnectFn connect_fn;
+  };
+
+  struct Backoff {
+    std::chrono::nanoseconds delay;
+    std::chrono::steady_clock::time_point retry_after;
+  };
+
+  typedef std::unordered_map<boost::uuids::uuid, Backoff, boost::hash<boost::uuids::uuid>> BackoffsMap;
+  typedef std::unordered_map<boost::uuids::uuid, TimingWheelEntryPtr, boost::hash<boost::uuids::uuid>>
+      JitterTimersMap;
+
+  ConnectSchedulerWeakPtr make_weak_ptr() {
+    return {shared_from_this()};
+  }
+
+  std::chrono::nanoseconds make_jitter();
+  void start_jitter_timer(const boost::uuids::uuid& uuid, ConnectFn connect_fn, std::chrono::nanoseconds delay);
+  void increase_backoff(const boost::uuids::uuid& uuid);
+  void prune_backoffs(std::chrono::steady_clock::time_point now, std::chrono::nanoseconds max_backoff);
+  void start_queued_connects();
+
+  const ContextPtr context_;
+  const LocalBranchInfoPtr info_;
+  std::mutex mutex_;
+  std::default_random_engine random_engine_;
+  JitterTimersMap jitter_timers_;
+  std::deque<QueuedConnect> queue_;
+  UuidSet running_;
+  BackoffsMap backoffs_;
+};
@@ -21,6 +21,7 @@
 
 #include <src/api/constants.h>
 #include <src/data/crypto.h>
+#include <src/network/io_uring_transport.h>
 #include <src/objects/branch/connection_manager.h>
 #include <src/system/network_info.h>
 #include <src/util/bind.h>
@@ -32,11 +33,16 @@
 YOGI_DEFINE_INTERNAL_LOGGER("Branch.ConnectionManager")
 
 ConnectionManager::ConnectionManager(ContextPtr context, const nlohmann::json& cfg)
-    : context_(context), last_op_tag_(0), observed_branch_events_(YOGI_BEV_NONE) {
+    : context_(context),
+      sessions_(std::make_unique<std::vector<BranchConnectionPtr>>()),
+      known_uuids_(std::make_unique<UuidSet>()),
+      last_op_tag_(0),
+      observed_branch_events_(YOGI_BEV_NONE) {
   password_hash_ = make_shared_buffer(make_sha256(cfg.value("network_password", std::string{})));
 
   create_adv_sender_and_receiver(cfg);
   create_listener(cfg);
+  create_io_backend(cfg);
 
   YOGI_ASSERT(adv_ep_.port() != 0);
 }
@@ -53,7 +59,12 @@ void ConnectionManager::start(LocalBranchInfoPtr info, ConnectionChangedHandler
 
   set_logging_prefix(info->logging_prefix());
 
+  connect_scheduler_ = std::make_shared<ConnectScheduler>(context_, info_);
   listener_->start(bind_weak(&ConnectionManager::on_accepted, this));
+
+  loopback_listener_ = std::make_shared<LoopbackListener>(context_, info_->get_uuid(), info_->get_timeout(),
+                                                          info_->get_transceive_byte_limit());
+  loopback_listener_->start(bind_weak(&ConnectionManager::on_loopback_accepted, this));
   adv_receiver_->start(info, bind_weak(&ConnectionManager::on_advertisement_received, this));
   adv_sender_->start(info);
 
@@ -75,6 +86,17 @@ ConnectionManager::BranchInfoStringsList ConnectionManager::make_connected_branc
   return branches;
 }
 
+BranchConnectionPtr ConnectionManager::get_running_session(const boost::uuids::uuid& uuid) const {
+  auto sessions = sessions_.read();
+  for (auto& conn : *sessions) {
+    if (conn->get_remote_branch_info()->get_uuid() == uuid && conn->session_running()) {
+      return conn;
+    }
+  }
+
+  return {};
+}
+
 bool ConnectionManager::await_event_async(int branch_events, BranchEventHandler handler) {
   std::lock_guard<std::recursive_mutex> lock(event_mutex_);
 
@@ -95,6 +117,12 @@ bool ConnectionManager::cancel_await_event() {
   return await_event_async(YOGI_BEV_NONE, {});
 }
 
+void ConnectionManager::report_lost_broadcasts(const boost::uuids::uuid& uuid, std::uint64_t count) {
+  emit_branch_event(YOGI_BEV_BROADCASTS_LOST, Error(YOGI_ERR_BROADCASTS_LOST), uuid, [&] {
+    return nlohmann::json{{"uuid", boost::uuids::to_string(uuid)}, {"count", count}};
+  });
+}
+
 ConnectionManager::OperationTag ConnectionManager::make_operation_id() {
   OperationTag tag;
   do {
@@ -118,36 +146,63 @@ void ConnectionManager::create_listener(const nlohmann::json&) {
   listener_ = std::make_shared<TcpListener>(context_, std::vector<std::string>{"all"}, ip_version, "branch");
 }
 
+void ConnectionManager::create_io_backend(const nlohmann::json& cfg) {
+  if (cfg.value("io_backend", "asio") != "io_uring") return;
+
+  io_uring_ = IoUring::try_create(context_->io_context());
+  if (!io_uring_) {
+    LOG_WRN("io_uring is not supported on this system; falling back to asio for TCP connections");
+  }
+}
+
 void ConnectionManager::on_accepted(boost::asio::ip::tcp::socket socket) {
-  auto transport = std::make_shared<TcpTransport>(context_, std::move(socket), info_->get_timeout(),
-                                                  info_->get_transceive_byte_limit(), true);
+  TcpTransportPtr transport;
+  if (io_uring_) {
+    transport = std::make_shared<IoUringTransport>(context_, io_uring_, std::move(socket), info_->get_timeout(),
+                                                   info_->get_transceive_byte_limit(), true);
+  } else {
+    transport = std::make_shared<TcpTransport>(context_, std::move(socket), info_->get_timeout(),
+                                               info_->get_transceive_byte_limit(), true);
+  }
 
   LOG_DBG("Accepted incoming TCP connection from " << make_ip_address_string(transport->get_peer_endpoint()));
 
   start_exchange_branch_info(transport, transport->get_peer_endpoint().address(), {});
 }
 
+void ConnectionManager::on_loopback_accepted(LoopbackTransportPtr transport) {
+  LOG_DBG("Accepted incoming in-process connection");
+
+  start_exchange_branch_info(transport, make_loopback_address(), {});
+}
+
 void ConnectionManager::on_advertisement_received(const boost::uuids::uuid& adv_uuid,
                                                   const boost::asio::ip::tcp::endpoint& ep) {
+  // Almost all advertisements come from branches that we already know, so
+  // they get filtered out without taking connections_mutex_
+  if (known_uuids_.read()->count(adv_uuid)) return;
+
   std::lock_guard<std::mutex> lock(connections_mutex_);
   if (connections_.count(adv_uuid)) return;
   if (blacklisted_uuids_.count(adv_uuid)) return;
   if (pending_connects_.count(adv_uuid)) return;
 
-  LOG_DBG("Attempting to connect to [" << adv_uuid << "] on " << make_ip_address_string(ep) << " port " << ep.port());
+  // Lost sessions get resumed by the branch that created the connection; the
+  // other branch waits for it until the ticket expires
+  if (auto ticket = find_resumption_ticket(adv_uuid)) {
+    if (ticket->is_client) {
+      start_resume(adv_uuid, *ticket);
+    }
 
-  auto weak_self = make_weak_ptr();
-  auto guard     = TcpTransport::connect_async(context_, ep, info_->get_timeout(), info_->get_transceive_byte_limit(),
-                                           [=](auto& res, auto transport, auto guard) {
-                                             auto self = weak_self.lock();
-                                             if (!self) return;
+    return;
+  }
 
-                                             self->connect_guards_.erase(guard);
-                                             self->on_connect_finished(res, adv_uuid, transport);
-                                           });
+  if (!try_connect_in_process(adv_uuid) && !schedule_connect(adv_uuid, ep)) {
+    return;
+  }
 
   pending_connects_.insert(adv_uuid);
-  connect_guards_.insert(guard);
+  adv_sender_->reset_interval();
 
   emit_branch_event(YOGI_BEV_BRANCH_DISCOVERED, Success(), adv_uuid, [&] {
     return nlohmann::json{{"uuid", boost::uuids::to_string(adv_uuid)},
@@ -156,11 +211,66 @@ void ConnectionManager::on_advertisement_received(const boost::uuids::uuid& adv_
   });
 }
 
+bool ConnectionManager::try_connect_in_process(const boost::uuids::uuid& adv_uuid) {
+  auto transport = LoopbackListener::connect(context_, adv_uuid, info_->get_timeout(),
+                                             info_->get_transceive_byte_limit());
+  if (!transport) return false;
+
+  LOG_DBG("Connecting to [" << adv_uuid << "] within the same process");
+
+  auto weak_self = make_weak_ptr();
+  context_->post([=] {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    self->start_exchange_branch_info(transport, self->make_loopback_address(), adv_uuid);
+  });
+
+  return true;
+}
+
+bool ConnectionManager::schedule_connect(const boost::uuids::uuid& adv_uuid,
+                                         const boost::asio::ip::tcp::endpoint& ep) {
+  auto weak_self = make_weak_ptr();
+  return connect_scheduler_->schedule(adv_uuid, [weak_self, adv_uuid, ep] {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    self->start_connect(adv_uuid, ep);
+  });
+}
+
+void ConnectionManager::start_connect(const boost::uuids::uuid& adv_uuid, const boost::asio::ip::tcp::endpoint& ep) {
+  LOG_DBG("Attempting to connect to [" << adv_uuid << "] on " << make_ip_address_string(ep) << " port " << ep.port());
+
+  auto weak_self = make_weak_ptr();
+  auto handler   = [=](auto& res, auto transport, auto guard) {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    self->connect_guards_.erase(guard);
+    self->on_connect_finished(res, adv_uuid, transport);
+  };
+
+  auto guard = TcpTransport::connect_async(context_, ep, info_->get_timeout(), info_->get_transceive_byte_limit(),
+                                           handler, io_uring_);
+  connect_guards_.insert(guard);
+}
+
+boost::asio::ip::address ConnectionManager::make_loopback_address() const {
+  if (adv_ep_.address().is_v4()) {
+    return boost::asio::ip::address_v4::loopback();
+  }
+
+  return boost::asio::ip::address_v6::loopback();
+}
+
 void ConnectionManager::on_connect_finished(const Result& res, const boost::uuids::uuid& adv_uuid,
                                             TcpTransportPtr transport) {
   if (res.is_error()) {
     emit_branch_event(YOGI_BEV_BRANCH_QUERIED, res, adv_uuid);
     pending_connects_.erase(adv_uuid);
+    connect_scheduler_->finished(adv_uuid, false);
     return;
   }
 
@@ -178,6 +288,7 @@ void ConnectionManager::start_exchange_branch_info(TransportPtr transport, const
     this->on_exchange_branch_info_finished(res, weak_conn.lock(), adv_uuid);
     this->stop_keeping_connection_alive(weak_conn);
     this->pending_connects_.erase(adv_uuid);
+    this->connect_scheduler_->finished(adv_uuid, res.is_success());
   });
 }
 
@@ -187,6 +298,11 @@ void ConnectionManager::on_exchange_branch_info_finished(const Result& res, Bran
     return;
   }
 
+  if (conn->resumption_requested()) {
+    on_resumption_requested(conn);
+    return;
+  }
+
   auto remote_info  = conn->get_remote_branch_info();
   auto& remote_uuid = remote_info->get_uuid();
 
@@ -210,7 +326,11 @@ void ConnectionManager::on_exchange_branch_info_finished(const Result& res, Bran
     return;
   }
 
-  con_res.first->second = conn;
+  if (conn_already_exists) {
+    con_res.first->second = conn;
+  }
+
+  publish_snapshots();
 
   if (!conn_already_exists) {
     emit_branch_event(YOGI_BEV_BRANCH_QUERIED, Success(), remote_uuid, [&] { return remote_info->to_json(); });
@@ -338,15 +458,41 @@ void ConnectionManager::on_authenticate_finished(const Result& res, BranchConnec
 
     std::lock_guard<std::mutex> lock(connections_mutex_);
     connections_.erase(uuid);
+    publish_snapshots();
 
     emit_branch_event(YOGI_BEV_CONNECT_FINISHED, res, uuid);
   } else {
     LOG_DBG("Successfully authenticated with " << conn->get_remote_branch_info());
+    start_negotiate_transport(conn);
+  }
+}
+
+void ConnectionManager::start_negotiate_transport(BranchConnectionPtr conn) {
+  auto weak_conn = branch_connection_weak_ptr(conn);
+  conn->negotiate_transport([this, weak_conn](auto& res) {
+    YOGI_ASSERT(weak_conn.lock());
+    this->on_negotiate_transport_finished(res, weak_conn.lock());
+  });
+}
+
+void ConnectionManager::on_negotiate_transport_finished(const Result& res, BranchConnectionPtr conn) {
+  auto& uuid = conn->get_remote_branch_info()->get_uuid();
+
+  if (res.is_error()) {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    connections_.erase(uuid);
+    publish_snapshots();
+
+    emit_branch_event(YOGI_BEV_CONNECT_FINISHED, res, uuid);
+  } else {
+    LOG_DBG("Successfully negotiated transport with " << conn->get_remote_branch_info());
     start_session(conn);
   }
 }
 
 void ConnectionManager::start_session(BranchConnectionPtr conn) {
+  conn->derive_session_secret(*password_hash_);
+
   auto weak_conn = branch_connection_weak_ptr(conn);
   conn->run_session(
       [this, weak_conn](auto& msg) {
@@ -358,6 +504,14 @@ void ConnectionManager::start_session(BranchConnectionPtr conn) {
         this->on_session_terminated(res.to_error(), weak_conn.lock());
       });
 
+  {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    publish_snapshots();
+    issue_resumption_ticket(conn);
+  }
+
+  adv_sender_->reset_interval();
+
   emit_branch_event(YOGI_BEV_CONNECT_FINISHED, Success(), conn->get_remote_branch_info()->get_uuid());
 
   LOG_DBG("Successfully started session for " << conn->get_remote_branch_info());
@@ -369,13 +523,176 @@ void ConnectionManager::on_session_terminated(const Error& err, BranchConnection
   LOG_DBG("Session for " << conn->get_remote_branch_info() << " terminated: " << err);
 
   emit_branch_event(YOGI_BEV_CONNECTION_LOST, err, conn->get_remote_branch_info()->get_uuid());
+  adv_sender_->reset_interval();
 
   std::lock_guard<std::mutex> lock(connections_mutex_);
-  connections_.erase(conn->get_remote_branch_info()->get_uuid());
+  auto& uuid = conn->get_remote_branch_info()->get_uuid();
+  connections_.erase(uuid);
+  publish_snapshots();
+
+  auto it = resumption_tickets_.find(uuid);
+  if (it != resumption_tickets_.end()) {
+    auto& ticket  = it->second;
+    ticket.expiry = std::chrono::steady_clock::now() + ticket.window;
+    if (ticket.is_client) {
+      start_resume(uuid, ticket);
+    }
+  }
 
   connection_changed_handler_(err, conn);
 }
 
+// Must be called with connections_mutex_ locked
+void ConnectionManager::issue_resumption_ticket(const BranchConnectionPtr& conn) {
+  auto remote_info = std::static_pointer_cast<RemoteBranchInfo>(conn->get_remote_branch_info());
+  auto& uuid       = remote_info->get_uuid();
+
+  if (!conn->supports_resumption()) {
+    resumption_tickets_.erase(uuid);
+    return;
+  }
+
+  ResumptionTicket ticket;
+  ticket.ticket      = conn->make_resumption_ticket();
+  ticket.id          = conn->make_resumption_ticket_id();
+  ticket.remote_info = remote_info;
+  ticket.server_ep   = {conn->get_peer_address(), remote_info->get_tcp_server_port()};
+  ticket.is_client   = !conn->created_from_incoming_connection_request();
+  ticket.window      = std::min(info_->get_resumption_window(), remote_info->get_resumption_window());
+  ticket.expiry      = std::chrono::steady_clock::time_point::max();
+
+  resumption_tickets_[uuid] = ticket;
+}
+
+// Must be called with connections_mutex_ locked. Returns nullptr if there is
+// no ticket for a lost session with the given branch that is still valid.
+ConnectionManager::ResumptionTicket* ConnectionManager::find_resumption_ticket(const boost::uuids::uuid& uuid) {
+  auto it = resumption_tickets_.find(uuid);
+  if (it == resumption_tickets_.end()) return nullptr;
+
+  if (it->second.expiry < std::chrono::steady_clock::now()) {
+    LOG_DBG("Resumption ticket for [" << uuid << "] expired");
+    resumption_tickets_.erase(it);
+    return nullptr;
+  }
+
+  return &it->second;
+}
+
+// Must be called with connections_mutex_ locked
+void ConnectionManager::start_resume(const boost::uuids::uuid& uuid, const ResumptionTicket& ticket) {
+  LOG_DBG("Attempting to resume session with [" << uuid << "] on " << make_ip_address_string(ticket.server_ep)
+                                                 << " port " << ticket.server_ep.port());
+
+  pending_connects_.insert(uuid);
+
+  auto weak_self  = make_weak_ptr();
+  auto ticket_buf = ticket.ticket;
+  auto ticket_id  = ticket.id;
+  auto handler    = [=](auto& res, auto transport, auto guard) {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    self->connect_guards_.erase(guard);
+    self->on_resume_connect_finished(res, uuid, ticket_buf, ticket_id, transport);
+  };
+
+  auto guard = TcpTransport::connect_async(context_, ticket.server_ep, info_->get_timeout(),
+                                           info_->get_transceive_byte_limit(), handler, io_uring_);
+  connect_guards_.insert(guard);
+}
+
+void ConnectionManager::on_resume_connect_finished(const Result& res, const boost::uuids::uuid& uuid,
+                                                   SharedBuffer ticket, SharedBuffer ticket_id,
+                                                   TcpTransportPtr transport) {
+  if (res.is_error()) {
+    LOG_DBG("Could not connect to [" << uuid << "] for resuming the session: " << res);
+    pending_connects_.erase(uuid);
+    return;
+  }
+
+  auto conn      = make_connection_and_keep_it_alive(transport->get_peer_endpoint().address(), transport);
+  auto weak_conn = branch_connection_weak_ptr(conn);
+  conn->resume_session(ticket, ticket_id, [this, weak_conn, uuid](auto& res) {
+    YOGI_ASSERT(weak_conn.lock());
+    this->on_resume_finished(res, weak_conn.lock(), uuid);
+    this->stop_keeping_connection_alive(weak_conn);
+    this->pending_connects_.erase(uuid);
+  });
+}
+
+void ConnectionManager::on_resume_finished(const Result& res, BranchConnectionPtr conn,
+                                           const boost::uuids::uuid& uuid) {
+  {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+
+    // The other branch rejected the ticket, so we connect normally instead
+    if (res.is_error() || conn->get_remote_branch_info()->get_uuid() != uuid) {
+      LOG_DBG("Resuming session with [" << uuid << "] failed: " << res);
+      resumption_tickets_.erase(uuid);
+      return;
+    }
+
+    if (!connections_.insert(std::make_pair(uuid, conn)).second) {
+      LOG_DBG("Dropping resumed session with [" << uuid << "] since a connection already exists");
+      return;
+    }
+  }
+
+  LOG_DBG("Successfully resumed session with " << conn->get_remote_branch_info());
+  start_session(conn);
+}
+
+void ConnectionManager::on_resumption_requested(BranchConnectionPtr conn) {
+  auto& uuid = conn->get_resumption_uuid();
+
+  std::lock_guard<std::mutex> lock(connections_mutex_);
+  auto ticket = find_resumption_ticket(uuid);
+  if (!ticket || ticket->is_client || ticket->expiry == std::chrono::steady_clock::time_point::max() ||
+      !secure_equal(*ticket->id, conn->get_received_resumption_ticket_id())) {
+    LOG_WRN("Rejecting invalid request to resume session with [" << uuid << "] from "
+                                                                 << conn->get_peer_description());
+    return;
+  }
+
+  if (!connections_.insert(std::make_pair(uuid, conn)).second) {
+    LOG_DBG("Rejecting request to resume session with [" << uuid << "] since a connection already exists");
+    return;
+  }
+
+  // The ticket stays valid until the other branch has proven that it knows
+  // it; anybody could have seen its ID on the network
+  auto weak_conn = branch_connection_weak_ptr(conn);
+  conn->accept_resumption(ticket->remote_info, ticket->ticket, [this, weak_conn](auto& res) {
+    auto conn = weak_conn.lock();
+    if (!conn) return;
+
+    this->on_resumption_accepted(res, conn);
+  });
+}
+
+void ConnectionManager::on_resumption_accepted(const Result& res, BranchConnectionPtr conn) {
+  auto& uuid = conn->get_remote_branch_info()->get_uuid();
+
+  if (res.is_error()) {
+    LOG_DBG("Resuming session with [" << uuid << "] failed: " << res);
+
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    connections_.erase(uuid);
+    publish_snapshots();
+    return;
+  }
+
+  {
+    // Tickets can only be used once
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    resumption_tickets_.erase(uuid);
+  }
+
+  LOG_DBG("Successfully resumed session with " << conn->get_remote_branch_info());
+  start_session(conn);
+}
+
 BranchConnectionPtr ConnectionManager::make_connection_and_keep_it_alive(const boost::asio::ip::address& peer_address,
                                                                          TransportPtr transport) {
   auto conn = std::make_shared<BranchConnection>(transport, peer_address, info_);
@@ -390,6 +707,23 @@ BranchConnectionPtr ConnectionManager::stop_keeping_connection_alive(const branc
   return conn;
 }
 
+// Must be called with connections_mutex_ locked. Readers keep using the
+// previous snapshots until they are done with them.
+void ConnectionManager::publish_snapshots() {
+  auto sessions    = std::make_unique<std::vector<BranchConnectionPtr>>();
+  auto known_uuids = std::make_unique<UuidSet>(blacklisted_uuids_);
+  for (auto& entry : connections_) {
+    if (entry.second->session_running()) {
+      sessions->push_back(entry.second);
+    }
+
+    known_uuids->insert(entry.first);
+  }
+
+  sessions_.publish(std::move(sessions));
+  known_uuids_.publish(std::move(known_uuids));
+}
+
 template <typename Fn>
 void ConnectionManager::emit_branch_event(int branch_event, const Result& ev_res, const boost::uuids::uuid& uuid,
                                           Fn make_json_fn) {
@@ -429,5 +763,9 @@ void ConnectionManager::log_branch_event(int branch_event, const Result& ev_res,
     case YOGI_BEV_CONNECTION_LOST:
       LOG_WRN("Event: YOGI_BEV_CONNECTION_LOST; ev_res=\"" << ev_res << "; json=\"" << make_json_fn() << "\"");
       break;
+
+    case YOGI_BEV_BROADCASTS_LOST:
+      LOG_WRN("Event: YOGI_BEV_BROADCASTS_LOST; ev_res=\"" << ev_res << "; json=\"" << make_json_fn() << "\"");
+      break;
   }
 }
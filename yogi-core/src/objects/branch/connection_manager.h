@@ -23,21 +23,27 @@
 
 #include <src/config.h>
 
+#include <src/network/loopback_listener.h>
 #include <src/network/tcp_listener.h>
 #include <src/network/tcp_transport.h>
 #include <src/objects/branch/advertising_receiver.h>
 #include <src/objects/branch/advertising_sender.h>
 #include <src/objects/branch/branch_connection.h>
+#include <src/objects/branch/connect_scheduler.h>
 #include <src/system/network_info.h>
+#include <src/util/snapshot.h>
 
 #include <atomic>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/functional/hash.hpp>
+#include <chrono>
+#include <memory>
 #include <mutex>
 #include <nlohmann/json.hpp>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 class ConnectionManager;
 typedef std::shared_ptr<ConnectionManager> ConnectionManagerPtr;
@@ -73,14 +79,22 @@ class ConnectionManager : public std::enable_shared_from_this<ConnectionManager>
 
   BranchInfoStringsList make_connected_branches_info_strings() const;
 
+  // Returns nullptr if no session with the given branch is running
+  BranchConnectionPtr get_running_session(const boost::uuids::uuid& uuid) const;
+
   bool await_event_async(int branch_events, BranchEventHandler handler);
   bool cancel_await_event();
 
+  // Emits YOGI_BEV_BROADCASTS_LOST for broadcasts from the given branch that
+  // will never be delivered
+  void report_lost_broadcasts(const boost::uuids::uuid& uuid, std::uint64_t count);
+
+  // Iterates over a snapshot of the running sessions without taking
+  // connections_mutex_; the sessions may terminate while fn is being called
   template <typename Fn>
   void foreach_running_session(Fn fn) {
-    std::lock_guard<std::mutex> lock(connections_mutex_);
-    for (auto& entry : connections_) {
-      auto& conn = entry.second;
+    auto sessions = sessions_.read();
+    for (auto& conn : *sessions) {
       if (conn->session_running()) {
         fn(conn);
       }
@@ -98,14 +112,36 @@ class ConnectionManager : public std::enable_shared_from_this<ConnectionManager>
   typedef std::set<TcpTransport::ConnectGuardPtr> ConnectGuardsSet;
   typedef std::set<BranchConnectionPtr> ConnectionsSet;
 
+  // Issued when a TCP session starts; the branch that created the connection
+  // can use it to resume the session without exchanging branch info and
+  // authenticating again if the session gets lost
+  struct ResumptionTicket {
+    SharedBuffer ticket;
+    SharedBuffer id;
+    RemoteBranchInfoPtr remote_info;
+    boost::asio::ip::tcp::endpoint server_ep;
+    bool is_client;
+    std::chrono::nanoseconds window;
+    std::chrono::steady_clock::time_point expiry;  // max() while the session is running
+  };
+
+  typedef std::unordered_map<boost::uuids::uuid, ResumptionTicket, boost::hash<boost::uuids::uuid>>
+      ResumptionTicketsMap;
+
   ConnectionManagerWeakPtr make_weak_ptr() {
     return {shared_from_this()};
   }
 
   void create_adv_sender_and_receiver(const nlohmann::json& cfg);
   void create_listener(const nlohmann::json& cfg);
+  void create_io_backend(const nlohmann::json& cfg);
   void on_accepted(boost::asio::ip::tcp::socket socket);
+  void on_loopback_accepted(LoopbackTransportPtr transport);
   void on_advertisement_received(const boost::uuids::uuid& adv_uuid, const boost::asio::ip::tcp::endpoint& ep);
+  bool try_connect_in_process(const boost::uuids::uuid& adv_uuid);
+  bool schedule_connect(const boost::uuids::uuid& adv_uuid, const boost::asio::ip::tcp::endpoint& ep);
+  void start_connect(const boost::uuids::uuid& adv_uuid, const boost::asio::ip::tcp::endpoint& ep);
+  boost::asio::ip::address make_loopback_address() const;
   void on_connect_finished(const Result& res, const boost::uuids::uuid& adv_uuid, TcpTransportPtr transport);
   void start_exchange_branch_info(TransportPtr transport, const boost::asio::ip::address& peer_address,
                                   const boost::uuids::uuid& adv_uuid);
@@ -119,11 +155,22 @@ class ConnectionManager : public std::enable_shared_from_this<ConnectionManager>
   Result check_remote_branch_info(const BranchInfoPtr& remote_info);
   void start_authenticate(BranchConnectionPtr conn);
   void on_authenticate_finished(const Result& res, BranchConnectionPtr conn);
+  void start_negotiate_transport(BranchConnectionPtr conn);
+  void on_negotiate_transport_finished(const Result& res, BranchConnectionPtr conn);
   void start_session(BranchConnectionPtr conn);
   void on_session_terminated(const Error& err, BranchConnectionPtr conn);
+  void issue_resumption_ticket(const BranchConnectionPtr& conn);
+  ResumptionTicket* find_resumption_ticket(const boost::uuids::uuid& uuid);
+  void start_resume(const boost::uuids::uuid& uuid, const ResumptionTicket& ticket);
+  void on_resume_connect_finished(const Result& res, const boost::uuids::uuid& uuid, SharedBuffer ticket,
+                                  SharedBuffer ticket_id, TcpTransportPtr transport);
+  void on_resume_finished(const Result& res, BranchConnectionPtr conn, const boost::uuids::uuid& uuid);
+  void on_resumption_requested(BranchConnectionPtr conn);
+  void on_resumption_accepted(const Result& res, BranchConnectionPtr conn);
   BranchConnectionPtr make_connection_and_keep_it_alive(const boost::asio::ip::address& peer_address,
                                                         TransportPtr transport);
   BranchConnectionPtr stop_keeping_connection_alive(const branch_connection_weak_ptr& weak_conn);
+  void publish_snapshots();
 
   template <typename Fn>
   void emit_branch_event(int branch_event, const Result& ev_res, const boost::uuids::uuid& uuid, Fn make_json_fn);
@@ -141,6 +188,9 @@ class ConnectionManager : public std::enable_shared_from_this<ConnectionManager>
   AdvertisingSenderPtr adv_sender_;
   AdvertisingReceiverPtr adv_receiver_;
   TcpListenerPtr listener_;
+  LoopbackListenerPtr loopback_listener_;
+  IoUringPtr io_uring_;
+  ConnectSchedulerPtr connect_scheduler_;
   ConnectGuardsSet connect_guards_;
   ConnectionsSet connections_kept_alive_;
   LocalBranchInfoPtr info_;
@@ -149,6 +199,9 @@ class ConnectionManager : public std::enable_shared_from_this<ConnectionManager>
   UuidSet pending_connects_;
   ConnectionsMap connections_;
   mutable std::mutex connections_mutex_;
+  mutable Snapshot<std::vector<BranchConnectionPtr>> sessions_;  // Replaced whenever connections_ changes
+  Snapshot<UuidSet> known_uuids_;                                // Keys of connections_ and blacklisted UUIDs
+  ResumptionTicketsMap resumption_tickets_;
 
   std::atomic<OperationTag> last_op_tag_;
 
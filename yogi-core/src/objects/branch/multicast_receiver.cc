@@ -0,0 +1,122 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <src/api/constants.h>
+#include <src/api/errors.h>
+#include <src/network/serialize.h>
+#include <src/network/udp_multicast.h>
+#include <src/objects/branch/multicast_receiver.h>
+#include <src/objects/branch/multicast_sender.h>
+
+#include <boost/endian/arithmetic.hpp>
+#include <cstring>
+
+YOGI_DEFINE_INTERNAL_LOGGER("Branch.MulticastReceiver")
+
+MulticastReceiver::MulticastReceiver(ContextPtr context, const boost::asio::ip::udp::endpoint& group_ep)
+    : context_(context), group_ep_(group_ep), socket_(context->io_context()) {
+  buffer_ = make_shared_buffer(MulticastSender::kMaxDatagramSize + 1);
+
+  open_multicast_rx_socket(&socket_, group_ep_);
+}
+
+void MulticastReceiver::start(LocalBranchInfoPtr info, ObserverFn observer_fn) {
+  YOGI_ASSERT(!info_);
+  observer_fn_ = observer_fn;
+
+  info_ = info;
+  set_logging_prefix(info->logging_prefix());
+
+  if (!join_multicast_groups()) {
+    throw DescriptiveError(YOGI_ERR_JOIN_MULTICAST_GROUP_FAILED)
+        << "No network interfaces available for receiving broadcasts via multicast";
+  }
+
+  start_receive_datagram();
+}
+
+bool MulticastReceiver::join_multicast_groups() {
+  bool joined_at_least_once = false;
+  for (auto& ifc : info_->get_advertising_interfaces()) {
+    for (auto& addr : ifc.addresses) {
+      auto ec = join_multicast_group(&socket_, group_ep_, addr);
+      if (ec) {
+        LOG_ERR("Could not join broadcast multicast group " << group_ep_ << " for interface " << addr << ": "
+                                                            << ec.message() << ". This interface will be ignored.");
+        continue;
+      }
+
+      LOG_IFO("Using interface " << addr << " for receiving broadcasts from " << group_ep_);
+      joined_at_least_once = true;
+    }
+  }
+
+  return joined_at_least_once;
+}
+
+void MulticastReceiver::start_receive_datagram() {
+  auto buffer    = buffer_;
+  auto weak_self = std::weak_ptr<MulticastReceiver>{shared_from_this()};
+  socket_.async_receive_from(boost::asio::buffer(*buffer_), sender_ep_, [weak_self, buffer](auto ec, auto bytes) {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    self->on_receive_datagram_finished(ec, bytes);
+  });
+}
+
+void MulticastReceiver::on_receive_datagram_finished(const boost::system::error_code& ec,
+                                                     std::size_t bytes_received) {
+  if (ec) {
+    LOG_ERR("Failed to receive multicast datagram: " << ec.message()
+                                                     << ". No more broadcasts will be received via multicast.");
+    return;
+  }
+
+  auto& buffer = *buffer_;
+  if (bytes_received < MulticastSender::kDatagramHeaderSize + MulticastSender::kMacSize ||
+      bytes_received > MulticastSender::kMaxDatagramSize ||
+      std::memcmp(buffer.data(), "YOGI", 5) || buffer[5] != constants::kVersionMajor) {
+    LOG_WRN("Invalid multicast datagram received from " << sender_ep_.address());
+    start_receive_datagram();
+    return;
+  }
+
+  Datagram dgram;
+  dgram.sender_address = sender_ep_.address();
+
+  auto it = buffer.cbegin() + 7;
+  deserialize(&dgram.uuid, buffer, &it);
+  deserialize_integer<boost::endian::big_uint64_t>(&dgram.seq, buffer, &it);
+
+  auto msg_size = bytes_received - MulticastSender::kDatagramHeaderSize - MulticastSender::kMacSize;
+  dgram.header  = boost::asio::buffer(buffer.data(), MulticastSender::kDatagramHeaderSize);
+  dgram.msg     = boost::asio::buffer(buffer.data() + MulticastSender::kDatagramHeaderSize, msg_size);
+  dgram.mac     = boost::asio::buffer(buffer.data() + MulticastSender::kDatagramHeaderSize + msg_size,
+                                      MulticastSender::kMacSize);
+
+  // Ignore datagrams that we sent ourself
+  if (dgram.uuid != info_->get_uuid()) {
+    observer_fn_(dgram);
+  }
+
+  start_receive_datagram();
+}
@@ -0,0 +1,70 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <src/objects/branch/branch_info.h>
+#include <src/objects/context.h>
+#include <src/objects/logger/log_user.h>
+
+#include <boost/asio/ip/udp.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+// Receives the datagrams sent by the MulticastSender instances of other
+// branches. The datagrams are not authenticated yet since only the observer
+// knows the keys of the senders.
+class MulticastReceiver : public std::enable_shared_from_this<MulticastReceiver>, public LogUser {
+ public:
+  struct Datagram {
+    boost::asio::ip::address sender_address;
+    boost::uuids::uuid uuid;
+    std::uint64_t seq;
+    boost::asio::const_buffer header;
+    boost::asio::const_buffer msg;  // Empty for datagrams that only carry seq
+    boost::asio::const_buffer mac;
+  };
+
+  typedef std::function<void(const Datagram& datagram)> ObserverFn;
+
+  MulticastReceiver(ContextPtr context, const boost::asio::ip::udp::endpoint& group_ep);
+
+  void start(LocalBranchInfoPtr info, ObserverFn observer_fn);
+
+ private:
+  bool join_multicast_groups();
+  void start_receive_datagram();
+  void on_receive_datagram_finished(const boost::system::error_code& ec, std::size_t bytes_received);
+
+  const ContextPtr context_;
+  const boost::asio::ip::udp::endpoint group_ep_;
+  ObserverFn observer_fn_;
+  SharedBuffer buffer_;
+  LocalBranchInfoPtr info_;
+  boost::asio::ip::udp::socket socket_;
+  boost::asio::ip::udp::endpoint sender_ep_;
+};
+
+typedef std::shared_ptr<MulticastReceiver> MulticastReceiverPtr;
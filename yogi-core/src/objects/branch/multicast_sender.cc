@@ -0,0 +1,176 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <src/api/constants.h>
+#include <src/api/errors.h>
+#include <src/data/crypto.h>
+#include <src/network/serialize.h>
+#include <src/network/udp_multicast.h>
+#include <src/objects/branch/multicast_sender.h>
+#include <src/util/bind.h>
+
+#include <array>
+#include <boost/endian/arithmetic.hpp>
+
+YOGI_DEFINE_INTERNAL_LOGGER("Branch.MulticastSender")
+
+Buffer MulticastSender::make_datagram_header(const boost::uuids::uuid& uuid, std::uint64_t seq) {
+  Buffer buffer{'Y', 'O', 'G', 'I', 0};
+  buffer.push_back(constants::kVersionMajor);
+  buffer.push_back(constants::kVersionMinor);
+  serialize(&buffer, uuid);
+  serialize_integer<boost::endian::big_uint64_t>(&buffer, seq);
+
+  YOGI_ASSERT(buffer.size() == kDatagramHeaderSize);
+  return buffer;
+}
+
+Buffer MulticastSender::make_mac(const Buffer& key, boost::asio::const_buffer header, boost::asio::const_buffer msg) {
+  Buffer data(header.size() + msg.size());
+  boost::asio::buffer_copy(boost::asio::buffer(data), std::array<boost::asio::const_buffer, 2>{header, msg});
+
+  auto mac = make_hmac_sha256(key, data.data(), data.size());
+  mac.resize(kMacSize);
+  return mac;
+}
+
+MulticastSender::MulticastSender(ContextPtr context, const boost::asio::ip::udp::endpoint& group_ep)
+    : context_(context),
+      group_ep_(group_ep),
+      key_(generate_random_bytes(kKeySize)),
+      next_seq_(1),
+      tail_heartbeat_timer_(context->io_context()),
+      tail_heartbeat_timer_running_(false),
+      tail_heartbeats_left_(0) {
+}
+
+void MulticastSender::start(LocalBranchInfoPtr info) {
+  YOGI_ASSERT(!info_);
+
+  info_ = info;
+  set_logging_prefix(info->logging_prefix());
+
+  setup_sockets();
+  if (sockets_.empty()) {
+    throw DescriptiveError(YOGI_ERR_SET_SOCKET_OPTION_FAILED)
+        << "No network interfaces available for sending broadcasts via multicast";
+  }
+
+  for (auto& socket : sockets_) {
+    LOG_IFO("Using interface " << socket->address << " for sending broadcasts to " << group_ep_);
+  }
+}
+
+std::uint64_t MulticastSender::get_next_seq() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return next_seq_;
+}
+
+void MulticastSender::send(SharedSmallBuffer msg_bytes) {
+  YOGI_ASSERT(msg_bytes->size() <= kMaxMsgSize);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto seq = next_seq_++;
+
+  sent_msgs_.push_back({seq, msg_bytes});
+  if (sent_msgs_.size() > kRepairWindowSize) {
+    sent_msgs_.pop_front();
+  }
+
+  send_datagram(seq, *msg_bytes);
+  start_tail_heartbeats();
+}
+
+SharedSmallBuffer MulticastSender::get_sent_msg(std::uint64_t seq) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (sent_msgs_.empty() || seq < sent_msgs_.front().seq || seq > sent_msgs_.back().seq) {
+    return {};
+  }
+
+  return sent_msgs_[static_cast<std::size_t>(seq - sent_msgs_.front().seq)].msg_bytes;
+}
+
+void MulticastSender::setup_sockets() {
+  for (auto& ifc : info_->get_advertising_interfaces()) {
+    for (auto& addr : ifc.addresses) {
+      auto entry     = std::make_unique<SocketEntry>(context_->io_context());
+      entry->address = addr;
+
+      auto ec = open_multicast_tx_socket(&entry->socket, group_ep_, addr);
+      if (ec) {
+        LOG_ERR("Could not set outbound interface for socket using address "
+                << addr << ": " << ec.message() << ". This interface will not be used for multicast broadcasts.");
+        continue;
+      }
+
+      sockets_.push_back(std::move(entry));
+    }
+  }
+}
+
+// Datagrams that cannot be sent get treated like lost datagrams, i.e. the
+// receivers request them over their connection
+void MulticastSender::send_datagram(std::uint64_t seq, const SmallBuffer& msg_bytes) {
+  auto hdr = make_datagram_header(info_->get_uuid(), seq);
+  auto msg = boost::asio::buffer(msg_bytes.data(), msg_bytes.size());
+  auto mac = make_mac(key_, boost::asio::buffer(hdr), msg);
+
+  std::array<boost::asio::const_buffer, 3> buffers = {boost::asio::buffer(hdr), msg, boost::asio::buffer(mac)};
+
+  for (auto& socket : sockets_) {
+    boost::system::error_code ec;
+    socket->socket.send_to(buffers, group_ep_, 0, ec);
+    if (ec) {
+      LOG_WRN("Sending multicast datagram over " << socket->address << " failed: " << ec.message());
+    }
+  }
+}
+
+void MulticastSender::start_tail_heartbeats() {
+  tail_heartbeats_left_ = kTailHeartbeatCount;
+  if (tail_heartbeat_timer_running_) return;
+
+  tail_heartbeat_timer_running_ = true;
+  start_tail_heartbeat_timer();
+}
+
+void MulticastSender::start_tail_heartbeat_timer() {
+  tail_heartbeat_timer_.expires_after(kTailHeartbeatInterval);
+  tail_heartbeat_timer_.async_wait(bind_weak(&MulticastSender::on_tail_heartbeat_timer_expired, this));
+}
+
+void MulticastSender::on_tail_heartbeat_timer_expired(const boost::system::error_code& ec) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (ec) {
+    LOG_ERR("Awaiting tail heartbeat timer expiry failed: " << ec.message());
+    tail_heartbeat_timer_running_ = false;
+    return;
+  }
+
+  send_datagram(next_seq_ - 1, {});
+
+  if (--tail_heartbeats_left_ > 0) {
+    start_tail_heartbeat_timer();
+  } else {
+    tail_heartbeat_timer_running_ = false;
+  }
+}
@@ -0,0 +1,114 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <src/objects/branch/branch_info.h>
+#include <src/objects/context.h>
+#include <src/objects/logger/log_user.h>
+
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Sends serialized broadcast messages as UDP multicast datagrams. Each
+// datagram consists of the magic prefix, the version, the UUID of the sending
+// branch and the sequence number of the broadcast, followed by the serialized
+// broadcast message and a MAC over everything before it. A few datagrams
+// without a message get sent after the last broadcast so that receivers can
+// detect if the last datagrams got lost. The sequence number of such a
+// datagram is the one of the last broadcast.
+//
+// The MAC key is created randomly when the sender starts and is passed to
+// each connected branch over its authenticated connection.
+class MulticastSender : public std::enable_shared_from_this<MulticastSender>, public LogUser {
+ public:
+  enum {
+    kDatagramHeaderSize = 31,
+    kMacSize            = 16,    // Truncated HMAC-SHA256
+    kKeySize            = 32,
+    kMaxDatagramSize    = 1472,  // Avoids IP fragmentation on Ethernet links
+    kMaxMsgSize         = kMaxDatagramSize - kDatagramHeaderSize - kMacSize,
+  };
+
+  // Number of sent broadcasts that are kept for repairing lost datagrams
+  static constexpr std::size_t kRepairWindowSize = 1024;
+
+  static Buffer make_datagram_header(const boost::uuids::uuid& uuid, std::uint64_t seq);
+  static Buffer make_mac(const Buffer& key, boost::asio::const_buffer header, boost::asio::const_buffer msg);
+
+  MulticastSender(ContextPtr context, const boost::asio::ip::udp::endpoint& group_ep);
+  void start(LocalBranchInfoPtr info);
+
+  const Buffer& get_key() const {
+    return key_;
+  }
+
+  // Sequence number that the next call to send() will use
+  std::uint64_t get_next_seq();
+  void send(SharedSmallBuffer msg_bytes);
+
+  // Returns nullptr if the broadcast is not in the repair window anymore
+  SharedSmallBuffer get_sent_msg(std::uint64_t seq);
+
+ private:
+  struct SocketEntry {
+    boost::asio::ip::address address;
+    boost::asio::ip::udp::socket socket;
+
+    SocketEntry(boost::asio::io_context& ioc) : socket(ioc) {
+    }
+  };
+
+  struct SentMsg {
+    std::uint64_t seq;
+    SharedSmallBuffer msg_bytes;
+  };
+
+  static constexpr std::chrono::milliseconds kTailHeartbeatInterval{10};
+  static constexpr int kTailHeartbeatCount = 3;
+
+  void setup_sockets();
+  void send_datagram(std::uint64_t seq, const SmallBuffer& msg_bytes);
+  void start_tail_heartbeats();
+  void start_tail_heartbeat_timer();
+  void on_tail_heartbeat_timer_expired(const boost::system::error_code& ec);
+
+  const ContextPtr context_;
+  const boost::asio::ip::udp::endpoint group_ep_;
+  LocalBranchInfoPtr info_;
+  const Buffer key_;
+  std::vector<std::unique_ptr<SocketEntry>> sockets_;
+  std::mutex mutex_;
+  std::uint64_t next_seq_;
+  std::deque<SentMsg> sent_msgs_;
+  boost::asio::steady_timer tail_heartbeat_timer_;
+  bool tail_heartbeat_timer_running_;
+  int tail_heartbeats_left_;
+};
+
+typedef std::shared_ptr<MulticastSender> MulticastSenderPtr;
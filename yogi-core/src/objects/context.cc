@@ -28,7 +28,7 @@
 
 YOGI_DEFINE_INTERNAL_LOGGER("Context")
 
-Context::Context() : ioc_(1), work_(ioc_), running_(false) {
+Context::Context() : ioc_(1), work_(ioc_), timing_wheel_(ioc_), running_(false) {
   set_logging_prefix(*this);
 }
 
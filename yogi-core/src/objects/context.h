@@ -26,6 +26,7 @@
 #include <src/api/object.h>
 #include <src/objects/logger/log_user.h>
 #include <src/util/time.h>
+#include <src/util/timing_wheel.h>
 
 #include <boost/asio/io_context.hpp>
 
@@ -42,6 +43,10 @@ class Context : public ExposedObjectT<Context, ObjectType::kContext>, public Log
     return ioc_;
   }
 
+  TimingWheel& timing_wheel() {
+    return timing_wheel_;
+  }
+
   int poll();
   int poll_one();
   int run(Duration duration);
@@ -61,6 +66,7 @@ class Context : public ExposedObjectT<Context, ObjectType::kContext>, public Log
 
   boost::asio::io_context ioc_;
   boost::asio::io_context::work work_;
+  TimingWheel timing_wheel_;
   bool running_;
   std::mutex mutex_;
   std::condition_variable cv_;
@@ -103,10 +103,27 @@ const char kBranchConfig[] = R"raw({
     "advertising_address":    { "$ref": "branch_properties.schema.json#/properties/advertising_address" },
     "advertising_port":       { "$ref": "branch_properties.schema.json#/properties/advertising_port" },
     "advertising_interval":   { "$ref": "branch_properties.schema.json#/properties/advertising_interval" },
+    "max_advertising_interval": { "$ref": "branch_properties.schema.json#/properties/max_advertising_interval" },
+    "max_concurrent_connects": { "$ref": "branch_properties.schema.json#/properties/max_concurrent_connects" },
+    "connect_jitter":         { "$ref": "branch_properties.schema.json#/properties/connect_jitter" },
+    "max_connect_backoff":    { "$ref": "branch_properties.schema.json#/properties/max_connect_backoff" },
     "timeout":                { "$ref": "branch_properties.schema.json#/properties/timeout" },
     "ghost_mode":             { "$ref": "branch_properties.schema.json#/properties/ghost_mode" },
     "tx_queue_size":          { "$ref": "branch_properties.schema.json#/properties/tx_queue_size" },
     "rx_queue_size":          { "$ref": "branch_properties.schema.json#/properties/rx_queue_size" },
+    "mirrored_queues":        { "$ref": "branch_properties.schema.json#/properties/mirrored_queues" },
+    "tx_coalescing_delay":    { "$ref": "branch_properties.schema.json#/properties/tx_coalescing_delay" },
+    "tx_coalescing_bytes":    { "$ref": "branch_properties.schema.json#/properties/tx_coalescing_bytes" },
+    "io_backend":             { "$ref": "branch_properties.schema.json#/properties/io_backend" },
+    "shm_transport":          { "$ref": "branch_properties.schema.json#/properties/shm_transport" },
+    "zero_copy_threshold":    { "$ref": "branch_properties.schema.json#/properties/zero_copy_threshold" },
+    "broadcast_queue_depth":  { "$ref": "branch_properties.schema.json#/properties/broadcast_queue_depth" },
+    "broadcast_queue_bytes":  { "$ref": "branch_properties.schema.json#/properties/broadcast_queue_bytes" },
+    "broadcast_queue_policy": { "$ref": "branch_properties.schema.json#/properties/broadcast_queue_policy" },
+    "max_broadcast_size":     { "$ref": "branch_properties.schema.json#/properties/max_broadcast_size" },
+    "compression_threshold":  { "$ref": "branch_properties.schema.json#/properties/compression_threshold" },
+    "broadcast_multicast_port": { "$ref": "branch_properties.schema.json#/properties/broadcast_multicast_port" },
+    "resumption_window": { "$ref": "branch_properties.schema.json#/properties/resumption_window" },
 
     "_transceive_byte_limit": {
       "title": "DO NOT USE! Transceive byte limit",
@@ -214,6 +231,38 @@ const char kBranchProperties[] = R"raw({
       "anyOf": [{ "const": "null" }, { "minimum": 0.001 }],
       "default": 1.0
     },
+    "max_advertising_interval": {
+      "title": "Maximum advertising interval",
+      "description": "Upper limit for the time between advertising messages. The interval doubles with every advertising message while no branches connect or disconnect and falls back to the advertising interval as soon as they do; 0 disables the backoff.",
+      "type": "number",
+      "minimum": 0,
+      "default": 0,
+      "examples": [30.0]
+    },
+    "max_concurrent_connects": {
+      "title": "Maximum number of concurrent connection attempts",
+      "description": "Maximum number of outgoing connections to other branches that are being established at the same time; further attempts are queued. 0 means unlimited.",
+      "type": "integer",
+      "minimum": 0,
+      "default": 0,
+      "examples": [8]
+    },
+    "connect_jitter": {
+      "title": "Connect jitter",
+      "description": "Upper limit for the random delay before connecting to a newly discovered branch so that branches do not all connect at once, e.g. after a network partition heals; 0 disables the delay.",
+      "type": "number",
+      "minimum": 0,
+      "default": 0,
+      "examples": [0.5]
+    },
+    "max_connect_backoff": {
+      "title": "Maximum connect backoff",
+      "description": "Upper limit for the time to wait before connecting to a branch again after the previous attempt failed. The time starts at the advertising interval and doubles with every failed attempt; 0 disables the backoff.",
+      "type": "number",
+      "minimum": 0,
+      "default": 0,
+      "examples": [60.0]
+    },
     "tcp_server_address": {
       "title": "TCP address for branch connections",
       "description": "TCP address that the branch listens on for connections from other branches",
@@ -242,7 +291,7 @@ const char kBranchProperties[] = R"raw({
     },
     "tx_queue_size": {
       "title": "Send queue size",
-      "description": "Size of the send queues for remote branches.",
+      "description": "Size of the send queues for remote branches. High priority messages have their own send queue with an eighth of this size, but at least 35000 bytes.",
       "type": "integer",
       "minimum": 35000,
       "maximum": 10000000,
@@ -255,6 +304,110 @@ const char kBranchProperties[] = R"raw({
       "minimum": 35000,
       "maximum": 10000000,
       "default": 35000
+    },
+    "mirrored_queues": {
+      "title": "Mirrored queues",
+      "description": "Map the memory of the send and receive queues twice back-to-back so that queued data is always contiguous in memory. Falls back to normal queues if the platform does not support it.",
+      "type": "boolean",
+      "default": false
+    },
+    "tx_coalescing_delay": {
+      "title": "Send coalescing delay",
+      "description": "Maximum amount of time that messages are held back in the send queues so that several of them can be written to the network at once; 0 disables coalescing.",
+      "type": "number",
+      "minimum": 0,
+      "default": 0
+    },
+    "tx_coalescing_bytes": {
+      "title": "Send coalescing threshold",
+      "description": "Number of bytes in a send queue at which held back messages are written immediately, regardless of the coalescing delay; 0 means that only the delay applies.",
+      "type": "integer",
+      "minimum": 0,
+      "maximum": 10000000,
+      "default": 0
+    },
+    "io_backend": {
+      "title": "I/O backend",
+      "description": "Mechanism used for sending and receiving data on TCP connections to remote branches. The io_uring backend is only available on Linux; the branch falls back to asio if the kernel does not support it.",
+      "type": "string",
+      "enum": ["asio", "io_uring"],
+      "default": "asio"
+    },
+    "shm_transport": {
+      "title": "Shared memory transport",
+      "description": "Exchange data with remote branches on the same host through shared memory instead of TCP. Only used if both branches enable it and if the platform supports it.",
+      "type": "boolean",
+      "default": true
+    },
+    "zero_copy_threshold": {
+      "title": "Zero-copy threshold",
+      "description": "Size in bytes at which broadcast messages are queued by reference on each connection instead of being copied into the send queues; 0 disables this.",
+      "type": "integer",
+      "minimum": 0,
+      "maximum": 10000000,
+      "default": 0
+    },
+    "broadcast_queue_depth": {
+      "title": "Broadcast receive queue depth",
+      "description": "Maximum number of received broadcasts that are stored while no receive operation is pending; 0 disables the queue so that such broadcasts get discarded.",
+      "type": "integer",
+      "minimum": 0,
+      "maximum": 1000000,
+      "default": 0
+    },
+    "broadcast_queue_bytes": {
+      "title": "Broadcast receive queue byte limit",
+      "description": "Maximum number of payload bytes stored in the broadcast receive queue; 0 means that only the queue depth applies.",
+      "type": "integer",
+      "minimum": 0,
+      "maximum": 1000000000,
+      "default": 0
+    },
+    "broadcast_queue_policy": {
+      "title": "Broadcast receive queue overflow policy",
+      "description": "Action taken if a broadcast is received while the receive queue is full: discard the oldest queued broadcast, discard the received broadcast, or stop receiving from the sending branch until the queue has space again. A branch gets blocked for at most half of its timeout so that it does not drop the connection; after that, receiving from it continues and its broadcasts that do not fit into the queue get discarded. Discarded broadcasts, including the ones that a blocked branch multicasts, get reported via the YOGI_BEV_BROADCASTS_LOST event.",
+      "type": "string",
+      "enum": ["drop_oldest", "drop_newest", "block_peer"],
+      "default": "drop_oldest"
+    },
+    "max_broadcast_size": {
+      "title": "Maximum size of fragmented broadcasts",
+      "description": "Maximum size in bytes of a received broadcast message that has been split into fragments. A branch announcing a larger message violates the protocol and its connection gets closed. Also limits the size of compressed messages after decompression; remote branches do not compress messages exceeding it.",
+      "type": "integer",
+      "minimum": 1,
+      "maximum": 1000000000,
+      "default": 16777216
+    },
+    "compression_threshold": {
+      "title": "Compression threshold",
+      "description": "Size in bytes at which messages sent to remote branches over TCP get compressed; messages that do not get smaller are sent uncompressed. Only used if both branches enable it, in which case the larger of the two thresholds applies; 0 disables compression.",
+      "type": "integer",
+      "minimum": 0,
+      "maximum": 10000000,
+      "default": 0
+    },
+    "broadcast_multicast_port": {
+      "title": "Broadcast multicast port",
+      "description": "UDP port for multicasting broadcasts to the advertising address instead of sending them over each TCP connection. Only used for connections to branches with the same port; lost datagrams get repaired over the TCP connection. Broadcasts that do not fit into a single datagram and broadcasts sent to a single branch are always sent over TCP and are not ordered relative to multicast broadcasts. Multicast broadcasts bypass the send queues; 0 disables multicasting.",
+      "type": "integer",
+      "minimum": 0,
+      "maximum": 65535,
+      "default": 0,
+      "examples": [13532]
+    },
+    "resumption_window": {
+      "title": "Session resumption window",
+      "description": "Amount of time after losing a TCP session during which the branch that created the connection can resume the session without rediscovery, info exchange and authentication. Only used if both branches set it; 0 disables session resumption.",
+      "type": "number",
+      "minimum": 0,
+      "default": 0,
+      "examples": [10.0]
+    },
+    "broadcast_queue_peak": {
+      "title": "Broadcast receive queue high-watermark",
+      "description": "Largest number of broadcasts that have been stored in the broadcast receive queue at the same time.",
+      "type": "integer",
+      "minimum": 0
     }
   }
 }
@@ -278,7 +431,11 @@ const char kRemoteBranchInfo[] = R"raw({
     "start_time":             { "$ref": "branch_properties.schema.json#/properties/start_time" },
     "timeout":                { "$ref": "branch_properties.schema.json#/properties/timeout" },
     "advertising_interval":   { "$ref": "branch_properties.schema.json#/properties/advertising_interval" },
-    "ghost_mode":             { "$ref": "branch_properties.schema.json#/properties/ghost_mode" }
+    "ghost_mode":             { "$ref": "branch_properties.schema.json#/properties/ghost_mode" },
+    "compression_threshold":  { "$ref": "branch_properties.schema.json#/properties/compression_threshold" },
+    "broadcast_multicast_port": { "$ref": "branch_properties.schema.json#/properties/broadcast_multicast_port" },
+    "resumption_window": { "$ref": "branch_properties.schema.json#/properties/resumption_window" },
+    "max_broadcast_size":     { "$ref": "branch_properties.schema.json#/properties/max_broadcast_size" }
   }
 }
 )raw";
@@ -300,12 +457,30 @@ const char kLocalBranchInfo[] = R"raw({
     "advertising_address":    { "$ref": "branch_properties.schema.json#/properties/advertising_address" },
     "advertising_port":       { "$ref": "branch_properties.schema.json#/properties/advertising_port" },
     "advertising_interval":   { "$ref": "branch_properties.schema.json#/properties/advertising_interval" },
+    "max_advertising_interval": { "$ref": "branch_properties.schema.json#/properties/max_advertising_interval" },
+    "max_concurrent_connects": { "$ref": "branch_properties.schema.json#/properties/max_concurrent_connects" },
+    "connect_jitter":         { "$ref": "branch_properties.schema.json#/properties/connect_jitter" },
+    "max_connect_backoff":    { "$ref": "branch_properties.schema.json#/properties/max_connect_backoff" },
     "tcp_server_port":        { "$ref": "branch_properties.schema.json#/properties/tcp_server_port" },
     "timeout":                { "$ref": "branch_properties.schema.json#/properties/timeout" },
     "start_time":             { "$ref": "branch_properties.schema.json#/properties/start_time" },
     "ghost_mode":             { "$ref": "branch_properties.schema.json#/properties/ghost_mode" },
     "tx_queue_size":          { "$ref": "branch_properties.schema.json#/properties/tx_queue_size" },
-    "rx_queue_size":          { "$ref": "branch_properties.schema.json#/properties/rx_queue_size" }
+    "rx_queue_size":          { "$ref": "branch_properties.schema.json#/properties/rx_queue_size" },
+    "mirrored_queues":        { "$ref": "branch_properties.schema.json#/properties/mirrored_queues" },
+    "tx_coalescing_delay":    { "$ref": "branch_properties.schema.json#/properties/tx_coalescing_delay" },
+    "tx_coalescing_bytes":    { "$ref": "branch_properties.schema.json#/properties/tx_coalescing_bytes" },
+    "io_backend":             { "$ref": "branch_properties.schema.json#/properties/io_backend" },
+    "shm_transport":          { "$ref": "branch_properties.schema.json#/properties/shm_transport" },
+    "zero_copy_threshold":    { "$ref": "branch_properties.schema.json#/properties/zero_copy_threshold" },
+    "broadcast_queue_depth":  { "$ref": "branch_properties.schema.json#/properties/broadcast_queue_depth" },
+    "broadcast_queue_bytes":  { "$ref": "branch_properties.schema.json#/properties/broadcast_queue_bytes" },
+    "broadcast_queue_policy": { "$ref": "branch_properties.schema.json#/properties/broadcast_queue_policy" },
+    "max_broadcast_size":     { "$ref": "branch_properties.schema.json#/properties/max_broadcast_size" },
+    "compression_threshold":  { "$ref": "branch_properties.schema.json#/properties/compression_threshold" },
+    "broadcast_multicast_port": { "$ref": "branch_properties.schema.json#/properties/broadcast_multicast_port" },
+    "resumption_window": { "$ref": "branch_properties.schema.json#/properties/resumption_window" },
+    "broadcast_queue_peak":   { "$ref": "branch_properties.schema.json#/properties/broadcast_queue_peak" }
   }
 }
 )raw";
@@ -0,0 +1,506 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <src/system/io_uring.h>
+
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <cerrno>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#  define YOGI_HAS_IO_URING
+#  include <linux/io_uring.h>
+#  include <poll.h>
+#  include <sys/eventfd.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <sys/uio.h>
+#  include <unistd.h>
+
+#  include <cstring>
+#endif
+
+#ifdef YOGI_HAS_IO_URING
+namespace {
+
+int sys_io_uring_setup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, 0, 0, nullptr, 0));
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+  return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+void* map_ring(int fd, std::size_t size, off_t offset) {
+  auto p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+  return p == MAP_FAILED ? nullptr : p;
+}
+
+template <typename T>
+T* ring_field(void* ring, unsigned offset) {
+  return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+unsigned load_acquire(const unsigned* p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void store_release(unsigned* p, unsigned val) {
+  __atomic_store_n(p, val, __ATOMIC_RELEASE);
+}
+
+}  // anonymous namespace
+#endif
+
+IoUringPtr IoUring::try_create(boost::asio::io_context& ioc, unsigned entries, std::size_t num_buffers,
+                               std::size_t buffer_size) {
+#ifdef YOGI_HAS_IO_URING
+  YOGI_ASSERT(num_buffers > 0 && num_buffers <= entries);
+
+  auto ring = IoUringPtr(new IoUring(ioc, num_buffers, buffer_size));
+  if (!ring->setup(entries) || !ring->setup_registered_buffers() || !ring->setup_eventfd()) {
+    return {};
+  }
+
+  ring->start_waiting_for_completions();
+  return ring;
+#else
+  YOGI_UNUSED(ioc);
+  YOGI_UNUSED(entries);
+  YOGI_UNUSED(num_buffers);
+  YOGI_UNUSED(buffer_size);
+  return {};
+#endif
+}
+
+IoUring::IoUring(boost::asio::io_context& ioc, std::size_t num_buffers, std::size_t buffer_size)
+    : ioc_(ioc),
+      num_buffers_(num_buffers),
+      buffer_size_(buffer_size),
+      ring_fd_(-1),
+#ifndef _WIN32
+      event_sd_(ioc),
+#endif
+      sq_ring_ptr_(nullptr),
+      sq_ring_size_(0),
+      cq_ring_ptr_(nullptr),
+      cq_ring_size_(0),
+      sqes_ptr_(nullptr),
+      sqes_size_(0),
+      sq_head_(nullptr),
+      sq_tail_(nullptr),
+      sq_mask_(0),
+      sq_entries_(0),
+      sq_array_(nullptr),
+      cq_head_(nullptr),
+      cq_tail_(nullptr),
+      cq_mask_(0),
+      cqes_(nullptr),
+      buffers_(nullptr),
+      unsubmitted_(0),
+      submit_scheduled_(false),
+      last_op_id_(0) {
+}
+
+IoUring::~IoUring() {
+#ifdef YOGI_HAS_IO_URING
+  // Closing the ring cancels all outstanding operations. The registered
+  // buffers are pinned by the kernel, so unmapping them is safe even if the
+  // kernel has not finished with them yet.
+  if (ring_fd_ != -1) close(ring_fd_);
+  if (sqes_ptr_) munmap(sqes_ptr_, sqes_size_);
+  if (cq_ring_ptr_ && cq_ring_ptr_ != sq_ring_ptr_) munmap(cq_ring_ptr_, cq_ring_size_);
+  if (sq_ring_ptr_) munmap(sq_ring_ptr_, sq_ring_size_);
+  if (buffers_) munmap(buffers_, num_buffers_ * buffer_size_);
+#endif
+}
+
+void IoUring::write_some_async(int fd, const ConstBufferSequence& data, CompletionHandler handler) {
+  auto size = std::min(boost::asio::buffer_size(data), buffer_size_);
+  start_operation({fd, true, size, handler, 0, {}, false, false}, data);
+}
+
+void IoUring::read_some_async(int fd, std::size_t max_size, CompletionHandler handler) {
+  auto size = std::min(max_size, buffer_size_);
+  start_operation({fd, false, size, handler, 0, {}, true, false}, {});
+}
+
+void IoUring::submit() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  submit_impl();
+}
+
+void IoUring::cancel(int fd) {
+  std::vector<Operation> canceled;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Operations waiting for a buffer have not reached the kernel yet
+    for (auto it = ops_waiting_for_buffer_.begin(); it != ops_waiting_for_buffer_.end();) {
+      if (it->fd == fd) {
+        canceled.push_back(std::move(*it));
+        it = ops_waiting_for_buffer_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    // A read whose poll already completed but has not been reaped yet must
+    // not start reading from the file descriptor
+    for (auto& entry : ops_) {
+      if (entry.second.fd == fd) {
+        entry.second.canceled = true;
+        queue_cancel_request(entry.first);
+      }
+    }
+
+    // The requests must reach the kernel before the file descriptor gets closed
+    submit_impl();
+  }
+
+  for (auto& op : canceled) {
+    boost::asio::post(ioc_, [handler = std::move(op.handler)] { handler(-ECANCELED, nullptr); });
+  }
+}
+
+bool IoUring::setup(unsigned entries) {
+#ifdef YOGI_HAS_IO_URING
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+
+  ring_fd_ = sys_io_uring_setup(entries, &params);
+  if (ring_fd_ < 0) {
+    ring_fd_ = -1;
+    return false;
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+
+  sq_ring_ptr_ = map_ring(ring_fd_, sq_ring_size_, IORING_OFF_SQ_RING);
+  if (!sq_ring_ptr_) return false;
+
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    cq_ring_ptr_ = sq_ring_ptr_;
+  } else {
+    cq_ring_ptr_ = map_ring(ring_fd_, cq_ring_size_, IORING_OFF_CQ_RING);
+    if (!cq_ring_ptr_) return false;
+  }
+
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ptr_  = map_ring(ring_fd_, sqes_size_, IORING_OFF_SQES);
+  if (!sqes_ptr_) return false;
+
+  sq_head_    = ring_field<unsigned>(sq_ring_ptr_, params.sq_off.head);
+  sq_tail_    = ring_field<unsigned>(sq_ring_ptr_, params.sq_off.tail);
+  sq_mask_    = *ring_field<unsigned>(sq_ring_ptr_, params.sq_off.ring_mask);
+  sq_entries_ = *ring_field<unsigned>(sq_ring_ptr_, params.sq_off.ring_entries);
+  sq_array_   = ring_field<unsigned>(sq_ring_ptr_, params.sq_off.array);
+  cq_head_    = ring_field<unsigned>(cq_ring_ptr_, params.cq_off.head);
+  cq_tail_    = ring_field<unsigned>(cq_ring_ptr_, params.cq_off.tail);
+  cq_mask_    = *ring_field<unsigned>(cq_ring_ptr_, params.cq_off.ring_mask);
+  cqes_       = ring_field<io_uring_cqe>(cq_ring_ptr_, params.cq_off.cqes);
+
+  return true;
+#else
+  YOGI_UNUSED(entries);
+  return false;
+#endif
+}
+
+bool IoUring::setup_registered_buffers() {
+#ifdef YOGI_HAS_IO_URING
+  auto p = mmap(nullptr, num_buffers_ * buffer_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) return false;
+  buffers_ = static_cast<Byte*>(p);
+
+  std::vector<iovec> iovecs(num_buffers_);
+  for (std::size_t i = 0; i < num_buffers_; ++i) {
+    iovecs[i].iov_base = get_buffer(i);
+    iovecs[i].iov_len  = buffer_size_;
+    free_buffers_.push_back(num_buffers_ - i - 1);
+  }
+
+  return sys_io_uring_register(ring_fd_, IORING_REGISTER_BUFFERS, iovecs.data(),
+                               static_cast<unsigned>(iovecs.size())) == 0;
+#else
+  return false;
+#endif
+}
+
+bool IoUring::setup_eventfd() {
+#ifdef YOGI_HAS_IO_URING
+  int efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (efd < 0) return false;
+
+  boost::system::error_code ec;
+  event_sd_.assign(efd, ec);
+  if (ec) {
+    close(efd);
+    return false;
+  }
+
+  return sys_io_uring_register(ring_fd_, IORING_REGISTER_EVENTFD, &efd, 1) == 0;
+#else
+  return false;
+#endif
+}
+
+void IoUring::start_operation(Operation op, const ConstBufferSequence& data) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (op.polling) {
+    queue_operation(std::move(op));
+  } else {
+    start_transfer(std::move(op), data);
+  }
+}
+
+void IoUring::start_transfer(Operation op, const ConstBufferSequence& data) {
+  if (free_buffers_.empty()) {
+    // The caller's memory is only guaranteed to be valid during this call
+    if (op.is_write) {
+      op.waiting_data.resize(op.size);
+      boost::asio::buffer_copy(boost::asio::buffer(op.waiting_data), data);
+    }
+
+    ops_waiting_for_buffer_.push_back(std::move(op));
+    return;
+  }
+
+  op.buffer_idx = free_buffers_.back();
+  free_buffers_.pop_back();
+
+  if (op.is_write) {
+    boost::asio::buffer_copy(boost::asio::buffer(get_buffer(op.buffer_idx), op.size), data);
+  }
+
+  queue_operation(std::move(op));
+}
+
+void IoUring::queue_operation(Operation op) {
+#ifdef YOGI_HAS_IO_URING
+  make_room_in_submission_queue();
+
+  auto tail = *sq_tail_;
+  auto id   = ++last_op_id_;
+
+  auto idx = tail & sq_mask_;
+  auto sqe = static_cast<io_uring_sqe*>(sqes_ptr_) + idx;
+  std::memset(sqe, 0, sizeof(*sqe));
+  sqe->fd        = op.fd;
+  sqe->user_data = id;
+  if (op.polling) {
+    sqe->opcode      = IORING_OP_POLL_ADD;
+    sqe->poll_events = POLLIN;
+  } else {
+    sqe->opcode    = op.is_write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+    sqe->addr      = reinterpret_cast<std::uint64_t>(get_buffer(op.buffer_idx));
+    sqe->len       = static_cast<std::uint32_t>(op.size);
+    sqe->buf_index = static_cast<std::uint16_t>(op.buffer_idx);
+  }
+  sq_array_[idx] = idx;
+  store_release(sq_tail_, tail + 1);
+
+  ops_.emplace(id, std::move(op));
+  ++unsubmitted_;
+
+  schedule_submit();
+#else
+  YOGI_UNUSED(op);
+#endif
+}
+
+void IoUring::queue_cancel_request(std::uint64_t id) {
+#ifdef YOGI_HAS_IO_URING
+  make_room_in_submission_queue();
+
+  auto tail = *sq_tail_;
+  auto idx = tail & sq_mask_;
+  auto sqe = static_cast<io_uring_sqe*>(sqes_ptr_) + idx;
+  std::memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+  sqe->fd        = -1;
+  sqe->addr      = id;
+  sqe->user_data = kCancelRequestId;
+  sq_array_[idx] = idx;
+  store_release(sq_tail_, tail + 1);
+
+  ++unsubmitted_;
+#else
+  YOGI_UNUSED(id);
+#endif
+}
+
+// Neither polls nor cancel requests occupy a registered buffer, so there may
+// be more of them than the submission queue can hold
+void IoUring::make_room_in_submission_queue() {
+#ifdef YOGI_HAS_IO_URING
+  if (*sq_tail_ - load_acquire(sq_head_) >= sq_entries_) {
+    submit_impl();
+  }
+
+  YOGI_ASSERT(*sq_tail_ - load_acquire(sq_head_) < sq_entries_);
+#endif
+}
+
+void IoUring::schedule_submit() {
+  if (submit_scheduled_) return;
+  submit_scheduled_ = true;
+
+  // Everything that gets queued until this handler runs is submitted together
+  auto weak_self = make_weak_ptr();
+  boost::asio::post(ioc_, [weak_self] {
+    auto self = weak_self.lock();
+    if (!self) return;
+
+    self->submit();
+  });
+}
+
+void IoUring::submit_impl() {
+#ifdef YOGI_HAS_IO_URING
+  submit_scheduled_ = false;
+  if (unsubmitted_ == 0) return;
+
+  int res = sys_io_uring_enter(ring_fd_, unsubmitted_);
+  if (res > 0) {
+    unsubmitted_ -= std::min(unsubmitted_, static_cast<unsigned>(res));
+  }
+
+  // Try again later, e.g. after completions have been reaped
+  if (unsubmitted_ > 0) {
+    schedule_submit();
+  }
+#endif
+}
+
+void IoUring::start_waiting_for_completions() {
+#ifndef _WIN32
+  auto weak_self = make_weak_ptr();
+  event_sd_.async_wait(boost::asio::posix::stream_descriptor::wait_read, [weak_self](auto& ec) {
+    auto self = weak_self.lock();
+    if (!self || ec) return;
+
+    self->on_completions_available();
+  });
+#endif
+}
+
+void IoUring::on_completions_available() {
+#ifdef YOGI_HAS_IO_URING
+  std::uint64_t counter;
+  while (read(event_sd_.native_handle(), &counter, sizeof(counter)) > 0) {
+  }
+
+  std::vector<std::pair<Operation, int>> completed;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto head = *cq_head_;
+    auto tail = load_acquire(cq_tail_);
+    for (; head != tail; ++head) {
+      auto& cqe = static_cast<io_uring_cqe*>(cqes_)[head & cq_mask_];
+      if (cqe.user_data == kCancelRequestId) continue;
+
+      auto it = ops_.find(cqe.user_data);
+      YOGI_ASSERT(it != ops_.end());
+
+      auto op = std::move(it->second);
+      ops_.erase(it);
+      on_operation_finished(std::move(op), cqe.res, &completed);
+    }
+
+    store_release(cq_head_, head);
+  }
+
+  for (auto& entry : completed) {
+    auto& op = entry.first;
+    op.handler(entry.second, op.is_write || op.polling ? nullptr : get_buffer(op.buffer_idx));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : completed) {
+      if (!entry.first.polling) {
+        release_buffer(entry.first.buffer_idx);
+      }
+    }
+  }
+
+  start_waiting_for_completions();
+#endif
+}
+
+void IoUring::on_operation_finished(Operation op, int res, std::vector<std::pair<Operation, int>>* completed) {
+  // Data is available, so the read can take a buffer now
+  if (op.polling && res >= 0) {
+    if (op.canceled) {
+      res = -ECANCELED;
+    } else {
+      op.polling = false;
+      start_transfer(std::move(op), {});
+      return;
+    }
+  }
+
+  // Another reader took the data in the meantime
+  if (!op.is_write && !op.polling && !op.canceled && res == -EAGAIN) {
+    release_buffer(op.buffer_idx);
+    op.polling = true;
+    queue_operation(std::move(op));
+    return;
+  }
+
+  completed->push_back(std::make_pair(std::move(op), res));
+}
+
+void IoUring::release_buffer(std::size_t idx) {
+  if (ops_waiting_for_buffer_.empty()) {
+    free_buffers_.push_back(idx);
+    return;
+  }
+
+  auto op = std::move(ops_waiting_for_buffer_.front());
+  ops_waiting_for_buffer_.pop_front();
+
+  op.buffer_idx = idx;
+  if (op.is_write) {
+    std::copy(op.waiting_data.begin(), op.waiting_data.end(), get_buffer(idx));
+    op.waiting_data.clear();
+  }
+
+  queue_operation(std::move(op));
+}
+
+Byte* IoUring::get_buffer(std::size_t idx) const {
+  return buffers_ + idx * buffer_size_;
+}
@@ -0,0 +1,172 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <src/data/buffer.h>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_context.hpp>
+#ifndef _WIN32
+#  include <boost/asio/posix/stream_descriptor.hpp>
+#endif
+#include <boost/container/small_vector.hpp>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class IoUring;
+typedef std::shared_ptr<IoUring> IoUringPtr;
+typedef std::weak_ptr<IoUring> IoUringWeakPtr;
+
+// Linux io_uring instance whose completions get dispatched on an asio
+// io_context. Operations queued while handling other events are submitted to
+// the kernel together with one system call, and all available completions are
+// reaped at once.
+//
+// Data is transferred through a pool of buffers that are registered with the
+// kernel. This also guarantees that the kernel never writes into or reads from
+// memory owned by the caller once the caller has gone away. Reads first wait
+// for data without occupying a buffer, so idle connections with a pending
+// read do not use up the pool.
+class IoUring final : public std::enable_shared_from_this<IoUring> {
+ public:
+  // The result is the number of bytes transferred or a negative errno value;
+  // data points to the received bytes in the registered buffer
+  typedef std::function<void(int res, const Byte* data)> CompletionHandler;
+  typedef boost::container::small_vector<boost::asio::const_buffer, 2> ConstBufferSequence;
+
+  static constexpr unsigned kDefaultEntries       = 256;
+  static constexpr std::size_t kDefaultNumBuffers = 128;
+  static constexpr std::size_t kDefaultBufferSize = 32 * 1024;
+
+  // Returns an empty pointer if io_uring is not supported on this platform or
+  // if setting up the ring failed
+  static IoUringPtr try_create(boost::asio::io_context& ioc, unsigned entries = kDefaultEntries,
+                               std::size_t num_buffers = kDefaultNumBuffers,
+                               std::size_t buffer_size = kDefaultBufferSize);
+
+  ~IoUring();
+
+  IoUring(const IoUring&) = delete;
+  IoUring& operator=(const IoUring&) = delete;
+
+  std::size_t buffer_size() const {
+    return buffer_size_;
+  }
+
+  // Writes at most buffer_size() bytes
+  void write_some_async(int fd, const ConstBufferSequence& data, CompletionHandler handler);
+
+  // Reads at most buffer_size() bytes
+  void read_some_async(int fd, std::size_t max_size, CompletionHandler handler);
+
+  // Submits all queued operations immediately. Must be called before closing
+  // a file descriptor that queued operations refer to.
+  void submit();
+
+  // Cancels all operations on the given file descriptor. Their handlers get
+  // called with -ECANCELED unless the operation finished in the meantime. The
+  // registered buffers are returned to the pool once the kernel reports the
+  // completions, so this can be called right before closing the descriptor.
+  void cancel(int fd);
+
+ private:
+  struct Operation {
+    int fd;
+    bool is_write;
+    std::size_t size;
+    CompletionHandler handler;
+    std::size_t buffer_idx;
+    Buffer waiting_data;  // Data to write while waiting for a free buffer
+    bool polling;         // Read waiting for data; does not occupy a buffer
+    bool canceled;
+  };
+
+  IoUring(boost::asio::io_context& ioc, std::size_t num_buffers, std::size_t buffer_size);
+
+  IoUringWeakPtr make_weak_ptr() {
+    return shared_from_this();
+  }
+
+  // User data of cancel requests whose completions need no handling
+  static constexpr std::uint64_t kCancelRequestId = 0;
+
+  bool setup(unsigned entries);
+  bool setup_registered_buffers();
+  bool setup_eventfd();
+  void start_operation(Operation op, const ConstBufferSequence& data);
+  void start_transfer(Operation op, const ConstBufferSequence& data);
+  void queue_operation(Operation op);
+  void make_room_in_submission_queue();
+  void queue_cancel_request(std::uint64_t id);
+  void schedule_submit();
+  void submit_impl();
+  void start_waiting_for_completions();
+  void on_completions_available();
+  void on_operation_finished(Operation op, int res, std::vector<std::pair<Operation, int>>* completed);
+  void release_buffer(std::size_t idx);
+  Byte* get_buffer(std::size_t idx) const;
+
+  boost::asio::io_context& ioc_;
+  const std::size_t num_buffers_;
+  const std::size_t buffer_size_;
+  int ring_fd_;
+#ifndef _WIN32
+  boost::asio::posix::stream_descriptor event_sd_;
+#endif
+
+  // Kernel-shared ring memory
+  void* sq_ring_ptr_;
+  std::size_t sq_ring_size_;
+  void* cq_ring_ptr_;
+  std::size_t cq_ring_size_;
+  void* sqes_ptr_;
+  std::size_t sqes_size_;
+  unsigned* sq_head_;
+  unsigned* sq_tail_;
+  unsigned sq_mask_;
+  unsigned sq_entries_;
+  unsigned* sq_array_;
+  unsigned* cq_head_;
+  unsigned* cq_tail_;
+  unsigned cq_mask_;
+  void* cqes_;
+
+  // Registered buffers
+  Byte* buffers_;
+  std::vector<std::size_t> free_buffers_;
+
+  std::mutex mutex_;
+  unsigned unsubmitted_;
+  bool submit_scheduled_;
+  std::uint64_t last_op_id_;
+  std::unordered_map<std::uint64_t, Operation> ops_;
+  std::deque<Operation> ops_waiting_for_buffer_;
+};
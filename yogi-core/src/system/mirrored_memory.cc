@@ -0,0 +1,76 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <src/system/mirrored_memory.h>
+
+#ifdef __linux__
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+MirroredMemoryPtr MirroredMemory::try_create(std::size_t min_size) {
+#ifdef __linux__
+  auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  auto size      = (min_size + page_size - 1) / page_size * page_size;
+
+  int fd = memfd_create("yogi-ringbuffer", MFD_CLOEXEC);
+  if (fd == -1) {
+    return {};
+  }
+
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    close(fd);
+    return {};
+  }
+
+  // Reserve the address range for both mappings first so nothing else can
+  // end up in between them
+  auto addr = mmap(nullptr, size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (addr == MAP_FAILED) {
+    close(fd);
+    return {};
+  }
+
+  auto data = static_cast<Byte*>(addr);
+  for (auto part : {data, data + size}) {
+    if (mmap(part, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+      munmap(addr, size * 2);
+      close(fd);
+      return {};
+    }
+  }
+
+  close(fd);
+  return MirroredMemoryPtr(new MirroredMemory(data, size));
+#else
+  YOGI_UNUSED(min_size);
+  return {};
+#endif
+}
+
+MirroredMemory::~MirroredMemory() {
+#ifdef __linux__
+  munmap(data_, size_ * 2);
+#endif
+}
+
+MirroredMemory::MirroredMemory(Byte* data, std::size_t size) : data_(data), size_(size) {
+}
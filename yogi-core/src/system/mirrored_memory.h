@@ -0,0 +1,61 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <src/data/buffer.h>
+
+#include <cstddef>
+#include <memory>
+
+class MirroredMemory;
+typedef std::unique_ptr<MirroredMemory> MirroredMemoryPtr;
+
+// Block of memory that is mapped twice back-to-back into the virtual address
+// space, i.e. data()[i] and data()[size() + i] refer to the same byte.
+class MirroredMemory final {
+ public:
+  // Returns an empty pointer if mirrored mappings are not supported on this
+  // platform or if creating the mappings failed. The size gets rounded up to
+  // a multiple of the page size.
+  static MirroredMemoryPtr try_create(std::size_t min_size);
+
+  ~MirroredMemory();
+
+  MirroredMemory(const MirroredMemory&) = delete;
+  MirroredMemory& operator=(const MirroredMemory&) = delete;
+
+  Byte* data() const {
+    return data_;
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+ private:
+  MirroredMemory(Byte* data, std::size_t size);
+
+  Byte* const data_;
+  const std::size_t size_;
+};
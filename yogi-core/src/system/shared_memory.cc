@@ -0,0 +1,132 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <src/system/shared_memory.h>
+
+#include <thread>
+
+#ifdef __linux__
+#  include <fcntl.h>
+#  include <linux/futex.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+SharedMemoryPtr SharedMemory::try_create(const std::string& name, std::size_t size) {
+#ifdef __linux__
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+  if (fd == -1) {
+    return {};
+  }
+
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    close(fd);
+    shm_unlink(name.c_str());
+    return {};
+  }
+
+  auto addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    return {};
+  }
+
+  return SharedMemoryPtr(new SharedMemory(name, static_cast<Byte*>(addr), size, true));
+#else
+  YOGI_UNUSED(name);
+  YOGI_UNUSED(size);
+  return {};
+#endif
+}
+
+SharedMemoryPtr SharedMemory::try_open(const std::string& name) {
+#ifdef __linux__
+  int fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+  if (fd == -1) {
+    return {};
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return {};
+  }
+
+  auto size = static_cast<std::size_t>(st.st_size);
+  auto addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return {};
+  }
+
+  return SharedMemoryPtr(new SharedMemory(name, static_cast<Byte*>(addr), size, false));
+#else
+  YOGI_UNUSED(name);
+  return {};
+#endif
+}
+
+SharedMemory::~SharedMemory() {
+  remove_name();
+
+#ifdef __linux__
+  munmap(data_, size_);
+#endif
+}
+
+void SharedMemory::remove_name() {
+  if (!owns_name_) return;
+
+#ifdef __linux__
+  shm_unlink(name_.c_str());
+#endif
+
+  owns_name_ = false;
+}
+
+SharedMemory::SharedMemory(const std::string& name, Byte* data, std::size_t size, bool owns_name)
+    : name_(name), data_(data), size_(size), owns_name_(owns_name) {
+}
+
+void wait_on_address(std::atomic<std::uint32_t>* addr, std::uint32_t expected) {
+  static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "Unexpected atomic layout");
+
+#ifdef __linux__
+  // Not using FUTEX_PRIVATE_FLAG since the address may be shared between
+  // processes
+  syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(addr), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+#else
+  if (addr->load() == expected) {
+    std::this_thread::yield();
+  }
+#endif
+}
+
+void wake_all_on_address(std::atomic<std::uint32_t>* addr) {
+#ifdef __linux__
+  syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(addr), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+#else
+  YOGI_UNUSED(addr);
+#endif
+}
@@ -0,0 +1,85 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <src/data/buffer.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class SharedMemory;
+typedef std::unique_ptr<SharedMemory> SharedMemoryPtr;
+
+// Named block of memory that can be mapped by several processes on the same
+// host. Newly created blocks are zero-initialized.
+class SharedMemory final {
+ public:
+  // Returns an empty pointer if shared memory is not supported on this
+  // platform or if a block with the given name already exists. The block is
+  // only accessible by the current user.
+  static SharedMemoryPtr try_create(const std::string& name, std::size_t size);
+
+  // Returns an empty pointer if the block does not exist or cannot be mapped
+  static SharedMemoryPtr try_open(const std::string& name);
+
+  // Removes the name of the block if it has been created (and not yet
+  // removed) by this instance
+  ~SharedMemory();
+
+  SharedMemory(const SharedMemory&) = delete;
+  SharedMemory& operator=(const SharedMemory&) = delete;
+
+  Byte* data() const {
+    return data_;
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+  const std::string& name() const {
+    return name_;
+  }
+
+  // Removes the name so that the block cannot be opened anymore; existing
+  // mappings stay valid
+  void remove_name();
+
+ private:
+  SharedMemory(const std::string& name, Byte* data, std::size_t size, bool owns_name);
+
+  const std::string name_;
+  Byte* const data_;
+  const std::size_t size_;
+  bool owns_name_;
+};
+
+// Blocks until *addr no longer contains expected or until another thread or
+// process calls wake_all_on_address(addr). May return spuriously. Works with
+// addresses in shared memory.
+void wait_on_address(std::atomic<std::uint32_t>* addr, std::uint32_t expected);
+void wake_all_on_address(std::atomic<std::uint32_t>* addr);
@@ -0,0 +1,125 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Value that gets read frequently by many threads and replaced rarely.
+// Readers neither take a lock nor modify a reference count of the value; they
+// only announce themselves via a counter. Replaced values get deleted once no
+// reader is active any more, either by the next call to publish() or by the
+// last reader leaving.
+template <typename T>
+class Snapshot {
+ public:
+  // Keeps the value that was current on construction alive
+  class ReadGuard {
+   public:
+    explicit ReadGuard(Snapshot* snapshot) : snapshot_(snapshot), value_(snapshot->enter()) {
+    }
+
+    ~ReadGuard() {
+      snapshot_->leave();
+    }
+
+    ReadGuard(const ReadGuard&) = delete;
+    ReadGuard& operator=(const ReadGuard&) = delete;
+
+    const T& operator*() const {
+      return *value_;
+    }
+
+    const T* operator->() const {
+      return value_;
+    }
+
+   private:
+    Snapshot* const snapshot_;
+    const T* const value_;
+  };
+
+  explicit Snapshot(std::unique_ptr<const T> value) : current_(value.release()), readers_(0), has_retired_(false) {
+  }
+
+  ~Snapshot() {
+    YOGI_ASSERT(readers_ == 0);
+    delete current_.load();
+    for (auto value : retired_) delete value;
+  }
+
+  Snapshot(const Snapshot&) = delete;
+  Snapshot& operator=(const Snapshot&) = delete;
+
+  ReadGuard read() {
+    return ReadGuard(this);
+  }
+
+  void publish(std::unique_ptr<const T> value) {
+    {
+      std::lock_guard<std::mutex> lock(retired_mutex_);
+      retired_.push_back(current_.exchange(value.release()));
+      has_retired_ = true;
+    }
+
+    try_delete_retired_values();
+  }
+
+ private:
+  // A reader that loads the value after announcing itself either gets the
+  // current value or one that only gets deleted after the reader has left
+  const T* enter() {
+    ++readers_;
+    return current_.load();
+  }
+
+  void leave() {
+    if (--readers_ == 0) {
+      try_delete_retired_values();
+    }
+  }
+
+  // Never waits for the mutex; whoever holds it checks again after releasing
+  // it, so retired values cannot be left behind once all readers have left
+  void try_delete_retired_values() {
+    while (has_retired_ && readers_ == 0) {
+      std::unique_lock<std::mutex> lock(retired_mutex_, std::try_to_lock);
+      if (!lock) return;
+
+      if (readers_ == 0) {
+        for (auto value : retired_) delete value;
+        retired_.clear();
+        has_retired_ = false;
+      }
+    }
+  }
+
+  std::atomic<const T*> current_;
+  std::atomic<int> readers_;
+  std::atomic<bool> has_retired_;
+  std::mutex retired_mutex_;
+  std::vector<const T*> retired_;
+};
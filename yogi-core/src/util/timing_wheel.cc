@@ -0,0 +1,157 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <src/util/timing_wheel.h>
+
+#include <algorithm>
+
+TimingWheel::TimingWheel(boost::asio::io_context& ioc, std::chrono::nanoseconds tick_duration, std::size_t num_slots)
+    : tick_duration_(tick_duration),
+      start_time_(std::chrono::steady_clock::now()),
+      slots_(num_slots),
+      last_processed_tick_(0),
+      num_scheduled_(0),
+      timer_(ioc),
+      timer_running_(false) {
+  YOGI_ASSERT(tick_duration.count() > 0);
+  YOGI_ASSERT(num_slots > 0);
+}
+
+TimingWheelEntryPtr TimingWheel::make_entry(TimingWheelEntry::ExpiryHandler handler) {
+  return std::make_shared<TimingWheelEntry>(handler);
+}
+
+void TimingWheel::arm(const TimingWheelEntryPtr& entry, std::chrono::nanoseconds timeout) {
+  auto ticks = (timeout + tick_duration_ - std::chrono::nanoseconds(1)) / tick_duration_;
+  entry->deadline_.store(current_tick() + ticks);
+
+  // Fast path: the entry will be rescheduled when its current slot is processed
+  if (entry->scheduled_.load()) return;
+
+  schedule(entry);
+}
+
+void TimingWheel::disarm(const TimingWheelEntryPtr& entry) {
+  // The entry gets removed from its slot lazily
+  entry->deadline_.store(TimingWheelEntry::kDisarmed);
+}
+
+long long TimingWheel::current_tick() const {
+  return (std::chrono::steady_clock::now() - start_time_) / tick_duration_;
+}
+
+void TimingWheel::schedule(const TimingWheelEntryPtr& entry) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entry->scheduled_.load()) return;
+
+  auto deadline = entry->deadline_.load();
+  if (deadline == TimingWheelEntry::kDisarmed) return;
+
+  // All slots are empty if nothing is scheduled, so skip the idle time
+  if (num_scheduled_ == 0) {
+    last_processed_tick_ = std::max(last_processed_tick_, current_tick() - 1);
+  }
+
+  entry->scheduled_.store(true);
+  insert_into_slot(entry, deadline);
+  ++num_scheduled_;
+
+  start_timer();
+}
+
+void TimingWheel::insert_into_slot(const TimingWheelEntryPtr& entry, long long deadline) {
+  deadline = std::max(deadline, last_processed_tick_ + 1);
+  slots_[static_cast<std::size_t>(deadline) % slots_.size()].push_back(entry);
+}
+
+void TimingWheel::start_timer() {
+  if (timer_running_ || num_scheduled_ == 0) return;
+  timer_running_ = true;
+
+  timer_.expires_at(start_time_ + (last_processed_tick_ + 1) * tick_duration_);
+  timer_.async_wait([this](auto& ec) { this->on_timer_expired(ec); });
+}
+
+void TimingWheel::on_timer_expired(const boost::system::error_code& ec) {
+  if (ec == boost::asio::error::operation_aborted) return;
+
+  std::vector<TimingWheelEntryPtr> expired;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    timer_running_ = false;
+
+    // Catch up if we are late, but visit each slot at most once
+    auto now   = current_tick();
+    auto first = std::max(last_processed_tick_ + 1, now - static_cast<long long>(slots_.size()) + 1);
+    for (auto tick = first; tick <= now; ++tick) {
+      last_processed_tick_ = tick;
+      process_slot(static_cast<std::size_t>(tick) % slots_.size(), now, &expired);
+    }
+
+    last_processed_tick_ = std::max(last_processed_tick_, now);
+    start_timer();
+  }
+
+  for (auto& entry : expired) {
+    entry->handler_();
+  }
+}
+
+void TimingWheel::process_slot(std::size_t slot_idx, long long now, std::vector<TimingWheelEntryPtr>* expired) {
+  std::vector<TimingWheelEntryPtr> entries;
+  std::swap(entries, slots_[slot_idx]);
+
+  for (auto& entry : entries) {
+    auto deadline = entry->deadline_.load();
+
+    if (deadline == TimingWheelEntry::kDisarmed) {
+      if (try_unschedule(entry)) continue;
+      deadline = entry->deadline_.load();
+    }
+
+    if (deadline > now) {
+      insert_into_slot(entry, deadline);
+    } else if (entry->deadline_.compare_exchange_strong(deadline, TimingWheelEntry::kDisarmed)) {
+      expired->push_back(entry);
+      if (!try_unschedule(entry)) {
+        insert_into_slot(entry, entry->deadline_.load());
+      }
+    } else {
+      // Re-armed concurrently
+      insert_into_slot(entry, deadline);
+    }
+  }
+}
+
+bool TimingWheel::try_unschedule(const TimingWheelEntryPtr& entry) {
+  // Pairs with arm(), which stores the deadline before checking scheduled_:
+  // either arm() sees that the entry is no longer scheduled or we see the new
+  // deadline
+  entry->scheduled_.store(false);
+  if (entry->deadline_.load() == TimingWheelEntry::kDisarmed) {
+    --num_scheduled_;
+    return true;
+  }
+
+  entry->scheduled_.store(true);
+  return false;
+}
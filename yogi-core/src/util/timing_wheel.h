@@ -0,0 +1,97 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <src/config.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class TimingWheel;
+
+// Timeout tracked by a TimingWheel. Re-arming an entry that is already
+// scheduled only updates its deadline; the wheel moves the entry to the right
+// slot when it comes across it during a tick.
+class TimingWheelEntry {
+ public:
+  typedef std::function<void()> ExpiryHandler;
+
+  explicit TimingWheelEntry(ExpiryHandler handler) : handler_(handler), deadline_(kDisarmed), scheduled_(false) {
+  }
+
+ private:
+  friend class TimingWheel;
+
+  static constexpr long long kDisarmed = std::numeric_limits<long long>::max();
+
+  const ExpiryHandler handler_;
+  std::atomic<long long> deadline_;  // Tick number
+  std::atomic<bool> scheduled_;      // Entry is in one of the slots
+};
+
+typedef std::shared_ptr<TimingWheelEntry> TimingWheelEntryPtr;
+
+// Coarse-grained hashed timing wheel that checks the deadlines of many
+// timeouts in bulk on every tick instead of using one asio timer per timeout.
+// Deadlines are rounded up to the next tick.
+class TimingWheel {
+ public:
+  static constexpr std::chrono::nanoseconds kDefaultTickDuration = std::chrono::milliseconds(10);
+  static constexpr std::size_t kDefaultNumSlots                  = 256;
+
+  TimingWheel(boost::asio::io_context& ioc, std::chrono::nanoseconds tick_duration = kDefaultTickDuration,
+              std::size_t num_slots = kDefaultNumSlots);
+
+  std::chrono::nanoseconds tick_duration() const {
+    return tick_duration_;
+  }
+
+  TimingWheelEntryPtr make_entry(TimingWheelEntry::ExpiryHandler handler);
+  void arm(const TimingWheelEntryPtr& entry, std::chrono::nanoseconds timeout);
+  void disarm(const TimingWheelEntryPtr& entry);
+
+ private:
+  long long current_tick() const;
+  void schedule(const TimingWheelEntryPtr& entry);
+  void insert_into_slot(const TimingWheelEntryPtr& entry, long long deadline);
+  void start_timer();
+  void on_timer_expired(const boost::system::error_code& ec);
+  void process_slot(std::size_t slot_idx, long long now, std::vector<TimingWheelEntryPtr>* expired);
+  bool try_unschedule(const TimingWheelEntryPtr& entry);
+
+  const std::chrono::nanoseconds tick_duration_;
+  const std::chrono::steady_clock::time_point start_time_;
+  std::mutex mutex_;
+  std::vector<std::vector<TimingWheelEntryPtr>> slots_;
+  long long last_processed_tick_;
+  std::size_t num_scheduled_;
+  boost::asio::steady_timer timer_;
+  bool timer_running_;
+};
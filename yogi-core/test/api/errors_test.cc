@@ -28,7 +28,7 @@
 #include <type_traits>
 
 // :CODEGEN_BEGIN:
-int kLastError = YOGI_ERR_OPEN_FILE_FAILED;
+int kLastError = YOGI_ERR_BROADCASTS_LOST;
 // :CODEGEN_END:
 
 TEST(ErrorsTest, DefaultResultConstructor) {
@@ -23,7 +23,8 @@
 
 #include <src/api/constants.h>
 #include <src/data/crypto.h>
-#include <src/network/messages.h>
+#include <src/network/msg_transport.h>
+#include <src/objects/branch/multicast_sender.h>
 #include <src/objects/logger.h>
 
 #include <boost/asio.hpp>
@@ -118,14 +119,20 @@ void MulticastSocket::send(const Buffer& msg) {
 std::pair<ip::address, Buffer> MulticastSocket::receive(const std::chrono::milliseconds& timeout) {
   Buffer msg(1000);
   udp::endpoint sender_ep;
+  bool received = false;
   socket_.async_receive_from(asio::buffer(msg), sender_ep, [&](auto ec, auto size) {
     EXPECT_FALSE(ec) << ec.message();
     msg.resize(size);
+    received = true;
   });
 
+  // run_one_for() may return after running internal operations only
   ioc_.reset();
-  if (!ioc_.run_one_for(timeout)) {
-    throw std::runtime_error("No multicast message received within the specified time.");
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!received) {
+    if (!ioc_.run_one_until(deadline)) {
+      throw std::runtime_error("No multicast message received within the specified time.");
+    }
   }
 
   return {sender_ep.address(), msg};
@@ -171,8 +178,12 @@ void BranchEventRecorder::callback(int res, int event, int ev_res, void* userarg
   self->start_await_event();
 }
 
-FakeBranch::FakeBranch()
-    : acceptor_(ioc_), tcp_socket_(ioc_), adv_ep_(ip::make_address(kAdvAddress), kAdvPort), mc_socket_(adv_ep_) {
+FakeBranch::FakeBranch(bool pipelined_handshake, std::chrono::milliseconds resumption_window,
+                       unsigned short broadcast_multicast_port)
+    : pipelined_handshake_(pipelined_handshake),
+      shm_negotiation_(true),
+      password_hash_(make_sha256(Buffer{})),
+      acceptor_(ioc_), tcp_socket_(ioc_), adv_ep_(ip::make_address(kAdvAddress), kAdvPort), mc_socket_(adv_ep_) {
   acceptor_.open(kTcpProtocol);
   acceptor_.set_option(tcp::acceptor::reuse_address(true));
   acceptor_.bind(tcp::endpoint(kTcpProtocol, 0));
@@ -184,20 +195,30 @@ FakeBranch::FakeBranch()
       {"name", "Fake Branch"},
       {"advertising_address", kAdvAddress},
       {"advertising_port", kAdvPort},
+      {"resumption_window", static_cast<float>(resumption_window.count()) / 1e3f},
+      {"broadcast_multicast_port", broadcast_multicast_port},
   };
 
+  if (broadcast_multicast_port != 0) {
+    bc_mc_socket_ =
+        std::make_unique<MulticastSocket>(udp::endpoint(ip::make_address(kAdvAddress), broadcast_multicast_port));
+  }
+
   info_ = std::make_shared<LocalBranchInfo>(cfg, adv_ifs, acceptor_.local_endpoint().port());
 }
 
 void FakeBranch::connect(void* branch, std::function<void(Buffer*)> msg_changer) {
   auto addr = mc_socket_.receive().first;
-  tcp_socket_.connect(tcp::endpoint(addr, get_branch_info(branch)["tcp_server_port"].get<unsigned short>()));
+  branch_ep_ = tcp::endpoint(addr, get_branch_info(branch)["tcp_server_port"].get<unsigned short>());
+  tcp_socket_.connect(branch_ep_);
   authenticate(msg_changer);
+  if (shm_negotiation_) decline_shm_transport(false);
 }
 
 void FakeBranch::accept(std::function<void(Buffer*)> msg_changer) {
   tcp_socket_ = acceptor_.accept();
   authenticate(msg_changer);
+  if (shm_negotiation_) decline_shm_transport(true);
 }
 
 void FakeBranch::disconnect() {
@@ -211,6 +232,131 @@ void FakeBranch::advertise(std::function<void(Buffer*)> msg_changer) {
   mc_socket_.send(msg);
 }
 
+Buffer FakeBranch::make_resumption_ticket() const {
+  return make_session_key("resumption");
+}
+
+Buffer FakeBranch::make_resumption_ticket_id() const {
+  return make_session_key("resumption id");
+}
+
+void FakeBranch::resume(const Buffer& ticket, const Buffer& ticket_id, bool valid_proof) {
+  tcp_socket_ = tcp::socket(ioc_);
+  tcp_socket_.connect(branch_ep_);
+
+  // Send resumption request
+  my_challenge_ = generate_random_bytes(BranchInfo::kChallengeSize);
+  asio::write(tcp_socket_, asio::buffer(*info_->make_resumption_request_message(my_challenge_, ticket_id)));
+
+  // Receive branch info
+  auto buffer = Buffer(BranchInfo::kInfoMessageHeaderSize);
+  asio::read(tcp_socket_, asio::buffer(buffer));
+  std::size_t body_size;
+  RemoteBranchInfo::deserialize_info_message_body_size(&body_size, buffer);
+  buffer.resize(body_size);
+  asio::read(tcp_socket_, asio::buffer(buffer));
+  remote_challenge_ = Buffer(buffer.end() - BranchInfo::kChallengeSize, buffer.end());
+
+  // ACK and proof; the branch closes the connection if it rejects the ticket ID
+  buffer.resize(1 + BranchInfo::kResumptionProofSize);
+  asio::read(tcp_socket_, asio::buffer(buffer));
+  EXPECT_EQ(buffer[0], MessageType::kAcknowledge);
+  EXPECT_EQ(Buffer(buffer.begin() + 1, buffer.end()), make_resumption_proof(ticket, "server"));
+
+  // Our proof; the branch closes the connection if it rejects it
+  auto proof = make_resumption_proof(ticket, "client");
+  if (!valid_proof) ++proof[0];
+  asio::write(tcp_socket_, asio::buffer(proof));
+
+  if (!valid_proof) {
+    asio::read(tcp_socket_, asio::buffer(buffer.data(), 1));
+  }
+}
+
+Buffer FakeBranch::make_resumption_proof(const Buffer& ticket, const std::string& role) const {
+  // We were the client, i.e. the one that created the TCP connection
+  auto data = my_challenge_;
+  data.insert(data.end(), remote_challenge_.begin(), remote_challenge_.end());
+  data.insert(data.end(), role.begin(), role.end());
+  return make_hmac_sha256(ticket, data.data(), data.size());
+}
+
+Buffer FakeBranch::make_session_key(const std::string& label) const {
+  // We were the client, i.e. the one that created the TCP connection
+  auto secret = my_challenge_;
+  secret.insert(secret.end(), remote_challenge_.begin(), remote_challenge_.end());
+  secret.insert(secret.end(), password_hash_.begin(), password_hash_.end());
+  secret = make_sha256(secret);
+
+  secret.insert(secret.end(), label.begin(), label.end());
+  return make_sha256(secret);
+}
+
+void FakeBranch::send_message(const OutgoingMessage& msg) {
+  auto& msg_bytes = msg.serialize();
+
+  std::array<Byte, 5> size_field;
+  auto n = serialize_msg_size_field(msg_bytes.size(), &size_field);
+
+  std::array<asio::const_buffer, 2> data = {asio::buffer(size_field.data(), n),
+                                            asio::buffer(msg_bytes.data(), msg_bytes.size())};
+  asio::write(tcp_socket_, data);
+}
+
+Buffer FakeBranch::receive_message() {
+  while (true) {
+    std::array<Byte, 5> size_field;
+    std::size_t n = 0;
+    std::size_t msg_size;
+    do {
+      asio::read(tcp_socket_, asio::buffer(&size_field[n], 1));
+      ++n;
+    } while (!deserialize_msg_size_field(size_field, n, &msg_size));
+
+    if (msg_size == 0) continue;  // Heartbeat
+
+    Buffer msg(msg_size);
+    asio::read(tcp_socket_, asio::buffer(msg));
+    return msg;
+  }
+}
+
+void FakeBranch::send_multicast_datagram(const Buffer& key, std::uint64_t seq, const SmallBuffer& msg_bytes,
+                                         bool valid_mac) {
+  auto msg = asio::buffer(msg_bytes.data(), msg_bytes.size());
+
+  auto datagram = MulticastSender::make_datagram_header(info_->get_uuid(), seq);
+  auto mac      = MulticastSender::make_mac(key, asio::buffer(datagram), msg);
+  if (!valid_mac) mac[0] ^= 1;
+
+  datagram.insert(datagram.end(), msg_bytes.begin(), msg_bytes.end());
+  datagram.insert(datagram.end(), mac.begin(), mac.end());
+  bc_mc_socket_->send(datagram);
+}
+
+std::pair<std::uint64_t, Buffer> FakeBranch::receive_multicast_datagram(const Buffer& key) {
+  while (true) {
+    auto datagram = bc_mc_socket_->receive().second;
+    EXPECT_GE(datagram.size(), MulticastSender::kDatagramHeaderSize + MulticastSender::kMacSize);
+
+    auto msg_begin = datagram.begin() + MulticastSender::kDatagramHeaderSize;
+    auto mac_begin = datagram.end() - MulticastSender::kMacSize;
+    if (msg_begin == mac_begin) continue;
+
+    std::uint64_t seq = 0;
+    for (auto it = msg_begin - 8; it != msg_begin; ++it) {
+      seq = (seq << 8) | *it;
+    }
+
+    Buffer header(datagram.begin(), msg_begin);
+    Buffer msg(msg_begin, mac_begin);
+    auto mac = MulticastSender::make_mac(key, asio::buffer(header), asio::buffer(msg));
+    EXPECT_EQ(Buffer(mac_begin, datagram.end()), mac);
+
+    return {seq, msg};
+  }
+}
+
 bool FakeBranch::is_connected_to(void* branch) const {
   struct Data {
     uuids::uuid my_uuid;
@@ -235,9 +381,19 @@ bool FakeBranch::is_connected_to(void* branch) const {
 }
 
 void FakeBranch::authenticate(std::function<void(Buffer*)> msg_changer) {
+  auto solve = [&](const Buffer& challenge) {
+    auto buffer = challenge;
+    buffer.insert(buffer.end(), password_hash_.begin(), password_hash_.end());
+    return make_sha256(buffer);
+  };
+
   // Send branch info
-  auto info_msg = *info_->make_info_message();
+  auto my_challenge = generate_random_bytes(BranchInfo::kChallengeSize);
+  my_challenge_     = my_challenge;
+  auto info_msg     = pipelined_handshake_ ? *info_->make_pipelined_info_message(my_challenge)
+                                       : *info_->make_info_message();
   if (msg_changer) msg_changer(&info_msg);
+  shm_negotiation_ = RemoteBranchInfo::has_shm_negotiation_flag(info_msg);
   asio::write(tcp_socket_, asio::buffer(info_msg));
 
   // Receive branch info
@@ -245,25 +401,37 @@ void FakeBranch::authenticate(std::function<void(Buffer*)> msg_changer) {
   asio::read(tcp_socket_, asio::buffer(buffer));
   std::size_t body_size;
   RemoteBranchInfo::deserialize_info_message_body_size(&body_size, buffer);
+  EXPECT_TRUE(RemoteBranchInfo::has_pipelined_handshake_flag(buffer));
   buffer.resize(body_size);
   asio::read(tcp_socket_, asio::buffer(buffer));
 
+  if (pipelined_handshake_) {
+    // ACK and solution
+    auto remote_challenge = Buffer(buffer.end() - BranchInfo::kChallengeSize, buffer.end());
+    auto remote_solution  = solve(remote_challenge);
+    remote_challenge_     = remote_challenge;
+    buffer                = Buffer{MessageType::kAcknowledge};
+    buffer.insert(buffer.end(), remote_solution.begin(), remote_solution.end());
+    asio::write(tcp_socket_, asio::buffer(buffer));
+    asio::read(tcp_socket_, asio::buffer(buffer));
+    EXPECT_EQ(buffer[0], MessageType::kAcknowledge);
+    EXPECT_EQ(Buffer(buffer.begin() + 1, buffer.end()), solve(my_challenge));
+    return;
+  }
+
   // ACK
   exchange_ack();
 
   // Send challenge
-  auto my_challenge = generate_random_bytes(8);
   asio::write(tcp_socket_, asio::buffer(my_challenge));
 
   // Receive challenge
-  auto remote_challenge = Buffer(8);
+  auto remote_challenge = Buffer(BranchInfo::kChallengeSize);
   asio::read(tcp_socket_, asio::buffer(remote_challenge));
+  remote_challenge_ = remote_challenge;
 
   // Send solution
-  auto password_hash = make_sha256(Buffer{});
-  buffer             = remote_challenge;
-  buffer.insert(buffer.end(), password_hash.begin(), password_hash.end());
-  auto remote_solution = make_sha256(buffer);
+  auto remote_solution = solve(remote_challenge);
   asio::write(tcp_socket_, asio::buffer(remote_solution));
 
   // Receive Solution
@@ -281,6 +449,19 @@ void FakeBranch::exchange_ack() {
   EXPECT_EQ(buffer[0], MessageType::kAcknowledge);
 }
 
+void FakeBranch::decline_shm_transport(bool accepted) {
+  // The branch runs on the same host, so it negotiates the transport
+  auto buffer = Buffer{0};
+  if (accepted) {
+    asio::write(tcp_socket_, asio::buffer(buffer));
+    asio::read(tcp_socket_, asio::buffer(buffer));
+  } else {
+    asio::read(tcp_socket_, asio::buffer(buffer));
+    buffer[0] = 0;
+    asio::write(tcp_socket_, asio::buffer(buffer));
+  }
+}
+
 CommandLine::CommandLine(std::initializer_list<std::string> args) {
   argc = static_cast<int>(args.size() + 1);
   argv = new char*[static_cast<std::size_t>(argc)];
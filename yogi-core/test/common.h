@@ -26,6 +26,7 @@
 #include <include/yogi_core.h>
 #include <src/api/errors.h>
 #include <src/data/buffer.h>
+#include <src/network/messages.h>
 #include <src/objects/branch/branch_info.h>
 
 #include <gtest/gtest.h>
@@ -162,25 +163,58 @@ class BranchEventRecorder final {
 
 class FakeBranch final {
  public:
-  FakeBranch();
+  // Uses the serial handshake of branches that do not support the pipelined
+  // handshake unless pipelined_handshake is true; broadcasts get multicast to
+  // the given port unless broadcast_multicast_port is 0
+  FakeBranch(bool pipelined_handshake = false, std::chrono::milliseconds resumption_window = {},
+             unsigned short broadcast_multicast_port = 0);
 
   void connect(void* branch, std::function<void(Buffer*)> info_changer = {});
   void accept(std::function<void(Buffer*)> info_changer = {});
   void disconnect();
   void advertise(std::function<void(Buffer*)> msg_changer = {});
 
+  // Ticket and its ID for resuming the last session established via
+  // connect(); resume() throws if the branch rejects the ticket ID or, if
+  // valid_proof is false, once the branch rejected our proof
+  Buffer make_resumption_ticket() const;
+  Buffer make_resumption_ticket_id() const;
+  void resume(const Buffer& ticket, const Buffer& ticket_id, bool valid_proof = true);
+
+  // Key derived from the secret of the last session established via connect()
+  Buffer make_session_key(const std::string& label) const;
+
+  // Messages exchanged over a running session; heartbeats get skipped
+  void send_message(const OutgoingMessage& msg);
+  Buffer receive_message();
+
+  // Datagrams with a broadcast message sent via multicast; datagrams that
+  // carry only a sequence number get skipped by receive_multicast_datagram()
+  void send_multicast_datagram(const Buffer& key, std::uint64_t seq, const SmallBuffer& msg_bytes,
+                               bool valid_mac = true);
+  std::pair<std::uint64_t, Buffer> receive_multicast_datagram(const Buffer& key);
+
   bool is_connected_to(void* branch) const;
 
  private:
   void authenticate(std::function<void(Buffer*)> info_changer);
   void exchange_ack();
+  void decline_shm_transport(bool accepted);
+  Buffer make_resumption_proof(const Buffer& ticket, const std::string& role) const;
 
+  const bool pipelined_handshake_;
+  bool shm_negotiation_;
   LocalBranchInfoPtr info_;
+  Buffer password_hash_;
+  Buffer my_challenge_;
+  Buffer remote_challenge_;
+  boost::asio::ip::tcp::endpoint branch_ep_;
   boost::asio::io_context ioc_;
   boost::asio::ip::tcp::acceptor acceptor_;
   boost::asio::ip::tcp::socket tcp_socket_;
   boost::asio::ip::udp::endpoint adv_ep_;
   MulticastSocket mc_socket_;
+  std::unique_ptr<MulticastSocket> bc_mc_socket_;
 };
 
 // ========== Helpers for command-line parameter emulation ==========
@@ -0,0 +1,93 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <test/common.h>
+
+#include <src/data/compression.h>
+
+class CompressionTest : public TestFixture {
+ protected:
+  static Buffer make_compressible_data() {
+    Buffer data;
+    for (int i = 0; i < 1000; ++i) {
+      data.push_back(static_cast<Byte>(i % 10));
+    }
+
+    return data;
+  }
+
+  static Buffer make_incompressible_data() {
+    Buffer data;
+    for (int i = 0; i < 200; ++i) {
+      data.push_back(static_cast<Byte>(i));
+    }
+
+    return data;
+  }
+};
+
+TEST_F(CompressionTest, CompressAndDecompress) {
+  auto data = make_compressible_data();
+
+  SmallBuffer compressed{'x'};
+  ASSERT_TRUE(compress_data(data.data(), data.size(), &compressed));
+  EXPECT_LT(compressed.size(), data.size());
+  EXPECT_EQ(compressed[0], 'x');
+
+  Buffer decompressed(data.size());
+  ASSERT_TRUE(decompress_data(compressed.data() + 1, compressed.size() - 1, &decompressed));
+  EXPECT_EQ(decompressed, data);
+}
+
+TEST_F(CompressionTest, IncompressibleData) {
+  auto data = make_incompressible_data();
+
+  SmallBuffer compressed{'x'};
+  EXPECT_FALSE(compress_data(data.data(), data.size(), &compressed));
+  EXPECT_EQ(compressed, SmallBuffer{'x'});
+
+  EXPECT_FALSE(compress_data(data.data(), 0, &compressed));
+}
+
+TEST_F(CompressionTest, DecompressedSizeMismatch) {
+  auto data = make_compressible_data();
+
+  SmallBuffer compressed;
+  ASSERT_TRUE(compress_data(data.data(), data.size(), &compressed));
+
+  Buffer too_small(data.size() - 1);
+  EXPECT_FALSE(decompress_data(compressed.data(), compressed.size(), &too_small));
+
+  Buffer too_large(data.size() + 1);
+  EXPECT_FALSE(decompress_data(compressed.data(), compressed.size(), &too_large));
+}
+
+TEST_F(CompressionTest, CorruptData) {
+  auto data = make_compressible_data();
+
+  SmallBuffer compressed;
+  ASSERT_TRUE(compress_data(data.data(), data.size(), &compressed));
+  compressed[compressed.size() / 2] ^= 0xFF;
+
+  Buffer decompressed(data.size());
+  EXPECT_FALSE(decompress_data(compressed.data(), compressed.size(), &decompressed));
+  EXPECT_FALSE(decompress_data(compressed.data(), compressed.size() / 2, &decompressed));
+}
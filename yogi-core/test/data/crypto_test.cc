@@ -37,6 +37,24 @@ TEST(CryptoTest, MakeSha256) {
   EXPECT_EQ(make_sha256("hello"s), bytes);
 }
 
+TEST(CryptoTest, MakeHmacSha256) {
+  // Test case 2 from RFC 4231
+  auto data  = "what do ya want for nothing?"s;
+  auto bytes = make_hmac_sha256(Buffer{'J', 'e', 'f', 'e'}, reinterpret_cast<const Byte*>(data.data()), data.size());
+  auto mac   = Buffer{
+      0x5b, 0xdc, 0xc1, 0x46, 0xbf, 0x60, 0x75, 0x4e, 0x6a, 0x04, 0x24, 0x26, 0x08, 0x95, 0x75, 0xc7,
+      0x5a, 0x00, 0x3f, 0x08, 0x9d, 0x27, 0x39, 0x83, 0x9d, 0xec, 0x58, 0xb9, 0x64, 0xec, 0x38, 0x43,
+  };
+  EXPECT_EQ(bytes, mac);
+}
+
+TEST(CryptoTest, SecureEqual) {
+  EXPECT_TRUE(secure_equal(Buffer{1, 2, 3}, Buffer{1, 2, 3}));
+  EXPECT_FALSE(secure_equal(Buffer{1, 2, 3}, Buffer{1, 2, 4}));
+  EXPECT_FALSE(secure_equal(Buffer{1, 2, 3}, Buffer{1, 2}));
+  EXPECT_TRUE(secure_equal(Buffer{}, Buffer{}));
+}
+
 TEST(CryptoTest, GenerateRandomBytes) {
   auto bytes = generate_random_bytes(5);
   EXPECT_EQ(bytes.size(), 5);
@@ -0,0 +1,179 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <test/common.h>
+
+#include <src/data/json_transcoder.h>
+
+#include <nlohmann/json.hpp>
+
+class JsonTranscoderTest : public TestFixture {
+ protected:
+  static SmallBuffer to_msgpack(const std::string& json) {
+    SmallBuffer msgpack;
+    transcode_json_to_msgpack(json.data(), json.size(), &msgpack);
+    return msgpack;
+  }
+
+  static std::string to_json(const SmallBuffer& msgpack) {
+    std::string json(transcode_msgpack_to_json(msgpack.data(), msgpack.size(), {}), '\0');
+    auto n = transcode_msgpack_to_json(msgpack.data(), msgpack.size(), boost::asio::buffer(json));
+    EXPECT_EQ(n, json.size());
+    EXPECT_EQ(json.back(), '\0');
+    json.pop_back();
+    return json;
+  }
+
+  static SmallBuffer to_msgpack_via_dom(const std::string& json) {
+    auto bytes = nlohmann::json::to_msgpack(nlohmann::json::parse(json));
+    return SmallBuffer(bytes.begin(), bytes.end());
+  }
+
+  static std::string to_json_via_dom(const SmallBuffer& msgpack) {
+    return nlohmann::json::from_msgpack(msgpack.begin(), msgpack.end()).dump();
+  }
+
+  // Keys are sorted since nlohmann::json sorts them as well
+  const std::vector<std::string> documents_ = {
+      "null",
+      "true",
+      "false",
+      "0",
+      "127",
+      "128",
+      "255",
+      "256",
+      "65535",
+      "65536",
+      "4294967295",
+      "4294967296",
+      "18446744073709551615",
+      "-1",
+      "-32",
+      "-33",
+      "-128",
+      "-129",
+      "-32768",
+      "-32769",
+      "-2147483648",
+      "-2147483649",
+      "-9223372036854775808",
+      "0.5",
+      "0.1",
+      "-1.5e300",
+      "1e-7",
+      R"("")",
+      R"("hello")",
+      R"("\"\\\/\b\f\n\r\t\u0001\u001f\u007f")",
+      R"("Grüße 日本 😀")",
+      R"("01234567890123456789012345678901")",
+      "[]",
+      "{}",
+      "[1,[2,[3,[]]],{}]",
+      R"({"a":1,"b":[true,false,null],"c":{"d":"e","f":{}}})",
+  };
+};
+
+TEST_F(JsonTranscoderTest, JsonToMsgPack) {
+  for (auto& doc : documents_) {
+    EXPECT_EQ(to_msgpack(doc), to_msgpack_via_dom(doc)) << doc;
+  }
+}
+
+TEST_F(JsonTranscoderTest, MsgPackToJson) {
+  for (auto& doc : documents_) {
+    auto msgpack = to_msgpack_via_dom(doc);
+    EXPECT_EQ(to_json(msgpack), to_json_via_dom(msgpack)) << doc;
+  }
+}
+
+TEST_F(JsonTranscoderTest, LargeContainers) {
+  for (std::size_t n : {15, 16, 65535, 65536}) {
+    auto json = nlohmann::json::array();
+    auto obj  = nlohmann::json::object();
+    for (std::size_t i = 0; i < n; ++i) {
+      json.push_back(i);
+      obj[std::to_string(1000000 + i)] = i;
+    }
+
+    for (auto& doc : {json.dump(), obj.dump()}) {
+      auto msgpack = to_msgpack(doc);
+      EXPECT_EQ(msgpack, to_msgpack_via_dom(doc)) << n;
+      EXPECT_EQ(to_json(msgpack), doc) << n;
+    }
+  }
+}
+
+TEST_F(JsonTranscoderTest, LongStrings) {
+  for (std::size_t n : {255, 256, 65535, 65536}) {
+    auto doc = nlohmann::json(std::string(n, 'x')).dump();
+    auto msgpack = to_msgpack(doc);
+    EXPECT_EQ(msgpack, to_msgpack_via_dom(doc)) << n;
+    EXPECT_EQ(to_json(msgpack), doc) << n;
+  }
+}
+
+TEST_F(JsonTranscoderTest, KeyOrderPreserved) {
+  std::string doc = R"({"b":1,"a":2})";
+  EXPECT_EQ(to_json(to_msgpack(doc)), doc);
+}
+
+TEST_F(JsonTranscoderTest, BinaryAndExtension) {
+  SmallBuffer bin = {0xC4, 0x02, 0x01, 0xFF};
+  EXPECT_EQ(to_json(bin), to_json_via_dom(bin));
+
+  SmallBuffer ext = {0xD5, 0x05, 0x01, 0x02};
+  EXPECT_EQ(to_json(ext), to_json_via_dom(ext));
+}
+
+TEST_F(JsonTranscoderTest, InvalidJson) {
+  SmallBuffer msgpack = {0x01};
+  for (std::string doc : {"", "[1,", "{\"a\"}", "[1]x", "{1:2}", "1e400"}) {
+    EXPECT_THROW_ERROR(transcode_json_to_msgpack(doc.data(), doc.size(), &msgpack), YOGI_ERR_PARSING_JSON_FAILED);
+    EXPECT_EQ(msgpack, SmallBuffer{0x01}) << doc;
+  }
+}
+
+TEST_F(JsonTranscoderTest, InvalidMsgPack) {
+  std::vector<SmallBuffer> invalid = {
+      {},                  // Empty
+      {0xC1},              // Unused type byte
+      {0x92, 0x01},        // Missing array element
+      {0xD9, 0x05, 'a'},   // String too short
+      {0x81, 0x01, 0x02},  // Non-string key
+      {0xA1, 0xC0},        // Invalid UTF-8
+      {0xA2, 0xED, 0xA0},  // Surrogate
+      {0x01, 0x02},        // Trailing data
+  };
+
+  for (auto& msgpack : invalid) {
+    EXPECT_THROW_ERROR(to_json(msgpack), YOGI_ERR_INVALID_USER_MSGPACK);
+  }
+}
+
+TEST_F(JsonTranscoderTest, BufferTooSmall) {
+  auto msgpack = to_msgpack(R"(["abc",123])");
+
+  char buffer[5];
+  auto n = transcode_msgpack_to_json(msgpack.data(), msgpack.size(), boost::asio::buffer(buffer));
+  EXPECT_EQ(n, 12u);
+  EXPECT_EQ(std::string(buffer, sizeof(buffer)), R"(["abc)");
+}
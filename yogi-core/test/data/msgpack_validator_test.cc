@@ -0,0 +1,143 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <test/common.h>
+
+#include <src/data/msgpack_validator.h>
+
+#include <msgpack.hpp>
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <iostream>
+
+class MsgPackValidatorTest : public TestFixture {
+ protected:
+  static Buffer make_msgpack(const nlohmann::json& json) {
+    return nlohmann::json::to_msgpack(json);
+  }
+
+  // Telemetry-like payload with a mix of numbers, strings and nested objects
+  static Buffer make_payload(std::size_t min_size) {
+    auto json = nlohmann::json::array();
+    while (make_msgpack(json).size() < min_size) {
+      json.push_back({{"id", json.size()},
+                      {"name", "sensor-" + std::to_string(json.size())},
+                      {"value", 3.14159 * static_cast<double>(json.size())},
+                      {"ok", true},
+                      {"samples", {1, -200, 70000, 5000000000}}});
+    }
+
+    return make_msgpack(json);
+  }
+
+  static bool validate(const Buffer& data) {
+    std::size_t error_offset;
+    return validate_msgpack(data.data(), data.size(), &error_offset);
+  }
+};
+
+TEST_F(MsgPackValidatorTest, ValidData) {
+  auto data = Buffer{0xC4, 0x02, 0x01, 0x02};  // bin 8
+  EXPECT_TRUE(validate(data));
+
+  data = Buffer{0xD6, 0x01, 0x01, 0x02, 0x03, 0x04};  // fixext 4
+  EXPECT_TRUE(validate(data));
+
+  for (std::size_t n : {0, 15, 16, 65535, 65536}) {
+    EXPECT_TRUE(validate(make_msgpack(std::string(n, 'x')))) << n;
+    EXPECT_TRUE(validate(make_msgpack(nlohmann::json::array({nlohmann::json(n)})))) << n;
+    EXPECT_TRUE(validate(make_msgpack(std::vector<int>(n, -1000)))) << n;
+  }
+
+  EXPECT_TRUE(validate(make_payload(32 * 1024)));
+}
+
+TEST_F(MsgPackValidatorTest, InvalidData) {
+  std::vector<Buffer> invalid = {
+      {},                    // Empty
+      {0xC1},                // Unused type byte
+      {0x92, 0x01},          // Missing array element
+      {0x81, 0x01},          // Missing map value
+      {0xD9, 0x05, 'a'},     // String too short
+      {0xDA, 0x00},          // Incomplete length field
+      {0xCB, 0x00, 0x00},    // Incomplete float
+      {0xDD, 0xFF, 0xFF, 0xFF, 0xFF, 0xC0},  // Huge array
+      {0x01, 0x02},          // Trailing data
+  };
+
+  for (auto& data : invalid) {
+    EXPECT_FALSE(validate(data));
+  }
+}
+
+TEST_F(MsgPackValidatorTest, TruncatedData) {
+  auto data = make_payload(1000);
+  for (std::size_t n = 0; n < data.size(); ++n) {
+    std::size_t error_offset;
+    EXPECT_FALSE(validate_msgpack(data.data(), n, &error_offset)) << n;
+    EXPECT_LE(error_offset, n);
+  }
+}
+
+TEST_F(MsgPackValidatorTest, ErrorOffset) {
+  auto data = Buffer{0x93, 0x01, 0xC1, 0x02};
+  std::size_t error_offset;
+  EXPECT_FALSE(validate_msgpack(data.data(), data.size(), &error_offset));
+  EXPECT_EQ(error_offset, 2);
+}
+
+// Run with --gtest_also_run_disabled_tests to compare the validator with
+// msgpack::parse() and a null visitor, as used before
+TEST_F(MsgPackValidatorTest, DISABLED_Benchmark) {
+  using clock = std::chrono::steady_clock;
+
+  struct NullVisitor : public msgpack::null_visitor {
+    void parse_error(std::size_t, std::size_t) {
+    }
+
+    void insufficient_bytes(std::size_t, std::size_t) {
+    }
+  };
+
+  for (std::size_t size : {100, 1000, 8 * 1024, 32 * 1024}) {
+    auto data       = make_payload(size);
+    auto iterations = 100'000'000 / data.size();
+
+    auto start = clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+      NullVisitor visitor;
+      auto ok = msgpack::parse(reinterpret_cast<const char*>(data.data()), data.size(), visitor);
+      ASSERT_TRUE(ok);
+    }
+    auto parse_time = clock::now() - start;
+
+    start = clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+      ASSERT_TRUE(validate(data));
+    }
+    auto validate_time = clock::now() - start;
+
+    auto per_msg = [&](auto t) { return std::chrono::duration<double, std::nano>(t).count() / iterations; };
+    std::cout << data.size() << " bytes: msgpack::parse() " << per_msg(parse_time) << " ns, validate_msgpack() "
+              << per_msg(validate_time) << " ns" << std::endl;
+  }
+}
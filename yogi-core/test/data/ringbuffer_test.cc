@@ -23,6 +23,9 @@
 
 #include <src/data/ringbuffer.h>
 
+#include <thread>
+#include <vector>
+
 class RingBufferTest : public TestFixture {
  protected:
   LockFreeRingBuffer uut{10};
@@ -93,6 +96,110 @@ TEST_F(RingBufferTest, FirstWriteArray) {
   EXPECT_EQ(0, first_write_array_size());
 }
 
+TEST_F(RingBufferTest, ReadArrays) {
+  auto arrays = uut.read_arrays();
+  EXPECT_EQ(0, arrays[0].size());
+  EXPECT_EQ(0, arrays[1].size());
+
+  Buffer data{1, 2, 3, 4, 5, 6, 7, 8};
+  uut.write(data.data(), data.size());
+  arrays = uut.read_arrays();
+  EXPECT_EQ(data.size(), arrays[0].size());
+  EXPECT_EQ(0, arrays[1].size());
+
+  uut.commit_read_arrays(6);
+  uut.write(data.data(), 5);
+  arrays = uut.read_arrays();
+  EXPECT_EQ(uut.available_for_read(), arrays[0].size() + arrays[1].size());
+  EXPECT_GT(arrays[1].size(), 0);
+
+  Buffer out(uut.available_for_read());
+  boost::asio::buffer_copy(boost::asio::buffer(out), arrays);
+  EXPECT_EQ(out, (Buffer{7, 8, 1, 2, 3, 4, 5}));
+
+  uut.commit_read_arrays(uut.available_for_read());
+  EXPECT_TRUE(uut.empty());
+}
+
+TEST_F(RingBufferTest, TryWriteConcurrently) {
+  Buffer hdr{1, 2};
+  Buffer body{3, 4, 5};
+  EXPECT_TRUE(uut.try_write_concurrently({boost::asio::buffer(hdr), boost::asio::buffer(body)}));
+  EXPECT_TRUE(uut.try_write_concurrently({boost::asio::buffer(hdr), boost::asio::const_buffer()}));
+  EXPECT_FALSE(uut.try_write_concurrently({boost::asio::buffer(hdr), boost::asio::buffer(body)}));
+  EXPECT_EQ(uut.available_for_read(), 7);
+
+  Buffer data(7);
+  uut.read(data.data(), data.size());
+  EXPECT_EQ(data, (Buffer{1, 2, 3, 4, 5, 1, 2}));
+
+  // Wraps around the end of the buffer
+  EXPECT_TRUE(uut.try_write_concurrently({boost::asio::buffer(hdr), boost::asio::buffer(body)}));
+  data.resize(5);
+  uut.read(data.data(), data.size());
+  EXPECT_EQ(data, (Buffer{1, 2, 3, 4, 5}));
+  EXPECT_TRUE(uut.empty());
+}
+
+TEST_F(RingBufferTest, TryWriteConcurrentlyBeforePublish) {
+  Buffer data{1, 2, 3};
+  uut.write(data.data(), 2);
+
+  LockFreeRingBuffer::size_type end_idx = 0;
+  EXPECT_TRUE(uut.try_write_concurrently({boost::asio::buffer(data), boost::asio::const_buffer()}, [&](auto idx) {
+    EXPECT_EQ(uut.available_for_read(), 2);
+    end_idx = idx;
+  }));
+
+  EXPECT_EQ(uut.available_for_read(), 5);
+  EXPECT_EQ(uut.readable_bytes_before(end_idx), 5);
+  uut.discard(4);
+  EXPECT_EQ(uut.readable_bytes_before(end_idx), 1);
+  uut.discard(1);
+  EXPECT_EQ(uut.readable_bytes_before(end_idx), 0);
+}
+
+TEST_F(RingBufferTest, TryWriteConcurrentlyMultipleProducers) {
+  const int kProducers = 4;
+  const int kRecords   = 10'000;
+
+  LockFreeRingBuffer rb(64);
+
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kProducers; ++i) {
+    producers.push_back(std::thread([&, i] {
+      for (int j = 0; j < kRecords; ++j) {
+        Byte id  = static_cast<Byte>(i);
+        Byte seq = static_cast<Byte>(j);
+        while (!rb.try_write_concurrently({boost::asio::buffer(&id, 1), boost::asio::buffer(&seq, 1)})) {
+          std::this_thread::yield();
+        }
+      }
+    }));
+  }
+
+  std::vector<int> records_received(kProducers);
+  for (int n = 0; n < kProducers * kRecords;) {
+    Byte record[2];
+    if (rb.available_for_read() < sizeof(record)) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    rb.read(record, sizeof(record));
+    ASSERT_LT(record[0], kProducers);
+    EXPECT_EQ(record[1], static_cast<Byte>(records_received[record[0]]));
+    ++records_received[record[0]];
+    ++n;
+  }
+
+  for (auto& producer : producers) {
+    producer.join();
+  }
+
+  EXPECT_TRUE(rb.empty());
+}
+
 TEST_F(RingBufferTest, Empty) {
   EXPECT_TRUE(uut.empty());
   Buffer buffer{'x'};
@@ -168,3 +275,35 @@ TEST_F(RingBufferTest, AvailableForWrite) {
     EXPECT_EQ(uut.available_for_write(), uut.capacity() - i - 1);
   }
 }
+
+TEST_F(RingBufferTest, Mirrored) {
+  LockFreeRingBuffer rb(10, true);
+  if (!rb.mirrored()) {
+    GTEST_SKIP() << "Mirrored memory not supported on this platform";
+  }
+
+  EXPECT_GE(rb.capacity(), 10);
+  EXPECT_EQ(boost::asio::buffer_size(rb.first_write_array()), rb.capacity());
+
+  Buffer data(rb.capacity() - 2, 'x');
+  rb.write(data.data(), data.size());
+  rb.discard(data.size());
+
+  // The data now wraps around the end of the mapped memory
+  Buffer msg{1, 2, 3, 4, 5};
+  EXPECT_EQ(rb.write(msg.data(), msg.size()), msg.size());
+  EXPECT_EQ(boost::asio::buffer_size(rb.first_read_array()), msg.size());
+  EXPECT_EQ(boost::asio::buffer_size(rb.first_write_array()), rb.capacity() - msg.size());
+
+  auto arrays = rb.read_arrays();
+  EXPECT_EQ(arrays[0].size(), msg.size());
+  EXPECT_EQ(arrays[1].size(), 0);
+
+  auto p = static_cast<const Byte*>(arrays[0].data());
+  EXPECT_EQ(Buffer(p, p + msg.size()), msg);
+
+  Buffer out(msg.size());
+  EXPECT_EQ(rb.read(out.data(), out.size()), msg.size());
+  EXPECT_EQ(out, msg);
+  EXPECT_TRUE(rb.empty());
+}
@@ -0,0 +1,213 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <test/common.h>
+
+#include <src/network/loopback_listener.h>
+#include <src/network/loopback_transport.h>
+
+#include <boost/uuid/random_generator.hpp>
+
+using namespace std::chrono_literals;
+
+class LoopbackTransportTest : public TestFixture {
+ protected:
+  virtual void SetUp() override {
+    std::tie(connector_, acceptor_) = LoopbackTransport::create_pair(cfg_, cfg_, 10);
+  }
+
+  virtual void TearDown() override {
+    connector_->close();
+    acceptor_->close();
+  }
+
+  void transfer(TransportPtr from, TransportPtr to, std::vector<char> data, bool receive_first) {
+    std::vector<char> buffer(data.size());
+    bool received = false;
+    auto receive  = [&] {
+      to->receive_all_async(boost::asio::buffer(buffer), [&](auto& res) {
+        EXPECT_EQ(res, Success());
+        received = true;
+      });
+    };
+
+    if (receive_first) receive();
+
+    bool sent = false;
+    from->send_all_async(boost::asio::buffer(data), [&](auto& res) {
+      EXPECT_EQ(res, Success());
+      sent = true;
+    });
+
+    if (!receive_first) receive();
+
+    while (!sent || !received) {
+      context_->run_one(100us);
+    }
+
+    EXPECT_EQ(data, buffer);
+  }
+
+  static constexpr std::size_t kNoLimit = std::numeric_limits<std::size_t>::max();
+
+  ContextPtr context_ = Context::create();
+  LoopbackTransport::EndpointConfig cfg_{context_, 10s, kNoLimit};
+  LoopbackTransportPtr connector_;
+  LoopbackTransportPtr acceptor_;
+};
+
+TEST_F(LoopbackTransportTest, CreatePair) {
+  EXPECT_FALSE(connector_->created_from_incoming_connection_request());
+  EXPECT_TRUE(acceptor_->created_from_incoming_connection_request());
+}
+
+TEST_F(LoopbackTransportTest, SendToWaitingReceiver) {
+  transfer(connector_, acceptor_, {1, 2, 3, 4, 5, 6}, true);
+  transfer(acceptor_, connector_, {7, 8, 9}, true);
+}
+
+TEST_F(LoopbackTransportTest, SendToBuffer) {
+  transfer(connector_, acceptor_, {1, 2, 3, 4, 5, 6}, false);
+  transfer(acceptor_, connector_, {7, 8, 9}, false);
+}
+
+TEST_F(LoopbackTransportTest, SendMoreThanBufferSize) {
+  std::vector<char> data(1000);
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>(i);
+  }
+
+  transfer(connector_, acceptor_, data, false);
+  transfer(acceptor_, connector_, data, true);
+}
+
+TEST_F(LoopbackTransportTest, ReceiveFromWaitingSender) {
+  std::vector<char> data(15);
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>(i);
+  }
+
+  // The first send fills the intermediate buffer, so the second one waits
+  std::size_t bytes_written = 0;
+  for (std::size_t offset : {0, 10}) {
+    connector_->send_some_async(boost::asio::buffer(data) + offset, [&](auto& res, auto n) {
+      EXPECT_EQ(res, Success());
+      bytes_written += n;
+    });
+
+    context_->poll();
+  }
+
+  EXPECT_EQ(bytes_written, 10u);
+
+  // The waiting sender's data follows the buffered data within one receive
+  std::vector<char> buffer(20);
+  std::size_t bytes_read = 0;
+  acceptor_->receive_some_async(boost::asio::buffer(buffer), [&](auto& res, auto n) {
+    EXPECT_EQ(res, Success());
+    bytes_read = n;
+  });
+
+  while (bytes_read == 0 || bytes_written < data.size()) {
+    context_->run_one(100us);
+  }
+
+  EXPECT_EQ(bytes_read, data.size());
+  EXPECT_EQ(bytes_written, data.size());
+  EXPECT_EQ(data, std::vector<char>(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(bytes_read)));
+}
+
+TEST_F(LoopbackTransportTest, SendBufferSequence) {
+  std::vector<char> data = {1, 2, 3, 4, 5, 6};
+  Transport::ConstBufferSequence seq{boost::asio::buffer(data.data(), 2),
+                                     boost::asio::buffer(data.data() + 2, data.size() - 2)};
+
+  bool sent = false;
+  connector_->send_some_async(seq, [&](auto& res, auto bytes_written) {
+    EXPECT_EQ(res, Success());
+    EXPECT_EQ(bytes_written, data.size());
+    sent = true;
+  });
+
+  std::vector<char> buffer(data.size());
+  bool received = false;
+  acceptor_->receive_all_async(boost::asio::buffer(buffer), [&](auto& res) {
+    EXPECT_EQ(res, Success());
+    received = true;
+  });
+
+  while (!sent || !received) {
+    context_->run_one(100us);
+  }
+
+  EXPECT_EQ(data, buffer);
+}
+
+TEST_F(LoopbackTransportTest, PeerClosed) {
+  std::vector<char> buffer(10);
+  bool called = false;
+  acceptor_->receive_some_async(boost::asio::buffer(buffer), [&](auto& res, auto) {
+    EXPECT_EQ(res, Error(YOGI_ERR_RW_SOCKET_FAILED));
+    called = true;
+  });
+
+  connector_->close();
+
+  while (!called) {
+    context_->run_one(100us);
+  }
+}
+
+TEST_F(LoopbackTransportTest, CloseCancelsPendingReceive) {
+  std::vector<char> buffer(10);
+  bool called = false;
+  connector_->receive_some_async(boost::asio::buffer(buffer), [&](auto& res, auto) {
+    EXPECT_EQ(res, Error(YOGI_ERR_CANCELED));
+    called = true;
+  });
+
+  connector_->close();
+
+  while (!called) {
+    context_->run_one(100us);
+  }
+}
+
+TEST_F(LoopbackTransportTest, Listener) {
+  auto uuid = boost::uuids::random_generator()();
+  EXPECT_FALSE(LoopbackListener::connect(context_, uuid, 10s, kNoLimit));
+
+  LoopbackTransportPtr accepted;
+  auto listener = std::make_shared<LoopbackListener>(context_, uuid, 10s, kNoLimit);
+  listener->start([&](auto transport) { accepted = transport; });
+
+  auto connected = LoopbackListener::connect(context_, uuid, 10s, kNoLimit);
+  ASSERT_TRUE(!!connected);
+
+  while (!accepted) {
+    context_->run_one(100us);
+  }
+
+  transfer(connected, accepted, {1, 2, 3}, true);
+
+  listener.reset();
+  EXPECT_FALSE(LoopbackListener::connect(context_, uuid, 10s, kNoLimit));
+}
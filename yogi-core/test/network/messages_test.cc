@@ -64,6 +64,36 @@ TEST(MessageTest, UserDataMsgPack) {
   EXPECT_THROW_ERROR(payload.serialize_to(&buffer), YOGI_ERR_INVALID_USER_MSGPACK);
 }
 
+TEST(MessagesTest, UserDataRaw) {
+  auto data    = SmallBuffer{0xC1, 0x00, 0xFF};  // Not valid MessagePack
+  auto payload = Payload(boost::asio::buffer(data.data(), data.size()), YOGI_ENC_RAW);
+
+  SmallBuffer buffer;
+  EXPECT_NO_THROW(payload.serialize_to(&buffer));
+  EXPECT_EQ(buffer, (SmallBuffer{Payload::kRawPayloadMarker, 0xC1, 0x00, 0xFF}));
+
+  auto received = Payload::deserialize(boost::asio::buffer(buffer.data(), buffer.size()));
+  EXPECT_EQ(received.get_encoding(), YOGI_ENC_RAW);
+
+  Buffer user_data(data.size());
+  std::size_t n = 0;
+  auto res      = received.serialize_to_user_buffer(boost::asio::buffer(user_data), YOGI_ENC_RAW, &n);
+  EXPECT_EQ(res, Success());
+  EXPECT_EQ(n, data.size());
+  EXPECT_TRUE(std::equal(user_data.begin(), user_data.end(), data.begin()));
+
+  res = received.serialize_to_user_buffer(boost::asio::buffer(user_data), YOGI_ENC_JSON, &n);
+  EXPECT_EQ(res, Error(YOGI_ERR_INCOMPATIBLE_ENCODING));
+  res = received.serialize_to_user_buffer(boost::asio::buffer(user_data), YOGI_ENC_MSGPACK, &n);
+  EXPECT_EQ(res, Error(YOGI_ERR_INCOMPATIBLE_ENCODING));
+
+  auto msgpack = SmallBuffer{0x93, 0x1, 0x2, 0x3};
+  received     = Payload::deserialize(boost::asio::buffer(msgpack.data(), msgpack.size()));
+  EXPECT_EQ(received.get_encoding(), YOGI_ENC_MSGPACK);
+  res = received.serialize_to_user_buffer(boost::asio::buffer(user_data), YOGI_ENC_RAW, &n);
+  EXPECT_EQ(res, Error(YOGI_ERR_INCOMPATIBLE_ENCODING));
+}
+
 TEST(MessagesTest, UserDataSerializeToUserBuffer) {
   auto json    = Buffer{'[', '1', ',', '2', ',', '3', ']', '\0'};
   auto msgpack = Buffer{0x93, 0x1, 0x2, 0x3};
@@ -172,3 +202,204 @@ TEST(MessagesTest, Deserialize) {
 
   EXPECT_TRUE(called);
 }
+
+TEST(MessagesTest, CompressedMessage) {
+  Buffer data(1000, 0x42);
+  auto bc_msg = messages::BroadcastOutgoing(Payload(boost::asio::buffer(data), YOGI_ENC_RAW));
+
+  SmallBuffer compressed;
+  ASSERT_TRUE(compress_msg_bytes(bc_msg.serialize(), &compressed));
+  EXPECT_LT(compressed.size(), bc_msg.get_size());
+  EXPECT_EQ(compressed[0], MessageType::kCompressed);
+
+  auto compressed_buf = boost::asio::buffer(compressed.data(), compressed.size());
+  bool called         = false;
+  IncomingMessage::deserialize(
+      compressed_buf,
+      [&](const IncomingMessage& msg) {
+        EXPECT_EQ(msg.get_type(), MessageType::kBroadcast);
+
+        auto bcm = dynamic_cast<const messages::BroadcastIncoming*>(&msg);
+        ASSERT_NE(bcm, nullptr);
+        EXPECT_EQ(bcm->get_payload().get_encoding(), YOGI_ENC_RAW);
+        EXPECT_EQ(bcm->get_payload().get_data().size(), data.size());
+
+        called = true;
+      },
+      bc_msg.get_size());
+
+  EXPECT_TRUE(called);
+
+  // The decompressed message must not exceed the given size
+  auto fail_fn = [](const IncomingMessage&) { FAIL(); };
+  EXPECT_THROW_ERROR(IncomingMessage::deserialize(compressed_buf, fail_fn, bc_msg.get_size() - 1),
+                     YOGI_ERR_DESERIALIZE_MSG_FAILED);
+  EXPECT_THROW_ERROR(IncomingMessage::deserialize(compressed_buf, fail_fn), YOGI_ERR_DESERIALIZE_MSG_FAILED);
+
+  // Messages that do not get smaller are not compressed
+  SmallBuffer small_msg{MessageType::kBroadcast, 1, 2, 3, 4, 5, 6, 7};
+  EXPECT_FALSE(compress_msg_bytes(small_msg, &compressed));
+  EXPECT_TRUE(compressed.empty());
+}
+
+TEST(MessagesTest, CompressShared) {
+  Buffer data(1000, 0x42);
+  auto bc_msg = messages::BroadcastOutgoing(Payload(boost::asio::buffer(data), YOGI_ENC_RAW));
+
+  SmallBuffer compressed;
+  ASSERT_TRUE(compress_msg_bytes(bc_msg.serialize(), &compressed));
+
+  // The message only gets compressed once
+  auto bytes = bc_msg.compress_shared();
+  ASSERT_TRUE(bytes);
+  EXPECT_EQ(*bytes, compressed);
+  EXPECT_EQ(bc_msg.compress_shared(), bytes);
+
+  auto small_msg = FakeOutgoingMessage({MessageType::kBroadcast, 1, 2, 3, 4, 5, 6, 7});
+  EXPECT_FALSE(small_msg.compress_shared());
+}
+
+TEST(MessagesTest, CorruptCompressedMessage) {
+  auto check = [](const SmallBuffer& bytes) {
+    EXPECT_THROW_ERROR(IncomingMessage::deserialize(boost::asio::buffer(bytes.data(), bytes.size()),
+                                                    [](const IncomingMessage&) { FAIL(); }, 1000),
+                       YOGI_ERR_DESERIALIZE_MSG_FAILED);
+  };
+
+  SmallBuffer msg_bytes(500, 0);
+  msg_bytes[0] = MessageType::kBroadcast;
+
+  SmallBuffer compressed;
+  ASSERT_TRUE(compress_msg_bytes(msg_bytes, &compressed));
+
+  // Header too short
+  check(SmallBuffer(compressed.begin(), compressed.begin() + 4));
+
+  // Wrong decompressed size
+  auto bytes = compressed;
+  ++bytes[4];
+  check(bytes);
+
+  // Corrupt data
+  bytes = compressed;
+  bytes.resize(bytes.size() - 2);
+  check(bytes);
+
+  // Nested compressed messages
+  msg_bytes[0] = MessageType::kCompressed;
+  ASSERT_TRUE(compress_msg_bytes(msg_bytes, &bytes));
+  check(bytes);
+}
+
+TEST(MessagesTest, Fragment) {
+  auto header = messages::Fragment::make_header(1000, 300);
+  EXPECT_EQ(header, (messages::Fragment::Header{MessageType::kFragment, 0, 0, 0x03, 0xE8, 0, 0, 0x01, 0x2C}));
+
+  Buffer bytes(header.begin(), header.end());
+  bytes.resize(bytes.size() + 700, 0x55);
+
+  bool called = false;
+  IncomingMessage::deserialize(bytes, [&](const IncomingMessage& msg) {
+    EXPECT_EQ(msg.get_type(), MessageType::kFragment);
+
+    auto frag = dynamic_cast<const messages::FragmentIncoming*>(&msg);
+    ASSERT_NE(frag, nullptr);
+    EXPECT_EQ(frag->get_msg_size(), 1000u);
+    EXPECT_EQ(frag->get_offset(), 300u);
+    EXPECT_EQ(frag->get_data().size(), 700u);
+    EXPECT_FALSE(frag->is_first());
+    EXPECT_TRUE(frag->is_last());
+
+    called = true;
+  });
+
+  EXPECT_TRUE(called);
+
+  // Data exceeding the message size
+  bytes.push_back(0x55);
+  EXPECT_THROW_ERROR(IncomingMessage::deserialize(bytes, [](const IncomingMessage&) {}),
+                     YOGI_ERR_DESERIALIZE_MSG_FAILED);
+
+  // No data
+  bytes.resize(messages::Fragment::kHeaderSize);
+  EXPECT_THROW_ERROR(IncomingMessage::deserialize(bytes, [](const IncomingMessage&) {}),
+                     YOGI_ERR_DESERIALIZE_MSG_FAILED);
+}
+
+TEST(MessagesTest, MulticastSync) {
+  Buffer key(messages::MulticastSync::kKeySize, 0xAB);
+  auto bytes = messages::MulticastSyncOutgoing(0x0102030405060708, key).serialize();
+  EXPECT_EQ(bytes.size(), messages::MulticastSync::kSize);
+  EXPECT_EQ(SmallBuffer(bytes.begin(), bytes.begin() + 9),
+            (SmallBuffer{MessageType::kMulticastSync, 1, 2, 3, 4, 5, 6, 7, 8}));
+
+  bool called = false;
+  IncomingMessage::deserialize(boost::asio::buffer(bytes.data(), bytes.size()), [&](const IncomingMessage& msg) {
+    auto sync = dynamic_cast<const messages::MulticastSyncIncoming*>(&msg);
+    ASSERT_NE(sync, nullptr);
+    EXPECT_EQ(sync->get_seq(), 0x0102030405060708u);
+    EXPECT_EQ(sync->get_wrapped_key(), key);
+
+    called = true;
+  });
+
+  EXPECT_TRUE(called);
+
+  bytes.pop_back();
+  EXPECT_THROW_ERROR(IncomingMessage::deserialize(boost::asio::buffer(bytes.data(), bytes.size()),
+                                                  [](const IncomingMessage&) {}),
+                     YOGI_ERR_DESERIALIZE_MSG_FAILED);
+}
+
+TEST(MessagesTest, MulticastNack) {
+  auto bytes = messages::MulticastNackOutgoing(1234, 56).serialize();
+  EXPECT_EQ(bytes.size(), messages::MulticastNack::kSize);
+
+  bool called = false;
+  IncomingMessage::deserialize(boost::asio::buffer(bytes.data(), bytes.size()), [&](const IncomingMessage& msg) {
+    auto nack = dynamic_cast<const messages::MulticastNackIncoming*>(&msg);
+    ASSERT_NE(nack, nullptr);
+    EXPECT_EQ(nack->get_first_seq(), 1234u);
+    EXPECT_EQ(nack->get_count(), 56u);
+
+    called = true;
+  });
+
+  EXPECT_TRUE(called);
+}
+
+TEST(MessagesTest, MulticastRepair) {
+  auto bcm_bytes = messages::BroadcastOutgoing(Payload(boost::asio::buffer("x", 1), YOGI_ENC_RAW)).serialize();
+  auto bytes     = messages::MulticastRepairOutgoing(77, bcm_bytes).serialize();
+  EXPECT_EQ(bytes.size(), messages::MulticastRepair::kHeaderSize + bcm_bytes.size());
+
+  bool called = false;
+  IncomingMessage::deserialize(boost::asio::buffer(bytes.data(), bytes.size()), [&](const IncomingMessage& msg) {
+    auto repair = dynamic_cast<const messages::MulticastRepairIncoming*>(&msg);
+    ASSERT_NE(repair, nullptr);
+    EXPECT_EQ(repair->get_seq(), 77u);
+    EXPECT_FALSE(repair->is_lost());
+
+    auto data = repair->get_msg();
+    auto raw  = static_cast<const Byte*>(data.data());
+    EXPECT_EQ(SmallBuffer(raw, raw + data.size()), bcm_bytes);
+
+    called = true;
+  });
+
+  EXPECT_TRUE(called);
+
+  // Broadcast that the sender does not have anymore
+  bytes  = messages::MulticastRepairOutgoing(78, {}).serialize();
+  called = false;
+  IncomingMessage::deserialize(boost::asio::buffer(bytes.data(), bytes.size()), [&](const IncomingMessage& msg) {
+    auto repair = dynamic_cast<const messages::MulticastRepairIncoming*>(&msg);
+    ASSERT_NE(repair, nullptr);
+    EXPECT_EQ(repair->get_seq(), 78u);
+    EXPECT_TRUE(repair->is_lost());
+
+    called = true;
+  });
+
+  EXPECT_TRUE(called);
+}
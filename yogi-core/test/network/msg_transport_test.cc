@@ -26,6 +26,7 @@
 #include <algorithm>
 #include <atomic>
 #include <random>
+#include <thread>
 
 class FakeOutgoingMessage : public OutgoingMessage, public MessageT<MessageType::kBroadcast> {
  public:
@@ -145,6 +146,41 @@ class MessageTransportTest : public TestFixture {
     append_to_byte_vector(v, msg.serialize());
   }
 
+  static std::vector<Buffer> split_transport_bytes(const Buffer& data) {
+    std::vector<Buffer> msgs;
+    for (auto it = data.begin(); it != data.end();) {
+      std::array<Byte, 5> size_field;
+      std::size_t n = 0;
+      std::size_t msg_size;
+      do {
+        size_field[n++] = *it++;
+      } while (!deserialize_msg_size_field(size_field, n, &msg_size));
+
+      msgs.emplace_back(it, it + static_cast<Buffer::difference_type>(msg_size));
+      it += static_cast<Buffer::difference_type>(msg_size);
+    }
+
+    return msgs;
+  }
+
+  static void check_fragments(const std::vector<Buffer>& fragments, const SmallBuffer& msg_bytes) {
+    Buffer reassembled;
+    for (auto& fragment : fragments) {
+      IncomingMessage::deserialize(fragment, [&](auto& msg) {
+        ASSERT_EQ(msg.get_type(), MessageType::kFragment);
+        auto& frag = static_cast<const messages::FragmentIncoming&>(msg);
+        EXPECT_EQ(frag.get_msg_size(), msg_bytes.size());
+        EXPECT_EQ(frag.get_offset(), reassembled.size());
+        EXPECT_LE(frag.get_data().size(), messages::Fragment::kMaxDataSize);
+
+        auto data = static_cast<const Byte*>(frag.get_data().data());
+        reassembled.insert(reassembled.end(), data, data + frag.get_data().size());
+      });
+    }
+
+    EXPECT_EQ(reassembled, Buffer(msg_bytes.begin(), msg_bytes.end()));
+  }
+
   ContextPtr context_;
   std::shared_ptr<FakeTransport> transport_;
   MessageTransportPtr uut_;
@@ -211,6 +247,452 @@ TEST_F(MessageTransportTest, TrySendTransportFailure) {
   EXPECT_THROW_ERROR(uut_->try_send(make_message(5)), YOGI_ERR_RW_SOCKET_FAILED);
 }
 
+TEST_F(MessageTransportTest, TxCoalescingDelay) {
+  uut_->set_tx_coalescing(20ms, 0);
+  uut_->start();
+
+  auto msg = make_message(2);
+  EXPECT_TRUE(uut_->try_send(msg));
+  EXPECT_TRUE(uut_->try_send(msg));
+  context_->poll();
+  EXPECT_TRUE(transport_->tx_data.empty());
+
+  std::this_thread::sleep_for(30ms);
+  context_->poll();
+  EXPECT_EQ(transport_->tx_data, make_transport_bytes(2, msg, 2, msg));
+}
+
+TEST_F(MessageTransportTest, TxCoalescingThreshold) {
+  uut_->set_tx_coalescing(1h, 5);
+  uut_->start();
+
+  auto msg = make_message(2);
+  EXPECT_TRUE(uut_->try_send(msg));
+  context_->poll();
+  EXPECT_TRUE(transport_->tx_data.empty());
+
+  EXPECT_TRUE(uut_->try_send(msg));
+  context_->poll();
+  EXPECT_EQ(transport_->tx_data, make_transport_bytes(2, msg, 2, msg));
+}
+
+TEST_F(MessageTransportTest, TxCoalescingQueueFull) {
+  uut_->set_tx_coalescing(1h, 0);
+  uut_->start();
+
+  auto msg = make_message(5);
+  EXPECT_TRUE(uut_->try_send(msg));
+  EXPECT_FALSE(uut_->try_send(msg));
+  context_->poll();
+  EXPECT_EQ(transport_->tx_data, make_transport_bytes(5, msg));
+}
+
+TEST_F(MessageTransportTest, TrySendMultipleProducers) {
+  const int kProducers = 4;
+  const int kMessages  = 1'000;
+
+  uut_ = std::make_shared<MessageTransport>(transport_, 100, 100);
+  uut_->start();
+
+  std::atomic<int> producers_done{0};
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kProducers; ++i) {
+    producers.push_back(std::thread([&, i] {
+      for (int j = 0; j < kMessages; ++j) {
+        auto msg = FakeOutgoingMessage({FakeOutgoingMessage::kMessageType, static_cast<Byte>(i), static_cast<Byte>(j)});
+        while (!uut_->try_send(msg)) {
+          std::this_thread::yield();
+        }
+      }
+
+      ++producers_done;
+    }));
+  }
+
+  while (producers_done < kProducers) {
+    context_->poll();
+  }
+
+  for (auto& producer : producers) {
+    producer.join();
+  }
+
+  context_->poll();
+
+  auto& data = transport_->tx_data;
+  ASSERT_EQ(data.size(), static_cast<std::size_t>(kProducers * kMessages * 4));
+
+  std::vector<int> msgs_received(kProducers);
+  for (std::size_t i = 0; i < data.size(); i += 4) {
+    EXPECT_EQ(data[i], 3);
+    ASSERT_LT(data[i + 2], kProducers);
+    EXPECT_EQ(data[i + 3], static_cast<Byte>(msgs_received[data[i + 2]]));
+    ++msgs_received[data[i + 2]];
+  }
+}
+
+TEST_F(MessageTransportTest, TrySendAndSendAsyncMultipleProducers) {
+  const int kProducers = 4;
+  const int kMessages  = 1'000;
+
+  uut_ = std::make_shared<MessageTransport>(transport_, 100, 100);
+  uut_->start();
+
+  // Messages sent via try_send() must not overtake the ones queued by
+  // send_async() before, even while other threads are sending
+  std::atomic<int> producers_done{0};
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kProducers; ++i) {
+    producers.push_back(std::thread([&, i] {
+      for (int j = 0; j < kMessages; ++j) {
+        auto msg = FakeOutgoingMessage({FakeOutgoingMessage::kMessageType, static_cast<Byte>(i), static_cast<Byte>(j)});
+        if (j % 2) {
+          while (!uut_->try_send(msg)) {
+            std::this_thread::yield();
+          }
+        } else {
+          uut_->send_async(&msg, [](auto& res) { EXPECT_EQ(res, Success()); });
+        }
+      }
+
+      ++producers_done;
+    }));
+  }
+
+  while (producers_done < kProducers) {
+    context_->poll();
+  }
+
+  for (auto& producer : producers) {
+    producer.join();
+  }
+
+  while (transport_->tx_data.size() < static_cast<std::size_t>(kProducers * kMessages * 4)) {
+    context_->poll();
+  }
+
+  auto& data = transport_->tx_data;
+  ASSERT_EQ(data.size(), static_cast<std::size_t>(kProducers * kMessages * 4));
+
+  std::vector<int> msgs_received(kProducers);
+  for (std::size_t i = 0; i < data.size(); i += 4) {
+    EXPECT_EQ(data[i], 3);
+    ASSERT_LT(data[i + 2], kProducers);
+    EXPECT_EQ(data[i + 3], static_cast<Byte>(msgs_received[data[i + 2]]));
+    ++msgs_received[data[i + 2]];
+  }
+}
+
+TEST_F(MessageTransportTest, TrySendByReference) {
+  uut_ = std::make_shared<MessageTransport>(transport_, 16, 16);
+  uut_->set_tx_zero_copy_threshold(5);
+  uut_->start();
+
+  auto small_msg = make_message(3);
+  auto large_msg = make_message(8);
+  auto msg_bytes = large_msg.serialize_shared();
+
+  EXPECT_TRUE(uut_->try_send(small_msg));
+  EXPECT_TRUE(uut_->try_send(msg_bytes));
+  EXPECT_TRUE(uut_->try_send(small_msg));
+  EXPECT_EQ(msg_bytes.use_count(), 3);  // large_msg, msg_bytes and the queue
+
+  context_->poll();
+  EXPECT_EQ(transport_->tx_data, make_transport_bytes(3, small_msg, 8, large_msg, 3, small_msg));
+  EXPECT_EQ(msg_bytes.use_count(), 2);
+}
+
+TEST_F(MessageTransportTest, TrySendByReferenceQueueFull) {
+  uut_ = std::make_shared<MessageTransport>(transport_, 16, 16);
+  uut_->set_tx_zero_copy_threshold(5);
+  uut_->start();
+
+  // References are limited to the size of the send queue
+  auto msg = make_message(9);
+  EXPECT_TRUE(uut_->try_send(msg.serialize_shared()));
+  EXPECT_FALSE(uut_->try_send(msg.serialize_shared()));
+  context_->poll();
+  EXPECT_TRUE(uut_->try_send(msg.serialize_shared()));
+  context_->poll();
+
+  EXPECT_EQ(transport_->tx_data, make_transport_bytes(9, msg, 9, msg));
+}
+
+TEST_F(MessageTransportTest, TrySendByReferenceMultipleConnections) {
+  auto transport_2 = std::make_shared<FakeTransport>(context_);
+  auto uut_2       = std::make_shared<MessageTransport>(transport_2, 16, 16);
+
+  for (auto& uut : {uut_, uut_2}) {
+    uut->set_tx_zero_copy_threshold(1);
+    uut->start();
+  }
+
+  auto msg       = make_message(6);
+  auto msg_bytes = msg.serialize_shared();
+  EXPECT_TRUE(uut_->try_send(msg_bytes));
+  EXPECT_TRUE(uut_2->try_send(msg_bytes));
+
+  context_->poll();
+  EXPECT_EQ(transport_->tx_data, make_transport_bytes(6, msg));
+  EXPECT_EQ(transport_2->tx_data, make_transport_bytes(6, msg));
+  EXPECT_EQ(msg_bytes.use_count(), 2);  // msg and msg_bytes
+}
+
+TEST_F(MessageTransportTest, TxCompression) {
+  uut_ = std::make_shared<MessageTransport>(transport_, 1000, 1000);
+  uut_->set_tx_compression_threshold(100, 1000);
+  uut_->start();
+
+  SmallBuffer compressible(300, 7);
+  compressible[0] = FakeOutgoingMessage::kMessageType;
+  auto compressible_msg = FakeOutgoingMessage(compressible);
+
+  SmallBuffer incompressible;
+  for (int i = 0; i < 200; ++i) incompressible.push_back(static_cast<Byte>(i));
+  auto incompressible_msg = FakeOutgoingMessage(incompressible);
+
+  SmallBuffer compressed;
+  ASSERT_TRUE(compress_msg_bytes(compressible, &compressed));
+  ASSERT_LT(compressed.size(), 128u);  // Fits into a single byte size field
+
+  auto small_msg = make_message(8);
+
+  EXPECT_TRUE(uut_->try_send(compressible_msg));
+  EXPECT_TRUE(uut_->try_send(incompressible_msg));
+  EXPECT_TRUE(uut_->try_send(small_msg));
+  EXPECT_TRUE(uut_->try_send(compressible_msg.serialize_shared()));
+  EXPECT_TRUE(uut_->try_send(&compressible_msg));
+  EXPECT_TRUE(uut_->try_send(&incompressible_msg));
+
+  bool called = false;
+  uut_->send_async(&compressible_msg, [&](auto& res) {
+    EXPECT_EQ(res, Success());
+    called = true;
+  });
+
+  context_->poll();
+  EXPECT_TRUE(called);
+
+  auto incompressible_frame = make_transport_bytes(0x80 | (200 >> 7), 200 & 0x7F, incompressible_msg);
+  auto compressed_frame     = make_transport_bytes(static_cast<int>(compressed.size()), compressed);
+  auto expected             = compressed_frame;
+  expected.insert(expected.end(), incompressible_frame.begin(), incompressible_frame.end());
+  auto small_frame = make_transport_bytes(8, small_msg);
+  expected.insert(expected.end(), small_frame.begin(), small_frame.end());
+  expected.insert(expected.end(), compressed_frame.begin(), compressed_frame.end());
+  expected.insert(expected.end(), compressed_frame.begin(), compressed_frame.end());
+  expected.insert(expected.end(), incompressible_frame.begin(), incompressible_frame.end());
+  expected.insert(expected.end(), compressed_frame.begin(), compressed_frame.end());
+
+  EXPECT_EQ(transport_->tx_data, expected);
+
+  // The compressed message gets shared instead of being created again
+  EXPECT_EQ(compressible_msg.compress_shared().use_count(), 2);  // Cache and returned pointer
+}
+
+TEST_F(MessageTransportTest, TxCompressionMaxSize) {
+  uut_ = std::make_shared<MessageTransport>(transport_, 1000, 1000);
+  uut_->set_tx_compression_threshold(100, 299);
+  uut_->start();
+
+  // The remote side would refuse to decompress the message
+  SmallBuffer compressible(300, 7);
+  compressible[0] = FakeOutgoingMessage::kMessageType;
+  auto msg        = FakeOutgoingMessage(compressible);
+
+  EXPECT_TRUE(uut_->try_send(msg));
+  context_->poll();
+  EXPECT_EQ(transport_->tx_data, make_transport_bytes(0x80 | (300 >> 7), 300 & 0x7F, msg));
+}
+
+TEST_F(MessageTransportTest, TrySendFragmented) {
+  uut_ = std::make_shared<MessageTransport>(transport_, 200'000, 200'000);
+  uut_->start();
+
+  auto large_msg = make_message(80'000);
+  auto small_msg = make_message(3);
+
+  // Fragments only get queued via send_async() which reports send errors
+  EXPECT_FALSE(uut_->try_send(large_msg));
+  EXPECT_FALSE(uut_->try_send(large_msg, MessageTransport::TxPriority::kHigh));
+  EXPECT_TRUE(uut_->try_send(small_msg));
+  context_->poll();
+
+  EXPECT_EQ(transport_->tx_data, make_transport_bytes(3, small_msg));
+}
+
+TEST_F(MessageTransportTest, SendAsyncFragmented) {
+  // Only one fragment fits into the send queue at a time
+  uut_ = std::make_shared<MessageTransport>(transport_, 35'000, 35'000);
+  uut_->start();
+
+  auto msg_1 = make_message(100'000);
+  auto msg_2 = make_message(40'000);
+
+  int calls = 0;
+  uut_->send_async(&msg_1, [&](auto& res) {
+    EXPECT_EQ(res, Success());
+    EXPECT_EQ(calls, 0);
+    ++calls;
+  });
+
+  // The fragments of different messages must not get mixed up
+  EXPECT_FALSE(uut_->try_send(msg_2));
+  uut_->send_async(&msg_2, [&](auto& res) {
+    EXPECT_EQ(res, Success());
+    EXPECT_EQ(calls, 1);
+    ++calls;
+  });
+
+  while (calls < 2) {
+    context_->poll();
+  }
+
+  context_->poll();
+
+  auto msgs = split_transport_bytes(transport_->tx_data);
+  ASSERT_EQ(msgs.size(), 6u);
+  check_fragments({msgs.begin(), msgs.begin() + 4}, msg_1.serialize());
+  check_fragments({msgs.begin() + 4, msgs.end()}, msg_2.serialize());
+}
+
+TEST_F(MessageTransportTest, SendAsyncFragmentedHighPriority) {
+  // Only one fragment fits into the send queue at a time
+  uut_ = std::make_shared<MessageTransport>(transport_, 35'000, 35'000);
+  uut_->start();
+
+  auto msg_1     = make_message(100'000);
+  auto msg_2     = make_message(40'000);
+  auto small_msg = make_message(3);
+
+  int calls = 0;
+  uut_->send_async(&msg_1, [&](auto& res) {
+    EXPECT_EQ(res, Success());
+    ++calls;
+  });
+
+  // The fragments of a high priority message go through the normal priority
+  // queue after the ones of msg_1, but later high priority messages must not
+  // overtake them
+  uut_->send_async(
+      &msg_2,
+      [&](auto& res) {
+        EXPECT_EQ(res, Success());
+        ++calls;
+      },
+      MessageTransport::TxPriority::kHigh);
+  EXPECT_FALSE(uut_->try_send(small_msg, MessageTransport::TxPriority::kHigh));
+
+  while (calls < 2) {
+    context_->poll();
+  }
+
+  context_->poll();
+
+  auto msgs = split_transport_bytes(transport_->tx_data);
+  ASSERT_EQ(msgs.size(), 6u);
+  check_fragments({msgs.begin(), msgs.begin() + 4}, msg_1.serialize());
+  check_fragments({msgs.begin() + 4, msgs.end()}, msg_2.serialize());
+}
+
+TEST_F(MessageTransportTest, TrySendHighPriority) {
+  uut_                      = std::make_shared<MessageTransport>(transport_, 16, 16);
+  transport_->tx_send_limit = 2;
+  uut_->start();
+
+  // The high priority message overtakes the queued normal priority message
+  // but does not interrupt the one that is being sent already
+  auto normal_msg = make_message(5);
+  auto high_msg   = make_message(3);
+  EXPECT_TRUE(uut_->try_send(normal_msg));
+  EXPECT_TRUE(uut_->try_send(normal_msg));
+  EXPECT_TRUE(uut_->try_send(high_msg, MessageTransport::TxPriority::kHigh));
+
+  context_->poll();
+  EXPECT_EQ(transport_->tx_data, make_transport_bytes(5, normal_msg, 3, high_msg, 5, normal_msg));
+}
+
+TEST_F(MessageTransportTest, HighPriorityQueueSize) {
+  uut_                      = std::make_shared<MessageTransport>(transport_, 400'000, 16);
+  transport_->tx_send_limit = 0;  // Make sure the queues are not emptied
+  uut_->start();
+
+  // The high priority queue gets an eighth of the send queue size
+  auto msg = make_message(10'000);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(uut_->try_send(msg, MessageTransport::TxPriority::kHigh));
+  }
+
+  EXPECT_FALSE(uut_->try_send(msg, MessageTransport::TxPriority::kHigh));
+
+  for (int i = 0; i < 39; ++i) {
+    EXPECT_TRUE(uut_->try_send(msg));
+  }
+}
+
+TEST_F(MessageTransportTest, SendAsyncHighPriority) {
+  transport_->tx_send_limit = 1;
+  uut_->start();
+
+  // Pending normal priority sends must not block high priority messages
+  auto normal_msg = make_message(5);
+  auto high_msg   = make_message(5);
+  EXPECT_TRUE(uut_->try_send(normal_msg));
+
+  bool called = false;
+  uut_->send_async(&normal_msg, [&](auto& res) {
+    EXPECT_EQ(res, Success());
+    called = true;
+  });
+
+  EXPECT_FALSE(uut_->try_send(normal_msg));
+  EXPECT_TRUE(uut_->try_send(high_msg, MessageTransport::TxPriority::kHigh));
+
+  context_->poll();
+  EXPECT_TRUE(called);
+  EXPECT_EQ(transport_->tx_data, make_transport_bytes(5, normal_msg, 5, high_msg, 5, normal_msg));
+}
+
+TEST_F(MessageTransportTest, TxBatchSizeLimit) {
+  const std::size_t kMsgSize = 30'000;
+
+  Buffer frame;
+  std::array<Byte, 5> size_field;
+  auto msg = make_message(kMsgSize);
+  auto n   = serialize_msg_size_field(kMsgSize, &size_field);
+  frame.insert(frame.end(), size_field.begin(), size_field.begin() + static_cast<Buffer::difference_type>(n));
+  append_to_byte_vector(&frame, msg);
+
+  uut_                      = std::make_shared<MessageTransport>(transport_, 200'000, 200'000);
+  transport_->tx_send_limit = 1'000;
+  uut_->set_tx_coalescing(1h, 4 * frame.size());
+  uut_->start();
+
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(uut_->try_send(msg));
+  }
+
+  // Normal priority messages are sent in batches of up to 64 KiB, rounded up
+  // to the next message boundary, so the high priority message gets sent
+  // after the third message
+  auto high_msg = make_message(3);
+  EXPECT_TRUE(uut_->try_send(high_msg, MessageTransport::TxPriority::kHigh));
+
+  context_->poll();
+
+  Buffer expected;
+  for (int i = 0; i < 4; ++i) {
+    if (i == 3) {
+      auto high_frame = make_transport_bytes(3, high_msg);
+      expected.insert(expected.end(), high_frame.begin(), high_frame.end());
+    }
+
+    expected.insert(expected.end(), frame.begin(), frame.end());
+  }
+
+  EXPECT_EQ(transport_->tx_data, expected);
+}
+
 TEST_F(MessageTransportTest, SendAsync) {
   transport_->tx_send_limit = 1;
   uut_->start();
@@ -335,6 +817,119 @@ TEST_F(MessageTransportTest, CancelReceive) {
   EXPECT_TRUE(called);
 }
 
+TEST_F(MessageTransportTest, ReceiveInPlace) {
+  transport_->rx_data = Buffer{5, 1, 2, 3, 4, 5, 4, 1, 2, 3, 4};
+  uut_->start();
+  context_->poll();
+
+  Buffer data;
+  bool called = false;
+  uut_->receive_in_place_async([&](auto& res, auto msg) {
+    EXPECT_EQ(res, Success());
+    auto p = static_cast<const Byte*>(msg.data());
+    data   = Buffer(p, p + msg.size());
+    called = true;
+  });
+
+  context_->poll();
+  EXPECT_TRUE(called);
+  EXPECT_EQ(data, (Buffer{1, 2, 3, 4, 5}));
+
+  called = false;
+  uut_->receive_in_place_async([&](auto& res, auto msg) {
+    EXPECT_EQ(res, Success());
+    auto p = static_cast<const Byte*>(msg.data());
+    data   = Buffer(p, p + msg.size());
+    called = true;
+  });
+
+  context_->poll();
+  EXPECT_TRUE(called);
+  EXPECT_EQ(data, (Buffer{1, 2, 3, 4}));
+}
+
+TEST_F(MessageTransportTest, CancelReceiveInPlace) {
+  uut_->start();
+
+  bool called = false;
+  uut_->receive_in_place_async([&](auto& res, auto msg) {
+    EXPECT_EQ(res, Error(YOGI_ERR_CANCELED));
+    EXPECT_EQ(msg.size(), 0);
+    called = true;
+  });
+  uut_->cancel_receive();
+
+  context_->poll();
+  EXPECT_TRUE(called);
+}
+
+TEST_F(MessageTransportTest, ReceiveBatch) {
+  transport_->rx_data = Buffer{2, 1, 2, 1, 3, 0, 1, 4};
+  uut_->start();
+  context_->poll();
+
+  std::vector<Buffer> msgs;
+  int calls = 0;
+  uut_->receive_batch_async([&](auto& res, auto& batch) {
+    EXPECT_EQ(res, Success());
+    for (auto& msg : batch) {
+      auto p = static_cast<const Byte*>(msg.data());
+      msgs.push_back(Buffer(p, p + msg.size()));
+    }
+    ++calls;
+  });
+
+  context_->poll();
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(msgs, (std::vector<Buffer>{{1, 2}, {3}, {}, {4}}));
+}
+
+TEST_F(MessageTransportTest, ReceiveBatchWrapAround) {
+  std::vector<Buffer> expected;
+  for (int i = 0; i < 100; ++i) {
+    Buffer msg(static_cast<std::size_t>(i % 7), static_cast<Byte>(i));
+    transport_->rx_data.push_back(static_cast<Byte>(msg.size()));
+    transport_->rx_data.insert(transport_->rx_data.end(), msg.begin(), msg.end());
+    expected.push_back(msg);
+  }
+
+  uut_->start();
+
+  std::vector<Buffer> msgs;
+  std::function<void()> receive = [&] {
+    uut_->receive_batch_async([&](auto& res, auto& batch) {
+      ASSERT_EQ(res, Success());
+      for (auto& msg : batch) {
+        auto p = static_cast<const Byte*>(msg.data());
+        msgs.push_back(Buffer(p, p + msg.size()));
+      }
+
+      if (msgs.size() < expected.size()) receive();
+    });
+  };
+
+  receive();
+  while (context_->poll() > 0) {
+  }
+
+  EXPECT_EQ(msgs, expected);
+}
+
+TEST_F(MessageTransportTest, CancelReceiveBatch) {
+  uut_->start();
+
+  bool called = false;
+  uut_->receive_batch_async([&](auto& res, auto& batch) {
+    EXPECT_EQ(res, Error(YOGI_ERR_CANCELED));
+    EXPECT_TRUE(batch.empty());
+    called = true;
+  });
+  uut_->cancel_receive();
+
+  context_->poll();
+  EXPECT_TRUE(called);
+}
+
 TEST_F(MessageTransportTest, Close) {
   uut_->start();
   EXPECT_FALSE(transport_->dead);
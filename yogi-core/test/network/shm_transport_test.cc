@@ -0,0 +1,213 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <test/common.h>
+
+#include <src/network/shm_transport.h>
+#include <src/system/process.h>
+
+using namespace std::chrono_literals;
+
+class ShmTransportTest : public TestFixture {
+ protected:
+  virtual void SetUp() override {
+    name_ = "/yogi-test-" + std::to_string(get_process_id()) + '-' +
+            ::testing::UnitTest::GetInstance()->current_test_info()->name();
+
+    creator_ = ShmTransport::try_create(context_, name_, 10, 10s, true, "creator", kNoLimit);
+    if (!creator_) {
+      GTEST_SKIP() << "Shared memory not supported on this platform";
+    }
+
+    opener_ = ShmTransport::try_open(context_, name_, 10s, false, "opener", kNoLimit);
+    ASSERT_TRUE(!!opener_);
+  }
+
+  virtual void TearDown() override {
+    if (creator_) creator_->close();
+    if (opener_) opener_->close();
+  }
+
+  void transfer(TransportPtr from, TransportPtr to, std::vector<char> data) {
+    std::vector<char> buffer(data.size());
+    bool received = false;
+    to->receive_all_async(boost::asio::buffer(buffer), [&](auto& res) {
+      EXPECT_EQ(res, Success());
+      received = true;
+    });
+
+    bool sent = false;
+    from->send_all_async(boost::asio::buffer(data), [&](auto& res) {
+      EXPECT_EQ(res, Success());
+      sent = true;
+    });
+
+    while (!sent || !received) {
+      context_->run_one(100us);
+    }
+
+    EXPECT_EQ(data, buffer);
+  }
+
+  static constexpr std::size_t kNoLimit = std::numeric_limits<std::size_t>::max();
+
+  ContextPtr context_ = Context::create();
+  std::string name_;
+  ShmTransportPtr creator_;
+  ShmTransportPtr opener_;
+};
+
+TEST_F(ShmTransportTest, CreateAndOpen) {
+  EXPECT_FALSE(ShmTransport::try_create(context_, name_, 10, 10s, true, "", kNoLimit));
+  EXPECT_FALSE(ShmTransport::try_open(context_, name_ + "x", 10s, false, "", kNoLimit));
+
+  EXPECT_TRUE(creator_->created_from_incoming_connection_request());
+  EXPECT_FALSE(opener_->created_from_incoming_connection_request());
+  EXPECT_EQ(opener_->get_peer_description(), "opener");
+}
+
+TEST_F(ShmTransportTest, RemoveSegmentName) {
+  creator_->remove_segment_name();
+  EXPECT_FALSE(ShmTransport::try_open(context_, name_, 10s, false, "", kNoLimit));
+
+  transfer(creator_, opener_, {1, 2, 3});
+}
+
+TEST_F(ShmTransportTest, SendAndReceive) {
+  transfer(creator_, opener_, {1, 2, 3, 4, 5, 6});
+  transfer(opener_, creator_, {7, 8, 9});
+}
+
+TEST_F(ShmTransportTest, SendBufferSequence) {
+  std::vector<char> data = {1, 2, 3, 4, 5, 6};
+  Transport::ConstBufferSequence seq{boost::asio::buffer(data.data(), 2),
+                                     boost::asio::buffer(data.data() + 2, data.size() - 2)};
+
+  bool sent = false;
+  creator_->send_some_async(seq, [&](auto& res, auto bytes_written) {
+    EXPECT_EQ(res, Success());
+    EXPECT_EQ(bytes_written, data.size());
+    sent = true;
+  });
+
+  std::vector<char> buffer(data.size());
+  bool received = false;
+  opener_->receive_all_async(boost::asio::buffer(buffer), [&](auto& res) {
+    EXPECT_EQ(res, Success());
+    received = true;
+  });
+
+  while (!sent || !received) {
+    context_->run_one(100us);
+  }
+
+  EXPECT_EQ(data, buffer);
+}
+
+TEST_F(ShmTransportTest, SendMoreThanQueueSize) {
+  std::vector<char> data(1000);
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>(i);
+  }
+
+  transfer(creator_, opener_, data);
+  transfer(opener_, creator_, data);
+}
+
+TEST_F(ShmTransportTest, SendFromOtherThread) {
+  std::vector<char> data(10000);
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>(i * 7);
+  }
+
+  creator_->close();
+  opener_->close();
+
+  name_ += "-2";
+  auto other_context = Context::create();
+  creator_           = ShmTransport::try_create(other_context, name_, 10, 10s, true, "", kNoLimit);
+  opener_            = ShmTransport::try_open(context_, name_, 10s, false, "", kNoLimit);
+  ASSERT_TRUE(creator_ && opener_);
+
+  std::atomic<bool> sent{false};
+  creator_->send_all_async(boost::asio::buffer(data), [&](auto& res) {
+    EXPECT_EQ(res, Success());
+    sent = true;
+  });
+
+  other_context->run_in_background();
+
+  std::vector<char> buffer(data.size());
+  bool received = false;
+  opener_->receive_all_async(boost::asio::buffer(buffer), [&](auto& res) {
+    EXPECT_EQ(res, Success());
+    received = true;
+  });
+
+  while (!sent || !received) {
+    context_->run_one(100us);
+  }
+
+  other_context->stop();
+  other_context->wait_for_stopped(1s);
+
+  EXPECT_EQ(data, buffer);
+}
+
+TEST_F(ShmTransportTest, PeerClosed) {
+  bool called = false;
+  std::vector<char> buffer(10);
+  opener_->receive_some_async(boost::asio::buffer(buffer), [&](auto& res, auto) {
+    EXPECT_EQ(res, Error(YOGI_ERR_RW_SOCKET_FAILED));
+    called = true;
+  });
+
+  creator_->close();
+
+  while (!called) {
+    context_->run_one(100us);
+  }
+
+  called = false;
+  opener_->send_some_async(boost::asio::buffer("x", 1), [&](auto& res, auto) {
+    EXPECT_TRUE(res.is_error());
+    called = true;
+  });
+
+  while (!called) {
+    context_->run_one(100us);
+  }
+}
+
+TEST_F(ShmTransportTest, CloseCancelsPendingReceive) {
+  std::vector<char> buffer(10);
+  bool called = false;
+  creator_->receive_some_async(boost::asio::buffer(buffer), [&](auto& res, auto) {
+    EXPECT_EQ(res, Error(YOGI_ERR_CANCELED));
+    called = true;
+  });
+
+  creator_->close();
+
+  while (!called) {
+    context_->run_one(100us);
+  }
+}
@@ -21,6 +21,7 @@
 
 #include <test/common.h>
 
+#include <src/network/io_uring_transport.h>
 #include <src/network/tcp_transport.h>
 
 using namespace std::chrono_literals;
@@ -36,13 +37,15 @@ class TcpTransportTest : public TestFixture {
     acceptor_ep_ = boost::asio::ip::tcp::endpoint(kLoopbackAddress, acceptor_.local_endpoint().port());
   }
 
-  TcpTransportPtr connect() {
+  TcpTransportPtr connect(IoUringPtr io_uring = {}) {
     TcpTransportPtr transport;
-    auto guard = TcpTransport::connect_async(context_, acceptor_ep_, 10s, std::numeric_limits<std::size_t>::max(),
-                                             [&](auto& res, auto tp, auto) {
-                                               ASSERT_EQ(res, Success());
-                                               transport = tp;
-                                             });
+    auto guard = TcpTransport::connect_async(
+        context_, acceptor_ep_, 10s, std::numeric_limits<std::size_t>::max(),
+        [&](auto& res, auto tp, auto) {
+          ASSERT_EQ(res, Success());
+          transport = tp;
+        },
+        io_uring);
 
     bool accepted = false;
     acceptor_.async_accept(socket_, [&](auto& ec) {
@@ -172,6 +175,34 @@ TEST_F(TcpTransportTest, Send) {
   EXPECT_EQ(data_, buffer);
 }
 
+TEST_F(TcpTransportTest, SendBufferSequence) {
+  auto transport = connect();
+
+  bool received = false;
+  std::vector<char> buffer(data_.size());
+  boost::asio::async_read(socket_, boost::asio::buffer(buffer), [&](auto& ec, auto bytes_read) {
+    EXPECT_TRUE(!ec) << ec.message();
+    EXPECT_EQ(bytes_read, buffer.size());
+    received = true;
+  });
+
+  Transport::ConstBufferSequence data{boost::asio::buffer(data_.data(), 2),
+                                      boost::asio::buffer(data_.data() + 2, data_.size() - 2)};
+
+  bool sent = false;
+  transport->send_some_async(data, [&](auto& res, auto bytes_written) {
+    EXPECT_EQ(res, Success());
+    EXPECT_EQ(bytes_written, data_.size());
+    sent = true;
+  });
+
+  while (!sent || !received) {
+    context_->run_one(100us);
+  }
+
+  EXPECT_EQ(data_, buffer);
+}
+
 TEST_F(TcpTransportTest, SendFailure) {
   auto transport = connect();
   transport->close();
@@ -226,3 +257,63 @@ TEST_F(TcpTransportTest, ReceiveFailure) {
     context_->run_one(100us);
   }
 }
+
+TEST_F(TcpTransportTest, IoUringSendAndReceive) {
+  auto io_uring = IoUring::try_create(context_->io_context());
+  if (!io_uring) {
+    GTEST_SKIP() << "io_uring not supported on this platform";
+  }
+
+  auto transport = connect(io_uring);
+  EXPECT_TRUE(!!std::dynamic_pointer_cast<IoUringTransport>(transport));
+
+  std::vector<char> rcv_buffer(data_.size());
+  bool received = false;
+  transport->receive_all_async(boost::asio::buffer(rcv_buffer), [&](auto& res) {
+    EXPECT_EQ(res, Success());
+    received = true;
+  });
+
+  std::vector<char> echo_buffer(data_.size());
+  boost::asio::async_read(socket_, boost::asio::buffer(echo_buffer), [&](auto& ec, auto) {
+    EXPECT_TRUE(!ec) << ec.message();
+    boost::asio::write(socket_, boost::asio::buffer(echo_buffer));
+  });
+
+  Transport::ConstBufferSequence data{boost::asio::buffer(data_.data(), 2),
+                                      boost::asio::buffer(data_.data() + 2, data_.size() - 2)};
+
+  bool sent = false;
+  transport->send_some_async(data, [&](auto& res, auto bytes_written) {
+    EXPECT_EQ(res, Success());
+    EXPECT_EQ(bytes_written, data_.size());
+    sent = true;
+  });
+
+  while (!sent || !received) {
+    context_->run_one(100us);
+  }
+
+  EXPECT_EQ(data_, rcv_buffer);
+}
+
+TEST_F(TcpTransportTest, IoUringReceiveFailure) {
+  auto io_uring = IoUring::try_create(context_->io_context());
+  if (!io_uring) {
+    GTEST_SKIP() << "io_uring not supported on this platform";
+  }
+
+  auto transport = connect(io_uring);
+
+  bool called = false;
+  transport->receive_some_async(boost::asio::buffer(data_), [&](auto& res, auto) {
+    EXPECT_TRUE(res.is_error());
+    called = true;
+  });
+
+  socket_.close();
+
+  while (!called) {
+    context_->run_one(100us);
+  }
+}
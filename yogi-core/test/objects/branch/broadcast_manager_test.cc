@@ -21,13 +21,16 @@
 
 #include <test/common.h>
 
+#include <src/objects/branch/multicast_sender.h>
+
 #include <atomic>
 #include <chrono>
 #include <thread>
 
 class BroadcastReceiver {
  public:
-  BroadcastReceiver(void* branch, int enc = YOGI_ENC_JSON) : branch_(branch), data_(16) {
+  BroadcastReceiver(void* branch, int enc = YOGI_ENC_JSON, std::size_t buffer_size = 16)
+      : branch_(branch), data_(buffer_size) {
     handler_called_ = false;
 
     auto res = YOGI_BranchReceiveBroadcastAsync(
@@ -155,6 +158,90 @@ TEST_F(BroadcastManagerTest, SendMessagePack) {
   EXPECT_FALSE(rcv_a_.broadcast_received());
 }
 
+TEST_F(BroadcastManagerTest, SendRaw) {
+  BroadcastReceiver rcv_raw(branch_a_, YOGI_ENC_RAW);  // Replaces rcv_a_
+  run_context_in_background(context_);
+
+  const char raw_data[] = {-63, 0, 1, 2};  // Not valid MessagePack
+  int res               = YOGI_BranchSendBroadcast(branch_b_, YOGI_ENC_RAW, raw_data, sizeof(raw_data), YOGI_FALSE);
+  ASSERT_OK(res);
+
+  rcv_raw.wait_for_broadcast();
+  EXPECT_OK(rcv_raw.get_handler_result());
+  rcv_raw.get_received_data_equals(raw_data);
+
+  rcv_c_.wait_for_broadcast();
+  EXPECT_ERR(rcv_c_.get_handler_result(), YOGI_ERR_INCOMPATIBLE_ENCODING);
+}
+
+TEST_F(BroadcastManagerTest, SendFragmentedRaw) {
+  // Streamed directly into the receive buffer
+  std::vector<char> data(100'000);
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>(i % 251);
+  }
+
+  BroadcastReceiver rcv_raw(branch_a_, YOGI_ENC_RAW, data.size());  // Replaces rcv_a_
+  run_context_in_background(context_);
+
+  int res = YOGI_BranchSendBroadcast(branch_b_, YOGI_ENC_RAW, data.data(), static_cast<int>(data.size()), YOGI_FALSE);
+  ASSERT_OK(res);
+
+  rcv_raw.wait_for_broadcast();
+  EXPECT_OK(rcv_raw.get_handler_result());
+  EXPECT_EQ(rcv_raw.get_received_data(), data);
+}
+
+TEST_F(BroadcastManagerTest, SendFragmentedJson) {
+  // Reassembled in memory since the payload has to be converted
+  auto data = make_big_json_data(100'000);
+  BroadcastReceiver rcv_json(branch_b_, YOGI_ENC_JSON, data.size());  // Replaces rcv_b_
+  run_context_in_background(context_);
+
+  int res = YOGI_BranchSendBroadcast(branch_a_, YOGI_ENC_JSON, data.data(), static_cast<int>(data.size()), YOGI_FALSE);
+  ASSERT_OK(res);
+
+  rcv_json.wait_for_broadcast();
+  EXPECT_OK(rcv_json.get_handler_result());
+  EXPECT_EQ(rcv_json.get_received_data(), data);
+}
+
+TEST_F(BroadcastManagerTest, SendFragmentedBufferTooSmall) {
+  std::vector<char> data(100'000, 'x');
+  BroadcastReceiver rcv_raw(branch_a_, YOGI_ENC_RAW, 50'000);  // Replaces rcv_a_
+  run_context_in_background(context_);
+
+  int res = YOGI_BranchSendBroadcast(branch_b_, YOGI_ENC_RAW, data.data(), static_cast<int>(data.size()), YOGI_FALSE);
+  ASSERT_OK(res);
+
+  rcv_raw.wait_for_broadcast();
+  EXPECT_ERR(rcv_raw.get_handler_result(), YOGI_ERR_BUFFER_TOO_SMALL);
+  EXPECT_EQ(rcv_raw.get_received_data(), std::vector<char>(50'000, 'x'));
+}
+
+TEST_F(BroadcastManagerTest, SendFragmentedTooBig) {
+  auto props                  = kBranchProps;
+  props["name"]               = "d";
+  props["max_broadcast_size"] = 50'000;
+
+  void* branch_d;
+  int res = YOGI_BranchCreate(&branch_d, context_, create_configuration(props), nullptr);
+  ASSERT_OK(res);
+
+  run_context_until_branches_are_connected(context_, {branch_a_, branch_b_, branch_c_, branch_d});
+  BranchEventRecorder rec(context_, branch_d);
+  BroadcastReceiver rcv_raw(branch_d, YOGI_ENC_RAW, 100'000);
+
+  // The receiving branch closes the connection
+  std::vector<char> data(100'000, 'x');
+  res = YOGI_BranchSendBroadcastAsync(branch_b_, YOGI_ENC_RAW, data.data(), static_cast<int>(data.size()), YOGI_TRUE,
+                                      YOGI_PRIO_NORMAL, [](int, int, void*) {}, nullptr);
+  ASSERT_GT(res, 0);
+
+  rec.run_context_until(YOGI_BEV_CONNECTION_LOST, branch_b_, YOGI_ERR_PAYLOAD_TOO_LARGE);
+  EXPECT_FALSE(rcv_raw.broadcast_received());
+}
+
 TEST_F(BroadcastManagerTest, SendBlock) {
   run_context_in_background(context_);
 
@@ -181,7 +268,7 @@ TEST_F(BroadcastManagerTest, SendNoBlock) {
 TEST_F(BroadcastManagerTest, AsyncSendJson) {
   int oid = -1;
   int res = YOGI_BranchSendBroadcastAsync(
-      branch_a_, YOGI_ENC_JSON, json_data_, sizeof(json_data_), YOGI_TRUE,
+      branch_a_, YOGI_ENC_JSON, json_data_, sizeof(json_data_), YOGI_TRUE, YOGI_PRIO_NORMAL,
       [](int res, int oid, void* userarg) {
         EXPECT_OK(res);
         EXPECT_GT(oid, 0);
@@ -204,7 +291,7 @@ TEST_F(BroadcastManagerTest, AsyncSendJson) {
 TEST_F(BroadcastManagerTest, AsyncSendMessagePack) {
   int oid = -1;
   int res = YOGI_BranchSendBroadcastAsync(
-      branch_a_, YOGI_ENC_MSGPACK, msgpack_data_, sizeof(msgpack_data_), YOGI_TRUE,
+      branch_a_, YOGI_ENC_MSGPACK, msgpack_data_, sizeof(msgpack_data_), YOGI_TRUE, YOGI_PRIO_NORMAL,
       [](int res, int oid, void* userarg) {
         EXPECT_OK(res);
         EXPECT_GT(oid, 0);
@@ -224,6 +311,70 @@ TEST_F(BroadcastManagerTest, AsyncSendMessagePack) {
   EXPECT_EQ(oid, res);
 }
 
+TEST_F(BroadcastManagerTest, SendTo) {
+  auto uuid = get_branch_uuid(branch_b_);
+
+  int oid = -1;
+  int res = YOGI_BranchSendToAsync(
+      branch_a_, &uuid, YOGI_ENC_JSON, json_data_, sizeof(json_data_), YOGI_TRUE, YOGI_PRIO_NORMAL,
+      [](int res, int oid, void* userarg) {
+        EXPECT_OK(res);
+        *static_cast<int*>(userarg) = oid;
+      },
+      &oid);
+  ASSERT_GT(res, 0);
+  int send_to_oid = res;
+
+  run_context_in_background(context_);
+
+  rcv_b_.wait_for_broadcast();
+  rcv_b_.get_received_data_equals(json_data_);
+  EXPECT_EQ(rcv_b_.get_source_id(), get_branch_uuid(branch_a_));
+
+  // Messages on a connection arrive in order, so branch c would receive the
+  // first message before this broadcast if it had been sent to it as well
+  const char other_json_data[] = "[4,5]";
+  res = YOGI_BranchSendBroadcast(branch_a_, YOGI_ENC_JSON, other_json_data, sizeof(other_json_data), YOGI_TRUE);
+  ASSERT_OK(res);
+  rcv_c_.wait_for_broadcast();
+  rcv_c_.get_received_data_equals(other_json_data);
+  EXPECT_FALSE(rcv_a_.broadcast_received());
+
+  EXPECT_EQ(oid, send_to_oid);
+}
+
+TEST_F(BroadcastManagerTest, SendToNoRetry) {
+  auto uuid = get_branch_uuid(branch_b_);
+  auto data = make_big_json_data();
+
+  // Without running the context, more data gets queued than fits into the queue
+  std::vector<int> errs;
+  for (int i = 0; i < 10; ++i) {
+    int oid = YOGI_BranchSendToAsync(
+        branch_c_, &uuid, YOGI_ENC_JSON, data.data(), static_cast<int>(data.size()), YOGI_FALSE, YOGI_PRIO_NORMAL,
+        [](int res, int, void* userarg) { static_cast<decltype(errs)*>(userarg)->push_back(res); }, &errs);
+    ASSERT_GT(oid, 0);
+  }
+
+  while (errs.size() < 10) {
+    YOGI_ContextPoll(context_, nullptr);
+  }
+
+  EXPECT_OK(errs.front());
+  EXPECT_ERR(errs.back(), YOGI_ERR_TX_QUEUE_FULL);
+}
+
+TEST_F(BroadcastManagerTest, SendToUnknownBranch) {
+  boost::uuids::uuid uuid = {};
+
+  int res = YOGI_BranchSendToAsync(
+      branch_a_, &uuid, YOGI_ENC_JSON, json_data_, sizeof(json_data_), YOGI_TRUE, YOGI_PRIO_NORMAL,
+      [](int, int, void*) { FAIL(); }, nullptr);
+  EXPECT_ERR(res, YOGI_ERR_BRANCH_NOT_CONNECTED);
+
+  YOGI_ContextPoll(context_, nullptr);
+}
+
 TEST_F(BroadcastManagerTest, AsyncSendRetry) {
   auto data = make_big_json_data();
 
@@ -231,7 +382,7 @@ TEST_F(BroadcastManagerTest, AsyncSendRetry) {
   std::vector<int> errs;
   for (int i = 0; i < n; ++i) {
     int oid = YOGI_BranchSendBroadcastAsync(
-        branch_c_, YOGI_ENC_JSON, data.data(), static_cast<int>(data.size()), YOGI_TRUE,
+        branch_c_, YOGI_ENC_JSON, data.data(), static_cast<int>(data.size()), YOGI_TRUE, YOGI_PRIO_NORMAL,
         [](int res, int, void* userarg) { static_cast<decltype(errs)*>(userarg)->push_back(res); }, &errs);
     EXPECT_GT(oid, 0);
   }
@@ -251,7 +402,7 @@ TEST_F(BroadcastManagerTest, AsyncSendNoRetry) {
   int err = YOGI_OK;
   do {
     int oid = YOGI_BranchSendBroadcastAsync(
-        branch_c_, YOGI_ENC_JSON, data.data(), static_cast<int>(data.size()), YOGI_FALSE,
+        branch_c_, YOGI_ENC_JSON, data.data(), static_cast<int>(data.size()), YOGI_FALSE, YOGI_PRIO_NORMAL,
         [](int res, int, void* userarg) { *static_cast<int*>(userarg) = res; }, &err);
     EXPECT_GT(oid, 0);
 
@@ -269,7 +420,7 @@ TEST_F(BroadcastManagerTest, CancelSend) {
   std::map<int, int> oid_to_res;
   do {
     oid = YOGI_BranchSendBroadcastAsync(
-        branch_c_, YOGI_ENC_JSON, data.data(), static_cast<int>(data.size()), YOGI_TRUE,
+        branch_c_, YOGI_ENC_JSON, data.data(), static_cast<int>(data.size()), YOGI_TRUE, YOGI_PRIO_NORMAL,
         [](int res, int oid, void* userarg) { (*static_cast<decltype(oid_to_res)*>(userarg))[oid] = res; },
         &oid_to_res);
     EXPECT_GT(oid, 0);
@@ -287,7 +438,8 @@ TEST_F(BroadcastManagerTest, CancelSend) {
 
 TEST_F(BroadcastManagerTest, ReceiveSourceUuid) {
   int oid = YOGI_BranchSendBroadcastAsync(
-      branch_a_, YOGI_ENC_JSON, json_data_, sizeof(json_data_), YOGI_TRUE, [](int, int, void*) {}, nullptr);
+      branch_a_, YOGI_ENC_JSON, json_data_, sizeof(json_data_), YOGI_TRUE, YOGI_PRIO_NORMAL,
+      [](int, int, void*) {}, nullptr);
   ASSERT_GT(oid, 0);
 
   while (!rcv_b_.broadcast_received()) poll_context(context_);
@@ -297,7 +449,8 @@ TEST_F(BroadcastManagerTest, ReceiveSourceUuid) {
 
 TEST_F(BroadcastManagerTest, ReceiveJson) {
   int oid = YOGI_BranchSendBroadcastAsync(
-      branch_a_, YOGI_ENC_JSON, json_data_, sizeof(json_data_), YOGI_TRUE, [](int, int, void*) {}, nullptr);
+      branch_a_, YOGI_ENC_JSON, json_data_, sizeof(json_data_), YOGI_TRUE, YOGI_PRIO_NORMAL,
+      [](int, int, void*) {}, nullptr);
   ASSERT_GT(oid, 0);
 
   while (!rcv_b_.broadcast_received()) poll_context(context_);
@@ -309,7 +462,8 @@ TEST_F(BroadcastManagerTest, ReceiveJson) {
 TEST_F(BroadcastManagerTest, ReceiveJsonBufferTooSmall) {
   auto data = make_big_json_data();
   int oid   = YOGI_BranchSendBroadcastAsync(
-      branch_a_, YOGI_ENC_JSON, data.data(), static_cast<int>(data.size()), YOGI_TRUE, [](int, int, void*) {}, nullptr);
+      branch_a_, YOGI_ENC_JSON, data.data(), static_cast<int>(data.size()), YOGI_TRUE, YOGI_PRIO_NORMAL,
+      [](int, int, void*) {}, nullptr);
   ASSERT_GT(oid, 0);
 
   while (!rcv_b_.broadcast_received()) poll_context(context_);
@@ -322,7 +476,8 @@ TEST_F(BroadcastManagerTest, ReceiveJsonBufferTooSmall) {
 
 TEST_F(BroadcastManagerTest, ReceiveMessagePack) {
   int oid = YOGI_BranchSendBroadcastAsync(
-      branch_b_, YOGI_ENC_JSON, json_data_, sizeof(json_data_), YOGI_TRUE, [](int, int, void*) {}, nullptr);
+      branch_b_, YOGI_ENC_JSON, json_data_, sizeof(json_data_), YOGI_TRUE, YOGI_PRIO_NORMAL,
+      [](int, int, void*) {}, nullptr);
   ASSERT_GT(oid, 0);
 
   while (!rcv_a_.broadcast_received()) poll_context(context_);
@@ -334,7 +489,8 @@ TEST_F(BroadcastManagerTest, ReceiveMessagePack) {
 TEST_F(BroadcastManagerTest, ReceiveMessagePackBufferTooSmall) {
   auto data = make_big_json_data();
   int oid   = YOGI_BranchSendBroadcastAsync(
-      branch_b_, YOGI_ENC_JSON, data.data(), static_cast<int>(data.size()), YOGI_TRUE, [](int, int, void*) {}, nullptr);
+      branch_b_, YOGI_ENC_JSON, data.data(), static_cast<int>(data.size()), YOGI_TRUE, YOGI_PRIO_NORMAL,
+      [](int, int, void*) {}, nullptr);
   ASSERT_GT(oid, 0);
 
   while (!rcv_a_.broadcast_received()) poll_context(context_);
@@ -353,3 +509,317 @@ TEST_F(BroadcastManagerTest, CancelReceive) {
   EXPECT_TRUE(rcv_a_.broadcast_received());
   EXPECT_EQ(rcv_a_.get_handler_result(), YOGI_ERR_CANCELED);
 }
+
+class BroadcastQueueTest : public TestFixture {
+ protected:
+  virtual void TearDown() {
+    EXPECT_EQ(YOGI_DestroyAll(), YOGI_OK);
+  }
+
+  void create_branches(const char* policy, std::size_t depth, double timeout_a = kBranchProps["timeout"]) {
+    context_ = create_context();
+
+    auto props_a       = kBranchProps;
+    props_a["name"]    = "a";
+    props_a["timeout"] = timeout_a;
+
+    int res = YOGI_BranchCreate(&branch_a_, context_, create_configuration(props_a), nullptr);
+    ASSERT_OK(res);
+
+    auto props                      = kBranchProps;
+    props["name"]                   = "b";
+    props["broadcast_queue_depth"]  = depth;
+    props["broadcast_queue_policy"] = policy;
+
+    res = YOGI_BranchCreate(&branch_b_, context_, create_configuration(props), nullptr);
+    ASSERT_OK(res);
+
+    run_context_until_branches_are_connected(context_, {branch_a_, branch_b_});
+    run_context_in_background(context_);
+  }
+
+  void send_broadcasts(int n, std::size_t min_peak, int first = 1) {
+    for (int i = first; i < first + n; ++i) {
+      auto json = "["s + std::to_string(i) + "]";
+      int res   = YOGI_BranchSendBroadcast(branch_a_, YOGI_ENC_JSON, json.c_str(), static_cast<int>(json.size() + 1),
+                                         YOGI_TRUE);
+      ASSERT_OK(res);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (get_branch_info(branch_b_)["broadcast_queue_peak"].get<std::size_t>() < min_peak) {
+      ASSERT_LT(std::chrono::steady_clock::now() - start, 1s);
+      std::this_thread::sleep_for(1ms);
+    }
+
+    // Give the remaining broadcasts time to arrive
+    std::this_thread::sleep_for(kTimingMargin);
+  }
+
+  std::string receive_broadcast() {
+    BroadcastReceiver rcv(branch_b_);
+    rcv.wait_for_broadcast();
+    EXPECT_EQ(rcv.get_handler_result(), YOGI_OK);
+    return rcv.get_received_data().data();
+  }
+
+  void* context_;
+  void* branch_a_;
+  void* branch_b_;
+};
+
+TEST_F(BroadcastQueueTest, DropOldest) {
+  create_branches("drop_oldest", 2);
+  send_broadcasts(3, 2);
+
+  EXPECT_EQ(receive_broadcast(), "[2]");
+  EXPECT_EQ(receive_broadcast(), "[3]");
+  EXPECT_EQ(get_branch_info(branch_b_)["broadcast_queue_peak"], 2);
+}
+
+TEST_F(BroadcastQueueTest, DropNewest) {
+  create_branches("drop_newest", 2);
+  send_broadcasts(3, 2);
+
+  EXPECT_EQ(receive_broadcast(), "[1]");
+  EXPECT_EQ(receive_broadcast(), "[2]");
+  EXPECT_EQ(get_branch_info(branch_b_)["broadcast_queue_peak"], 2);
+}
+
+TEST_F(BroadcastQueueTest, BlockPeer) {
+  create_branches("block_peer", 1);
+  send_broadcasts(3, 1);
+
+  EXPECT_EQ(receive_broadcast(), "[1]");
+  EXPECT_EQ(receive_broadcast(), "[2]");
+  EXPECT_EQ(receive_broadcast(), "[3]");
+}
+
+TEST_F(BroadcastQueueTest, BlockPeerForHalfItsTimeout) {
+  create_branches("block_peer", 1, 0.2);
+  send_broadcasts(2, 1);
+
+  // Branch a is not blocked anymore, so its broadcasts get discarded
+  std::this_thread::sleep_for(100ms + kTimingMargin);
+  send_broadcasts(1, 1, 3);
+
+  EXPECT_EQ(receive_broadcast(), "[1]");
+  EXPECT_EQ(receive_broadcast(), "[2]");
+
+  send_broadcasts(1, 1, 4);
+  EXPECT_EQ(receive_broadcast(), "[4]");
+}
+
+class MulticastBroadcastTest : public TestFixture {
+ protected:
+  MulticastBroadcastTest()
+      : port_(static_cast<unsigned short>(find_unused_port())),
+        context_(create_context()),
+        fake_(false, {}, port_),
+        key_(MulticastSender::kKeySize, 0x42) {
+    auto props                        = kBranchProps;
+    props["name"]                     = "a";
+    props["broadcast_multicast_port"] = port_;
+    props["broadcast_queue_depth"]    = 8;
+
+    int res = YOGI_BranchCreate(&branch_, context_, create_configuration(props), nullptr);
+    EXPECT_OK(res);
+
+    run_context_in_background(context_);
+    fake_.connect(branch_);
+    while (!fake_.is_connected_to(branch_)) std::this_thread::sleep_for(1ms);
+  }
+
+  virtual void TearDown() {
+    EXPECT_EQ(YOGI_DestroyAll(), YOGI_OK);
+  }
+
+  static SmallBuffer make_broadcast_msg(int n) {
+    const Byte msgpack_data[] = {0x91, static_cast<Byte>(n)};  // [n]
+    return messages::BroadcastOutgoing(Payload(boost::asio::buffer(msgpack_data), YOGI_ENC_MSGPACK)).serialize();
+  }
+
+  void send_sync(std::uint64_t seq) {
+    auto session_key = fake_.make_session_key("multicast");
+    Buffer wrapped_key(key_.size());
+    for (std::size_t i = 0; i < key_.size(); ++i) {
+      wrapped_key[i] = key_[i] ^ session_key[i];
+    }
+
+    fake_.send_message(messages::MulticastSyncOutgoing(seq, wrapped_key));
+  }
+
+  void send_datagram(std::uint64_t seq, int n, bool valid_mac = true) {
+    fake_.send_multicast_datagram(key_, seq, make_broadcast_msg(n), valid_mac);
+  }
+
+  std::pair<std::uint64_t, std::size_t> receive_nack() {
+    std::pair<std::uint64_t, std::size_t> nack;
+    IncomingMessage::deserialize(fake_.receive_message(), [&](auto& msg) {
+      ASSERT_EQ(msg.get_type(), MessageType::kMulticastNack);
+      auto& nack_msg = static_cast<const messages::MulticastNackIncoming&>(msg);
+      nack           = {nack_msg.get_first_seq(), nack_msg.get_count()};
+    });
+
+    return nack;
+  }
+
+  std::string receive_broadcast() {
+    BroadcastReceiver rcv(branch_);
+    rcv.wait_for_broadcast();
+    EXPECT_OK(rcv.get_handler_result());
+    return rcv.get_received_data().data();
+  }
+
+  void start_await_broadcasts_lost_event() {
+    lost_event_received_ = false;
+    int res              = YOGI_BranchAwaitEventAsync(
+        branch_, YOGI_BEV_BROADCASTS_LOST, &lost_event_uuid_, lost_event_json_, sizeof(lost_event_json_),
+        [](int res, int, int ev_res, void* userarg) {
+          auto self                  = static_cast<MulticastBroadcastTest*>(userarg);
+          self->lost_event_res_      = res == YOGI_OK ? ev_res : res;
+          self->lost_event_received_ = true;
+        },
+        this);
+    EXPECT_OK(res);
+  }
+
+  nlohmann::json wait_for_broadcasts_lost_event() {
+    auto start = std::chrono::steady_clock::now();
+    while (!lost_event_received_) {
+      if (std::chrono::steady_clock::now() > start + 1s) {
+        throw std::runtime_error("No YOGI_BEV_BROADCASTS_LOST event received within one second.");
+      }
+
+      std::this_thread::sleep_for(1ms);
+    }
+
+    EXPECT_ERR(lost_event_res_, YOGI_ERR_BROADCASTS_LOST);
+    return nlohmann::json::parse(lost_event_json_);
+  }
+
+  const unsigned short port_;
+  void* context_;
+  void* branch_;
+  FakeBranch fake_;
+  const Buffer key_;
+
+  std::atomic<bool> lost_event_received_;
+  int lost_event_res_;
+  boost::uuids::uuid lost_event_uuid_;
+  char lost_event_json_[1000];
+};
+
+TEST_F(MulticastBroadcastTest, Send) {
+  const char json_data[][4] = {"[1]", "[2]"};
+  for (auto& data : json_data) {
+    int res = YOGI_BranchSendBroadcast(branch_, YOGI_ENC_JSON, data, sizeof(data), YOGI_TRUE);
+    ASSERT_OK(res);
+  }
+
+  // The key and the first sequence number get passed over the connection
+  std::uint64_t first_seq = 0;
+  Buffer key;
+  IncomingMessage::deserialize(fake_.receive_message(), [&](auto& msg) {
+    ASSERT_EQ(msg.get_type(), MessageType::kMulticastSync);
+    auto& sync = static_cast<const messages::MulticastSyncIncoming&>(msg);
+    first_seq  = sync.get_seq();
+
+    auto session_key = fake_.make_session_key("multicast");
+    for (std::size_t i = 0; i < session_key.size(); ++i) {
+      key.push_back(sync.get_wrapped_key()[i] ^ session_key[i]);
+    }
+  });
+
+  // The branch sends the datagrams on every interface
+  std::map<std::uint64_t, Buffer> datagrams;
+  while (datagrams.size() < 2) {
+    datagrams.insert(fake_.receive_multicast_datagram(key));
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    auto msg_bytes = make_broadcast_msg(i + 1);
+    EXPECT_EQ(datagrams[first_seq + static_cast<std::uint64_t>(i)], Buffer(msg_bytes.begin(), msg_bytes.end()));
+  }
+
+  // Broadcasts that have not been sent yet do not get repaired
+  fake_.send_message(messages::MulticastNackOutgoing(first_seq, 3));
+  for (int i = 0; i < 2; ++i) {
+    IncomingMessage::deserialize(fake_.receive_message(), [&](auto& msg) {
+      ASSERT_EQ(msg.get_type(), MessageType::kMulticastRepair);
+      auto& repair = static_cast<const messages::MulticastRepairIncoming&>(msg);
+      EXPECT_EQ(repair.get_seq(), first_seq + static_cast<std::uint64_t>(i));
+
+      auto msg_bytes = make_broadcast_msg(i + 1);
+      auto raw       = static_cast<const Byte*>(repair.get_msg().data());
+      EXPECT_EQ(Buffer(raw, raw + repair.get_msg().size()), Buffer(msg_bytes.begin(), msg_bytes.end()));
+    });
+  }
+}
+
+TEST_F(MulticastBroadcastTest, ReceiveReordered) {
+  send_sync(1);
+  send_datagram(1, 1);
+  send_datagram(3, 3);
+  send_datagram(2, 2);
+
+  EXPECT_EQ(receive_broadcast(), "[1]");
+  EXPECT_EQ(receive_broadcast(), "[2]");
+  EXPECT_EQ(receive_broadcast(), "[3]");
+}
+
+TEST_F(MulticastBroadcastTest, RepairLostDatagram) {
+  send_sync(1);
+  send_datagram(1, 1);
+  send_datagram(3, 3);
+
+  auto nack = receive_nack();
+  EXPECT_EQ(nack.first, 2u);
+  EXPECT_EQ(nack.second, 1u);
+  fake_.send_message(messages::MulticastRepairOutgoing(2, make_broadcast_msg(2)));
+
+  EXPECT_EQ(receive_broadcast(), "[1]");
+  EXPECT_EQ(receive_broadcast(), "[2]");
+  EXPECT_EQ(receive_broadcast(), "[3]");
+}
+
+TEST_F(MulticastBroadcastTest, UnrepairableDatagram) {
+  start_await_broadcasts_lost_event();
+
+  send_sync(1);
+  send_datagram(1, 1);
+  send_datagram(3, 3);
+
+  auto nack = receive_nack();
+  EXPECT_EQ(nack.first, 2u);
+  fake_.send_message(messages::MulticastRepairOutgoing(2, SmallBuffer{}));
+
+  EXPECT_EQ(receive_broadcast(), "[1]");
+  EXPECT_EQ(receive_broadcast(), "[3]");
+  EXPECT_EQ(wait_for_broadcasts_lost_event()["count"], 1);
+}
+
+TEST_F(MulticastBroadcastTest, SkipUnrepairedDatagrams) {
+  start_await_broadcasts_lost_event();
+
+  send_sync(1);
+  send_datagram(1, 1);
+  EXPECT_EQ(receive_broadcast(), "[1]");
+
+  // Broadcast 2 never arrives, so the ones after it pile up until the repair
+  // window is exceeded
+  for (std::uint64_t seq = 3; seq <= MulticastSender::kRepairWindowSize + 3; ++seq) {
+    fake_.send_message(messages::MulticastRepairOutgoing(seq, make_broadcast_msg(3)));
+  }
+
+  EXPECT_EQ(wait_for_broadcasts_lost_event()["count"], 1);
+  EXPECT_EQ(receive_broadcast(), "[3]");
+}
+
+TEST_F(MulticastBroadcastTest, DropForgedDatagram) {
+  send_sync(1);
+  send_datagram(1, 1, false);
+  send_datagram(1, 2);
+
+  EXPECT_EQ(receive_broadcast(), "[2]");
+}
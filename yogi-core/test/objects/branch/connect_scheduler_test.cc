@@ -0,0 +1,137 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <test/common.h>
+
+#include <src/objects/branch/connect_scheduler.h>
+
+#include <boost/uuid/random_generator.hpp>
+#include <thread>
+#include <vector>
+
+class ConnectSchedulerTest : public TestFixture {
+ protected:
+  void create_scheduler(const nlohmann::json& cfg) {
+    auto info  = std::make_shared<LocalBranchInfo>(cfg, NetworkInterfaceInfosVector{}, 0);
+    scheduler_ = std::make_shared<ConnectScheduler>(context_, info);
+  }
+
+  // Returns false if the branch is still backing off; fails the attempt if
+  // success is false
+  bool connect(const boost::uuids::uuid& uuid, bool success) {
+    bool called = false;
+    if (!scheduler_->schedule(uuid, [&] { called = true; })) return false;
+
+    EXPECT_TRUE(called);
+    scheduler_->finished(uuid, success);
+    return true;
+  }
+
+  ContextPtr context_ = Context::create();
+  ConnectSchedulerPtr scheduler_;
+  boost::uuids::random_generator uuid_gen_;
+};
+
+TEST_F(ConnectSchedulerTest, ConcurrencyCap) {
+  create_scheduler({{"max_concurrent_connects", 2}});
+
+  std::vector<boost::uuids::uuid> uuids = {uuid_gen_(), uuid_gen_(), uuid_gen_()};
+  std::vector<boost::uuids::uuid> started;
+  for (auto& uuid : uuids) {
+    EXPECT_TRUE(scheduler_->schedule(uuid, [&, uuid] { started.push_back(uuid); }));
+  }
+
+  ASSERT_EQ(started.size(), 2u);
+  EXPECT_EQ(started[0], uuids[0]);
+  EXPECT_EQ(started[1], uuids[1]);
+
+  // Finishing an unknown attempt does not free a slot
+  scheduler_->finished(uuid_gen_(), true);
+  EXPECT_EQ(started.size(), 2u);
+
+  scheduler_->finished(uuids[1], true);
+  ASSERT_EQ(started.size(), 3u);
+  EXPECT_EQ(started[2], uuids[2]);
+}
+
+TEST_F(ConnectSchedulerTest, JitterRange) {
+  const auto max_jitter = 100ms;
+  create_scheduler({{"connect_jitter", std::chrono::duration<float>(max_jitter).count()}});
+
+  const std::size_t n = 20;
+  std::vector<std::chrono::steady_clock::duration> delays;
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < n; ++i) {
+    EXPECT_TRUE(scheduler_->schedule(uuid_gen_(), [&] { delays.push_back(std::chrono::steady_clock::now() - start); }));
+  }
+
+  while (delays.size() < n) {
+    ASSERT_LT(std::chrono::steady_clock::now() - start, max_jitter + kTimingMargin);
+    context_->run_one(1ms);
+  }
+
+  // The attempts get spread over the jitter range instead of starting at once
+  auto minmax = std::minmax_element(delays.begin(), delays.end());
+  EXPECT_GT(*minmax.second - *minmax.first, max_jitter / 4);
+}
+
+TEST_F(ConnectSchedulerTest, BackoffDoublesAndResets) {
+  // The backoff starts at the advertising interval
+  create_scheduler({{"advertising_interval", 0.1}, {"max_connect_backoff", 0.3}});
+  auto uuid = uuid_gen_();
+
+  auto expect_backoff = [&](std::chrono::milliseconds backoff) {
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(connect(uuid, false));
+    std::this_thread::sleep_until(start + backoff - kTimingMargin);
+    EXPECT_FALSE(connect(uuid, false));
+    std::this_thread::sleep_until(start + backoff + kTimingMargin);
+  };
+
+  EXPECT_TRUE(connect(uuid, false));
+  expect_backoff(100ms);
+  EXPECT_TRUE(connect(uuid, false));
+  expect_backoff(200ms);
+  EXPECT_TRUE(connect(uuid, false));
+  expect_backoff(300ms);  // Capped
+  EXPECT_TRUE(connect(uuid, false));
+  expect_backoff(300ms);
+
+  // A successful attempt resets the backoff
+  EXPECT_TRUE(connect(uuid, true));
+  EXPECT_TRUE(connect(uuid, false));
+  expect_backoff(100ms);
+}
+
+TEST_F(ConnectSchedulerTest, StaleBackoffsGetPruned) {
+  create_scheduler({{"advertising_interval", 0.1}, {"max_connect_backoff", 0.4}});
+  auto uuid = uuid_gen_();
+
+  EXPECT_TRUE(connect(uuid, false));
+
+  // Backoffs that ended longer than the maximum backoff ago get forgotten, so
+  // the next failed attempt starts over instead of doubling the backoff
+  std::this_thread::sleep_for(500ms + kTimingMargin);
+  EXPECT_TRUE(connect(uuid, false));
+  EXPECT_FALSE(connect(uuid, false));
+  std::this_thread::sleep_for(100ms + kTimingMargin);
+  EXPECT_TRUE(connect(uuid, false));
+}
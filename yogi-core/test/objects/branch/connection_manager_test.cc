@@ -22,8 +22,25 @@
 #include <test/common.h>
 
 #include <src/api/constants.h>
+#include <src/network/serialize.h>
 
 #include <boost/asio.hpp>
+#include <algorithm>
+#include <future>
+
+namespace {
+
+// Removes the given number of bytes from the end of a (non-pipelined) info
+// message, emulating a branch that does not know the last fields
+void strip_trailing_info_fields(Buffer* info_msg, std::size_t n) {
+  info_msg->resize(info_msg->size() - n);
+
+  Buffer body_size;
+  serialize(&body_size, info_msg->size() - BranchInfo::kInfoMessageHeaderSize);
+  std::copy(body_size.begin(), body_size.end(), info_msg->begin() + BranchInfo::kAdvertisingMessageSize);
+}
+
+}  // anonymous namespace
 
 class ConnectionManagerTest : public TestFixture {
  protected:
@@ -38,6 +55,26 @@ class ConnectionManagerTest : public TestFixture {
     branch_ = create_branch(context_, nullptr, nullptr, nullptr, nullptr, adv_addr);
   }
 
+  void re_create_branch_with_resumption_window(float seconds) {
+    auto res = YOGI_Destroy(branch_);
+    ASSERT_OK(res);
+
+    auto props                 = kBranchProps;
+    props["resumption_window"] = seconds;
+    res                        = YOGI_BranchCreate(&branch_, context_, create_configuration(props), nullptr);
+    ASSERT_OK(res);
+  }
+
+  void connect_and_lose_session(FakeBranch* fake) {
+    fake->connect(branch_);
+    while (!fake->is_connected_to(branch_))
+      ;
+
+    fake->disconnect();
+    while (fake->is_connected_to(branch_))
+      ;
+  }
+
   void* context_;
   void* branch_;
 
@@ -90,6 +127,61 @@ TEST_F(ConnectionManagerTest, AdvertisingIPv6) {
   test_advertising("ff02::8000:2439");
 }
 
+TEST_F(ConnectionManagerTest, AdvertisingIntervalBackoff) {
+  MulticastSocket multicast(boost::asio::ip::udp::endpoint(boost::asio::ip::make_address(kAdvAddress), kAdvPort));
+
+  auto res = YOGI_Destroy(branch_);
+  ASSERT_OK(res);
+
+  auto props                        = kBranchProps;
+  props["advertising_interval"]     = 0.05;
+  props["max_advertising_interval"] = 0.2;
+  res                               = YOGI_BranchCreate(&branch_, context_, create_configuration(props), nullptr);
+  ASSERT_OK(res);
+
+  auto uuid = get_branch_uuid(branch_);
+  run_context_in_background(context_);
+
+  // Advertisements get sent over every interface, so only the first message
+  // of each round counts
+  std::vector<std::chrono::milliseconds> gaps;
+  std::chrono::steady_clock::time_point last_adv;
+  auto record_gaps = [&](std::chrono::milliseconds duration) {
+    gaps.clear();
+    auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {
+      auto msg = multicast.receive().second;
+      auto now = std::chrono::steady_clock::now();
+      if (msg.size() < 7 + sizeof(uuid) || std::memcmp(&uuid, msg.data() + 7, sizeof(uuid))) continue;
+      if (now - last_adv < 20ms) continue;
+
+      if (last_adv != std::chrono::steady_clock::time_point{}) {
+        gaps.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(now - last_adv));
+      }
+
+      last_adv = now;
+    }
+  };
+
+  // The interval doubles up to the maximum
+  record_gaps(700ms);
+  ASSERT_GE(gaps.size(), 4u);
+  std::chrono::milliseconds expected_gaps[] = {50ms, 100ms, 200ms, 200ms};
+  for (std::size_t i = 0; i < 4; ++i) {
+    EXPECT_GE(gaps[i], expected_gaps[i] - 10ms);
+    EXPECT_LE(gaps[i], expected_gaps[i] + kTimingMargin);
+  }
+
+  // Once a branch connects, the interval starts over
+  FakeBranch fake;
+  auto connected = std::async(std::launch::async, [&] { fake.connect(branch_); });
+  record_gaps(700ms);
+  connected.get();
+
+  ASSERT_FALSE(gaps.empty());
+  EXPECT_LT(*std::min_element(gaps.begin(), gaps.end()), 150ms);
+}
+
 TEST_F(ConnectionManagerTest, ConnectNormallyIPv4) {
   test_connect_normally("239.255.0.1");
 }
@@ -165,6 +257,127 @@ TEST_F(ConnectionManagerTest, Reconnect) {
     ;
 }
 
+TEST_F(ConnectionManagerTest, PipelinedHandshake) {
+  run_context_in_background(context_);
+  FakeBranch fake(true);
+
+  fake.connect(branch_);
+  while (!fake.is_connected_to(branch_))
+    ;
+
+  fake.disconnect();
+  while (fake.is_connected_to(branch_))
+    ;
+
+  fake.advertise();
+  fake.accept();
+  while (!fake.is_connected_to(branch_))
+    ;
+}
+
+TEST_F(ConnectionManagerTest, InfoMessageWithoutOptionalFields) {
+  run_context_in_background(context_);
+  FakeBranch fake;
+
+  // compression_threshold, broadcast_multicast_port, resumption_window and
+  // max_broadcast_size
+  fake.connect(branch_, [](auto msg) { strip_trailing_info_fields(msg, 4 + 2 + 8 + 4); });
+  while (!fake.is_connected_to(branch_))
+    ;
+}
+
+TEST_F(ConnectionManagerTest, InfoMessageWithoutShmNegotiationFlag) {
+  run_context_in_background(context_);
+  FakeBranch fake;
+
+  // The branch must not send a shared memory offer or wait for one
+  auto fn = [](auto msg) { msg->at(6) &= static_cast<Byte>(~BranchInfo::kShmNegotiationFlag); };
+
+  fake.connect(branch_, fn);
+  while (!fake.is_connected_to(branch_))
+    ;
+
+  fake.disconnect();
+  while (fake.is_connected_to(branch_))
+    ;
+
+  fake.advertise();
+  fake.accept(fn);
+  while (!fake.is_connected_to(branch_))
+    ;
+}
+
+TEST_F(ConnectionManagerTest, ResumeSession) {
+  re_create_branch_with_resumption_window(10.0);
+  run_context_in_background(context_);
+  FakeBranch fake(true, 10s);
+
+  connect_and_lose_session(&fake);
+  fake.resume(fake.make_resumption_ticket(), fake.make_resumption_ticket_id());
+  while (!fake.is_connected_to(branch_))
+    ;
+}
+
+TEST_F(ConnectionManagerTest, RejectUnknownResumptionTicketId) {
+  re_create_branch_with_resumption_window(10.0);
+  run_context_in_background(context_);
+  FakeBranch fake(true, 10s);
+
+  connect_and_lose_session(&fake);
+  auto ticket_id = fake.make_resumption_ticket_id();
+  ++ticket_id[0];
+  EXPECT_THROW(fake.resume(fake.make_resumption_ticket(), ticket_id), boost::system::system_error);
+  EXPECT_FALSE(fake.is_connected_to(branch_));
+}
+
+TEST_F(ConnectionManagerTest, RejectInvalidResumptionProof) {
+  re_create_branch_with_resumption_window(10.0);
+  run_context_in_background(context_);
+  FakeBranch fake(true, 10s);
+
+  connect_and_lose_session(&fake);
+  auto ticket    = fake.make_resumption_ticket();
+  auto ticket_id = fake.make_resumption_ticket_id();
+  EXPECT_THROW(fake.resume(ticket, ticket_id, false), boost::system::system_error);
+  EXPECT_FALSE(fake.is_connected_to(branch_));
+
+  // Knowing the ticket ID alone does not invalidate the ticket
+  fake.resume(ticket, ticket_id);
+  while (!fake.is_connected_to(branch_))
+    ;
+}
+
+TEST_F(ConnectionManagerTest, RejectExpiredResumptionTicket) {
+  re_create_branch_with_resumption_window(0.05);
+  run_context_in_background(context_);
+  FakeBranch fake(true, 10s);
+
+  connect_and_lose_session(&fake);
+  std::this_thread::sleep_for(50ms + kTimingMargin);
+  EXPECT_THROW(fake.resume(fake.make_resumption_ticket(), fake.make_resumption_ticket_id()),
+               boost::system::system_error);
+  EXPECT_FALSE(fake.is_connected_to(branch_));
+}
+
+TEST_F(ConnectionManagerTest, ResumptionTicketCanOnlyBeUsedOnce) {
+  re_create_branch_with_resumption_window(10.0);
+  run_context_in_background(context_);
+  FakeBranch fake(true, 10s);
+
+  connect_and_lose_session(&fake);
+  auto ticket    = fake.make_resumption_ticket();
+  auto ticket_id = fake.make_resumption_ticket_id();
+  fake.resume(ticket, ticket_id);
+  while (!fake.is_connected_to(branch_))
+    ;
+
+  fake.disconnect();
+  while (fake.is_connected_to(branch_))
+    ;
+
+  EXPECT_THROW(fake.resume(ticket, ticket_id), boost::system::system_error);
+}
+
 TEST_F(ConnectionManagerTest, InvalidMagicPrefix) {
   run_context_in_background(context_);
   FakeBranch fake;
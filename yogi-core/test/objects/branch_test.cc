@@ -84,6 +84,189 @@ TEST_F(BranchTest, CustomQueueSizes) {
   EXPECT_EQ(info.value("rx_queue_size", -1), constants::kMaxRxQueueSize);
 }
 
+TEST_F(BranchTest, MirroredQueues) {
+  void* branch;
+  int res = YOGI_BranchCreate(&branch, context_, nullptr, nullptr);
+  ASSERT_OK(res);
+  EXPECT_FALSE(get_branch_info(branch).value("mirrored_queues", true));
+
+  nlohmann::json props;
+  props["mirrored_queues"] = true;
+
+  res = YOGI_BranchCreate(&branch, context_, create_configuration(props), nullptr);
+  ASSERT_OK(res);
+  EXPECT_TRUE(get_branch_info(branch).value("mirrored_queues", false));
+}
+
+TEST_F(BranchTest, TxCoalescing) {
+  void* branch;
+  int res = YOGI_BranchCreate(&branch, context_, nullptr, nullptr);
+  ASSERT_OK(res);
+  auto info = get_branch_info(branch);
+  EXPECT_EQ(info.value("tx_coalescing_delay", -1.0f), 0.0f);
+  EXPECT_EQ(info.value("tx_coalescing_bytes", -1), 0);
+
+  nlohmann::json props;
+  props["tx_coalescing_delay"] = 0.005;
+  props["tx_coalescing_bytes"] = 1400;
+
+  res = YOGI_BranchCreate(&branch, context_, create_configuration(props), nullptr);
+  ASSERT_OK(res);
+  info = get_branch_info(branch);
+  EXPECT_FLOAT_EQ(info.value("tx_coalescing_delay", -1.0f), 0.005f);
+  EXPECT_EQ(info.value("tx_coalescing_bytes", -1), 1400);
+}
+
+TEST_F(BranchTest, IoBackend) {
+  void* branch;
+  int res = YOGI_BranchCreate(&branch, context_, nullptr, nullptr);
+  ASSERT_OK(res);
+  EXPECT_EQ(get_branch_info(branch).value("io_backend", ""), "asio");
+
+  nlohmann::json props;
+  props["io_backend"] = "io_uring";
+
+  res = YOGI_BranchCreate(&branch, context_, create_configuration(props), nullptr);
+  ASSERT_OK(res);
+  EXPECT_EQ(get_branch_info(branch).value("io_backend", ""), "io_uring");
+
+  props["io_backend"] = "foo";
+  res                 = YOGI_BranchCreate(&branch, context_, create_configuration(props), nullptr);
+  EXPECT_ERR(res, YOGI_ERR_CONFIGURATION_VALIDATION_FAILED);
+}
+
+TEST_F(BranchTest, ShmTransport) {
+  void* branch;
+  int res = YOGI_BranchCreate(&branch, context_, nullptr, nullptr);
+  ASSERT_OK(res);
+  EXPECT_TRUE(get_branch_info(branch).value("shm_transport", false));
+
+  nlohmann::json props;
+  props["shm_transport"] = false;
+
+  res = YOGI_BranchCreate(&branch, context_, create_configuration(props), nullptr);
+  ASSERT_OK(res);
+  EXPECT_FALSE(get_branch_info(branch).value("shm_transport", true));
+}
+
+TEST_F(BranchTest, ZeroCopyThreshold) {
+  void* branch;
+  int res = YOGI_BranchCreate(&branch, context_, nullptr, nullptr);
+  ASSERT_OK(res);
+  EXPECT_EQ(get_branch_info(branch).value("zero_copy_threshold", -1), 0);
+
+  nlohmann::json props;
+  props["zero_copy_threshold"] = 4096;
+
+  res = YOGI_BranchCreate(&branch, context_, create_configuration(props), nullptr);
+  ASSERT_OK(res);
+  EXPECT_EQ(get_branch_info(branch).value("zero_copy_threshold", -1), 4096);
+}
+
+TEST_F(BranchTest, BroadcastQueue) {
+  void* branch;
+  int res = YOGI_BranchCreate(&branch, context_, nullptr, nullptr);
+  ASSERT_OK(res);
+  auto info = get_branch_info(branch);
+  EXPECT_EQ(info.value("broadcast_queue_depth", -1), 0);
+  EXPECT_EQ(info.value("broadcast_queue_bytes", -1), 0);
+  EXPECT_EQ(info.value("broadcast_queue_policy", ""), "drop_oldest");
+  EXPECT_EQ(info.value("broadcast_queue_peak", -1), 0);
+  EXPECT_EQ(info.value("max_broadcast_size", -1), 16777216);
+
+  nlohmann::json props;
+  props["broadcast_queue_depth"]  = 100;
+  props["broadcast_queue_bytes"]  = 65536;
+  props["broadcast_queue_policy"] = "block_peer";
+  props["max_broadcast_size"]     = 1000000;
+
+  res = YOGI_BranchCreate(&branch, context_, create_configuration(props), nullptr);
+  ASSERT_OK(res);
+  info = get_branch_info(branch);
+  EXPECT_EQ(info.value("broadcast_queue_depth", -1), 100);
+  EXPECT_EQ(info.value("broadcast_queue_bytes", -1), 65536);
+  EXPECT_EQ(info.value("broadcast_queue_policy", ""), "block_peer");
+  EXPECT_EQ(info.value("max_broadcast_size", -1), 1000000);
+}
+
+TEST_F(BranchTest, CompressionThreshold) {
+  void* branch;
+  int res = YOGI_BranchCreate(&branch, context_, nullptr, nullptr);
+  ASSERT_OK(res);
+  EXPECT_EQ(get_branch_info(branch).value("compression_threshold", -1), 0);
+
+  nlohmann::json props;
+  props["compression_threshold"] = 1024;
+
+  res = YOGI_BranchCreate(&branch, context_, create_configuration(props), nullptr);
+  ASSERT_OK(res);
+  EXPECT_EQ(get_branch_info(branch).value("compression_threshold", -1), 1024);
+}
+
+TEST_F(BranchTest, BroadcastMulticastPort) {
+  void* branch;
+  int res = YOGI_BranchCreate(&branch, context_, nullptr, nullptr);
+  ASSERT_OK(res);
+  EXPECT_EQ(get_branch_info(branch).value("broadcast_multicast_port", -1), 0);
+
+  auto props                        = kBranchProps;
+  props["broadcast_multicast_port"] = kAdvPort + 1;
+
+  res = YOGI_BranchCreate(&branch, context_, create_configuration(props), nullptr);
+  ASSERT_OK(res);
+  EXPECT_EQ(get_branch_info(branch).value("broadcast_multicast_port", -1), kAdvPort + 1);
+}
+
+TEST_F(BranchTest, ResumptionWindow) {
+  void* branch;
+  int res = YOGI_BranchCreate(&branch, context_, nullptr, nullptr);
+  ASSERT_OK(res);
+  EXPECT_EQ(get_branch_info(branch).value("resumption_window", -1.0), 0.0);
+
+  auto props                 = kBranchProps;
+  props["resumption_window"] = 2.5;
+
+  res = YOGI_BranchCreate(&branch, context_, create_configuration(props), nullptr);
+  ASSERT_OK(res);
+  EXPECT_EQ(get_branch_info(branch).value("resumption_window", -1.0), 2.5);
+}
+
+TEST_F(BranchTest, MaxAdvertisingInterval) {
+  void* branch;
+  int res = YOGI_BranchCreate(&branch, context_, nullptr, nullptr);
+  ASSERT_OK(res);
+  EXPECT_EQ(get_branch_info(branch).value("max_advertising_interval", -1.0), 0.0);
+
+  auto props                        = kBranchProps;
+  props["max_advertising_interval"] = 8.0;
+
+  res = YOGI_BranchCreate(&branch, context_, create_configuration(props), nullptr);
+  ASSERT_OK(res);
+  EXPECT_EQ(get_branch_info(branch).value("max_advertising_interval", -1.0), 8.0);
+}
+
+TEST_F(BranchTest, ConnectScheduling) {
+  void* branch;
+  int res = YOGI_BranchCreate(&branch, context_, nullptr, nullptr);
+  ASSERT_OK(res);
+  auto info = get_branch_info(branch);
+  EXPECT_EQ(info.value("max_concurrent_connects", -1), 0);
+  EXPECT_EQ(info.value("connect_jitter", -1.0), 0.0);
+  EXPECT_EQ(info.value("max_connect_backoff", -1.0), 0.0);
+
+  auto props                       = kBranchProps;
+  props["max_concurrent_connects"] = 4;
+  props["connect_jitter"]          = 0.5;
+  props["max_connect_backoff"]     = 16.0;
+
+  res = YOGI_BranchCreate(&branch, context_, create_configuration(props), nullptr);
+  ASSERT_OK(res);
+  info = get_branch_info(branch);
+  EXPECT_EQ(info.value("max_concurrent_connects", -1), 4);
+  EXPECT_EQ(info.value("connect_jitter", -1.0), 0.5);
+  EXPECT_EQ(info.value("max_connect_backoff", -1.0), 16.0);
+}
+
 TEST_F(BranchTest, InvalidQueueSizes) {
   std::vector<std::pair<const char*, int>> entries = {
       {"tx_queue_size", constants::kMinTxQueueSize - 1},
@@ -49,6 +49,23 @@ TEST(SchemasTest, BranchConfigDefaults) {
   EXPECT_EQ(schema["properties"]["ghost_mode"]["default"], false);
   EXPECT_EQ(schema["properties"]["tx_queue_size"]["default"], constants::kDefaultTxQueueSize);
   EXPECT_EQ(schema["properties"]["rx_queue_size"]["default"], constants::kDefaultRxQueueSize);
+  EXPECT_EQ(schema["properties"]["mirrored_queues"]["default"], false);
+  EXPECT_EQ(schema["properties"]["tx_coalescing_delay"]["default"], 0);
+  EXPECT_EQ(schema["properties"]["tx_coalescing_bytes"]["default"], 0);
+  EXPECT_EQ(schema["properties"]["io_backend"]["default"], "asio");
+  EXPECT_EQ(schema["properties"]["shm_transport"]["default"], true);
+  EXPECT_EQ(schema["properties"]["zero_copy_threshold"]["default"], 0);
+  EXPECT_EQ(schema["properties"]["broadcast_queue_depth"]["default"], 0);
+  EXPECT_EQ(schema["properties"]["broadcast_queue_bytes"]["default"], 0);
+  EXPECT_EQ(schema["properties"]["broadcast_queue_policy"]["default"], "drop_oldest");
+  EXPECT_EQ(schema["properties"]["max_broadcast_size"]["default"], 16777216);
+  EXPECT_EQ(schema["properties"]["compression_threshold"]["default"], 0);
+  EXPECT_EQ(schema["properties"]["broadcast_multicast_port"]["default"], 0);
+  EXPECT_EQ(schema["properties"]["resumption_window"]["default"], 0);
+  EXPECT_EQ(schema["properties"]["max_advertising_interval"]["default"], 0);
+  EXPECT_EQ(schema["properties"]["max_concurrent_connects"]["default"], 0);
+  EXPECT_EQ(schema["properties"]["connect_jitter"]["default"], 0);
+  EXPECT_EQ(schema["properties"]["max_connect_backoff"]["default"], 0);
 }
 
 TEST(SchemasTest, ValidateJson) {
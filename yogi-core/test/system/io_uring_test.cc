@@ -0,0 +1,240 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <test/common.h>
+
+#include <src/system/io_uring.h>
+
+#ifdef __linux__
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+
+using namespace std::chrono_literals;
+
+#ifdef __linux__
+
+class IoUringTest : public TestFixture {
+ protected:
+  virtual void SetUp() override {
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_), 0);
+  }
+
+  virtual void TearDown() override {
+    if (io_uring_) io_uring_->submit();
+    close(fds_[0]);
+    close(fds_[1]);
+  }
+
+  bool create(std::size_t num_buffers = IoUring::kDefaultNumBuffers,
+              std::size_t buffer_size = IoUring::kDefaultBufferSize) {
+    io_uring_ = IoUring::try_create(ioc_, IoUring::kDefaultEntries, num_buffers, buffer_size);
+    return !!io_uring_;
+  }
+
+  boost::asio::io_context ioc_;
+  IoUringPtr io_uring_;
+  int fds_[2];
+  Buffer data_ = {1, 2, 3, 4, 5, 6};
+};
+
+TEST_F(IoUringTest, WriteAndRead) {
+  if (!create()) {
+    GTEST_SKIP() << "io_uring not supported on this platform";
+  }
+
+  Buffer received;
+  io_uring_->read_some_async(fds_[1], 100, [&](int res, const Byte* data) {
+    ASSERT_GT(res, 0);
+    received.assign(data, data + res);
+  });
+
+  int bytes_written = 0;
+  io_uring_->write_some_async(
+      fds_[0], {boost::asio::buffer(data_.data(), 2), boost::asio::buffer(data_.data() + 2, data_.size() - 2)},
+      [&](int res, auto) { bytes_written = res; });
+
+  while (bytes_written == 0 || received.empty()) {
+    ioc_.run_one_for(100us);
+  }
+
+  EXPECT_EQ(bytes_written, static_cast<int>(data_.size()));
+  EXPECT_EQ(received, data_);
+}
+
+TEST_F(IoUringTest, WriteLimitedToBufferSize) {
+  if (!create(4, 4)) {
+    GTEST_SKIP() << "io_uring not supported on this platform";
+  }
+
+  int bytes_written = 0;
+  io_uring_->write_some_async(fds_[0], {boost::asio::buffer(data_)}, [&](int res, auto) { bytes_written = res; });
+
+  while (bytes_written == 0) {
+    ioc_.run_one_for(100us);
+  }
+
+  EXPECT_EQ(bytes_written, 4);
+}
+
+TEST_F(IoUringTest, PendingReadDoesNotOccupyBuffer) {
+  if (!create(1, 16)) {
+    GTEST_SKIP() << "io_uring not supported on this platform";
+  }
+
+  Buffer received;
+  io_uring_->read_some_async(fds_[1], 100, [&](int res, const Byte* data) {
+    ASSERT_GT(res, 0);
+    received.assign(data, data + res);
+  });
+
+  // The read waits for data without holding the only buffer
+  int bytes_written = 0;
+  io_uring_->write_some_async(fds_[1], {boost::asio::buffer(data_)}, [&](int res, auto) { bytes_written = res; });
+
+  while (bytes_written == 0) {
+    ioc_.run_one_for(100us);
+  }
+
+  EXPECT_EQ(bytes_written, static_cast<int>(data_.size()));
+  EXPECT_TRUE(received.empty());
+
+  Buffer echoed(data_.size());
+  ASSERT_EQ(read(fds_[0], echoed.data(), echoed.size()), static_cast<ssize_t>(data_.size()));
+  EXPECT_EQ(echoed, data_);
+
+  ASSERT_EQ(write(fds_[0], data_.data(), data_.size()), static_cast<ssize_t>(data_.size()));
+
+  while (received.empty()) {
+    ioc_.run_one_for(100us);
+  }
+
+  EXPECT_EQ(received, data_);
+}
+
+TEST_F(IoUringTest, WaitForFreeBuffer) {
+  if (!create(1, 16)) {
+    GTEST_SKIP() << "io_uring not supported on this platform";
+  }
+
+  // The second write waits until the first one returned the only buffer
+  int bytes_written_1 = 0;
+  io_uring_->write_some_async(fds_[0], {boost::asio::buffer(data_)}, [&](int res, auto) { bytes_written_1 = res; });
+
+  int bytes_written_2 = 0;
+  io_uring_->write_some_async(fds_[0], {boost::asio::buffer(data_)}, [&](int res, auto) { bytes_written_2 = res; });
+
+  while (bytes_written_1 == 0 || bytes_written_2 == 0) {
+    ioc_.run_one_for(100us);
+  }
+
+  EXPECT_EQ(bytes_written_1, static_cast<int>(data_.size()));
+  EXPECT_EQ(bytes_written_2, static_cast<int>(data_.size()));
+
+  Buffer received(data_.size() * 2);
+  ASSERT_EQ(read(fds_[1], received.data(), received.size()), static_cast<ssize_t>(received.size()));
+}
+
+TEST_F(IoUringTest, ReadFailure) {
+  if (!create()) {
+    GTEST_SKIP() << "io_uring not supported on this platform";
+  }
+
+  int result = 1;
+  io_uring_->read_some_async(-1, 100, [&](int res, auto) { result = res; });
+
+  while (result == 1) {
+    ioc_.run_one_for(100us);
+  }
+
+  EXPECT_LT(result, 0);
+}
+
+TEST_F(IoUringTest, Cancel) {
+  if (!create(1, 16)) {
+    GTEST_SKIP() << "io_uring not supported on this platform";
+  }
+
+  // The read waits for data and the second write waits for the buffer
+  // occupied by the first write
+  int read_result = 1;
+  io_uring_->read_some_async(fds_[1], 100, [&](int res, auto) { read_result = res; });
+
+  int bytes_written = 0;
+  io_uring_->write_some_async(fds_[0], {boost::asio::buffer(data_)}, [&](int res, auto) { bytes_written = res; });
+
+  int write_result = 1;
+  io_uring_->write_some_async(fds_[1], {boost::asio::buffer(data_)}, [&](int res, auto) { write_result = res; });
+
+  io_uring_->cancel(fds_[1]);
+
+  while (read_result == 1 || write_result == 1 || bytes_written == 0) {
+    ioc_.run_one_for(100us);
+  }
+
+  EXPECT_EQ(read_result, -ECANCELED);
+  EXPECT_EQ(write_result, -ECANCELED);
+  EXPECT_EQ(bytes_written, static_cast<int>(data_.size()));
+
+  // The buffer is available again
+  bytes_written = 0;
+  io_uring_->write_some_async(fds_[0], {boost::asio::buffer(data_)}, [&](int res, auto) { bytes_written = res; });
+
+  while (bytes_written == 0) {
+    ioc_.run_one_for(100us);
+  }
+
+  EXPECT_EQ(bytes_written, static_cast<int>(data_.size()));
+}
+
+TEST_F(IoUringTest, CancelWhileDataAvailable) {
+  if (!create()) {
+    GTEST_SKIP() << "io_uring not supported on this platform";
+  }
+
+  ASSERT_EQ(write(fds_[0], data_.data(), data_.size()), static_cast<ssize_t>(data_.size()));
+
+  // The kernel may already have reported the data but the read must not
+  // start once the operation got canceled
+  int read_result = 1;
+  io_uring_->read_some_async(fds_[1], 100, [&](int res, auto) { read_result = res; });
+  io_uring_->submit();
+  io_uring_->cancel(fds_[1]);
+
+  while (read_result == 1) {
+    ioc_.run_one_for(100us);
+  }
+
+  EXPECT_EQ(read_result, -ECANCELED);
+
+  Buffer received(data_.size());
+  ASSERT_EQ(read(fds_[1], received.data(), received.size()), static_cast<ssize_t>(data_.size()));
+  EXPECT_EQ(received, data_);
+}
+
+#else
+
+TEST(IoUringTest, NotSupported) {
+  boost::asio::io_context ioc;
+  EXPECT_FALSE(IoUring::try_create(ioc));
+}
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <test/common.h>
+
+#include <src/system/mirrored_memory.h>
+
+TEST(MirroredMemoryTest, TryCreate) {
+  auto mem = MirroredMemory::try_create(100);
+  if (!mem) {
+    GTEST_SKIP() << "Mirrored memory not supported on this platform";
+  }
+
+  EXPECT_GE(mem->size(), 100);
+
+  mem->data()[0] = 123;
+  EXPECT_EQ(mem->data()[mem->size()], 123);
+
+  mem->data()[mem->size() * 2 - 1] = 45;
+  EXPECT_EQ(mem->data()[mem->size() - 1], 45);
+}
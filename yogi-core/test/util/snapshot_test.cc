@@ -0,0 +1,97 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <test/common.h>
+
+#include <src/util/snapshot.h>
+
+#include <thread>
+
+namespace {
+
+struct Value {
+  Value(int n, int* destroyed) : n(n), destroyed(destroyed) {
+  }
+
+  ~Value() {
+    ++*destroyed;
+  }
+
+  int n;
+  int* destroyed;
+};
+
+}  // anonymous namespace
+
+class SnapshotTest : public TestFixture {
+ protected:
+  int destroyed_ = 0;
+  Snapshot<Value> uut_{std::make_unique<Value>(1, &destroyed_)};
+};
+
+TEST_F(SnapshotTest, Publish) {
+  EXPECT_EQ(uut_.read()->n, 1);
+
+  uut_.publish(std::make_unique<Value>(2, &destroyed_));
+  EXPECT_EQ(uut_.read()->n, 2);
+  EXPECT_EQ(destroyed_, 1);
+}
+
+TEST_F(SnapshotTest, ReaderKeepsValueAlive) {
+  {
+    auto value = uut_.read();
+    uut_.publish(std::make_unique<Value>(2, &destroyed_));
+    uut_.publish(std::make_unique<Value>(3, &destroyed_));
+
+    EXPECT_EQ(value->n, 1);
+    EXPECT_EQ(uut_.read()->n, 3);
+    EXPECT_EQ(destroyed_, 0);
+  }
+
+  // The last reader leaving deletes the replaced values
+  EXPECT_EQ(destroyed_, 2);
+}
+
+TEST_F(SnapshotTest, ConcurrentReaders) {
+  std::atomic<bool> stop{false};
+  std::atomic<int> errors{0};
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      while (!stop) {
+        auto value = uut_.read();
+        if (value->n < 1 || value->destroyed != &destroyed_) ++errors;
+      }
+    });
+  }
+
+  for (int i = 2; i < 10'000; ++i) {
+    uut_.publish(std::make_unique<Value>(i, &destroyed_));
+  }
+
+  stop = true;
+  for (auto& thread : readers) thread.join();
+
+  EXPECT_EQ(errors, 0);
+  EXPECT_EQ(uut_.read()->n, 9'999);
+  EXPECT_EQ(destroyed_, 9'998);
+}
@@ -0,0 +1,100 @@
+/*
+ * This file is part of the Yogi Framework
+ * https://github.com/yohummus/yogi-framework.
+ *
+ * Copyright (c) 2020 Johannes Bergmann.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <test/common.h>
+
+#include <src/util/timing_wheel.h>
+
+class TimingWheelTest : public TestFixture {
+ protected:
+  boost::asio::io_context ioc_;
+  TimingWheel uut_{ioc_, 1ms, 16};
+};
+
+TEST_F(TimingWheelTest, Expire) {
+  int calls  = 0;
+  auto entry = uut_.make_entry([&] { ++calls; });
+  uut_.arm(entry, 5ms);
+
+  ioc_.run_for(2ms);
+  EXPECT_EQ(calls, 0);
+
+  ioc_.restart();
+  ioc_.run_for(50ms);
+  EXPECT_EQ(calls, 1);
+}
+
+TEST_F(TimingWheelTest, Rearm) {
+  int calls  = 0;
+  auto entry = uut_.make_entry([&] { ++calls; });
+
+  // Deadlines beyond one full rotation of the wheel
+  for (int i = 0; i < 10; ++i) {
+    uut_.arm(entry, 20ms);
+    ioc_.restart();
+    ioc_.run_for(5ms);
+  }
+
+  EXPECT_EQ(calls, 0);
+
+  ioc_.restart();
+  ioc_.run_for(50ms);
+  EXPECT_EQ(calls, 1);
+}
+
+TEST_F(TimingWheelTest, Disarm) {
+  int calls  = 0;
+  auto entry = uut_.make_entry([&] { ++calls; });
+  uut_.arm(entry, 5ms);
+  uut_.disarm(entry);
+
+  ioc_.run_for(20ms);
+  EXPECT_EQ(calls, 0);
+
+  uut_.arm(entry, 5ms);
+  ioc_.restart();
+  ioc_.run_for(20ms);
+  EXPECT_EQ(calls, 1);
+}
+
+TEST_F(TimingWheelTest, RearmFromHandler) {
+  int calls = 0;
+  TimingWheelEntryPtr entry;
+  entry = uut_.make_entry([&] {
+    if (++calls < 3) uut_.arm(entry, 2ms);
+  });
+  uut_.arm(entry, 2ms);
+
+  ioc_.run_for(50ms);
+  EXPECT_EQ(calls, 3);
+}
+
+TEST_F(TimingWheelTest, ManyEntries) {
+  std::vector<TimingWheelEntryPtr> entries;
+  int calls = 0;
+  for (int i = 0; i < 1000; ++i) {
+    entries.push_back(uut_.make_entry([&] { ++calls; }));
+    uut_.arm(entries.back(), std::chrono::milliseconds(i % 30));
+  }
+
+  ioc_.run_for(100ms);
+  EXPECT_EQ(calls, 1000);
+}
@@ -421,6 +421,25 @@ class ConnectionLostEventInfo : public BranchEventInfo {
   using BranchEventInfo::BranchEventInfo;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+/// Information associated with the kBroadcastsLost event.
+////////////////////////////////////////////////////////////////////////////////
+class BroadcastsLostEventInfo : public BranchEventInfo {
+  friend class Branch;
+
+ public:
+  /// Returns the number of broadcasts that got lost.
+  ///
+  /// \returns The number of broadcasts that got lost.
+  int count() const {
+    return to_json()["count"];
+  }
+
+ protected:
+  BroadcastsLostEventInfo(const Uuid& uuid, std::string&& json_str) : BranchEventInfo(uuid, std::move(json_str)) {
+  }
+};
+
 class Branch;
 
 /// Shared pointer to a branch.
@@ -853,6 +872,10 @@ class Branch : public ObjectT<Branch> {
                 call_await_event_fn<ConnectionLostEventInfo>(res, be, ev_res, data);
                 break;
 
+              case BranchEvents::kBroadcastsLost:
+                call_await_event_fn<BroadcastsLostEventInfo>(res, be, ev_res, data);
+                break;
+
               default: {
                 bool should_never_get_here = false;
                 assert(should_never_get_here);
@@ -929,6 +952,10 @@ class Branch : public ObjectT<Branch> {
   /// be called once the message has been put into the send queues of all
   /// connected branches.
   ///
+  /// Messages sent with Priority::kHigh overtake any queued messages with
+  /// Priority::kNormal as soon as the message currently being transmitted has
+  /// been sent completely.
+  ///
   /// The function returns an ID which uniquely identifies this send operation
   /// until \p fn has been called. It can be used in a subsequent
   /// cancel_send_broadcast() call to abort the operation.
@@ -939,10 +966,11 @@ class Branch : public ObjectT<Branch> {
   ///
   /// \param payload Payload to send.
   /// \param retry   Retry sending the message if a send queue is full.
+  /// \param prio    Send priority.
   /// \param fn      Handler to call once the operation finishes.
   ///
   /// \return ID of the send operation.
-  OperationId send_broadcast_async(const PayloadView& payload, bool retry, SendBroadcastFn fn) {
+  OperationId send_broadcast_async(const PayloadView& payload, bool retry, Priority prio, SendBroadcastFn fn) {
     struct CallbackData {
       SendBroadcastFn fn;
     };
@@ -952,6 +980,7 @@ class Branch : public ObjectT<Branch> {
 
     int res = detail::YOGI_BranchSendBroadcastAsync(
         handle(), static_cast<int>(payload.encoding()), payload.data(), payload.size(), retry ? 1 : 0,
+        static_cast<int>(prio),
         [](int res, int oid, void* userarg) {
           auto data = std::unique_ptr<CallbackData>(static_cast<CallbackData*>(userarg));
           if (!data->fn) return;
@@ -966,6 +995,38 @@ class Branch : public ObjectT<Branch> {
     return detail::make_operation_id(res);
   }
 
+  /// Sends a broadcast message to all connected branches.
+  ///
+  /// Broadcast messages contain arbitrary data encoded as JSON or MessagePack.
+  /// As opposed to sending messages via terminals, broadcast messages don't
+  /// have to comply with a defined schema for the payload; any data that can be
+  /// encoded is valid. This implies that validating the data is entirely up to
+  /// the user code.
+  ///
+  /// Setting the \p retry parameter to false will cause the function to skip
+  /// sending the message to branches that have a full send queue. If at least
+  /// one branch was skipped, the handler \p fn will be called with the
+  /// #kTxQueueFull error. If the parameter is set to true instead, \p fn will
+  /// be called once the message has been put into the send queues of all
+  /// connected branches.
+  ///
+  /// The function returns an ID which uniquely identifies this send operation
+  /// until \p fn has been called. It can be used in a subsequent
+  /// cancel_send_broadcast() call to abort the operation.
+  ///
+  /// \note
+  ///   The payload will be copied if necessary, i.e. \p payload only needs to
+  ///   remain valid until the function returns.
+  ///
+  /// \param payload Payload to send.
+  /// \param retry   Retry sending the message if a send queue is full.
+  /// \param fn      Handler to call once the operation finishes.
+  ///
+  /// \return ID of the send operation.
+  OperationId send_broadcast_async(const PayloadView& payload, bool retry, SendBroadcastFn fn) {
+    return send_broadcast_async(payload, retry, Priority::kNormal, fn);
+  }
+
   /// Sends a broadcast message to all connected branches.
   ///
   /// Broadcast messages contain arbitrary data encoded as JSON or MessagePack.
@@ -993,12 +1054,96 @@ class Branch : public ObjectT<Branch> {
     return send_broadcast_async(payload, true, fn);
   }
 
+  /// Sends a broadcast message to a single connected branch.
+  ///
+  /// This function works like send_broadcast_async() but only sends the
+  /// message to the branch with the UUID \p uuid. The message is received like
+  /// any other broadcast message via receive_broadcast_async().
+  ///
+  /// If no session with the branch is running, the function throws a
+  /// FailureException with the #kBranchNotConnected error.
+  ///
+  /// Setting the \p retry parameter to false will cause \p fn to be called
+  /// with the #kTxQueueFull error if the send queue of the connection is full.
+  /// If the parameter is set to true instead, \p fn will be called once the
+  /// message has been put into the send queue.
+  ///
+  /// The function returns an ID which uniquely identifies this send operation
+  /// until \p fn has been called. It can be used in a subsequent
+  /// cancel_send_broadcast() call to abort the operation.
+  ///
+  /// \note
+  ///   The payload will be copied if necessary, i.e. \p payload only needs to
+  ///   remain valid until the function returns.
+  ///
+  /// \param uuid    UUID of the receiving branch.
+  /// \param payload Payload to send.
+  /// \param retry   Retry sending the message if the send queue is full.
+  /// \param prio    Send priority.
+  /// \param fn      Handler to call once the operation finishes.
+  ///
+  /// \return ID of the send operation.
+  OperationId send_to_async(const Uuid& uuid, const PayloadView& payload, bool retry, Priority prio,
+                            SendBroadcastFn fn) {
+    struct CallbackData {
+      SendBroadcastFn fn;
+    };
+
+    auto data = std::make_unique<CallbackData>();
+    data->fn  = fn;
+
+    int res = detail::YOGI_BranchSendToAsync(
+        handle(), &uuid, static_cast<int>(payload.encoding()), payload.data(), payload.size(), retry ? 1 : 0,
+        static_cast<int>(prio),
+        [](int res, int oid, void* userarg) {
+          auto data = std::unique_ptr<CallbackData>(static_cast<CallbackData*>(userarg));
+          if (!data->fn) return;
+
+          detail::with_error_code_to_result(res, data->fn, detail::make_operation_id(oid));
+        },
+        data.get());
+
+    detail::check_error_code(res);
+    data.release();
+
+    return detail::make_operation_id(res);
+  }
+
+  /// Sends a broadcast message to a single connected branch.
+  ///
+  /// This function works like send_broadcast_async() but only sends the
+  /// message to the branch with the UUID \p uuid. The message is received like
+  /// any other broadcast message via receive_broadcast_async().
+  ///
+  /// If no session with the branch is running, the function throws a
+  /// FailureException with the #kBranchNotConnected error.
+  ///
+  /// The handler function \p fn will be called once the message has been put
+  /// into the send queue of the connection.
+  ///
+  /// The function returns an ID which uniquely identifies this send operation
+  /// until \p fn has been called. It can be used in a subsequent
+  /// cancel_send_broadcast() call to abort the operation.
+  ///
+  /// \note
+  ///   The payload will be copied if necessary, i.e. \p payload only needs to
+  ///   remain valid until the function returns.
+  ///
+  /// \param uuid    UUID of the receiving branch.
+  /// \param payload Payload to send.
+  /// \param fn      Handler to call once the operation finishes.
+  ///
+  /// \return ID of the send operation.
+  OperationId send_to_async(const Uuid& uuid, const PayloadView& payload, SendBroadcastFn fn) {
+    return send_to_async(uuid, payload, true, Priority::kNormal, fn);
+  }
+
   /// Cancels a send broadcast operation.
   ///
   /// Calling this function will cause the send operation with the specified
   /// operation ID \p oid to be canceled, resulting in the handler function
-  /// registered via the send_broadcast_async() call that returned the same \p oid
-  /// to be called with the #kCanceled error.
+  /// registered via the send_broadcast_async() or send_to_async() call that
+  /// returned the same \p oid to be called with the #kCanceled error.
   ///
   /// \note
   ///   If the send operation has already been carried out but the handler
@@ -274,11 +274,20 @@ _YOGI_WEAK_SYMBOL int (*YOGI_BranchSendBroadcast)(void* branch, int enc, const v
 
 // YOGI_BranchSendBroadcastAsync
 _YOGI_WEAK_SYMBOL int (*YOGI_BranchSendBroadcastAsync)(void* branch, int enc, const void* data, int datasize, int retry,
-                                                       void (*fn)(int res, int oid, void* userarg), void* userarg) =
-    Library::get_function_address<int (*)(void* branch, int enc, const void* data, int datasize, int retry,
+                                                       int prio, void (*fn)(int res, int oid, void* userarg),
+                                                       void* userarg) =
+    Library::get_function_address<int (*)(void* branch, int enc, const void* data, int datasize, int retry, int prio,
                                           void (*fn)(int res, int oid, void* userarg), void* userarg)>(
         "YOGI_BranchSendBroadcastAsync");
 
+// YOGI_BranchSendToAsync
+_YOGI_WEAK_SYMBOL int (*YOGI_BranchSendToAsync)(void* branch, const void* uuid, int enc, const void* data, int datasize,
+                                                int retry, int prio, void (*fn)(int res, int oid, void* userarg),
+                                                void* userarg) =
+    Library::get_function_address<int (*)(void* branch, const void* uuid, int enc, const void* data, int datasize,
+                                          int retry, int prio, void (*fn)(int res, int oid, void* userarg),
+                                          void* userarg)>("YOGI_BranchSendToAsync");
+
 // YOGI_BranchCancelSendBroadcast
 _YOGI_WEAK_SYMBOL int (*YOGI_BranchCancelSendBroadcast)(void* branch, int oid) =
     Library::get_function_address<int (*)(void* branch, int oid)>("YOGI_BranchCancelSendBroadcast");
@@ -96,6 +96,9 @@ enum class ErrorCode {
   kConfigurationValidationFailed    = -48, ///< Validating the configuration failed
   kWorkerAlreadyAdded               = -49, ///< The context has already been added as a worker
   kOpenFileFailed                   = -50, ///< Could not open file
+  kIncompatibleEncoding             = -51, ///< The data cannot be converted to the requested encoding
+  kBranchNotConnected               = -52, ///< Not connected to the given branch
+  kBroadcastsLost                   = -53, ///< Broadcasts got lost and cannot be delivered
   // :CODEGEN_END:
   // clang-format on
 };
@@ -156,6 +159,9 @@ inline std::string to_string<ErrorCode>(ErrorCode val) {
   case ErrorCode::kConfigurationValidationFailed:    return "kConfigurationValidationFailed";
   case ErrorCode::kWorkerAlreadyAdded:               return "kWorkerAlreadyAdded";
   case ErrorCode::kOpenFileFailed:                   return "kOpenFileFailed";
+  case ErrorCode::kIncompatibleEncoding:             return "kIncompatibleEncoding";
+  case ErrorCode::kBranchNotConnected:               return "kBranchNotConnected";
+  case ErrorCode::kBroadcastsLost:                   return "kBroadcastsLost";
   // :CODEGEN_END:
   }
   // clang-format on
@@ -271,6 +277,7 @@ enum class Encoding {
   // :CODEGEN_BEGIN:
   kJson    =   0, ///< Data is encoded as JSON
   kMsgpack =   1, ///< Data is encoded as MessagePack
+  kRaw     =   2, ///< Opaque binary data that is passed through unchanged
   // :CODEGEN_END:
   // clang-format on
 };
@@ -282,6 +289,33 @@ inline std::string to_string<Encoding>(Encoding val) {
   // :CODEGEN_BEGIN:
   case Encoding::kJson:    return "kJson";
   case Encoding::kMsgpack: return "kMsgpack";
+  case Encoding::kRaw:     return "kRaw";
+  // :CODEGEN_END:
+  }
+  // clang-format on
+
+  return "INVALID ENUM VALUE";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Priorities for sending messages to remote branches.
+////////////////////////////////////////////////////////////////////////////////
+enum class Priority {
+  // clang-format off
+  // :CODEGEN_BEGIN:
+  kNormal =   0, ///< Regular messages
+  kHigh   =   1, ///< Messages that overtake queued regular messages
+  // :CODEGEN_END:
+  // clang-format on
+};
+
+template <>
+inline std::string to_string<Priority>(Priority val) {
+  // clang-format off
+  switch (val) {
+  // :CODEGEN_BEGIN:
+  case Priority::kNormal: return "kNormal";
+  case Priority::kHigh:   return "kHigh";
   // :CODEGEN_END:
   }
   // clang-format on
@@ -961,8 +995,26 @@ enum class BranchEvents {
   //!
   kConnectionLost = (1 << 3),
 
+  //! Broadcasts multicast by a branch got lost and cannot be delivered
+  //!
+  //! This happens if lost datagrams could not be repaired in time or if the
+  //! receive queue was full while the sending branch was blocked due to the
+  //! block_peer broadcast queue policy. The event result is
+  //! #YOGI_ERR_BROADCASTS_LOST.
+  //!
+  //! Associated event information:
+  //!
+  //! \code
+  //!   {
+  //!     "uuid":  "123e4567-e89b-12d3-a456-426655440000",
+  //!     "count": 3
+  //!   }
+  //! \endcode
+  //!
+  kBroadcastsLost = (1 << 4),
+
   //! All branch events
-  kAll = (kBranchDiscovered | kBranchQueried | kConnectFinished | kConnectionLost),
+  kAll = (kBranchDiscovered | kBranchQueried | kConnectFinished | kConnectionLost | kBroadcastsLost),
 };
 
 inline BranchEvents operator~(BranchEvents flags) {
@@ -994,6 +1046,11 @@ inline std::string to_string<BranchEvents>(BranchEvents flags) {
     ss    = std::string{"kAll | "} + ss;
   }
 
+  if ((flags & BranchEvents::kBroadcastsLost) == BranchEvents::kBroadcastsLost) {
+    flags = flags & ~BranchEvents::kBroadcastsLost;
+    ss    = std::string{"kBroadcastsLost | "} + ss;
+  }
+
   if ((flags & BranchEvents::kConnectionLost) == BranchEvents::kConnectionLost) {
     flags = flags & ~BranchEvents::kConnectionLost;
     ss    = std::string{"kConnectionLost | "} + ss;
@@ -223,8 +223,11 @@ void (*Test::MOCK_BranchCancelAwaitEvent)(int (*fn)(void* branch))
 void (*Test::MOCK_BranchSendBroadcast)(int (*fn)(void* branch, int enc, const void* data, int datasize, int block))
  = detail::Library::get_function_address<void (*)(int (*fn)(void* branch, int enc, const void* data, int datasize, int block))>("MOCK_BranchSendBroadcast");
 
-void (*Test::MOCK_BranchSendBroadcastAsync)(int (*fn)(void* branch, int enc, const void* data, int datasize, int retry, void (*fn)(int res, int oid, void* userarg), void* userarg))
- = detail::Library::get_function_address<void (*)(int (*fn)(void* branch, int enc, const void* data, int datasize, int retry, void (*fn)(int res, int oid, void* userarg), void* userarg))>("MOCK_BranchSendBroadcastAsync");
+void (*Test::MOCK_BranchSendBroadcastAsync)(int (*fn)(void* branch, int enc, const void* data, int datasize, int retry, int prio, void (*fn)(int res, int oid, void* userarg), void* userarg))
+ = detail::Library::get_function_address<void (*)(int (*fn)(void* branch, int enc, const void* data, int datasize, int retry, int prio, void (*fn)(int res, int oid, void* userarg), void* userarg))>("MOCK_BranchSendBroadcastAsync");
+
+void (*Test::MOCK_BranchSendToAsync)(int (*fn)(void* branch, const void* uuid, int enc, const void* data, int datasize, int retry, int prio, void (*fn)(int res, int oid, void* userarg), void* userarg))
+ = detail::Library::get_function_address<void (*)(int (*fn)(void* branch, const void* uuid, int enc, const void* data, int datasize, int retry, int prio, void (*fn)(int res, int oid, void* userarg), void* userarg))>("MOCK_BranchSendToAsync");
 
 void (*Test::MOCK_BranchCancelSendBroadcast)(int (*fn)(void* branch, int oid))
  = detail::Library::get_function_address<void (*)(int (*fn)(void* branch, int oid))>("MOCK_BranchCancelSendBroadcast");
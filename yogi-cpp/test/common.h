@@ -98,7 +98,8 @@ class Test : public testing::Test {
   static void (*MOCK_BranchAwaitEventAsync)(int (*fn)(void* branch, int events, void* uuid, char* json, int jsonsize, void (*fn)(int res, int ev, int evres, void* userarg), void* userarg));
   static void (*MOCK_BranchCancelAwaitEvent)(int (*fn)(void* branch));
   static void (*MOCK_BranchSendBroadcast)(int (*fn)(void* branch, int enc, const void* data, int datasize, int block));
-  static void (*MOCK_BranchSendBroadcastAsync)(int (*fn)(void* branch, int enc, const void* data, int datasize, int retry, void (*fn)(int res, int oid, void* userarg), void* userarg));
+  static void (*MOCK_BranchSendBroadcastAsync)(int (*fn)(void* branch, int enc, const void* data, int datasize, int retry, int prio, void (*fn)(int res, int oid, void* userarg), void* userarg));
+  static void (*MOCK_BranchSendToAsync)(int (*fn)(void* branch, const void* uuid, int enc, const void* data, int datasize, int retry, int prio, void (*fn)(int res, int oid, void* userarg), void* userarg));
   static void (*MOCK_BranchCancelSendBroadcast)(int (*fn)(void* branch, int oid));
   static void (*MOCK_BranchReceiveBroadcastAsync)(int (*fn)(void* branch, void* uuid, int enc, void* data, int datasize, void (*fn)(int res, int size, void* userarg), void* userarg));
   static void (*MOCK_BranchCancelReceiveBroadcast)(int (*fn)(void* branch));
@@ -42,6 +42,7 @@ MAKE_CTORS_PUBLIC(yogi::BranchDiscoveredEventInfo, TestBranchDiscoveredEventInfo
 MAKE_CTORS_PUBLIC(yogi::BranchQueriedEventInfo, TestBranchQueriedEventInfo);
 MAKE_CTORS_PUBLIC(yogi::ConnectFinishedEventInfo, TestConnectFinishedEventInfo);
 MAKE_CTORS_PUBLIC(yogi::ConnectionLostEventInfo, TestConnectionLostEventInfo);
+MAKE_CTORS_PUBLIC(yogi::BroadcastsLostEventInfo, TestBroadcastsLostEventInfo);
 
 class BranchTest : public Test {};
 
@@ -209,6 +210,18 @@ TEST_F(BranchTest, ConnectionLostEventInfo) {
   EXPECT_EQ(info.uuid(), uuid);
 }
 
+TEST_F(BranchTest, BroadcastsLostEventInfo) {
+  yogi::Uuid uuid = {};
+  uuid.data()[0]  = 123;
+
+  TestBroadcastsLostEventInfo info(uuid, R"({
+    "count": 3
+  })");
+
+  EXPECT_EQ(info.uuid(), uuid);
+  EXPECT_EQ(info.count(), 3);
+}
+
 TEST_F(BranchTest, CreateFromConfiguration) {
   auto context = create_context();
   auto config  = create_configuration();
@@ -493,13 +506,14 @@ TEST_F(BranchTest, SendBroadcastAsync) {
     called = true;
   };
 
-  MOCK_BranchSendBroadcastAsync([](void* branch, int enc, const void* data, int datasize, int retry,
+  MOCK_BranchSendBroadcastAsync([](void* branch, int enc, const void* data, int datasize, int retry, int prio,
                                    void (*fn)(int res, int oid, void* userarg), void* userarg) {
     EXPECT_EQ(branch, kPointer);
     EXPECT_EQ(enc, YOGI_ENC_JSON);
     EXPECT_NE(data, nullptr);
     EXPECT_EQ(datasize, 6);
     EXPECT_EQ(retry, YOGI_TRUE);
+    EXPECT_EQ(prio, YOGI_PRIO_NORMAL);
     EXPECT_NE(userarg, nullptr);
     fn(YOGI_OK, 456, userarg);
     return 123;
@@ -517,20 +531,21 @@ TEST_F(BranchTest, SendBroadcastAsync) {
     called = true;
   };
 
-  MOCK_BranchSendBroadcastAsync([](void* branch, int enc, const void* data, int datasize, int retry,
+  MOCK_BranchSendBroadcastAsync([](void* branch, int enc, const void* data, int datasize, int retry, int prio,
                                    void (*fn)(int res, int oid, void* userarg), void* userarg) {
     EXPECT_EQ(enc, YOGI_ENC_MSGPACK);
     EXPECT_EQ(retry, YOGI_FALSE);
+    EXPECT_EQ(prio, YOGI_PRIO_HIGH);
     EXPECT_NE(userarg, nullptr);
     fn(YOGI_ERR_BUSY, 456, userarg);
     return 123;
   });
 
-  EXPECT_EQ(branch->send_broadcast_async(yogi::MsgpackView(s), false, fn2).value(), 123);
+  EXPECT_EQ(branch->send_broadcast_async(yogi::MsgpackView(s), false, yogi::Priority::kHigh, fn2).value(), 123);
   EXPECT_TRUE(called);
 
   // Error
-  MOCK_BranchSendBroadcastAsync([](void* branch, int enc, const void* data, int datasize, int retry,
+  MOCK_BranchSendBroadcastAsync([](void* branch, int enc, const void* data, int datasize, int retry, int prio,
                                    void (*fn)(int res, int oid, void* userarg), void* userarg) {
     EXPECT_EQ(branch, kPointer);
     return YOGI_ERR_TIMEOUT;
@@ -539,6 +554,47 @@ TEST_F(BranchTest, SendBroadcastAsync) {
   EXPECT_THROW(branch->send_broadcast_async(yogi::MsgpackView(s), fn), yogi::FailureException);
 }
 
+TEST_F(BranchTest, SendToAsync) {
+  auto branch = create_branch();
+
+  yogi::Uuid uuid = {};
+  uuid.data()[0]  = 123;
+
+  bool called = false;
+  auto fn     = [&](const yogi::Result& res, yogi::OperationId oid) {
+    EXPECT_EQ(res.error_code(), yogi::ErrorCode::kBusy);
+    EXPECT_EQ(oid.value(), 456);
+    called = true;
+  };
+
+  MOCK_BranchSendToAsync([](void* branch, const void* uuid, int enc, const void* data, int datasize, int retry,
+                            int prio, void (*fn)(int res, int oid, void* userarg), void* userarg) {
+    EXPECT_EQ(branch, kPointer);
+    EXPECT_EQ(static_cast<const unsigned char*>(uuid)[0], 123);
+    EXPECT_EQ(enc, YOGI_ENC_MSGPACK);
+    EXPECT_NE(data, nullptr);
+    EXPECT_EQ(datasize, 5);
+    EXPECT_EQ(retry, YOGI_FALSE);
+    EXPECT_EQ(prio, YOGI_PRIO_HIGH);
+    EXPECT_NE(userarg, nullptr);
+    fn(YOGI_ERR_BUSY, 456, userarg);
+    return 123;
+  });
+
+  const char* s = "hello";
+  EXPECT_EQ(branch->send_to_async(uuid, yogi::MsgpackView(s, 5), false, yogi::Priority::kHigh, fn).value(), 123);
+  EXPECT_TRUE(called);
+
+  // Error
+  MOCK_BranchSendToAsync([](void* branch, const void* uuid, int enc, const void* data, int datasize, int retry,
+                            int prio, void (*fn)(int res, int oid, void* userarg), void* userarg) {
+    EXPECT_EQ(branch, kPointer);
+    return YOGI_ERR_BRANCH_NOT_CONNECTED;
+  });
+
+  EXPECT_THROW(branch->send_to_async(uuid, yogi::JsonView(s), fn), yogi::FailureException);
+}
+
 TEST_F(BranchTest, CancelSendBroadcast) {
   auto branch = create_branch();
 
@@ -52,6 +52,12 @@ TEST_F(EnumsTest, Schema) {
 TEST_F(EnumsTest, Encoding) {
   CHECK(Encoding, kJson, YOGI_ENC_JSON);
   CHECK(Encoding, kMsgpack, YOGI_ENC_MSGPACK);
+  CHECK(Encoding, kRaw, YOGI_ENC_RAW);
+}
+
+TEST_F(EnumsTest, Priority) {
+  CHECK(Priority, kNormal, YOGI_PRIO_NORMAL);
+  CHECK(Priority, kHigh, YOGI_PRIO_HIGH);
 }
 
 TEST_F(EnumsTest, HttpStatus) {
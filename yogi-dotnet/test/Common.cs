@@ -603,7 +603,7 @@ namespace test
         public delegate void BranchSendBroadcastAsyncFnDelegate(int res, int oid, IntPtr userarg);
 
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
-        public delegate int BranchSendBroadcastAsyncDelegate(IntPtr branch, int enc, IntPtr data, int datasize, int retry, BranchSendBroadcastAsyncFnDelegate fn, IntPtr userarg);
+        public delegate int BranchSendBroadcastAsyncDelegate(IntPtr branch, int enc, IntPtr data, int datasize, int retry, int prio, BranchSendBroadcastAsyncFnDelegate fn, IntPtr userarg);
 
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
         internal delegate void BranchSendBroadcastAsyncMockDelegate(BranchSendBroadcastAsyncDelegate fn);
@@ -611,6 +611,19 @@ namespace test
         internal static BranchSendBroadcastAsyncMockDelegate MOCK_BranchSendBroadcastAsync
             = Yogi.Library.GetDelegateForFunction<BranchSendBroadcastAsyncMockDelegate>("MOCK_BranchSendBroadcastAsync");
 
+        // MOCK_BranchSendToAsync
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate void BranchSendToAsyncFnDelegate(int res, int oid, IntPtr userarg);
+
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate int BranchSendToAsyncDelegate(IntPtr branch, IntPtr uuid, int enc, IntPtr data, int datasize, int retry, int prio, BranchSendToAsyncFnDelegate fn, IntPtr userarg);
+
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        internal delegate void BranchSendToAsyncMockDelegate(BranchSendToAsyncDelegate fn);
+
+        internal static BranchSendToAsyncMockDelegate MOCK_BranchSendToAsync
+            = Yogi.Library.GetDelegateForFunction<BranchSendToAsyncMockDelegate>("MOCK_BranchSendToAsync");
+
         // MOCK_BranchCancelSendBroadcast
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
         public delegate int BranchCancelSendBroadcastDelegate(IntPtr branch, int oid);
@@ -58,6 +58,14 @@ namespace test
         {
             Assert.Equal(0, (int)Yogi.Encoding.Json);
             Assert.Equal(1, (int)Yogi.Encoding.Msgpack);
+            Assert.Equal(2, (int)Yogi.Encoding.Raw);
+        }
+
+        [Fact]
+        public void Priority()
+        {
+            Assert.Equal(0, (int)Yogi.Priority.Normal);
+            Assert.Equal(1, (int)Yogi.Priority.High);
         }
 
         [Fact]
@@ -398,11 +398,21 @@ public static partial class Yogi
         public delegate void BranchSendBroadcastAsyncFnDelegate(int res, int oid, IntPtr userarg);
 
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
-        public delegate int BranchSendBroadcastAsyncDelegate(SafeHandle branch, int enc, IntPtr data, int datasize, int retry, BranchSendBroadcastAsyncFnDelegate fn, IntPtr userarg);
+        public delegate int BranchSendBroadcastAsyncDelegate(SafeHandle branch, int enc, IntPtr data, int datasize, int retry, int prio, BranchSendBroadcastAsyncFnDelegate fn, IntPtr userarg);
 
         public static BranchSendBroadcastAsyncDelegate YOGI_BranchSendBroadcastAsync
             = Library.GetDelegateForFunction<BranchSendBroadcastAsyncDelegate>("YOGI_BranchSendBroadcastAsync");
 
+        // YOGI_BranchSendToAsync
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate void BranchSendToAsyncFnDelegate(int res, int oid, IntPtr userarg);
+
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate int BranchSendToAsyncDelegate(SafeHandle branch, IntPtr uuid, int enc, IntPtr data, int datasize, int retry, int prio, BranchSendToAsyncFnDelegate fn, IntPtr userarg);
+
+        public static BranchSendToAsyncDelegate YOGI_BranchSendToAsync
+            = Library.GetDelegateForFunction<BranchSendToAsyncDelegate>("YOGI_BranchSendToAsync");
+
         // YOGI_BranchCancelSendBroadcast
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
         public delegate int BranchCancelSendBroadcastDelegate(SafeHandle branch, int oid);
@@ -183,6 +183,15 @@ public static partial class Yogi
         /// <summary>Could not open file</summary>
         OpenFileFailed = -50,
 
+        /// <summary>The data cannot be converted to the requested encoding</summary>
+        IncompatibleEncoding = -51,
+
+        /// <summary>Not connected to the given branch</summary>
+        BranchNotConnected = -52,
+
+        /// <summary>Broadcasts got lost and cannot be delivered</summary>
+        BroadcastsLost = -53,
+
         // :CODEGEN_END:
     }
 
@@ -275,6 +284,25 @@ public static partial class Yogi
         /// <summary>Data is encoded as MessagePack</summary>
         Msgpack = 1,
 
+        /// <summary>Opaque binary data that is passed through unchanged</summary>
+        Raw = 2,
+
+        // :CODEGEN_END:
+    }
+
+    /// <summary>
+    /// Priorities for sending messages to remote branches.
+    /// </summary>
+    public enum Priority
+    {
+        // :CODEGEN_BEGIN:
+
+        /// <summary>Regular messages</summary>
+        Normal = 0,
+
+        /// <summary>Messages that overtake queued regular messages</summary>
+        High = 1,
+
         // :CODEGEN_END:
     }
 
@@ -749,8 +777,27 @@ public static partial class Yogi
         /// </summary>
         ConnectionLost = 1 << 3,
 
+        /// <summary>
+        /// Broadcasts multicast by a branch got lost and cannot be delivered
+        /// 
+        /// This happens if lost datagrams could not be repaired in time or if the
+        /// receive queue was full while the sending branch was blocked due to the
+        /// block_peer broadcast queue policy. The event result is
+        /// #YOGI_ERR_BROADCASTS_LOST.
+        /// 
+        /// Associated event information:
+        /// 
+        /// \code
+        ///   {
+        ///     "uuid":  "123e4567-e89b-12d3-a456-426655440000",
+        ///     "count": 3
+        ///   }
+        /// \endcode
+        /// </summary>
+        BroadcastsLost = 1 << 4,
+
         /// <summary>All branch events</summary>
-        All = BranchDiscovered | BranchQueried | ConnectFinished | ConnectionLost,
+        All = BranchDiscovered | BranchQueried | ConnectFinished | ConnectionLost | BroadcastsLost,
 
         // :CODEGEN_END:
     }
@@ -563,7 +563,16 @@ class Mocks:
     def MOCK_BranchSendBroadcastAsync(self, fn):
         mock_fn = yogi._library.yogi_core.MOCK_BranchSendBroadcastAsync
         mock_fn.restype = None
-        mock_fn.argtypes = [CFUNCTYPE(c_int, c_void_p, c_int, c_void_p, c_int, c_int,
+        mock_fn.argtypes = [CFUNCTYPE(c_int, c_void_p, c_int, c_void_p, c_int, c_int, c_int,
+                                      CFUNCTYPE(None, c_int, c_int, c_void_p), c_void_p)]
+        wrapped_fn = mock_fn.argtypes[0](fn)
+        self._keepalive.append(wrapped_fn)
+        mock_fn(wrapped_fn)
+
+    def MOCK_BranchSendToAsync(self, fn):
+        mock_fn = yogi._library.yogi_core.MOCK_BranchSendToAsync
+        mock_fn.restype = None
+        mock_fn.argtypes = [CFUNCTYPE(c_int, c_void_p, c_void_p, c_int, c_void_p, c_int, c_int, c_int,
                                       CFUNCTYPE(None, c_int, c_int, c_void_p), c_void_p)]
         wrapped_fn = mock_fn.argtypes[0](fn)
         self._keepalive.append(wrapped_fn)
@@ -20,7 +20,7 @@
 import yogi
 import pytest
 import json
-from ctypes import memmove, c_char_p
+from ctypes import memmove, c_char_p, string_at
 from uuid import UUID
 
 from .conftest import Mocks
@@ -50,12 +50,16 @@ def make_branch_info_string(uuid: str = "123e4567-e89b-12d3-a456-426655440000")
         # LocalBranchInfo
         "advertising_address": "239.255.0.1",
         "advertising_port": 12345,
+
+        # BroadcastsLostEventInfo
+        "count": 3,
     })
 
 
 @pytest.mark.parametrize("info_cls", [yogi.BranchInfo, yogi.RemoteBranchInfo, yogi.LocalBranchInfo,
                                       yogi.BranchEventInfo, yogi.BranchDiscoveredEventInfo, yogi.BranchQueriedEventInfo,
-                                      yogi.ConnectFinishedEventInfo, yogi.ConnectionLostEventInfo])
+                                      yogi.ConnectFinishedEventInfo, yogi.ConnectionLostEventInfo,
+                                      yogi.BroadcastsLostEventInfo])
 def test_branch_info(info_cls, mocker):
     """Verifies that the BranchInfo/BranchEventInfo and derived classes have the expected properties"""
     branch_info_string = make_branch_info_string()
@@ -97,6 +101,9 @@ def test_branch_info(info_cls, mocker):
         assert info.tcp_server_address == "192.168.1.1"
         assert info.tcp_server_port == 11223
 
+    if isinstance(info, yogi.BroadcastsLostEventInfo):
+        assert info.count == 3
+
     mock_parse.assert_called_once_with("2018-04-23T18:25:43.511Z")
 
 
@@ -281,12 +288,13 @@ def test_send_broadcast_async(mocks: Mocks, branch: yogi.Branch):
     """Verifies that a broadcast can be sent asynchronously"""
     called = False
 
-    def fn(branch, enc, data, datasize, retry, handler_fn, userarg):
+    def fn(branch, enc, data, datasize, retry, prio, handler_fn, userarg):
         assert branch == 8888
         assert enc == yogi.Encoding.JSON
         assert c_char_p(data).value == b'{}'
         assert datasize == 3
         assert retry == 1
+        assert prio == yogi.Priority.NORMAL
         assert handler_fn
         handler_fn(yogi.ErrorCode.OK, 345, userarg)
         return 111
@@ -302,8 +310,9 @@ def test_send_broadcast_async(mocks: Mocks, branch: yogi.Branch):
     assert branch.send_broadcast_async(yogi.JsonView({}), handler_fn, retry=True).value == 111
     assert called
 
-    def fn2(branch, enc, data, datasize, retry, handler_fn, userarg):
+    def fn2(branch, enc, data, datasize, retry, prio, handler_fn, userarg):
         assert retry == 0
+        assert prio == yogi.Priority.HIGH
         handler_fn(yogi.ErrorCode.BUSY, 345, userarg)
         return 222
 
@@ -311,7 +320,41 @@ def test_send_broadcast_async(mocks: Mocks, branch: yogi.Branch):
         assert res.error_code == yogi.ErrorCode.BUSY
 
     mocks.MOCK_BranchSendBroadcastAsync(fn2)
-    assert branch.send_broadcast_async(yogi.JsonView({}), handler_fn2, retry=False).value == 222
+    assert branch.send_broadcast_async(yogi.JsonView({}), handler_fn2, retry=False,
+                                      priority=yogi.Priority.HIGH).value == 222
+
+
+def test_send_to_async(mocks: Mocks, branch: yogi.Branch):
+    """Verifies that a broadcast can be sent to a single branch"""
+    called = False
+    uuid = UUID('123e4567-e89b-12d3-a456-426655440000')
+
+    def fn(branch, uuid_ptr, enc, data, datasize, retry, prio, handler_fn, userarg):
+        assert branch == 8888
+        assert string_at(uuid_ptr, 16) == uuid.bytes
+        assert enc == yogi.Encoding.JSON
+        assert retry == 0
+        assert prio == yogi.Priority.HIGH
+        handler_fn(yogi.ErrorCode.OK, 345, userarg)
+        return 111
+
+    def handler_fn(res, oid):
+        assert isinstance(res, yogi.Success)
+        assert oid.value == 345
+        nonlocal called
+        called = True
+
+    mocks.MOCK_BranchSendToAsync(fn)
+    assert branch.send_to_async(uuid, yogi.JsonView({}), handler_fn, retry=False,
+                                priority=yogi.Priority.HIGH).value == 111
+    assert called
+
+    def fn2(branch, uuid_ptr, enc, data, datasize, retry, prio, handler_fn, userarg):
+        return yogi.ErrorCode.BRANCH_NOT_CONNECTED
+
+    mocks.MOCK_BranchSendToAsync(fn2)
+    with pytest.raises(yogi.FailureException):
+        branch.send_to_async(uuid, yogi.JsonView({}), handler_fn)
 
 
 def test_cancel_send_broadcast(mocks: Mocks, branch: yogi.Branch):
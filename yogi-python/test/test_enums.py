@@ -42,6 +42,13 @@ def test_encoding():
     """Checks the Encoding enum"""
     assert yogi.Encoding.JSON == 0
     assert yogi.Encoding.MSGPACK == 1
+    assert yogi.Encoding.RAW == 2
+
+
+def test_priority():
+    """Checks the Priority enum"""
+    assert yogi.Priority.NORMAL == 0
+    assert yogi.Priority.HIGH == 1
 
 
 def test_http_status():
@@ -18,12 +18,13 @@
 # Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 from ._branch import BranchInfo, RemoteBranchInfo, LocalBranchInfo, BranchEventInfo, BranchDiscoveredEventInfo
-from ._branch import BranchQueriedEventInfo, ConnectFinishedEventInfo, ConnectionLostEventInfo, Branch
+from ._branch import BranchQueriedEventInfo, ConnectFinishedEventInfo, ConnectionLostEventInfo, BroadcastsLostEventInfo
+from ._branch import Branch
 from ._configuration import Configuration
 from ._constants import constants
 from ._context import Context
 from ._duration import Duration
-from ._enums import ErrorCode, Verbosity, Stream, Schema, Encoding, HttpStatus, WebProcessAction
+from ._enums import ErrorCode, Verbosity, Stream, Schema, Encoding, Priority, HttpStatus, WebProcessAction
 from ._enums import WebProcessUpdate, HttpMethods, Signals, ConfigurationFlags, CommandLineOptions, BranchEvents
 from ._errors import ErrorCode, Result, Failure, DetailedFailure, Success
 from ._errors import Exception, FailureException, DetailedFailureException
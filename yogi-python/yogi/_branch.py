@@ -26,7 +26,7 @@ from ctypes import c_void_p, c_char, c_char_p, byref, create_string_buffer, size
 from ._configuration import Configuration
 from ._constants import Constants
 from ._context import Context
-from ._enums import BranchEvents, Encoding
+from ._enums import BranchEvents, Encoding, Priority
 from ._errors import ErrorCode, FailureException, Result, Success, error_code_to_result, false_if_specific_ec_else_raise
 from ._handler import Handler
 from ._json_view import JsonView
@@ -218,6 +218,18 @@ class ConnectionLostEventInfo(BranchEventInfo):
         super().__init__(info_string)
 
 
+class BroadcastsLostEventInfo(BranchEventInfo):
+    """Information associated with the BROADCASTS_LOST event."""
+
+    def __init__(self, info_string: str):
+        super().__init__(info_string)
+
+    @property
+    def count(self) -> int:
+        """Number of broadcasts that got lost."""
+        return self._info["count"]
+
+
 AwaitEventFn = Callable[[Result, BranchEvents, Result, Optional[BranchEventInfo]], Any]
 SendBroadcastFn = Callable[[Result, OperationId], Any]
 ReceiveBroadcastFn = Callable[[Result, UUID, PayloadView, Optional[bytearray]], Any]
@@ -495,6 +507,8 @@ class Branch(Object):
                     info = ConnectFinishedEventInfo(string)
                 elif event == BranchEvents.CONNECTION_LOST:
                     info = ConnectionLostEventInfo(string)
+                elif event == BranchEvents.BROADCASTS_LOST:
+                    info = BroadcastsLostEventInfo(string)
                 else:
                     info = BranchEventInfo(string)
 
@@ -550,7 +564,7 @@ class Branch(Object):
         return false_if_specific_ec_else_raise(res, ErrorCode.TX_QUEUE_FULL)
 
     def send_broadcast_async(self, payload: Union[PayloadView, JsonView, MsgpackView], fn: SendBroadcastFn, *,
-                             retry: bool = True) -> OperationId:
+                             retry: bool = True, priority: Priority = Priority.NORMAL) -> OperationId:
         """Sends a broadcast message to all connected branches.
 
         Broadcast messages contain arbitrary data encoded as JSON or
@@ -562,14 +576,19 @@ class Branch(Object):
         The handler function fn will be called once the message has been put
         into the send queues of all connected branches.
 
+        Messages sent with Priority.HIGH overtake any queued messages with
+        Priority.NORMAL as soon as the message currently being transmitted has
+        been sent completely.
+
         The function returns an ID which uniquely identifies this send
         operation until fn has been called. It can be used in a subsequent
         cancel_send_broadcast() call to abort the operation.
 
         Args:
-            payload: Payload to send.
-            fn:      Handler to call once the operation finishes.
-            retry:   Retry sending the message if a send queue is full.
+            payload:  Payload to send.
+            fn:       Handler to call once the operation finishes.
+            retry:    Retry sending the message if a send queue is full.
+            priority: Send priority.
 
         Returns:
             ID of the send operation.
@@ -580,9 +599,49 @@ class Branch(Object):
         def wrapped_fn(res, oid):
             fn(res, OperationId(oid))
 
-        with Handler(yogi_core.YOGI_BranchSendBroadcastAsync.argtypes[5], wrapped_fn) as handler:
+        with Handler(yogi_core.YOGI_BranchSendBroadcastAsync.argtypes[6], wrapped_fn) as handler:
             res = yogi_core.YOGI_BranchSendBroadcastAsync(self._handle, payload.encoding, payload.data.obj,
-                                                          payload.size, 1 if retry else 0, handler, None)
+                                                          payload.size, 1 if retry else 0, priority, handler, None)
+
+        return OperationId(res.value)
+
+    def send_to_async(self, uuid: UUID, payload: Union[PayloadView, JsonView, MsgpackView], fn: SendBroadcastFn, *,
+                      retry: bool = True, priority: Priority = Priority.NORMAL) -> OperationId:
+        """Sends a broadcast message to a single connected branch.
+
+        This function works like send_broadcast_async() but only sends the
+        message to the branch with the given UUID. The message is received
+        like any other broadcast message via receive_broadcast_async().
+
+        If no session with the branch is running, the function raises a
+        FailureException with the BRANCH_NOT_CONNECTED error.
+
+        The handler function fn will be called once the message has been put
+        into the send queue of the connection.
+
+        The function returns an ID which uniquely identifies this send
+        operation until fn has been called. It can be used in a subsequent
+        cancel_send_broadcast() call to abort the operation.
+
+        Args:
+            uuid:     UUID of the receiving branch.
+            payload:  Payload to send.
+            fn:       Handler to call once the operation finishes.
+            retry:    Retry sending the message if the send queue is full.
+            priority: Send priority.
+
+        Returns:
+            ID of the send operation.
+        """
+        if not isinstance(payload, PayloadView):
+            payload = PayloadView(payload)
+
+        def wrapped_fn(res, oid):
+            fn(res, OperationId(oid))
+
+        with Handler(yogi_core.YOGI_BranchSendToAsync.argtypes[7], wrapped_fn) as handler:
+            res = yogi_core.YOGI_BranchSendToAsync(self._handle, uuid.bytes, payload.encoding, payload.data.obj,
+                                                   payload.size, 1 if retry else 0, priority, handler, None)
 
         return OperationId(res.value)
 
@@ -591,8 +650,8 @@ class Branch(Object):
 
         Calling this function will cause the send operation with the specified
         operation ID to be canceled, resulting in the handler function
-        registered via the send_broadcast_async() call that returned the same
-        operation ID to be called with the Canceled error.
+        registered via the send_broadcast_async() or send_to_async() call that
+        returned the same operation ID to be called with the Canceled error.
 
         Note: If the send operation has already been carried out but the
               handler function has not been called yet, then cancelling the
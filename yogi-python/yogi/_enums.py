@@ -84,6 +84,9 @@ class ErrorCode(DocIntEnum):
     CONFIGURATION_VALIDATION_FAILED = -48, 'Validating the configuration failed'
     WORKER_ALREADY_ADDED = -49, 'The context has already been added as a worker'
     OPEN_FILE_FAILED = -50, 'Could not open file'
+    INCOMPATIBLE_ENCODING = -51, 'The data cannot be converted to the requested encoding'
+    BRANCH_NOT_CONNECTED = -52, 'Not connected to the given branch'
+    BROADCASTS_LOST = -53, 'Broadcasts got lost and cannot be delivered'
     # :CODEGEN_END:
 
 
@@ -129,6 +132,15 @@ class Encoding(DocIntEnum):
     # :CODEGEN_BEGIN:
     JSON = 0, 'Data is encoded as JSON'
     MSGPACK = 1, 'Data is encoded as MessagePack'
+    RAW = 2, 'Opaque binary data that is passed through unchanged'
+    # :CODEGEN_END:
+
+
+class Priority(DocIntEnum):
+    """Priorities for sending messages to remote branches"""
+    # :CODEGEN_BEGIN:
+    NORMAL = 0, 'Regular messages'
+    HIGH = 1, 'Messages that overtake queued regular messages'
     # :CODEGEN_END:
 
 
@@ -418,10 +430,29 @@ class BranchEvents(DocIntEnum):
         \endcode
         ''').strip()
 
+    BROADCASTS_LOST = 1 << 4, textwrap.dedent(r'''
+        Broadcasts multicast by a branch got lost and cannot be delivered
+        
+        This happens if lost datagrams could not be repaired in time or if the
+        receive queue was full while the sending branch was blocked due to the
+        block_peer broadcast queue policy. The event result is
+        #YOGI_ERR_BROADCASTS_LOST.
+        
+        Associated event information:
+        
+        \code
+          {
+            "uuid":  "123e4567-e89b-12d3-a456-426655440000",
+            "count": 3
+          }
+        \endcode
+        ''').strip()
+
     ALL = BRANCH_DISCOVERED[0] | \
         BRANCH_QUERIED[0] | \
         CONNECT_FINISHED[0] | \
-        CONNECTION_LOST[0], 'All branch events'
+        CONNECTION_LOST[0] | \
+        BROADCASTS_LOST[0], 'All branch events'
 
 # :CODEGEN_END:
 
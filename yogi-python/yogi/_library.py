@@ -213,7 +213,11 @@ yogi_core.YOGI_BranchSendBroadcast.argtypes = [c_void_p, c_int, c_void_p, c_int,
 
 yogi_core.YOGI_BranchSendBroadcastAsync.restype = api_result_handler
 yogi_core.YOGI_BranchSendBroadcastAsync.argtypes = [
-    c_void_p, c_int, c_void_p, c_int, c_int, CFUNCTYPE(None, c_int, c_int, c_void_p), c_void_p]
+    c_void_p, c_int, c_void_p, c_int, c_int, c_int, CFUNCTYPE(None, c_int, c_int, c_void_p), c_void_p]
+
+yogi_core.YOGI_BranchSendToAsync.restype = api_result_handler
+yogi_core.YOGI_BranchSendToAsync.argtypes = [
+    c_void_p, c_void_p, c_int, c_void_p, c_int, c_int, c_int, CFUNCTYPE(None, c_int, c_int, c_void_p), c_void_p]
 
 yogi_core.YOGI_BranchCancelSendBroadcast.restype = c_int
 yogi_core.YOGI_BranchCancelSendBroadcast.argtypes = [c_void_p, c_int]